@@ -3,8 +3,11 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <consensus/amount.h>
 #include <consensus/consensus.h>
+#include <consensus/validation.h>
 #include <node/miner.h>
+#include <policy/policy.h>
 #include <primitives/transaction.h>
 #include <random.h>
 #include <script/script.h>
@@ -12,12 +15,17 @@
 #include <test/util/mining.h>
 #include <test/util/script.h>
 #include <test/util/setup_common.h>
+#include <test/util/txmempool.h>
+#include <txgraph.h>
+#include <txmempool.h>
+#include <util/string.h>
 #include <validation.h>
 
 #include <array>
 #include <cassert>
 #include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 
 using node::BlockAssembler;
@@ -69,5 +77,74 @@ static void BlockAssemblerAddPackageTxns(benchmark::Bench& bench)
     });
 }
 
+/**
+ * Fill the mempool with several blocks worth of clusters of up to the largest
+ * size the transaction graph linearizes. Parents often pay less than their
+ * children, so that selection has to account for ancestors.
+ */
+static void PopulateClusters(CTxMemPool& pool, FastRandomContext& det_rand)
+{
+    TestMemPoolEntryHelper entry;
+    for (int cluster = 0; cluster < 2'000; ++cluster) {
+        std::vector<COutPoint> unspent;
+        const int cluster_size{int(det_rand.randrange(MAX_CLUSTER_COUNT_LIMIT)) + 1};
+        for (int i = 0; i < cluster_size; ++i) {
+            CMutableTransaction tx;
+            if (unspent.empty() || det_rand.randrange(8) == 0) {
+                tx.vin.emplace_back(COutPoint{Txid::FromUint256(det_rand.rand256()), 0});
+            }
+            for (int in = 0; in < 2 && !unspent.empty(); ++in) {
+                const size_t idx{det_rand.randrange(unspent.size())};
+                tx.vin.emplace_back(unspent[idx]);
+                unspent[idx] = unspent.back();
+                unspent.pop_back();
+            }
+            tx.vin[0].scriptSig = CScript() << det_rand.randbytes(det_rand.randrange(200));
+            tx.vout.resize(det_rand.randrange(3) + 1);
+            for (auto& out : tx.vout) {
+                out.scriptPubKey = P2WSH_OP_TRUE;
+                out.nValue = COIN;
+            }
+            const CAmount fee{int64_t(det_rand.randrange(i == 0 ? 1'000 : 20'000))};
+            AddToMempool(pool, entry.Fee(fee).FromTx(tx));
+            for (uint32_t n = 0; n < tx.vout.size(); ++n) unspent.emplace_back(tx.GetHash(), n);
+        }
+    }
+}
+
+static void BlockAssemblerSelection(benchmark::Bench& bench, bool ancestor_score_selection)
+{
+    FastRandomContext det_rand{true};
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>()};
+    PopulateClusters(*testing_setup->m_node.mempool, det_rand);
+    BlockAssembler::Options assembler_options;
+    assembler_options.test_block_validity = false;
+    assembler_options.coinbase_output_script = P2WSH_OP_TRUE;
+    assembler_options.ancestor_score_selection = ancestor_score_selection;
+
+    // Record the quality of the template, for comparing both algorithms.
+    const auto block_template{BlockAssembler{testing_setup->m_node.chainman->ActiveChainstate(), testing_setup->m_node.mempool.get(), assembler_options}.CreateNewBlock()};
+    CAmount fees{0};
+    for (const CAmount fee : block_template->vTxFees) fees += fee;
+    bench.context("fees", util::ToString(fees));
+    bench.context("weight", util::ToString(GetBlockWeight(block_template->block)));
+
+    bench.run([&] {
+        PrepareBlock(testing_setup->m_node, assembler_options);
+    });
+}
+
+static void BlockAssemblerChunks(benchmark::Bench& bench)
+{
+    BlockAssemblerSelection(bench, /*ancestor_score_selection=*/false);
+}
+
+static void BlockAssemblerAncestorScore(benchmark::Bench& bench)
+{
+    BlockAssemblerSelection(bench, /*ancestor_score_selection=*/true);
+}
+
 BENCHMARK(AssembleBlock, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockAssemblerAncestorScore, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockAssemblerChunks, benchmark::PriorityLevel::HIGH);
 BENCHMARK(BlockAssemblerAddPackageTxns, benchmark::PriorityLevel::LOW);
@@ -2,11 +2,17 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <arith_uint256.h>
 #include <bench/bench.h>
+#include <chain.h>
+#include <node/blockstorage.h>
+#include <random.h>
 #include <test/util/setup_common.h>
+#include <uint256.h>
 #include <validation.h>
 
 #include <memory>
+#include <vector>
 
 static void CheckBlockIndex(benchmark::Bench& bench)
 {
@@ -18,5 +24,61 @@ static void CheckBlockIndex(benchmark::Bench& bench)
     });
 }
 
+/** Build a block tree of `num_blocks` entries in `map`: a main chain with a short fork every 100 blocks. */
+static std::vector<CBlockIndex*> BuildBlockTree(node::BlockMap& map, int num_blocks)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<CBlockIndex*> tips;
+    CBlockIndex* prev{nullptr};
+    for (int i = 0; i < num_blocks; ++i) {
+        CBlockIndex* parent{prev};
+        // Every 100th block starts a fork off a recent main chain block.
+        const bool fork{i % 100 == 99 && prev && prev->nHeight > 10};
+        if (fork) parent = prev->GetAncestor(prev->nHeight - int(rng.randrange(10)));
+        const auto [it, inserted]{map.try_emplace(rng.rand256())};
+        CBlockIndex* index{&it->second};
+        index->phashBlock = &it->first;
+        index->pprev = parent;
+        index->nHeight = parent ? parent->nHeight + 1 : 0;
+        index->nChainWork = (parent ? parent->nChainWork : arith_uint256{0}) + 1;
+        index->BuildSkip();
+        if (fork) {
+            tips.push_back(index);
+        } else {
+            prev = index;
+        }
+    }
+    tips.push_back(prev);
+    return tips;
+}
+
+static void BlockIndexGetAncestor(benchmark::Bench& bench)
+{
+    node::BlockMapMemoryResource resource;
+    node::BlockMap map{0, BlockHasher{}, std::equal_to<uint256>{}, &resource};
+    const auto tips{BuildBlockTree(map, 200'000)};
+    const CBlockIndex* tip{tips.back()};
+    FastRandomContext rng{/*fDeterministic=*/true};
+    bench.batch(1).unit("lookup").run([&] {
+        const CBlockIndex* ancestor{tip->GetAncestor(rng.randrange(tip->nHeight))};
+        ankerl::nanobench::doNotOptimizeAway(ancestor);
+    });
+}
+
+static void BlockIndexLastCommonAncestor(benchmark::Bench& bench)
+{
+    node::BlockMapMemoryResource resource;
+    node::BlockMap map{0, BlockHasher{}, std::equal_to<uint256>{}, &resource};
+    const auto tips{BuildBlockTree(map, 200'000)};
+    FastRandomContext rng{/*fDeterministic=*/true};
+    bench.batch(1).unit("lookup").run([&] {
+        const CBlockIndex* a{tips[rng.randrange(tips.size())]};
+        const CBlockIndex* b{tips[rng.randrange(tips.size())]};
+        const CBlockIndex* fork{LastCommonAncestor(a, b)};
+        ankerl::nanobench::doNotOptimizeAway(fork);
+    });
+}
 
 BENCHMARK(CheckBlockIndex, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockIndexGetAncestor, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockIndexLastCommonAncestor, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,73 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chainparams.h>
+#include <coins.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+
+#include <cassert>
+#include <optional>
+#include <vector>
+
+static constexpr int NUM_TXIDS{50'000};
+//! Roughly the number of inputs of a full block.
+static constexpr int NUM_LOOKUPS{5'000};
+
+enum class LookupMode { SINGLE, BATCH };
+
+static void CoinsDBLookupBench(benchmark::Bench& bench, LookupMode mode, int read_threads)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    CoinsViewOptions options;
+    options.read_threads = read_threads;
+    CCoinsViewDB db{{.path = "", .cache_bytes = 1 << 23, .memory_only = true}, options};
+
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<Txid> txids;
+    {
+        CCoinsViewCache cache{&db};
+        for (int i = 0; i < NUM_TXIDS; ++i) {
+            txids.push_back(Txid::FromUint256(rng.rand256()));
+            for (uint32_t n = 0; n < 2; ++n) {
+                Coin coin{CTxOut{rng.randrange(50 * COIN), CScript() << OP_DUP << OP_HASH160 << rng.randbytes(20) << OP_EQUALVERIFY << OP_CHECKSIG}, /*nHeightIn=*/1, /*fCoinBaseIn=*/false};
+                cache.AddCoin(COutPoint{txids.back(), n}, std::move(coin), /*possible_overwrite=*/false);
+            }
+        }
+        cache.SetBestBlock(Params().GenesisBlock().GetHash());
+        const bool flushed{cache.Flush()};
+        assert(flushed);
+    }
+
+    // Random outpoints, some spending both outputs of a transaction and a
+    // few missing, like the inputs of a block.
+    std::vector<COutPoint> outpoints;
+    while (outpoints.size() < NUM_LOOKUPS) {
+        const Txid& txid{txids[rng.randrange(txids.size())]};
+        outpoints.emplace_back(txid, rng.randrange(3));
+        if (rng.randrange(4) == 0) outpoints.emplace_back(txid, outpoints.back().n ^ 1);
+    }
+
+    bench.batch(outpoints.size()).unit("coin").run([&] {
+        size_t found{0};
+        if (mode == LookupMode::SINGLE) {
+            for (const COutPoint& outpoint : outpoints) found += db.GetCoin(outpoint).has_value();
+        } else {
+            for (const auto& coin : db.GetCoins(outpoints)) found += coin.has_value();
+        }
+        assert(found > outpoints.size() / 2);
+    });
+}
+
+static void CoinsDBGetCoin(benchmark::Bench& bench) { CoinsDBLookupBench(bench, LookupMode::SINGLE, 1); }
+static void CoinsDBGetCoins1Thread(benchmark::Bench& bench) { CoinsDBLookupBench(bench, LookupMode::BATCH, 1); }
+static void CoinsDBGetCoins4Threads(benchmark::Bench& bench) { CoinsDBLookupBench(bench, LookupMode::BATCH, 4); }
+
+BENCHMARK(CoinsDBGetCoin, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CoinsDBGetCoins1Thread, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CoinsDBGetCoins4Threads, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,59 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chainparams.h>
+#include <coins.h>
+#include <kernel/coinstats.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+#include <validation.h>
+
+#include <cassert>
+
+static constexpr int NUM_COINS{50'000};
+
+static void ComputeUTXOStatsBench(benchmark::Bench& bench, kernel::CoinStatsHashType hash_type, int num_threads)
+{
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>()};
+    auto& blockman{testing_setup->m_node.chainman->m_blockman};
+
+    CCoinsViewDB db{{.path = "", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+    {
+        CCoinsViewCache cache{&db};
+        FastRandomContext rng{/*fDeterministic=*/true};
+        for (int i = 0; i < NUM_COINS; ++i) {
+            const Txid txid{Txid::FromUint256(rng.rand256())};
+            for (uint32_t n = 0; n < 2; ++n) {
+                Coin coin{CTxOut{rng.randrange(50 * COIN), CScript() << OP_DUP << OP_HASH160 << rng.randbytes(20) << OP_EQUALVERIFY << OP_CHECKSIG}, /*nHeightIn=*/1, /*fCoinBaseIn=*/false};
+                cache.AddCoin(COutPoint{txid, n}, std::move(coin), /*possible_overwrite=*/false);
+            }
+        }
+        cache.SetBestBlock(Params().GenesisBlock().GetHash());
+        const bool flushed{cache.Flush()};
+        assert(flushed);
+    }
+
+    bench.batch(NUM_COINS * 2).unit("coin").run([&] {
+        const auto stats{kernel::ComputeUTXOStats(hash_type, &db, blockman, {}, num_threads)};
+        assert(stats && stats->coins_count == NUM_COINS * 2);
+    });
+}
+
+static void ComputeUTXOStatsMuHash1Thread(benchmark::Bench& bench) { ComputeUTXOStatsBench(bench, kernel::CoinStatsHashType::MUHASH, 1); }
+static void ComputeUTXOStatsMuHash4Threads(benchmark::Bench& bench) { ComputeUTXOStatsBench(bench, kernel::CoinStatsHashType::MUHASH, 4); }
+static void ComputeUTXOStatsMuHash16Threads(benchmark::Bench& bench) { ComputeUTXOStatsBench(bench, kernel::CoinStatsHashType::MUHASH, 16); }
+static void ComputeUTXOStatsSerialized1Thread(benchmark::Bench& bench) { ComputeUTXOStatsBench(bench, kernel::CoinStatsHashType::HASH_SERIALIZED, 1); }
+static void ComputeUTXOStatsSerialized4Threads(benchmark::Bench& bench) { ComputeUTXOStatsBench(bench, kernel::CoinStatsHashType::HASH_SERIALIZED, 4); }
+static void ComputeUTXOStatsSerialized16Threads(benchmark::Bench& bench) { ComputeUTXOStatsBench(bench, kernel::CoinStatsHashType::HASH_SERIALIZED, 16); }
+
+BENCHMARK(ComputeUTXOStatsMuHash1Thread, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ComputeUTXOStatsMuHash4Threads, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ComputeUTXOStatsMuHash16Threads, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ComputeUTXOStatsSerialized1Thread, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ComputeUTXOStatsSerialized4Threads, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ComputeUTXOStatsSerialized16Threads, benchmark::PriorityLevel::HIGH);
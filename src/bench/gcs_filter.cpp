@@ -4,6 +4,7 @@
 
 #include <bench/bench.h>
 #include <blockfilter.h>
+#include <random.h>
 #include <uint256.h>
 
 #include <cstdint>
@@ -28,6 +29,16 @@ static GCSFilter::ElementSet GenerateGCSTestElements()
     return elements;
 }
 
+/** Elements of a typical full block: output scripts of 22 to 34 bytes. */
+static GCSFilter::ElementSet GenerateBlockElements(FastRandomContext& rng)
+{
+    GCSFilter::ElementSet elements;
+    while (elements.size() < 5000) {
+        elements.insert(rng.randbytes<unsigned char>(22 + rng.randrange(13)));
+    }
+    return elements;
+}
+
 static void GCSBlockFilterGetHash(benchmark::Bench& bench)
 {
     auto elements = GenerateGCSTestElements();
@@ -52,6 +63,19 @@ static void GCSFilterConstruct(benchmark::Bench& bench)
     });
 }
 
+static void GCSFilterConstructBlock(benchmark::Bench& bench)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    const auto elements{GenerateBlockElements(rng)};
+
+    uint64_t siphash_k0 = 0;
+    bench.batch(elements.size()).unit("elem").run([&] {
+        GCSFilter filter({siphash_k0, 0, BASIC_FILTER_P, BASIC_FILTER_M}, elements);
+
+        siphash_k0++;
+    });
+}
+
 static void GCSFilterDecode(benchmark::Bench& bench)
 {
     auto elements = GenerateGCSTestElements();
@@ -86,8 +110,72 @@ static void GCSFilterMatch(benchmark::Bench& bench)
         filter.Match(GCSFilter::Element());
     });
 }
+
+static void GCSFilterMatchAny(benchmark::Bench& bench)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    GCSFilter filter({0, 0, BASIC_FILTER_P, BASIC_FILTER_M}, GenerateBlockElements(rng));
+
+    // A wallet scanning for a few hundred scripts which are not in the block.
+    GCSFilter::ElementSet queries;
+    while (queries.size() < 500) {
+        queries.insert(rng.randbytes<unsigned char>(22 + rng.randrange(13)));
+    }
+
+    bench.run([&] {
+        filter.MatchAny(queries);
+    });
+}
+
+/** Filters of consecutive blocks and the scripts of a wallet, for rescan benchmarks. */
+struct RescanData {
+    std::vector<BlockFilter> filters;
+    GCSFilter::ElementSet wallet_scripts;
+
+    RescanData()
+    {
+        FastRandomContext rng{/*fDeterministic=*/true};
+        // Matching cost is linear in the number of blocks and dominated by
+        // hashing the wallet scripts, a few hundred blocks are representative.
+        for (int i = 0; i < 500; ++i) {
+            const uint256 block_hash{rng.rand256()};
+            GCSFilter::ElementSet elements;
+            while (elements.size() < 200) {
+                elements.insert(rng.randbytes<unsigned char>(22 + rng.randrange(13)));
+            }
+            const GCSFilter filter({block_hash.GetUint64(0), block_hash.GetUint64(1), BASIC_FILTER_P, BASIC_FILTER_M}, elements);
+            filters.emplace_back(BlockFilterType::BASIC, block_hash, filter.GetEncoded(), /*skip_decode_check=*/true);
+        }
+        while (wallet_scripts.size() < 10000) {
+            wallet_scripts.insert(rng.randbytes<unsigned char>(22 + rng.randrange(13)));
+        }
+    }
+};
+
+static void GCSFilterRescanSerial(benchmark::Bench& bench)
+{
+    const RescanData data;
+    bench.batch(data.filters.size()).unit("block").run([&] {
+        for (const BlockFilter& filter : data.filters) {
+            filter.GetFilter().MatchAny(data.wallet_scripts);
+        }
+    });
+}
+
+static void GCSFilterRescanParallel(benchmark::Bench& bench)
+{
+    const RescanData data;
+    bench.batch(data.filters.size()).unit("block").run([&] {
+        BlockFiltersMatchAny(data.filters, data.wallet_scripts, MAX_FILTER_MATCH_THREADS);
+    });
+}
+
 BENCHMARK(GCSBlockFilterGetHash, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterConstruct, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterConstructBlock, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterDecode, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterDecodeSkipCheck, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterMatch, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterMatchAny, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterRescanParallel, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterRescanSerial, benchmark::PriorityLevel::HIGH);
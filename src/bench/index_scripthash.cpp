@@ -0,0 +1,61 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <bench/bench.h>
+#include <index/scripthashindex.h>
+#include <interfaces/chain.h>
+#include <primitives/transaction.h>
+#include <pubkey.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+#include <util/strencodings.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+using namespace util::hex_literals;
+
+static constexpr int CHAIN_SIZE{600};
+
+/**
+ * Build a chain whose coinbases pay to one script, sync a scripthash index on
+ * it and measure the latency of a lookup of that script.
+ */
+static void ScriptHashIndexLookup(benchmark::Bench& bench, bool unspent)
+{
+    const auto test_setup = MakeNoLogFileContext<TestChain100Setup>();
+
+    CPubKey pubkey{"02ed26169896db86ced4cbb7b3ecef9859b5952825adbeab998fb5b307e54949c9"_hex_u8};
+    CScript script = GetScriptForDestination(WitnessV0KeyHash(pubkey));
+    std::vector<CMutableTransaction> noTxns;
+    for (int i = 0; i < CHAIN_SIZE - 100; i++) {
+        test_setup->CreateAndProcessBlock(noTxns, script);
+        SetMockTime(GetTime() + 1);
+    }
+    assert(WITH_LOCK(::cs_main, return test_setup->m_node.chainman->ActiveHeight() == CHAIN_SIZE));
+
+    ScriptHashIndex index(interfaces::MakeChain(test_setup->m_node), /*n_cache_size=*/0, /*f_memory=*/false, /*f_wipe=*/true);
+    assert(index.Init());
+    index.Sync();
+
+    const uint256 script_hash{ComputeScriptHash(script)};
+    bench.batch(CHAIN_SIZE - 100).unit("entry").run([&] {
+        const auto result{unspent ? index.FindUnspent(script_hash) : index.FindHistory(script_hash)};
+        assert(result && result->size() == CHAIN_SIZE - 100);
+    });
+
+    index.Stop();
+}
+
+static void ScriptHashIndexHistory(benchmark::Bench& bench) { ScriptHashIndexLookup(bench, /*unspent=*/false); }
+static void ScriptHashIndexUnspent(benchmark::Bench& bench) { ScriptHashIndexLookup(bench, /*unspent=*/true); }
+
+BENCHMARK(ScriptHashIndexHistory, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ScriptHashIndexUnspent, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,79 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <bench/bench.h>
+#include <index/txindex.h>
+#include <interfaces/chain.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <pubkey.h>
+#include <random.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+#include <util/strencodings.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+using namespace util::hex_literals;
+
+namespace {
+
+/** A synced transaction index over a chain of coinbase-only blocks, and the txids to look up. */
+struct TxIndexSetup {
+    const std::unique_ptr<TestChain100Setup> test_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    std::unique_ptr<TxIndex> txindex;
+    std::vector<Txid> txids;
+
+    explicit TxIndexSetup(bool short_keys)
+    {
+        constexpr int CHAIN_SIZE{600};
+        CPubKey pubkey{"02ed26169896db86ced4cbb7b3ecef9859b5952825adbeab998fb5b307e54949c9"_hex_u8};
+        CScript script = GetScriptForDestination(WitnessV0KeyHash(pubkey));
+        for (int i = 0; i < CHAIN_SIZE - 100; i++) {
+            txids.push_back(test_setup->CreateAndProcessBlock({}, script).vtx[0]->GetHash());
+            SetMockTime(GetTime() + 1);
+        }
+        // An explorer looks up transactions from all over the chain.
+        std::shuffle(txids.begin(), txids.end(), FastRandomContext{/*fDeterministic=*/true});
+
+        txindex = std::make_unique<TxIndex>(interfaces::MakeChain(test_setup->m_node), /*n_cache_size=*/1 << 20,
+                                            /*f_memory=*/false, /*f_wipe=*/true, short_keys);
+        assert(txindex->Init());
+        txindex->Sync();
+    }
+};
+
+void FindTxs(benchmark::Bench& bench, bool short_keys, bool batched)
+{
+    TxIndexSetup setup{short_keys};
+    bench.batch(setup.txids.size()).unit("lookup").run([&] {
+        if (batched) {
+            const auto found{setup.txindex->FindTxs(setup.txids)};
+            assert(std::ranges::all_of(found, [](const auto& entry) { return entry.has_value(); }));
+        } else {
+            uint256 block_hash;
+            CTransactionRef tx;
+            for (const Txid& txid : setup.txids) assert(setup.txindex->FindTx(txid, block_hash, tx));
+        }
+    });
+    setup.txindex->Stop();
+}
+
+} // namespace
+
+static void TxIndexFindTx(benchmark::Bench& bench) { FindTxs(bench, /*short_keys=*/false, /*batched=*/false); }
+static void TxIndexFindTxs(benchmark::Bench& bench) { FindTxs(bench, /*short_keys=*/false, /*batched=*/true); }
+static void TxIndexFindTxsShortKeys(benchmark::Bench& bench) { FindTxs(bench, /*short_keys=*/true, /*batched=*/true); }
+
+BENCHMARK(TxIndexFindTx, benchmark::PriorityLevel::HIGH);
+BENCHMARK(TxIndexFindTxs, benchmark::PriorityLevel::HIGH);
+BENCHMARK(TxIndexFindTxsShortKeys, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,69 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <bench/bench.h>
+#include <consensus/amount.h>
+#include <kernel/cs_main.h>
+#include <key.h>
+#include <policy/packages.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+//! Number of inputs and outputs of each transaction in the benchmarked package.
+static constexpr size_t PACKAGE_TX_INPUTS{50};
+
+/**
+ * Test-accept a parent and child package with PACKAGE_TX_INPUTS P2WPKH inputs
+ * per transaction. The validation caches are disabled so that every iteration
+ * verifies all signatures, which happens on the script check threads.
+ */
+static void MempoolAcceptPackage(benchmark::Bench& bench)
+{
+    const auto test_setup{MakeNoLogFileContext<TestChain100Setup>(ChainType::REGTEST, {.min_validation_cache = true})};
+    Chainstate& chainstate{test_setup->m_node.chainman->ActiveChainstate()};
+
+    const CKey key{GenerateRandomKey()};
+    const auto make_outputs{[&](CAmount amount) {
+        return std::vector<CTxOut>(PACKAGE_TX_INPUTS, CTxOut{amount, GetScriptForDestination(WitnessV0KeyHash{key.GetPubKey()})});
+    }};
+    const auto spend_all{[&](const CTransactionRef& tx) {
+        std::vector<COutPoint> inputs;
+        for (size_t i{0}; i < tx->vout.size(); ++i) inputs.emplace_back(tx->GetHash(), i);
+        return inputs;
+    }};
+
+    // Confirm the outputs spent by the parent, so that only the package is validated.
+    const auto& coinbase{test_setup->m_coinbase_txns[0]};
+    const auto [fanout, _fanout_fee]{test_setup->CreateValidTransaction({coinbase}, {COutPoint{coinbase->GetHash(), 0}},
+                                                                         chainstate.m_chain.Height() + 1, {test_setup->coinbaseKey},
+                                                                         make_outputs(COIN / 2), {}, {})};
+    test_setup->CreateAndProcessBlock({fanout}, GetScriptForDestination(PKHash(test_setup->coinbaseKey.GetPubKey())));
+    const auto fanout_tx{MakeTransactionRef(fanout)};
+
+    const int height{WITH_LOCK(cs_main, return chainstate.m_chain.Height())};
+    const auto [parent, _parent_fee]{test_setup->CreateValidTransaction({fanout_tx}, spend_all(fanout_tx), height, {key},
+                                                                        make_outputs(COIN / 2 - 10'000), {}, {})};
+    const auto parent_tx{MakeTransactionRef(parent)};
+    const auto [child, _child_fee]{test_setup->CreateValidTransaction({parent_tx}, spend_all(parent_tx), height, {key},
+                                                                       {CTxOut{PACKAGE_TX_INPUTS * (COIN / 2 - 20'000), GetScriptForDestination(WitnessV0KeyHash{key.GetPubKey()})}}, {}, {})};
+    const Package package{parent_tx, MakeTransactionRef(child)};
+
+    bench.unit("tx").batch(package.size()).run([&] {
+        LOCK(cs_main);
+        const auto result{ProcessNewPackage(chainstate, *test_setup->m_node.mempool, package, /*test_accept=*/true, /*client_maxfeerate=*/{})};
+        assert(result.m_state.IsValid());
+    });
+}
+
+BENCHMARK(MempoolAcceptPackage, benchmark::PriorityLevel::HIGH);
@@ -7,6 +7,7 @@
 #include <kernel/cs_main.h>
 #include <policy/policy.h>
 #include <primitives/transaction.h>
+#include <random.h>
 #include <script/script.h>
 #include <sync.h>
 #include <test/util/setup_common.h>
@@ -14,14 +15,16 @@
 #include <txmempool.h>
 #include <util/check.h>
 
+#include <cassert>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <vector>
 
 
-static void AddTx(const CTransactionRef& tx, const CAmount& nFee, CTxMemPool& pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
+static void AddTx(const CTransactionRef& tx, const CAmount& nFee, CTxMemPool& pool, int64_t nTime = 0) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
 {
-    int64_t nTime = 0;
     unsigned int nHeight = 1;
     uint64_t sequence = 0;
     bool spendsCoinbase = false;
@@ -144,4 +147,90 @@ static void MempoolEviction(benchmark::Bench& bench)
     });
 }
 
+//! Number of transactions in each cluster of the large mempool benchmarks.
+static constexpr size_t CLUSTER_SIZE{8};
+//! Number of clusters the large mempool benchmarks start with.
+static constexpr size_t NUM_CLUSTERS{5'000};
+
+/** A cluster of a parent with CLUSTER_SIZE - 1 children, and their fees. */
+struct Cluster {
+    std::vector<CTransactionRef> txs;
+    std::vector<CAmount> fees;
+};
+
+static std::vector<Cluster> CreateClusters(FastRandomContext& rng, size_t count)
+{
+    std::vector<Cluster> clusters(count);
+    for (Cluster& cluster : clusters) {
+        CMutableTransaction parent;
+        parent.vin.emplace_back(COutPoint{Txid::FromUint256(rng.rand256()), 0});
+        for (size_t i{1}; i < CLUSTER_SIZE; ++i) parent.vout.emplace_back(COIN, CScript() << OP_TRUE);
+        cluster.txs.push_back(MakeTransactionRef(parent));
+        for (size_t i{1}; i < CLUSTER_SIZE; ++i) {
+            CMutableTransaction child;
+            child.vin.emplace_back(COutPoint{cluster.txs[0]->GetHash(), uint32_t(i - 1)});
+            child.vout.emplace_back(COIN - 1'000, CScript() << OP_TRUE);
+            cluster.txs.push_back(MakeTransactionRef(child));
+        }
+        for (size_t i{0}; i < CLUSTER_SIZE; ++i) cluster.fees.push_back(1'000 + rng.randrange(100'000));
+    }
+    return clusters;
+}
+
+/**
+ * Trim a mempool of NUM_CLUSTERS clusters back to its size after adding
+ * another cluster. Each epoch is a single eviction, so the per-epoch results
+ * (e.g. from -output-json) give the latency distribution.
+ */
+static void MempoolEvictionLarge(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>();
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    FastRandomContext rng{/*fDeterministic=*/true};
+    const auto clusters{CreateClusters(rng, 2 * NUM_CLUSTERS)};
+
+    LOCK2(cs_main, pool.cs);
+    for (size_t i{0}; i < NUM_CLUSTERS; ++i) {
+        for (size_t j{0}; j < CLUSTER_SIZE; ++j) AddTx(clusters[i].txs[j], clusters[i].fees[j], pool);
+    }
+    const size_t limit{pool.DynamicMemoryUsage()};
+
+    size_t next{NUM_CLUSTERS};
+    bench.epochIterations(1).run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        // Re-add whatever part of the next cluster was evicted before.
+        const Cluster& cluster{clusters[next++ % clusters.size()]};
+        for (size_t j{0}; j < CLUSTER_SIZE; ++j) {
+            if (!pool.exists(cluster.txs[j]->GetHash())) AddTx(cluster.txs[j], cluster.fees[j], pool);
+        }
+        pool.TrimToSize(limit);
+    });
+}
+
+/** Expire the oldest cluster of a mempool of NUM_CLUSTERS clusters after adding a new one. */
+static void MempoolExpire(benchmark::Bench& bench)
+{
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>();
+    CTxMemPool& pool = *Assert(testing_setup->m_node.mempool);
+    FastRandomContext rng{/*fDeterministic=*/true};
+    const auto clusters{CreateClusters(rng, NUM_CLUSTERS + 1)};
+
+    LOCK2(cs_main, pool.cs);
+    // Cluster i enters the mempool at time i.
+    int64_t time{0};
+    const auto add_cluster{[&]() EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs) {
+        const Cluster& cluster{clusters[time % clusters.size()]};
+        for (size_t j{0}; j < CLUSTER_SIZE; ++j) AddTx(cluster.txs[j], cluster.fees[j], pool, time);
+        ++time;
+    }};
+    for (size_t i{0}; i < NUM_CLUSTERS; ++i) add_cluster();
+
+    bench.epochIterations(1).run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        add_cluster();
+        const int expired{pool.Expire(std::chrono::seconds{time - int64_t(NUM_CLUSTERS)})};
+        assert(expired == CLUSTER_SIZE);
+    });
+}
+
 BENCHMARK(MempoolEviction, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolEvictionLarge, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MempoolExpire, benchmark::PriorityLevel::HIGH);
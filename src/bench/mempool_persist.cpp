@@ -0,0 +1,65 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <bench/bench.h>
+#include <consensus/amount.h>
+#include <kernel/cs_main.h>
+#include <node/mempool_persist.h>
+#include <node/mempool_persist_args.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/setup_common.h>
+#include <txmempool.h>
+#include <validation.h>
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//! Number of confirmed outputs, each spent by a parent and child pair in the dumped mempool.
+static constexpr size_t LOAD_MEMPOOL_CHAINS{500};
+
+/**
+ * Load a dumped mempool of LOAD_MEMPOOL_CHAINS parent and child pairs. The
+ * validation caches are disabled so that every iteration verifies all
+ * signatures, in parallel while the batches are primed.
+ */
+static void LoadMempoolFile(benchmark::Bench& bench)
+{
+    const auto test_setup{MakeNoLogFileContext<TestChain100Setup>(ChainType::REGTEST, {.min_validation_cache = true})};
+    CTxMemPool& pool{*test_setup->m_node.mempool};
+    Chainstate& chainstate{test_setup->m_node.chainman->ActiveChainstate()};
+    const CScript script{GetScriptForDestination(PKHash(test_setup->coinbaseKey.GetPubKey()))};
+
+    const auto& coinbase{test_setup->m_coinbase_txns[0]};
+    const auto [fanout, _fanout_fee]{test_setup->CreateValidTransaction({coinbase}, {COutPoint{coinbase->GetHash(), 0}}, /*input_height=*/1, {test_setup->coinbaseKey},
+                                                                         std::vector<CTxOut>(LOAD_MEMPOOL_CHAINS, CTxOut{coinbase->vout[0].nValue / static_cast<CAmount>(2 * LOAD_MEMPOOL_CHAINS), script}), {}, {})};
+    test_setup->CreateAndProcessBlock({fanout}, script);
+    const auto fanout_tx{MakeTransactionRef(fanout)};
+    const int height{WITH_LOCK(cs_main, return chainstate.m_chain.Height())};
+
+    std::vector<CTransactionRef> parents;
+    for (uint32_t i{0}; i < LOAD_MEMPOOL_CHAINS; ++i) {
+        parents.push_back(MakeTransactionRef(test_setup->CreateValidMempoolTransaction(fanout_tx, i, height, test_setup->coinbaseKey, script, fanout_tx->vout[i].nValue - 1'000)));
+        test_setup->CreateValidMempoolTransaction(parents.back(), 0, height, test_setup->coinbaseKey, script, parents.back()->vout[0].nValue - 1'000);
+    }
+    assert(pool.size() == 2 * LOAD_MEMPOOL_CHAINS);
+
+    const fs::path path{node::MempoolPath(test_setup->m_args)};
+    assert(node::DumpMempool(pool, path));
+
+    bench.unit("tx").batch(pool.size()).run([&] {
+        {
+            LOCK(pool.cs);
+            for (const auto& parent : parents) pool.removeRecursive(*parent, MemPoolRemovalReason::REPLACED);
+        }
+        assert(node::LoadMempool(pool, path, chainstate, {}));
+        assert(pool.size() == 2 * LOAD_MEMPOOL_CHAINS);
+    });
+}
+
+BENCHMARK(LoadMempoolFile, benchmark::PriorityLevel::HIGH);
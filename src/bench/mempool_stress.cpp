@@ -11,9 +11,11 @@
 #include <sync.h>
 #include <test/util/setup_common.h>
 #include <test/util/txmempool.h>
+#include <txgraph.h>
 #include <txmempool.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -91,6 +93,40 @@ static std::vector<CTransactionRef> CreateOrderedCoins(FastRandomContext& det_ra
     return ordered_coins;
 }
 
+/** Create num_clusters independent clusters of cluster_size transactions each,
+ *  in which every transaction after the first spends one to three outputs of
+ *  earlier transactions of its cluster. */
+static std::vector<CTransactionRef> CreateClusters(FastRandomContext& det_rand, int num_clusters, int cluster_size)
+{
+    std::vector<CTransactionRef> ordered_txs;
+    for (int cluster = 0; cluster < num_clusters; ++cluster) {
+        std::vector<COutPoint> unspent;
+        for (int i = 0; i < cluster_size; ++i) {
+            CMutableTransaction tx;
+            if (unspent.empty()) {
+                tx.vin.emplace_back(COutPoint{Txid::FromUint256(det_rand.rand256()), 0});
+            } else {
+                const size_t n_inputs{std::min<size_t>(det_rand.randrange(3) + 1, unspent.size())};
+                for (size_t in = 0; in < n_inputs; ++in) {
+                    const size_t idx{det_rand.randrange(unspent.size())};
+                    tx.vin.emplace_back(unspent[idx]);
+                    unspent[idx] = unspent.back();
+                    unspent.pop_back();
+                }
+            }
+            tx.vin[0].scriptWitness.stack.push_back(CScriptNum(i).getvch());
+            tx.vout.resize(det_rand.randrange(3) + 1);
+            for (auto& out : tx.vout) {
+                out.scriptPubKey = CScript() << CScriptNum(cluster) << OP_EQUAL;
+                out.nValue = 10 * COIN;
+            }
+            ordered_txs.emplace_back(MakeTransactionRef(tx));
+            for (uint32_t n = 0; n < tx.vout.size(); ++n) unspent.emplace_back(ordered_txs.back()->GetHash(), n);
+        }
+    }
+    return ordered_txs;
+}
+
 static void ComplexMemPool(benchmark::Bench& bench)
 {
     FastRandomContext det_rand{true};
@@ -111,6 +147,23 @@ static void ComplexMemPool(benchmark::Bench& bench)
     });
 }
 
+//! Fill the mempool with clusters of the largest size the transaction graph linearizes, and evict all of them.
+static void ClusterMemPool(benchmark::Bench& bench)
+{
+    FastRandomContext det_rand{true};
+    const std::vector<CTransactionRef> ordered_txs{CreateClusters(det_rand, /*num_clusters=*/50, /*cluster_size=*/MAX_CLUSTER_COUNT_LIMIT)};
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(ChainType::MAIN);
+    CTxMemPool& pool = *testing_setup.get()->m_node.mempool;
+    LOCK2(cs_main, pool.cs);
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        for (auto& tx : ordered_txs) {
+            AddTx(tx, pool);
+        }
+        pool.TrimToSize(pool.DynamicMemoryUsage() * 3 / 4);
+        pool.TrimToSize(0);
+    });
+}
+
 static void MempoolCheck(benchmark::Bench& bench)
 {
     FastRandomContext det_rand{true};
@@ -126,5 +179,6 @@ static void MempoolCheck(benchmark::Bench& bench)
     });
 }
 
+BENCHMARK(ClusterMemPool, benchmark::PriorityLevel::HIGH);
 BENCHMARK(ComplexMemPool, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MempoolCheck, benchmark::PriorityLevel::HIGH);
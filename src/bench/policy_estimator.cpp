@@ -0,0 +1,107 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <consensus/amount.h>
+#include <kernel/mempool_entry.h>
+#include <policy/fees.h>
+#include <policy/fees_args.h>
+#include <policy/policy.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+//! Number of transactions entering the mempool per block.
+constexpr unsigned int TXS_PER_BLOCK{200};
+//! Transactions confirm after 1 to CONFIRM_BLOCKS blocks, the lower their fee the later.
+constexpr unsigned int CONFIRM_BLOCKS{10};
+
+/** Feeds an estimator with the mempool and block events of a steady fee market. */
+class FeeMarket
+{
+    CBlockPolicyEstimator& m_estimator;
+    //! TXS_PER_BLOCK transactions for each of the last CONFIRM_BLOCKS heights.
+    std::vector<CTransactionRef> m_txs;
+    std::vector<int64_t> m_vsizes;
+    unsigned int m_height{0};
+
+    static CAmount Fee(unsigned int index) { return 1'000 + 250 * index; }
+
+public:
+    explicit FeeMarket(CBlockPolicyEstimator& estimator) : m_estimator{estimator}
+    {
+        for (uint32_t i{0}; i < TXS_PER_BLOCK * CONFIRM_BLOCKS; ++i) {
+            CMutableTransaction mtx;
+            mtx.vin.emplace_back(COutPoint{Txid{}, i});
+            mtx.vout.emplace_back(COIN, CScript() << OP_TRUE);
+            m_txs.push_back(MakeTransactionRef(mtx));
+            m_vsizes.push_back(GetVirtualTransactionSize(*m_txs.back()));
+        }
+    }
+
+    /** Connect a block confirming the transactions that are due, then accept a new batch. */
+    void NextBlock()
+    {
+        ++m_height;
+        std::vector<RemovedMempoolTransactionInfo> removed;
+        removed.reserve(TXS_PER_BLOCK);
+        for (unsigned int i{0}; i < TXS_PER_BLOCK; ++i) {
+            const unsigned int delay{1 + (TXS_PER_BLOCK - 1 - i) * CONFIRM_BLOCKS / TXS_PER_BLOCK};
+            if (delay >= m_height) continue;
+            const unsigned int entry_height{m_height - delay};
+            const auto& tx{m_txs[(entry_height % CONFIRM_BLOCKS) * TXS_PER_BLOCK + i]};
+            removed.emplace_back(CTxMemPoolEntry{tx, Fee(i), /*time=*/0, entry_height, /*entry_sequence=*/0,
+                                                 /*spends_coinbase=*/false, /*sigops_cost=*/4, LockPoints{}});
+        }
+        m_estimator.processBlock(removed, m_height);
+
+        for (unsigned int i{0}; i < TXS_PER_BLOCK; ++i) {
+            const size_t pos{(m_height % CONFIRM_BLOCKS) * TXS_PER_BLOCK + i};
+            m_estimator.processTransaction(NewMempoolTransactionInfo{m_txs[pos], Fee(i), m_vsizes[pos], m_height,
+                                                                     /*mempool_limit_bypassed=*/false,
+                                                                     /*submitted_in_package=*/false,
+                                                                     /*chainstate_is_current=*/true,
+                                                                     /*has_no_mempool_parents=*/true});
+        }
+    }
+};
+
+} // namespace
+
+static void PolicyEstimatorBlock(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<>()};
+    CBlockPolicyEstimator estimator{FeeestPath(*testing_setup->m_node.args), DEFAULT_ACCEPT_STALE_FEE_ESTIMATES};
+    FeeMarket market{estimator};
+
+    bench.unit("block").run([&] { market.NextBlock(); });
+}
+
+static void PolicyEstimatorSmartFee(benchmark::Bench& bench)
+{
+    const auto testing_setup{MakeNoLogFileContext<>()};
+    CBlockPolicyEstimator estimator{FeeestPath(*testing_setup->m_node.args), DEFAULT_ACCEPT_STALE_FEE_ESTIMATES};
+    FeeMarket market{estimator};
+    // Enough history for estimates at every tracked target.
+    const unsigned int max_target{estimator.HighestTargetTracked(FeeEstimateHorizon::LONG_HALFLIFE)};
+    for (unsigned int i{0}; i < 2 * max_target + CONFIRM_BLOCKS; ++i) market.NextBlock();
+
+    bench.unit("estimate").batch(2 * max_target).run([&] {
+        for (bool conservative : {false, true}) {
+            for (unsigned int target{1}; target <= max_target; ++target) {
+                FeeCalculation calc;
+                const CFeeRate feerate{estimator.estimateSmartFee(target, &calc, conservative)};
+                ankerl::nanobench::doNotOptimizeAway(feerate);
+            }
+        }
+    });
+}
+
+BENCHMARK(PolicyEstimatorBlock, benchmark::PriorityLevel::HIGH);
+BENCHMARK(PolicyEstimatorSmartFee, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,53 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <bench/bench.h>
+#include <chain.h>
+#include <consensus/validation.h>
+#include <kernel/cs_main.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <cassert>
+#include <vector>
+
+static constexpr int REORG_DEPTH{100};
+
+/**
+ * Disconnect and reconnect the last REORG_DEPTH blocks of the active chain,
+ * reporting the time per block. Every block spends a coinbase output so that
+ * there is undo data to read and apply.
+ */
+static void Reorg(benchmark::Bench& bench)
+{
+    const auto test_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    ChainstateManager& chainman{*test_setup->m_node.chainman};
+    Chainstate& chainstate{chainman.ActiveChainstate()};
+
+    const CScript script{GetScriptForDestination(WitnessV0KeyHash(test_setup->coinbaseKey.GetPubKey()))};
+    for (int i = 0; i < REORG_DEPTH; ++i) {
+        const CTransactionRef& coinbase{test_setup->m_coinbase_txns[i]};
+        const auto tx{test_setup->CreateValidMempoolTransaction(coinbase, /*input_vout=*/0, /*input_height=*/i + 1,
+                                                                test_setup->coinbaseKey, script,
+                                                                coinbase->vout[0].nValue - 1000, /*submit=*/false)};
+        test_setup->CreateAndProcessBlock({tx}, script);
+    }
+
+    CBlockIndex* fork_child{WITH_LOCK(::cs_main, return chainstate.m_chain[chainstate.m_chain.Height() - REORG_DEPTH + 1])};
+    const CBlockIndex* tip{WITH_LOCK(::cs_main, return chainstate.m_chain.Tip())};
+
+    bench.batch(REORG_DEPTH).unit("block").run([&] {
+        BlockValidationState state;
+        assert(chainstate.InvalidateBlock(state, fork_child));
+        WITH_LOCK(::cs_main, chainstate.ResetBlockFailureFlags(fork_child));
+        assert(chainstate.ActivateBestChain(state));
+        assert(WITH_LOCK(::cs_main, return chainstate.m_chain.Tip()) == tip);
+    });
+}
+
+BENCHMARK(Reorg, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,58 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chainparams.h>
+#include <coins.h>
+#include <node/snapshotwriter.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <script/script.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+#include <util/fs.h>
+
+#include <cassert>
+
+static constexpr int NUM_TXIDS{50'000};
+
+static void SnapshotWriteBench(benchmark::Bench& bench, int num_threads)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    const fs::path path{testing_setup->m_path_root / "utxo.dat"};
+
+    CCoinsViewDB db{{.path = "", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+    {
+        CCoinsViewCache cache{&db};
+        FastRandomContext rng{/*fDeterministic=*/true};
+        for (int i = 0; i < NUM_TXIDS; ++i) {
+            const Txid txid{Txid::FromUint256(rng.rand256())};
+            for (uint32_t n = 0; n < 2; ++n) {
+                Coin coin{CTxOut{rng.randrange(50 * COIN), CScript() << OP_DUP << OP_HASH160 << rng.randbytes(20) << OP_EQUALVERIFY << OP_CHECKSIG}, /*nHeightIn=*/1, /*fCoinBaseIn=*/false};
+                cache.AddCoin(COutPoint{txid, n}, std::move(coin), /*possible_overwrite=*/false);
+            }
+        }
+        cache.SetBestBlock(Params().GenesisBlock().GetHash());
+        const bool flushed{cache.Flush()};
+        assert(flushed);
+    }
+
+    bench.batch(NUM_TXIDS * 2).unit("coin").run([&] {
+        node::SnapshotCoinsWriter writer{db, num_threads};
+        AutoFile file{fsbridge::fopen(path, "wb")};
+        const auto result{writer.Write(file)};
+        assert(result.coins_written == NUM_TXIDS * 2);
+        const int closed{file.fclose()};
+        assert(closed == 0);
+    });
+}
+
+static void SnapshotWrite1Thread(benchmark::Bench& bench) { SnapshotWriteBench(bench, 1); }
+static void SnapshotWrite4Threads(benchmark::Bench& bench) { SnapshotWriteBench(bench, 4); }
+static void SnapshotWrite16Threads(benchmark::Bench& bench) { SnapshotWriteBench(bench, 16); }
+
+BENCHMARK(SnapshotWrite1Thread, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SnapshotWrite4Threads, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SnapshotWrite16Threads, benchmark::PriorityLevel::HIGH);
@@ -20,7 +20,7 @@
 static constexpr node::TxOrphanage::Usage TINY_TX_WEIGHT{240};
 static constexpr int64_t APPROX_WEIGHT_PER_INPUT{200};
 
-// Creates a transaction with num_inputs inputs and 1 output, padded to target_weight. Use this function to maximize m_outpoint_to_orphan_it operations.
+// Creates a transaction with num_inputs inputs and 1 output, padded to target_weight. Use this function to maximize m_parent_to_orphan_wtxids operations.
 // If num_inputs is 0, we maximize the number of inputs.
 static CTransactionRef MakeTransactionBulkedTo(unsigned int num_inputs, int64_t target_weight, FastRandomContext& det_rand)
 {
@@ -262,7 +262,91 @@ static void OrphanageEraseForPeer(benchmark::Bench& bench)
     OrphanageEraseAll(bench, /*block_or_disconnect=*/false);
 }
 
+//! Number of orphans in the large orphanage benchmarks, and their maximum global latency score.
+static constexpr unsigned int LARGE_NUM_ORPHANS{100'000};
+static constexpr unsigned int LARGE_NUM_PEERS{125};
+
+/** Look up and schedule the children of a parent in an orphanage of LARGE_NUM_ORPHANS orphans, where every parent
+ * has many children spread over all peers. */
+static void OrphanageLargeChildren(benchmark::Bench& bench)
+{
+    static constexpr unsigned int NUM_PARENTS{1'000};
+    static constexpr unsigned int CHILDREN_PER_PARENT{LARGE_NUM_ORPHANS / NUM_PARENTS};
+    static_assert(CHILDREN_PER_PARENT <= LARGE_NUM_PEERS);
+
+    FastRandomContext det_rand{true};
+    // Only CHILDREN_PER_PARENT peers announce orphans, reserve enough usage for all of them.
+    const auto orphanage{node::MakeTxOrphanage(/*max_global_latency_score=*/LARGE_NUM_ORPHANS, /*reserved_peer_usage=*/2 * node::DEFAULT_RESERVED_ORPHAN_WEIGHT_PER_PEER)};
+    std::vector<CTransactionRef> parents;
+    parents.reserve(NUM_PARENTS);
+    for (unsigned int p{0}; p < NUM_PARENTS; ++p) {
+        CMutableTransaction parent;
+        parent.vin.emplace_back(Txid::FromUint256(det_rand.rand256()), 0);
+        parent.vout.resize(CHILDREN_PER_PARENT);
+        parents.emplace_back(MakeTransactionRef(parent));
+
+        // Child i spends output i of the parent and another missing input, and is announced by peer i.
+        for (unsigned int i{0}; i < CHILDREN_PER_PARENT; ++i) {
+            CMutableTransaction child;
+            child.vin.emplace_back(parents.back()->GetHash(), i);
+            child.vin.emplace_back(Txid::FromUint256(det_rand.rand256()), 0);
+            child.vout.resize(1);
+            assert(orphanage->AddTx(MakeTransactionRef(child), i));
+        }
+    }
+    assert(orphanage->CountAnnouncements() == LARGE_NUM_ORPHANS);
+    assert(orphanage->TotalOrphanUsage() <= orphanage->MaxGlobalUsage());
+
+    size_t next{0};
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        const auto& parent{parents[next++ % parents.size()]};
+        // As when a parent is accepted: its children from the sending peer are package candidates, and all of them
+        // are scheduled for reconsideration.
+        assert(orphanage->GetChildrenFromSamePeer(parent, /*nodeid=*/0).size() == 1);
+        assert(orphanage->AddChildrenToWorkSet(*parent, det_rand).size() == CHILDREN_PER_PARENT);
+        for (NodeId peer{0}; peer < NodeId{CHILDREN_PER_PARENT}; ++peer) {
+            while (orphanage->GetTxToReconsider(peer)) {}
+        }
+    });
+}
+
+/** A single peer floods a full orphanage of LARGE_NUM_ORPHANS orphans, so that each new orphan evicts its oldest one,
+ * while the other peers stay within their reservations. */
+static void OrphanageLargeFlood(benchmark::Bench& bench)
+{
+    static constexpr unsigned int ORPHANS_PER_HONEST_PEER{10};
+    static constexpr NodeId ATTACKER{LARGE_NUM_PEERS - 1};
+
+    FastRandomContext det_rand{true};
+    const auto orphanage{node::MakeTxOrphanage(/*max_global_latency_score=*/LARGE_NUM_ORPHANS, /*reserved_peer_usage=*/node::DEFAULT_RESERVED_ORPHAN_WEIGHT_PER_PEER)};
+    for (NodeId peer{0}; peer < ATTACKER; ++peer) {
+        for (unsigned int i{0}; i < ORPHANS_PER_HONEST_PEER; ++i) {
+            assert(orphanage->AddTx(MakeTransactionBulkedTo(1, TINY_TX_WEIGHT, det_rand), peer));
+        }
+    }
+    // Twice as many orphans as fit, so that each one was evicted before it is sent again.
+    std::vector<CTransactionRef> flood;
+    flood.reserve(2 * LARGE_NUM_ORPHANS);
+    for (unsigned int i{0}; i < 2 * LARGE_NUM_ORPHANS; ++i) {
+        flood.emplace_back(MakeTransactionBulkedTo(1, TINY_TX_WEIGHT, det_rand));
+    }
+    size_t next{0};
+    while (orphanage->TotalLatencyScore() < orphanage->MaxGlobalLatencyScore()) {
+        assert(orphanage->AddTx(flood[next++], ATTACKER));
+    }
+    const auto num_announcements{orphanage->CountAnnouncements()};
+
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        assert(orphanage->AddTx(flood[next++ % flood.size()], ATTACKER));
+        assert(orphanage->CountAnnouncements() == num_announcements);
+    });
+    // Only the attacker's orphans were evicted.
+    assert(orphanage->AnnouncementsFromPeer(0) == ORPHANS_PER_HONEST_PEER);
+}
+
 BENCHMARK(OrphanageSinglePeerEviction, benchmark::PriorityLevel::LOW);
 BENCHMARK(OrphanageMultiPeerEviction, benchmark::PriorityLevel::LOW);
 BENCHMARK(OrphanageEraseForBlock, benchmark::PriorityLevel::LOW);
 BENCHMARK(OrphanageEraseForPeer, benchmark::PriorityLevel::LOW);
+BENCHMARK(OrphanageLargeChildren, benchmark::PriorityLevel::LOW);
+BENCHMARK(OrphanageLargeFlood, benchmark::PriorityLevel::LOW);
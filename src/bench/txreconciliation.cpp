@@ -0,0 +1,87 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <minisketch.h>
+#include <node/minisketchwrapper.h>
+#include <node/txreconciliation.h>
+#include <primitives/transaction_identifier.h>
+#include <random.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+//! Difference decoded per sketch in the decode benchmarks.
+static constexpr size_t DECODE_DIFFERENCE{32};
+
+/** Merge two sketches differing by DECODE_DIFFERENCE elements and decode the difference. */
+static void DecodeSketch(benchmark::Bench& bench, Minisketch sketch_a, Minisketch sketch_b)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    for (size_t i{0}; i < 1000; ++i) {
+        const uint32_t element{1 + rng.rand32() % 0xFFFFFFFE};
+        sketch_a.Add(element);
+        sketch_b.Add(element);
+    }
+    for (size_t i{0}; i < DECODE_DIFFERENCE; ++i) (i % 2 ? sketch_a : sketch_b).Add(1 + rng.rand32() % 0xFFFFFFFE);
+
+    bench.run([&] {
+        const auto difference{Minisketch{sketch_a}.Merge(sketch_b).Decode(sketch_a.GetCapacity())};
+        assert(difference && difference->size() == DECODE_DIFFERENCE);
+    });
+}
+
+/** Decode with the fastest implementation available, as used for reconciliation. */
+static void MinisketchDecode(benchmark::Bench& bench)
+{
+    DecodeSketch(bench, node::MakeMinisketch32(DECODE_DIFFERENCE), node::MakeMinisketch32(DECODE_DIFFERENCE));
+}
+
+/** Decode with the portable implementation, for comparison with the carry-less multiplication ones. */
+static void MinisketchDecodeGeneric(benchmark::Bench& bench)
+{
+    DecodeSketch(bench, Minisketch(32, /*implementation=*/0, DECODE_DIFFERENCE), Minisketch(32, /*implementation=*/0, DECODE_DIFFERENCE));
+}
+
+/**
+ * A full reconciliation round between two peers with 1000 transactions in common and 10
+ * transactions on either side: filling the sets, sketching, decoding, and mapping the
+ * difference back to transactions.
+ */
+static void TxReconciliationRound(benchmark::Bench& bench)
+{
+    static constexpr int COMMON_TXS{1000};
+    static constexpr int UNIQUE_TXS{10};
+
+    FastRandomContext rng{/*fDeterministic=*/true};
+    TxReconciliationTracker initiator{TXRECONCILIATION_VERSION}, responder{TXRECONCILIATION_VERSION};
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(1)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(0)};
+    initiator.RegisterPeer(1, /*is_peer_inbound=*/false, TXRECONCILIATION_VERSION, responder_salt);
+    responder.RegisterPeer(0, /*is_peer_inbound=*/true, TXRECONCILIATION_VERSION, initiator_salt);
+
+    bench.unit("round").run([&] {
+        for (int i{0}; i < COMMON_TXS; ++i) {
+            const Wtxid wtxid{Wtxid::FromUint256(rng.rand256())};
+            initiator.AddToSet(1, wtxid);
+            responder.AddToSet(0, wtxid);
+        }
+        for (int i{0}; i < UNIQUE_TXS; ++i) {
+            initiator.AddToSet(1, Wtxid::FromUint256(rng.rand256()));
+            responder.AddToSet(0, Wtxid::FromUint256(rng.rand256()));
+        }
+
+        const auto request{initiator.InitiateReconciliationRequest(1)};
+        const auto sketch{responder.HandleReconciliationRequest(0, *request)};
+        const auto result{initiator.HandleSketch(1, *sketch)};
+        assert(result->outcome == ReconciliationOutcome::SUCCESS);
+        const auto announce{responder.HandleReconciliationDifference(0, /*success=*/true, result->request)};
+        assert(announce->size() == UNIQUE_TXS);
+    });
+}
+
+BENCHMARK(MinisketchDecode, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MinisketchDecodeGeneric, benchmark::PriorityLevel::HIGH);
+BENCHMARK(TxReconciliationRound, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,66 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <net.h>
+#include <primitives/transaction_identifier.h>
+#include <random.h>
+#include <txrequest.h>
+#include <uint256.h>
+
+#include <chrono>
+#include <deque>
+#include <utility>
+
+using namespace std::chrono_literals;
+
+/**
+ * Simulate a node with 500 peers, receiving announcements for 10k
+ * transactions per second. Each iteration is one 10ms message handler step:
+ * the announcements of that step are added, every peer is asked for its
+ * requestable transactions, and transactions requested 100ms earlier arrive.
+ */
+static void TxRequestManyPeers(benchmark::Bench& bench)
+{
+    static constexpr int NUM_PEERS{500};
+    //! The first peers are outbound and preferred for requests.
+    static constexpr int NUM_PREFERRED{8};
+    static constexpr int TXS_PER_STEP{100};
+    //! Number of peers announcing each transaction before it is received.
+    static constexpr int ANNOUNCEMENTS_PER_TX{10};
+    static constexpr auto STEP{10ms};
+    static constexpr auto NONPREF_PEER_TX_DELAY{2s};
+    static constexpr auto RESPONSE_TIME{100ms};
+    static constexpr auto REQUEST_EXPIRY{60s};
+
+    FastRandomContext rng{/*fDeterministic=*/true};
+    TxRequestTracker tracker{/*deterministic=*/true};
+    std::chrono::microseconds now{0};
+    // Transactions in flight, with the time their response arrives.
+    std::deque<std::pair<std::chrono::microseconds, uint256>> responses;
+
+    bench.unit("step").run([&] {
+        now += STEP;
+        for (int i{0}; i < TXS_PER_STEP; ++i) {
+            const GenTxid gtxid{Wtxid::FromUint256(rng.rand256())};
+            for (int j{0}; j < ANNOUNCEMENTS_PER_TX; ++j) {
+                const NodeId peer{NodeId(rng.randrange(NUM_PEERS))};
+                const bool preferred{peer < NUM_PREFERRED};
+                tracker.ReceivedInv(peer, gtxid, preferred, preferred ? now : now + NONPREF_PEER_TX_DELAY);
+            }
+        }
+        for (NodeId peer{0}; peer < NUM_PEERS; ++peer) {
+            for (const GenTxid& gtxid : tracker.GetRequestable(peer, now)) {
+                tracker.RequestedTx(peer, gtxid.ToUint256(), now + REQUEST_EXPIRY);
+                responses.emplace_back(now + RESPONSE_TIME, gtxid.ToUint256());
+            }
+        }
+        while (!responses.empty() && responses.front().first <= now) {
+            tracker.ForgetTxHash(responses.front().second);
+            responses.pop_front();
+        }
+    });
+}
+
+BENCHMARK(TxRequestManyPeers, benchmark::PriorityLevel::HIGH);
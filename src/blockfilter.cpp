@@ -2,8 +2,16 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <exception>
 #include <mutex>
 #include <set>
+#include <span>
+#include <thread>
+#include <utility>
 
 #include <blockfilter.h>
 #include <crypto/siphash.h>
@@ -30,17 +38,47 @@ uint64_t GCSFilter::HashToRange(const Element& element) const
     return FastRange64(hash, m_F);
 }
 
+/**
+ * Sort values below `max` with an LSD radix sort on 11-bit digits, skipping
+ * the digits above the highest bit of `max`. Small inputs use std::sort.
+ */
+static void SortHashes(std::vector<uint64_t>& values, uint64_t max)
+{
+    constexpr int RADIX_BITS{11};
+    constexpr size_t RADIX_SIZE{size_t{1} << RADIX_BITS};
+    constexpr size_t MIN_RADIX_SORT_SIZE{256};
+    if (values.size() < MIN_RADIX_SORT_SIZE) {
+        std::sort(values.begin(), values.end());
+        return;
+    }
+    const int bits{static_cast<int>(std::bit_width(max))};
+    std::vector<uint64_t> buffer(values.size());
+    for (int shift = 0; shift < bits; shift += RADIX_BITS) {
+        std::array<size_t, RADIX_SIZE> offsets{};
+        for (uint64_t value : values) ++offsets[(value >> shift) & (RADIX_SIZE - 1)];
+        size_t sum{0};
+        for (size_t& offset : offsets) sum += std::exchange(offset, sum);
+        for (uint64_t value : values) buffer[offsets[(value >> shift) & (RADIX_SIZE - 1)]++] = value;
+        values.swap(buffer);
+    }
+}
+
 std::vector<uint64_t> GCSFilter::BuildHashedSet(const ElementSet& elements) const
 {
+    std::vector<std::span<const unsigned char>> inputs(elements.begin(), elements.end());
     std::vector<uint64_t> hashed_elements;
-    hashed_elements.reserve(elements.size());
-    for (const Element& element : elements) {
-        hashed_elements.push_back(HashToRange(element));
-    }
-    std::sort(hashed_elements.begin(), hashed_elements.end());
+    BuildHashedSet(inputs, hashed_elements);
     return hashed_elements;
 }
 
+void GCSFilter::BuildHashedSet(std::span<const std::span<const unsigned char>> elements, std::vector<uint64_t>& hashes_out) const
+{
+    hashes_out.resize(elements.size());
+    SipHashBatch(m_params.m_siphash_k0, m_params.m_siphash_k1, elements, hashes_out);
+    for (uint64_t& hash : hashes_out) hash = FastRange64(hash, m_F);
+    SortHashes(hashes_out, m_F);
+}
+
 GCSFilter::GCSFilter(const Params& params)
     : m_params(params), m_N(0), m_F(0), m_encoded{0}
 {}
@@ -61,11 +99,12 @@ GCSFilter::GCSFilter(const Params& params, std::vector<unsigned char> encoded_fi
 
     // Verify that the encoded filter contains exactly N elements. If it has too much or too little
     // data, a std::ios_base::failure exception will be raised.
-    BitStreamReader bitreader{stream};
+    const std::span<const unsigned char> data{std::span{m_encoded}.last(stream.size())};
+    GolombRiceReader reader{data};
     for (uint64_t i = 0; i < m_N; ++i) {
-        GolombRiceDecode(bitreader, m_params.m_P);
+        reader.Decode(m_params.m_P);
     }
-    if (!stream.empty()) {
+    if (reader.BytesConsumed() != data.size()) {
         throw std::ios_base::failure("encoded_filter contains excess data");
     }
 }
@@ -88,16 +127,16 @@ GCSFilter::GCSFilter(const Params& params, const ElementSet& elements)
         return;
     }
 
-    BitStreamWriter bitwriter{stream};
+    GolombRiceWriter writer{m_encoded};
 
     uint64_t last_value = 0;
     for (uint64_t value : BuildHashedSet(elements)) {
         uint64_t delta = value - last_value;
-        GolombRiceEncode(bitwriter, m_params.m_P, delta);
+        writer.Encode(m_params.m_P, delta);
         last_value = value;
     }
 
-    bitwriter.Flush();
+    writer.Flush();
 }
 
 bool GCSFilter::MatchInternal(const uint64_t* element_hashes, size_t size) const
@@ -108,12 +147,12 @@ bool GCSFilter::MatchInternal(const uint64_t* element_hashes, size_t size) const
     uint64_t N = ReadCompactSize(stream);
     assert(N == m_N);
 
-    BitStreamReader bitreader{stream};
+    GolombRiceReader reader{std::span{m_encoded}.last(stream.size())};
 
     uint64_t value = 0;
     size_t hashes_index = 0;
     for (uint32_t i = 0; i < m_N; ++i) {
-        uint64_t delta = GolombRiceDecode(bitreader, m_params.m_P);
+        uint64_t delta = reader.Decode(m_params.m_P);
         value += delta;
 
         while (true) {
@@ -144,6 +183,55 @@ bool GCSFilter::MatchAny(const ElementSet& elements) const
     return MatchInternal(queries.data(), queries.size());
 }
 
+GCSFilterQuery::GCSFilterQuery(const GCSFilter::ElementSet& elements)
+    : m_elements(elements.begin(), elements.end())
+{}
+
+bool GCSFilterQuery::MatchAny(const GCSFilter& filter)
+{
+    const GCSFilter::Params& params{filter.GetParams()};
+    const std::tuple<uint64_t, uint64_t, uint64_t> hashes_params{params.m_siphash_k0, params.m_siphash_k1, filter.m_F};
+    if (m_hashes_params != hashes_params) {
+        filter.BuildHashedSet(m_elements, m_hashes);
+        m_hashes_params = hashes_params;
+    }
+    return filter.MatchInternal(m_hashes.data(), m_hashes.size());
+}
+
+std::vector<bool> BlockFiltersMatchAny(std::span<const BlockFilter> filters, const GCSFilter::ElementSet& elements, int num_threads)
+{
+    // Filters are handed out in small chunks, their sizes vary a lot between blocks.
+    constexpr size_t CHUNK_SIZE{16};
+    std::vector<uint8_t> matches(filters.size());
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    const auto worker{[&] {
+        GCSFilterQuery query{elements};
+        try {
+            for (size_t begin; !failed && (begin = next.fetch_add(CHUNK_SIZE)) < filters.size();) {
+                const size_t end{std::min(begin + CHUNK_SIZE, filters.size())};
+                for (size_t i = begin; i < end; ++i) matches[i] = query.MatchAny(filters[i].GetFilter());
+            }
+        } catch (...) {
+            failed = true;
+            std::lock_guard<std::mutex> lock{error_mutex};
+            if (!error) error = std::current_exception();
+        }
+    }};
+
+    const size_t max_threads{(filters.size() + CHUNK_SIZE - 1) / CHUNK_SIZE};
+    const int threads{static_cast<int>(std::min<size_t>(std::clamp(num_threads, 1, MAX_FILTER_MATCH_THREADS), max_threads))};
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; ++i) workers.emplace_back(worker);
+    worker();
+    for (auto& thread : workers) thread.join();
+    if (error) std::rethrow_exception(error);
+
+    return {matches.begin(), matches.end()};
+}
+
 const std::string& BlockFilterTypeName(BlockFilterType filter_type)
 {
     static std::string unknown_retval;
@@ -8,8 +8,11 @@
 #include <cstddef>
 #include <cstdint>
 #include <ios>
+#include <optional>
 #include <set>
+#include <span>
 #include <string>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -53,10 +56,13 @@ private:
     uint64_t HashToRange(const Element& element) const;
 
     std::vector<uint64_t> BuildHashedSet(const ElementSet& elements) const;
+    void BuildHashedSet(std::span<const std::span<const unsigned char>> elements, std::vector<uint64_t>& hashes_out) const;
 
     /** Helper method used to implement Match and MatchAny */
     bool MatchInternal(const uint64_t* sorted_element_hashes, size_t size) const;
 
+    friend class GCSFilterQuery;
+
 public:
 
     /** Constructs an empty filter. */
@@ -86,6 +92,31 @@ public:
     bool MatchAny(const ElementSet& elements) const;
 };
 
+/**
+ * A set of elements matched against many filters, such as the scripts of a
+ * wallet during a rescan. The elements are laid out for hashing once, and the
+ * sorted hashes are reused for consecutive filters with the same parameters.
+ * BIP 158 filters are keyed by their block hash, so across blocks only the
+ * buffers are reused.
+ *
+ * The element set must outlive the query. Not thread-safe, use one query per
+ * thread.
+ */
+class GCSFilterQuery
+{
+public:
+    explicit GCSFilterQuery(const GCSFilter::ElementSet& elements LIFETIMEBOUND);
+
+    /** Same as filter.MatchAny(elements). */
+    bool MatchAny(const GCSFilter& filter);
+
+private:
+    std::vector<std::span<const unsigned char>> m_elements;
+    std::vector<uint64_t> m_hashes;
+    //! SipHash keys and range m_hashes were computed for.
+    std::optional<std::tuple<uint64_t, uint64_t, uint64_t>> m_hashes_params;
+};
+
 constexpr uint8_t BASIC_FILTER_P = 19;
 constexpr uint32_t BASIC_FILTER_M = 784931;
 
@@ -172,4 +203,15 @@ public:
     }
 };
 
+/** Maximum number of threads used by BlockFiltersMatchAny. */
+static constexpr int MAX_FILTER_MATCH_THREADS{8};
+
+/**
+ * Check for each filter whether any of the elements may be in it, like
+ * GCSFilter::MatchAny, decoding up to num_threads filters in parallel.
+ *
+ * @throws std::ios_base::failure if a filter is malformed.
+ */
+std::vector<bool> BlockFiltersMatchAny(std::span<const BlockFilter> filters, const GCSFilter::ElementSet& elements, int num_threads);
+
 #endif // BITQUANTUM_BLOCKFILTER_H
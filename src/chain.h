@@ -140,6 +140,10 @@ enum BlockStatus : uint32_t {
 class CBlockIndex
 {
 public:
+    // The members used when walking and comparing the block tree (GetAncestor,
+    // LastCommonAncestor, CBlockIndexWorkComparator) come first, so that they
+    // share a cache line. Keep it that way when adding fields.
+
     //! pointer to the hash of the block, if any. Memory is owned by this CBlockIndex
     const uint256* phashBlock{nullptr};
 
@@ -152,6 +156,17 @@ public:
     //! height of the entry in the chain. The genesis block has height 0
     int nHeight{0};
 
+    //! Verification status of this block. See enum BlockStatus
+    //!
+    //! Note: this value is modified to show BLOCK_OPT_WITNESS during UTXO snapshot
+    //! load to avoid a spurious startup failure requiring -reindex.
+    //! @sa NeedsRedownload
+    //! @sa ActivateSnapshot
+    uint32_t nStatus GUARDED_BY(::cs_main){0};
+
+    //! (memory only) Total amount of work (expected number of hashes) in the chain up to and including this block
+    arith_uint256 nChainWork{};
+
     //! Which # file this block is stored in (blk?????.dat)
     int nFile GUARDED_BY(::cs_main){0};
 
@@ -161,9 +176,6 @@ public:
     //! Byte offset within rev?????.dat where this block's undo data is stored
     unsigned int nUndoPos GUARDED_BY(::cs_main){0};
 
-    //! (memory only) Total amount of work (expected number of hashes) in the chain up to and including this block
-    arith_uint256 nChainWork{};
-
     //! Number of transactions in this block. This will be nonzero if the block
     //! reached the VALID_TRANSACTIONS level, and zero otherwise.
     //! Note: in a potential headers-first mode, this number cannot be relied upon
@@ -175,14 +187,6 @@ public:
     //! VALID_TRANSACTIONS level.
     uint64_t m_chain_tx_count{0};
 
-    //! Verification status of this block. See enum BlockStatus
-    //!
-    //! Note: this value is modified to show BLOCK_OPT_WITNESS during UTXO snapshot
-    //! load to avoid a spurious startup failure requiring -reindex.
-    //! @sa NeedsRedownload
-    //! @sa ActivateSnapshot
-    uint32_t nStatus GUARDED_BY(::cs_main){0};
-
     //! block header
     int32_t nVersion{0};
     uint256 hashMerkleRoot{};
@@ -9,15 +9,25 @@
 #include <random.h>
 #include <util/trace.h>
 
+#include <algorithm>
+
 TRACEPOINT_SEMAPHORE(utxocache, add);
 TRACEPOINT_SEMAPHORE(utxocache, spent);
 TRACEPOINT_SEMAPHORE(utxocache, uncache);
 
 std::optional<Coin> CCoinsView::GetCoin(const COutPoint& outpoint) const { return std::nullopt; }
+std::vector<std::optional<Coin>> CCoinsView::GetCoins(std::span<const COutPoint> outpoints) const
+{
+    std::vector<std::optional<Coin>> coins;
+    coins.reserve(outpoints.size());
+    for (const COutPoint& outpoint : outpoints) coins.push_back(GetCoin(outpoint));
+    return coins;
+}
 uint256 CCoinsView::GetBestBlock() const { return uint256(); }
 std::vector<uint256> CCoinsView::GetHeadBlocks() const { return std::vector<uint256>(); }
 bool CCoinsView::BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &hashBlock) { return false; }
 std::unique_ptr<CCoinsViewCursor> CCoinsView::Cursor() const { return nullptr; }
+std::unique_ptr<CCoinsViewCursor> CCoinsView::CursorFrom(const Txid& start) const { return nullptr; }
 
 bool CCoinsView::HaveCoin(const COutPoint &outpoint) const
 {
@@ -32,6 +42,7 @@ std::vector<uint256> CCoinsViewBacked::GetHeadBlocks() const { return base->GetH
 void CCoinsViewBacked::SetBackend(CCoinsView &viewIn) { base = &viewIn; }
 bool CCoinsViewBacked::BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &hashBlock) { return base->BatchWrite(cursor, hashBlock); }
 std::unique_ptr<CCoinsViewCursor> CCoinsViewBacked::Cursor() const { return base->Cursor(); }
+std::unique_ptr<CCoinsViewCursor> CCoinsViewBacked::CursorFrom(const Txid& start) const { return base->CursorFrom(start); }
 size_t CCoinsViewBacked::EstimateSize() const { return base->EstimateSize(); }
 
 CCoinsViewCache::CCoinsViewCache(CCoinsView* baseIn, bool deterministic) :
@@ -165,6 +176,42 @@ bool CCoinsViewCache::HaveCoin(const COutPoint &outpoint) const {
     return (it != cacheCoins.end() && !it->second.coin.IsSpent());
 }
 
+std::vector<std::optional<Coin>> CCoinsViewCache::GetCoins(std::span<const COutPoint> outpoints) const
+{
+    PrefetchCoins(outpoints);
+    std::vector<std::optional<Coin>> coins;
+    coins.reserve(outpoints.size());
+    for (const COutPoint& outpoint : outpoints) {
+        if (auto it{cacheCoins.find(outpoint)}; it != cacheCoins.end() && !it->second.coin.IsSpent()) {
+            coins.emplace_back(it->second.coin);
+        } else {
+            coins.emplace_back();
+        }
+    }
+    return coins;
+}
+
+void CCoinsViewCache::PrefetchCoins(std::span<const COutPoint> outpoints) const
+{
+    std::vector<COutPoint> missing;
+    for (const COutPoint& outpoint : outpoints) {
+        if (!cacheCoins.contains(outpoint)) missing.push_back(outpoint);
+    }
+    if (missing.empty()) return;
+    std::sort(missing.begin(), missing.end());
+    missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+    // Insert the coins only once all of them have been fetched, as FetchCoin()
+    // does, so a failing backend does not leave empty entries behind.
+    auto coins{base->GetCoins(missing)};
+    for (size_t i = 0; i < missing.size(); ++i) {
+        if (!coins[i]) continue;
+        const auto it{cacheCoins.try_emplace(missing[i]).first};
+        it->second.coin = std::move(*coins[i]);
+        cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
+    }
+}
+
 bool CCoinsViewCache::HaveCoinInCache(const COutPoint &outpoint) const {
     CCoinsMap::const_iterator it = cacheCoins.find(outpoint);
     return (it != cacheCoins.end() && !it->second.coin.IsSpent());
@@ -382,6 +429,11 @@ std::optional<Coin> CCoinsViewErrorCatcher::GetCoin(const COutPoint& outpoint) c
     return ExecuteBackedWrapper<std::optional<Coin>>([&]() { return CCoinsViewBacked::GetCoin(outpoint); }, m_err_callbacks);
 }
 
+std::vector<std::optional<Coin>> CCoinsViewErrorCatcher::GetCoins(std::span<const COutPoint> outpoints) const
+{
+    return ExecuteBackedWrapper<std::vector<std::optional<Coin>>>([&]() { return base->GetCoins(outpoints); }, m_err_callbacks);
+}
+
 bool CCoinsViewErrorCatcher::HaveCoin(const COutPoint& outpoint) const
 {
     return ExecuteBackedWrapper<bool>([&]() { return CCoinsViewBacked::HaveCoin(outpoint); }, m_err_callbacks);
@@ -20,7 +20,10 @@
 #include <cstdint>
 
 #include <functional>
+#include <optional>
+#include <span>
 #include <unordered_map>
+#include <vector>
 
 /**
  * A UTXO entry.
@@ -312,6 +315,11 @@ public:
     //! Retrieve the Coin (unspent transaction output) for a given outpoint.
     virtual std::optional<Coin> GetCoin(const COutPoint& outpoint) const;
 
+    //! Retrieve the Coins for several outpoints at once, in the given order.
+    //! Views backed by a database override this to batch the lookups, the
+    //! default calls GetCoin() for each outpoint.
+    virtual std::vector<std::optional<Coin>> GetCoins(std::span<const COutPoint> outpoints) const;
+
     //! Just check whether a given outpoint is unspent.
     virtual bool HaveCoin(const COutPoint &outpoint) const;
 
@@ -331,6 +339,11 @@ public:
     //! Get a cursor to iterate over the whole state
     virtual std::unique_ptr<CCoinsViewCursor> Cursor() const;
 
+    //! Get a cursor to iterate over the state, starting at the first coin with
+    //! a txid not below `start` (in serialization order). Returns nullptr if
+    //! not implemented.
+    virtual std::unique_ptr<CCoinsViewCursor> CursorFrom(const Txid& start) const;
+
     //! As we use CCoinsViews polymorphically, have a virtual destructor
     virtual ~CCoinsView() = default;
 
@@ -354,6 +367,7 @@ public:
     void SetBackend(CCoinsView &viewIn);
     bool BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &hashBlock) override;
     std::unique_ptr<CCoinsViewCursor> Cursor() const override;
+    std::unique_ptr<CCoinsViewCursor> CursorFrom(const Txid& start) const override;
     size_t EstimateSize() const override;
 };
 
@@ -388,6 +402,7 @@ public:
 
     // Standard CCoinsView methods
     std::optional<Coin> GetCoin(const COutPoint& outpoint) const override;
+    std::vector<std::optional<Coin>> GetCoins(std::span<const COutPoint> outpoints) const override;
     bool HaveCoin(const COutPoint &outpoint) const override;
     uint256 GetBestBlock() const override;
     void SetBestBlock(const uint256 &hashBlock);
@@ -395,6 +410,9 @@ public:
     std::unique_ptr<CCoinsViewCursor> Cursor() const override {
         throw std::logic_error("CCoinsViewCache cursor iteration not supported.");
     }
+    std::unique_ptr<CCoinsViewCursor> CursorFrom(const Txid& start) const override {
+        throw std::logic_error("CCoinsViewCache cursor iteration not supported.");
+    }
 
     /**
      * Check if we have the given utxo already loaded in this cache.
@@ -403,6 +421,14 @@ public:
      */
     bool HaveCoinInCache(const COutPoint &outpoint) const;
 
+    /**
+     * Load the given coins into the cache, fetching all of them that are not
+     * cached yet from the backing view with a single GetCoins() call. Meant
+     * for callers that know all the outpoints they are going to access up
+     * front, such as the inputs of a block.
+     */
+    void PrefetchCoins(std::span<const COutPoint> outpoints) const;
+
     /**
      * Return a reference to Coin in the cache, or coinEmpty if not found. This is
      * more efficient than GetCoin.
@@ -518,6 +544,7 @@ public:
     }
 
     std::optional<Coin> GetCoin(const COutPoint& outpoint) const override;
+    std::vector<std::optional<Coin>> GetCoins(std::span<const COutPoint> outpoints) const override;
     bool HaveCoin(const COutPoint &outpoint) const override;
 
 private:
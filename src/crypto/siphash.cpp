@@ -4,6 +4,8 @@
 
 #include <crypto/siphash.h>
 
+#include <crypto/common.h>
+
 #include <bit>
 
 #define SIPROUND do { \
@@ -51,6 +53,19 @@ CSipHasher& CSipHasher::Write(std::span<const unsigned char> data)
     uint64_t t = tmp;
     uint8_t c = count;
 
+    // Consume whole words while aligned to a word boundary.
+    if ((c & 7) == 0) {
+        while (data.size() >= 8) {
+            const uint64_t m = ReadLE64(data.data());
+            v3 ^= m;
+            SIPROUND;
+            SIPROUND;
+            v0 ^= m;
+            c += 8;
+            data = data.subspan(8);
+        }
+    }
+
     while (data.size() > 0) {
         t |= uint64_t{data.front()} << (8 * (c % 8));
         c++;
@@ -92,6 +107,40 @@ uint64_t CSipHasher::Finalize() const
     return v0 ^ v1 ^ v2 ^ v3;
 }
 
+void SipHashBatch(uint64_t k0, uint64_t k1, std::span<const std::span<const unsigned char>> inputs, std::span<uint64_t> out)
+{
+    assert(inputs.size() == out.size());
+    const uint64_t init0 = 0x736f6d6570736575ULL ^ k0;
+    const uint64_t init1 = 0x646f72616e646f6dULL ^ k1;
+    const uint64_t init2 = 0x6c7967656e657261ULL ^ k0;
+    const uint64_t init3 = 0x7465646279746573ULL ^ k1;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        std::span<const unsigned char> data{inputs[i]};
+        uint64_t v0 = init0, v1 = init1, v2 = init2, v3 = init3;
+        const uint64_t b = uint64_t{data.size()} << 56;
+        while (data.size() >= 8) {
+            const uint64_t m = ReadLE64(data.data());
+            v3 ^= m;
+            SIPROUND;
+            SIPROUND;
+            v0 ^= m;
+            data = data.subspan(8);
+        }
+        uint64_t t = b;
+        for (size_t j = 0; j < data.size(); ++j) t |= uint64_t{data[j]} << (8 * j);
+        v3 ^= t;
+        SIPROUND;
+        SIPROUND;
+        v0 ^= t;
+        v2 ^= 0xFF;
+        SIPROUND;
+        SIPROUND;
+        SIPROUND;
+        SIPROUND;
+        out[i] = v0 ^ v1 ^ v2 ^ v3;
+    }
+}
+
 uint64_t SipHashUint256(uint64_t k0, uint64_t k1, const uint256& val)
 {
     /* Specialized implementation for efficiency */
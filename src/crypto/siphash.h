@@ -32,6 +32,14 @@ public:
     uint64_t Finalize() const;
 };
 
+/** SipHash-2-4 of many inputs with the same key.
+ *
+ *  Sets out[i] to CSipHasher(k0, k1).Write(inputs[i]).Finalize(), without
+ *  setting up a hasher per input and consuming the inputs a word at a time.
+ *  `out` must have the same size as `inputs`.
+ */
+void SipHashBatch(uint64_t k0, uint64_t k1, std::span<const std::span<const unsigned char>> inputs, std::span<uint64_t> out);
+
 /** Optimized SipHash-2-4 implementation for uint256.
  *
  *  It is identical to:
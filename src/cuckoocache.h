@@ -444,6 +444,27 @@ public:
         }
     }
 
+    /** capacity returns the number of slots available in the table
+     * @returns the number of elements storable */
+    uint32_t capacity() const
+    {
+        return size;
+    }
+
+    /** for_each calls `f` on every element which has not been marked for
+     * erasure, for example to persist the cache. Threadsafe without any
+     * concurrent insert.
+     *
+     * @param f the function called with each element
+     */
+    template <typename F>
+    void for_each(F f) const
+    {
+        for (uint32_t i = 0; i < size; ++i) {
+            if (!collection_flags.bit_is_set(i)) f(table[i]);
+        }
+    }
+
     /** contains iterates through the hash locations for a given element
      * and checks to see if it is present.
      *
@@ -9,16 +9,24 @@
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <sync.h>
+#include <tinyformat.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
 #include <util/obfuscation.h>
 #include <util/strencodings.h>
+#include <util/threadnames.h>
+#include <util/time.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
+#include <exception>
+#include <numeric>
 #include <leveldb/cache.h>
 #include <leveldb/db.h>
 #include <leveldb/env.h>
@@ -31,6 +39,7 @@
 #include <leveldb/write_batch.h>
 #include <memory>
 #include <optional>
+#include <thread>
 #include <utility>
 
 static auto CharCast(const std::byte* data) { return reinterpret_cast<const char*>(data); }
@@ -135,12 +144,17 @@ static void SetMaxOpenFiles(leveldb::Options *options) {
              options->max_open_files, default_open_files);
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+static leveldb::Options GetOptions(size_t nCacheSize, const DBOptions& db_options)
 {
     leveldb::Options options;
-    options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
-    options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
+    const size_t block_cache_size{nCacheSize / 100 * std::clamp(db_options.block_cache_percent, 0, 100)};
+    options.block_cache = leveldb::NewLRUCache(block_cache_size);
+    options.write_buffer_size = (nCacheSize - block_cache_size) / 2; // up to two write buffers may be held in memory simultaneously
+    if (db_options.bloom_bits > 0) {
+        // Tables written with a different number of bits (or without a
+        // filter) remain readable, the filter policy name does not change.
+        options.filter_policy = leveldb::NewBloomFilterPolicy(db_options.bloom_bits);
+    }
     options.compression = leveldb::kNoCompression;
     options.info_log = new CBitquantumLevelDBLogger();
     if (leveldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16)) {
@@ -148,7 +162,7 @@ static leveldb::Options GetOptions(size_t nCacheSize)
         // on corruption in later versions.
         options.paranoid_checks = true;
     }
-    options.max_file_size = std::max(options.max_file_size, DBWRAPPER_MAX_FILE_SIZE);
+    options.max_file_size = std::max(options.max_file_size, db_options.max_file_size);
     SetMaxOpenFiles(&options);
     return options;
 }
@@ -211,8 +225,61 @@ struct LevelDBContext {
 
     //! the database itself
     leveldb::DB* pdb;
+
+    //! size of the block cache
+    size_t block_cache_size{0};
+
+    //! bits per key of the bloom filter policy, if any
+    int bloom_bits{0};
+
+    std::atomic<uint64_t> batches_written{0};
+    std::atomic<uint64_t> bytes_written{0};
+
+    //! background compaction scheduler, see DBOptions::compact_after_bytes
+    size_t compact_after_bytes{0};
+    size_t compact_min_batch_bytes{0};
+    std::thread compact_thread;
+    Mutex compact_mutex;
+    std::condition_variable compact_cv;
+    //! bytes written in large batches since the last compaction was scheduled
+    uint64_t compact_pending_bytes GUARDED_BY(compact_mutex){0};
+    bool compact_requested GUARDED_BY(compact_mutex){false};
+    bool compact_stop GUARDED_BY(compact_mutex){false};
+    std::atomic<uint64_t> compactions_scheduled{0};
+    std::atomic<uint64_t> compactions_completed{0};
+    std::atomic<int64_t> compaction_time_ms{0};
+    std::atomic<bool> compaction_running{false};
 };
 
+/**
+ * Compact the whole database each time it is requested. LevelDB compacts on
+ * its own as well, but only a few files at a time; after a large flush that
+ * leaves level 0 full of overlapping files, reads and later writes stall
+ * until they are merged. Compacting right away in the background keeps the
+ * number of files a lookup has to check low.
+ */
+static void CompactionThread(LevelDBContext& ctx, const std::string& name) EXCLUSIVE_LOCKS_REQUIRED(!ctx.compact_mutex)
+{
+    util::ThreadRename("dbcompact");
+    while (true) {
+        {
+            WAIT_LOCK(ctx.compact_mutex, lock);
+            ctx.compact_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(ctx.compact_mutex) { return ctx.compact_requested || ctx.compact_stop; });
+            if (ctx.compact_stop) return;
+            ctx.compact_requested = false;
+        }
+        LogDebug(BCLog::LEVELDB, "Starting background compaction of %s\n", name);
+        ctx.compaction_running = true;
+        const auto start{SteadyClock::now()};
+        ctx.pdb->CompactRange(nullptr, nullptr);
+        const auto duration{Ticks<std::chrono::milliseconds>(SteadyClock::now() - start)};
+        ctx.compaction_time_ms += duration;
+        ++ctx.compactions_completed;
+        ctx.compaction_running = false;
+        LogDebug(BCLog::LEVELDB, "Finished background compaction of %s in %dms\n", name, duration);
+    }
+}
+
 CDBWrapper::CDBWrapper(const DBParams& params)
     : m_db_context{std::make_unique<LevelDBContext>()}, m_name{fs::PathToString(params.path.stem())}, m_path{params.path}, m_is_memory{params.memory_only}
 {
@@ -221,7 +288,9 @@ CDBWrapper::CDBWrapper(const DBParams& params)
     DBContext().iteroptions.verify_checksums = true;
     DBContext().iteroptions.fill_cache = false;
     DBContext().syncoptions.sync = true;
-    DBContext().options = GetOptions(params.cache_bytes);
+    DBContext().options = GetOptions(params.cache_bytes, params.options);
+    DBContext().block_cache_size = params.cache_bytes / 100 * std::clamp(params.options.block_cache_percent, 0, 100);
+    DBContext().bloom_bits = DBContext().options.filter_policy ? params.options.bloom_bits : 0;
     DBContext().options.create_if_missing = true;
     if (params.memory_only) {
         DBContext().penv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -248,6 +317,8 @@ CDBWrapper::CDBWrapper(const DBParams& params)
         DBContext().pdb->CompactRange(nullptr, nullptr);
         LogInfo("Finished database compaction of %s", fs::PathToString(params.path));
     }
+    LogDebug(BCLog::LEVELDB, "LevelDB %s: block cache %d bytes, write buffer %d bytes, %d bloom bits, max file size %d bytes\n",
+             m_name, DBContext().block_cache_size, DBContext().options.write_buffer_size, DBContext().bloom_bits, DBContext().options.max_file_size);
 
     if (!Read(OBFUSCATION_KEY, m_obfuscation) && params.obfuscate && IsEmpty()) {
         // Generate and write the new obfuscation key.
@@ -258,10 +329,24 @@ CDBWrapper::CDBWrapper(const DBParams& params)
         LogInfo("Wrote new obfuscation key for %s: %s", fs::PathToString(params.path), m_obfuscation.HexKey());
     }
     LogInfo("Using obfuscation key for %s: %s", fs::PathToString(params.path), m_obfuscation.HexKey());
+
+    // Started last, because the destructor that joins it does not run if the
+    // constructor throws.
+    if (params.options.compact_after_bytes > 0) {
+        DBContext().compact_after_bytes = params.options.compact_after_bytes;
+        DBContext().compact_min_batch_bytes = params.options.compact_min_batch_bytes;
+        DBContext().compact_thread = std::thread{[this] { CompactionThread(DBContext(), m_name); }};
+    }
 }
 
 CDBWrapper::~CDBWrapper()
 {
+    if (DBContext().compact_thread.joinable()) {
+        WITH_LOCK(DBContext().compact_mutex, DBContext().compact_stop = true);
+        DBContext().compact_cv.notify_all();
+        if (DBContext().compaction_running) LogInfo("Waiting for the background compaction of %s to finish", m_name);
+        DBContext().compact_thread.join();
+    }
     delete DBContext().pdb;
     DBContext().pdb = nullptr;
     delete DBContext().options.filter_policy;
@@ -283,6 +368,25 @@ bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
     }
     leveldb::Status status = DBContext().pdb->Write(fSync ? DBContext().syncoptions : DBContext().writeoptions, &batch.m_impl_batch->batch);
     HandleError(status);
+    const size_t batch_size{batch.ApproximateSize()};
+    ++DBContext().batches_written;
+    DBContext().bytes_written += batch_size;
+    if (DBContext().compact_after_bytes > 0 && batch_size >= DBContext().compact_min_batch_bytes) {
+        bool schedule{false};
+        {
+            LOCK(DBContext().compact_mutex);
+            DBContext().compact_pending_bytes += batch_size;
+            if (DBContext().compact_pending_bytes >= DBContext().compact_after_bytes && !DBContext().compact_requested) {
+                DBContext().compact_pending_bytes = 0;
+                DBContext().compact_requested = true;
+                schedule = true;
+            }
+        }
+        if (schedule) {
+            ++DBContext().compactions_scheduled;
+            DBContext().compact_cv.notify_all();
+        }
+    }
     if (log_memory) {
         double mem_after = DynamicMemoryUsage() / 1024.0 / 1024;
         LogDebug(BCLog::LEVELDB, "WriteBatch memory usage: db=%s, before=%.1fMiB, after=%.1fMiB\n",
@@ -302,6 +406,31 @@ size_t CDBWrapper::DynamicMemoryUsage() const
     return parsed.value();
 }
 
+DBStats CDBWrapper::GetStats() const
+{
+    DBStats stats;
+    stats.name = m_name;
+    // LevelDB has a fixed number of levels (config::kNumLevels), the property
+    // lookup fails for the first level past the last one.
+    std::string value;
+    for (int level = 0; DBContext().pdb->GetProperty(strprintf("leveldb.num-files-at-level%d", level), &value); ++level) {
+        stats.files_per_level.push_back(ToIntegral<int>(value).value_or(0));
+    }
+    DBContext().pdb->GetProperty("leveldb.stats", &stats.leveldb_stats);
+    stats.memory_usage = DynamicMemoryUsage();
+    stats.block_cache_bytes = DBContext().block_cache_size;
+    stats.write_buffer_bytes = DBContext().options.write_buffer_size;
+    stats.bloom_bits = DBContext().bloom_bits;
+    stats.max_file_size = DBContext().options.max_file_size;
+    stats.batches_written = DBContext().batches_written;
+    stats.bytes_written = DBContext().bytes_written;
+    stats.compactions_scheduled = DBContext().compactions_scheduled;
+    stats.compactions_completed = DBContext().compactions_completed;
+    stats.compaction_time = std::chrono::milliseconds{DBContext().compaction_time_ms.load()};
+    stats.compaction_running = DBContext().compaction_running;
+    return stats;
+}
+
 std::optional<std::string> CDBWrapper::ReadImpl(std::span<const std::byte> key) const
 {
     leveldb::Slice slKey(CharCast(key.data()), key.size());
@@ -316,6 +445,92 @@ std::optional<std::string> CDBWrapper::ReadImpl(std::span<const std::byte> key)
     return strValue;
 }
 
+std::vector<std::optional<std::string>> CDBWrapper::MultiReadImpl(std::span<const DataStream> keys, int num_threads) const
+{
+    // Number of entries an iterator may step over to reach the next key
+    // before it seeks instead.
+    constexpr int MAX_ITERATOR_STEPS{8};
+
+    const auto key_less{[&](size_t a, size_t b) {
+        return std::ranges::lexicographical_compare(keys[a], keys[b]);
+    }};
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), key_less);
+
+    std::vector<std::optional<std::string>> values(keys.size());
+    leveldb::ReadOptions options{DBContext().readoptions};
+    options.snapshot = DBContext().pdb->GetSnapshot();
+    struct SnapshotReleaser {
+        leveldb::DB& db;
+        const leveldb::Snapshot* snapshot;
+        ~SnapshotReleaser() { db.ReleaseSnapshot(snapshot); }
+    } releaser{*DBContext().pdb, options.snapshot};
+
+    const auto read_range{[&](size_t begin, size_t end) {
+        std::unique_ptr<leveldb::Iterator> it;
+        // Whether the iterator points at the first entry not below the previous key.
+        bool positioned{false};
+        for (size_t i = begin; i < end; ++i) {
+            const DataStream& key{keys[order[i]]};
+            const leveldb::Slice sl_key(CharCast(key.data()), key.size());
+            if (i > begin) {
+                const DataStream& prev{keys[order[i - 1]]};
+                const size_t shared_prefix = std::ranges::mismatch(prev, key).in2 - key.begin();
+                if (shared_prefix * 2 >= key.size()) {
+                    if (!it) it.reset(DBContext().pdb->NewIterator(options));
+                    if (positioned) {
+                        for (int steps{0}; it->Valid() && it->key().compare(sl_key) < 0 && steps < MAX_ITERATOR_STEPS; ++steps) it->Next();
+                    }
+                    if (!positioned || (it->Valid() && it->key().compare(sl_key) < 0)) it->Seek(sl_key);
+                    HandleError(it->status());
+                    positioned = true;
+                    if (it->Valid() && it->key() == sl_key) values[order[i]] = it->value().ToString();
+                    continue;
+                }
+            }
+            positioned = false;
+            std::string value;
+            const leveldb::Status status{DBContext().pdb->Get(options, sl_key, &value)};
+            if (status.ok()) {
+                values[order[i]] = std::move(value);
+            } else if (!status.IsNotFound()) {
+                LogPrintf("LevelDB read failure: %s\n", status.ToString());
+                HandleError(status);
+            }
+        }
+    }};
+
+    const size_t ranges{std::clamp<size_t>(keys.size() / DBWRAPPER_MULTIREAD_MIN_KEYS_PER_THREAD, 1, std::max(num_threads, 1))};
+    if (ranges == 1) {
+        read_range(0, keys.size());
+        return values;
+    }
+    // Each thread reads a contiguous range of the sorted keys, so clustered
+    // keys stay together. The calling thread reads the first range.
+    std::vector<std::exception_ptr> errors(ranges);
+    std::vector<std::thread> threads;
+    for (size_t r = 1; r < ranges; ++r) {
+        threads.emplace_back([&, r] {
+            try {
+                read_range(keys.size() * r / ranges, keys.size() * (r + 1) / ranges);
+            } catch (...) {
+                errors[r] = std::current_exception();
+            }
+        });
+    }
+    try {
+        read_range(0, keys.size() / ranges);
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+    for (auto& thread : threads) thread.join();
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+    return values;
+}
+
 bool CDBWrapper::ExistsImpl(std::span<const std::byte> key) const
 {
     leveldb::Slice slKey(CharCast(key.data()), key.size());
@@ -12,21 +12,63 @@
 #include <util/check.h>
 #include <util/fs.h>
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
 static const size_t DBWRAPPER_MAX_FILE_SIZE = 32 << 20; // 32 MiB
+static const int DEFAULT_DB_BLOOM_BITS = 10;
+static const int DEFAULT_DB_BLOCK_CACHE_PERCENT = 50;
+//! Minimum number of keys each thread of a multi-threaded MultiRead() looks up.
+static const size_t DBWRAPPER_MULTIREAD_MIN_KEYS_PER_THREAD = 64;
 
 //! User-controlled performance and debug options.
 struct DBOptions {
     //! Compact database on startup.
     bool force_compact = false;
+    //! Bits per key of the bloom filter of each table, 0 disables the filter.
+    int bloom_bits = DEFAULT_DB_BLOOM_BITS;
+    //! Share of the cache (in percent) used as block cache. The remainder is
+    //! split between the two write buffers LevelDB may hold at once.
+    int block_cache_percent = DEFAULT_DB_BLOCK_CACHE_PERCENT;
+    //! Target size of the table files.
+    size_t max_file_size = DBWRAPPER_MAX_FILE_SIZE;
+    //! Compact the database in the background once this many bytes have been
+    //! written in batches of at least compact_min_batch_bytes. 0 disables.
+    size_t compact_after_bytes = 0;
+    //! Smaller batches do not count towards compact_after_bytes, so only large
+    //! flushes (such as the coins cache being written out) trigger compactions.
+    size_t compact_min_batch_bytes = 1 << 20;
+};
+
+//! Snapshot of a database's LevelDB internals and compaction counters.
+struct DBStats {
+    std::string name;
+    //! Table files per level.
+    std::vector<int> files_per_level;
+    //! Output of LevelDB's "leveldb.stats" property.
+    std::string leveldb_stats;
+    size_t memory_usage{0};
+    size_t block_cache_bytes{0};
+    size_t write_buffer_bytes{0};
+    int bloom_bits{0};
+    size_t max_file_size{0};
+    uint64_t batches_written{0};
+    uint64_t bytes_written{0};
+    //! Background compactions started after large flushes.
+    uint64_t compactions_scheduled{0};
+    uint64_t compactions_completed{0};
+    //! Total time spent in background compactions.
+    std::chrono::milliseconds compaction_time{0};
+    bool compaction_running{false};
 };
 
 //! Application-specific storage settings.
@@ -198,6 +240,7 @@ private:
     bool m_is_memory;
 
     std::optional<std::string> ReadImpl(std::span<const std::byte> key) const;
+    std::vector<std::optional<std::string>> MultiReadImpl(std::span<const DataStream> keys, int num_threads) const;
     bool ExistsImpl(std::span<const std::byte> key) const;
     size_t EstimateSizeImpl(std::span<const std::byte> key1, std::span<const std::byte> key2) const;
     auto& DBContext() const LIFETIMEBOUND { return *Assert(m_db_context); }
@@ -229,6 +272,40 @@ public:
         return true;
     }
 
+    /**
+     * Read the values of several keys at once, from a consistent snapshot of
+     * the database. The keys are looked up in sorted order; runs of keys
+     * sharing a long prefix (such as the outputs of one transaction) are read
+     * by stepping an iterator instead of doing a new lookup for each. With
+     * `num_threads` above 1, large requests are split between threads.
+     *
+     * @returns the values in the order of `keys`, std::nullopt for keys that
+     *          are missing or whose value cannot be deserialized.
+     */
+    template <typename K, typename V>
+    std::vector<std::optional<V>> MultiRead(std::span<const K> keys, int num_threads = 1) const
+    {
+        std::vector<DataStream> ss_keys(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            ss_keys[i].reserve(DBWRAPPER_PREALLOC_KEY_SIZE);
+            ss_keys[i] << keys[i];
+        }
+        std::vector<std::optional<std::string>> values{MultiReadImpl(ss_keys, num_threads)};
+        std::vector<std::optional<V>> result(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (!values[i]) continue;
+            try {
+                DataStream ssValue{MakeByteSpan(*values[i])};
+                m_obfuscation(ssValue);
+                V value;
+                ssValue >> value;
+                result[i] = std::move(value);
+            } catch (const std::exception&) {
+            }
+        }
+        return result;
+    }
+
     template <typename K, typename V>
     bool Write(const K& key, const V& value, bool fSync = false)
     {
@@ -267,6 +344,9 @@ public:
     // Get an estimate of LevelDB memory usage (in bytes).
     size_t DynamicMemoryUsage() const;
 
+    //! Get LevelDB's internal statistics and the compaction counters of this database.
+    DBStats GetStats() const;
+
     CDBIterator* NewIterator();
 
     /**
@@ -5,6 +5,7 @@
 #include <chainparams.h>
 #include <common/args.h>
 #include <index/base.h>
+#include <index/synccoordinator.h>
 #include <interfaces/chain.h>
 #include <kernel/chain.h>
 #include <logging.h>
@@ -21,16 +22,20 @@
 #include <validation.h>
 
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 constexpr uint8_t DB_BEST_BLOCK{'B'};
 
 constexpr auto SYNC_LOG_INTERVAL{30s};
+//! Number of blocks processed at once during the initial sync with a sync coordinator.
+constexpr size_t SYNC_BATCH_SIZE{32};
 constexpr auto SYNC_LOCATOR_WRITE_INTERVAL{30s};
 
 template <typename... Args>
@@ -56,7 +61,12 @@ BaseIndex::DB::DB(const fs::path& path, size_t n_cache_size, bool f_memory, bool
         .memory_only = f_memory,
         .wipe_data = f_wipe,
         .obfuscate = f_obfuscate,
-        .options = [] { DBOptions options; node::ReadDatabaseArgs(gArgs, options); return options; }()}}
+        .options = [] {
+            DBOptions options;
+            // Malformed values were already rejected at startup.
+            (void)node::ReadDatabaseArgs(gArgs, options, node::DB_TYPE_INDEXES);
+            return options;
+        }()}}
 {}
 
 bool BaseIndex::DB::ReadBestBlock(CBlockLocator& locator) const
@@ -182,10 +192,62 @@ bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data
     return true;
 }
 
+bool BaseIndex::ProcessBlocks(std::span<const CBlockIndex* const> blocks)
+{
+    if (!m_sync_coordinator) {
+        for (const CBlockIndex* pindex : blocks) {
+            if (!ProcessBlock(pindex)) return false;
+        }
+        return true;
+    }
+
+    const bool need_undo{CustomOptions().connect_undo_data};
+    const bool parallel_append{AllowParallelAppend()};
+    std::vector<IndexSyncCoordinator::BlockData> data(blocks.size());
+    std::vector<interfaces::BlockInfo> infos;
+    infos.reserve(blocks.size());
+    for (const CBlockIndex* pindex : blocks) infos.push_back(kernel::MakeBlockInfo(pindex));
+
+    std::vector<std::function<bool()>> jobs;
+    jobs.reserve(blocks.size());
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        jobs.emplace_back([&, i] {
+            auto fetched{m_sync_coordinator->Fetch(*blocks[i], need_undo)};
+            if (!fetched) return false;
+            data[i] = std::move(*fetched);
+            infos[i].data = data[i].block.get();
+            infos[i].undo_data = data[i].undo.get();
+            return CustomPrepare(infos[i]) && (!parallel_append || CustomAppend(infos[i]));
+        });
+    }
+    const bool prepared{m_sync_coordinator->RunParallel(std::move(jobs))};
+    size_t appended{0};
+    if (prepared && !parallel_append) {
+        while (appended < blocks.size() && CustomAppend(infos[appended])) ++appended;
+    }
+    CustomDiscardPrepared();
+
+    if (!prepared) {
+        FatalErrorf("Failed to read or index blocks %s to %s",
+                    blocks.front()->GetBlockHash().ToString(), blocks.back()->GetBlockHash().ToString());
+        return false;
+    }
+    if (!parallel_append && appended < blocks.size()) {
+        FatalErrorf("Failed to write block %s to index database",
+                    blocks[appended]->GetBlockHash().ToString());
+        return false;
+    }
+    return true;
+}
+
 void BaseIndex::Sync()
 {
     const CBlockIndex* pindex = m_best_block_index.load();
     if (!m_synced) {
+        if (m_sync_coordinator) m_sync_coordinator->AddConsumer();
+        const auto remove_consumer{[&] { if (m_sync_coordinator) m_sync_coordinator->RemoveConsumer(); }};
+        m_sync_start_time = SteadyClock::now();
+        m_sync_blocks = 0;
         auto last_log_time{NodeClock::now()};
         auto last_locator_write_time{last_log_time};
         while (true) {
@@ -197,6 +259,7 @@ void BaseIndex::Sync()
                 // logged. The best way to recover is to continue, as index cannot be corrupted by
                 // a missed commit to disk for an advanced index state.
                 Commit();
+                remove_consumer();
                 return;
             }
 
@@ -222,12 +285,28 @@ void BaseIndex::Sync()
             }
             if (pindex_next->pprev != pindex && !Rewind(pindex, pindex_next->pprev)) {
                 FatalErrorf("Failed to rewind %s to a previous chain tip", GetName());
+                remove_consumer();
                 return;
             }
-            pindex = pindex_next;
-
 
-            if (!ProcessBlock(pindex)) return; // error logged internally
+            // With a sync coordinator, process a batch of consecutive blocks
+            // at once. A reorg in the meantime is handled by the next
+            // NextSyncBlock call, as for a single block.
+            std::vector<const CBlockIndex*> batch{pindex_next};
+            if (m_sync_coordinator) {
+                LOCK(cs_main);
+                while (batch.size() < SYNC_BATCH_SIZE) {
+                    const CBlockIndex* next{m_chainstate->m_chain.Next(batch.back())};
+                    if (!next) break;
+                    batch.push_back(next);
+                }
+            }
+            if (!ProcessBlocks(batch)) { // error logged internally
+                remove_consumer();
+                return;
+            }
+            pindex = batch.back();
+            m_sync_blocks += batch.size();
 
             auto current_time{NodeClock::now()};
             if (current_time - last_log_time >= SYNC_LOG_INTERVAL) {
@@ -242,6 +321,7 @@ void BaseIndex::Sync()
                 Commit();
             }
         }
+        remove_consumer();
     }
 
     if (pindex) {
@@ -461,6 +541,11 @@ IndexSummary BaseIndex::GetSummary() const
     IndexSummary summary{};
     summary.name = GetName();
     summary.synced = m_synced;
+    const auto sync_start_time{m_sync_start_time.load()};
+    if (!summary.synced && sync_start_time != SteadyClock::time_point{}) {
+        const auto elapsed{SteadyClock::now() - sync_start_time};
+        if (elapsed > 0s) summary.blocks_per_second = m_sync_blocks / Ticks<SecondsDouble>(elapsed);
+    }
     if (const auto& pindex = m_best_block_index.load()) {
         summary.best_block_height = pindex->nHeight;
         summary.best_block_hash = pindex->GetBlockHash();
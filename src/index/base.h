@@ -10,14 +10,19 @@
 #include <interfaces/types.h>
 #include <util/string.h>
 #include <util/threadinterrupt.h>
+#include <util/time.h>
 #include <validationinterface.h>
 
+#include <atomic>
+#include <optional>
+#include <span>
 #include <string>
 
 class CBlock;
 class CBlockIndex;
 class Chainstate;
 class ChainstateManager;
+class IndexSyncCoordinator;
 namespace interfaces {
 class Chain;
 } // namespace interfaces
@@ -27,6 +32,8 @@ struct IndexSummary {
     bool synced{false};
     int best_block_height{0};
     uint256 best_block_hash;
+    //! Average initial sync speed, only set while the index is catching up.
+    std::optional<double> blocks_per_second;
 };
 
 /**
@@ -80,6 +87,13 @@ private:
     std::thread m_thread_sync;
     CThreadInterrupt m_interrupt;
 
+    /// Optional helper shared by all indexes catching up, see SetSyncCoordinator.
+    IndexSyncCoordinator* m_sync_coordinator{nullptr};
+
+    /// Progress of the initial sync, for GetSummary.
+    std::atomic<SteadyClock::time_point> m_sync_start_time{};
+    std::atomic<uint64_t> m_sync_blocks{0};
+
     /// Write the current index state (eg. chain block locator and subclass-specific items) to disk.
     ///
     /// Recommendations for error handling:
@@ -95,6 +109,10 @@ private:
 
     bool ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data = nullptr);
 
+    /// Process consecutive blocks of the active chain during the initial sync,
+    /// reading them and running CustomPrepare on the sync coordinator's thread pool.
+    bool ProcessBlocks(std::span<const CBlockIndex* const> blocks);
+
     virtual bool AllowPrune() const = 0;
 
     template <typename... Args>
@@ -118,6 +136,19 @@ protected:
     /// Write update index entries for a newly connected block.
     [[nodiscard]] virtual bool CustomAppend(const interfaces::BlockInfo& block) { return true; }
 
+    /// Do the work for a block that does not depend on previous blocks, ahead of
+    /// CustomAppend. During the initial sync this may be called concurrently for
+    /// several blocks, in any order. Not called for blocks connected later on.
+    [[nodiscard]] virtual bool CustomPrepare(const interfaces::BlockInfo& block) { return true; }
+
+    /// Drop whatever CustomPrepare kept for blocks that were not appended. Called
+    /// at the end of every initial sync batch, including failed ones.
+    virtual void CustomDiscardPrepared() {}
+
+    /// Whether CustomAppend itself may be called concurrently and out of order
+    /// for the blocks of an initial sync batch.
+    virtual bool AllowParallelAppend() const { return false; }
+
     /// Virtual method called internally by Commit that can be overridden to atomically
     /// commit more index state.
     virtual bool CustomCommit(CDBBatch& batch) { return true; }
@@ -151,6 +182,11 @@ public:
     /// validation interface so that it stays in sync with blockchain updates.
     [[nodiscard]] bool Init();
 
+    /// Share block reads and a thread pool with the other indexes catching up.
+    /// Must be called before StartBackgroundSync, the coordinator must outlive
+    /// the sync thread.
+    void SetSyncCoordinator(IndexSyncCoordinator* coordinator) { m_sync_coordinator = coordinator; }
+
     /// Starts the initial sync process on a background thread.
     [[nodiscard]] bool StartBackgroundSync();
 
@@ -166,6 +202,9 @@ public:
 
     /// Get a summary of the index and its state.
     IndexSummary GetSummary() const;
+
+    /// Get the LevelDB statistics of the index database.
+    DBStats GetDBStats() const { return GetDB().GetStats(); }
 };
 
 #endif // BITQUANTUM_INDEX_BASE_H
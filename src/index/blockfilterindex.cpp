@@ -43,6 +43,10 @@ constexpr unsigned int FLTR_FILE_CHUNK_SIZE = 0x100000; // 1 MiB
  *  is big enough for a 2,000,000 length block chain, which
  *  we should be enough until ~2047. */
 constexpr size_t CF_HEADERS_CACHE_MAX_SZ{2000};
+/** Number of recent filter hashes and headers kept in memory. This covers two
+ *  maximum-size getcfheaders requests (2000 headers each), the common case for
+ *  light clients syncing up to the tip. */
+constexpr size_t RECENT_FILTERS_CACHE_SIZE{4000};
 
 namespace {
 
@@ -271,12 +275,43 @@ std::optional<uint256> BlockFilterIndex::ReadFilterHeader(int height, const uint
     return read_out.second.header;
 }
 
-bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
+bool BlockFilterIndex::CustomPrepare(const interfaces::BlockInfo& block)
 {
+    // Building the filter only depends on the block and its undo data, the
+    // header chain is extended in order by CustomAppend.
     BlockFilter filter(m_filter_type, *Assert(block.data), *Assert(block.undo_data));
+    LOCK(m_prepared_filters_mutex);
+    m_prepared_filters.insert_or_assign(block.hash, std::move(filter));
+    return true;
+}
+
+void BlockFilterIndex::CustomDiscardPrepared()
+{
+    LOCK(m_prepared_filters_mutex);
+    m_prepared_filters.clear();
+}
+
+bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    auto prepared{WITH_LOCK(m_prepared_filters_mutex, return m_prepared_filters.extract(block.hash))};
+    BlockFilter filter{prepared ? std::move(prepared.mapped()) : BlockFilter(m_filter_type, *Assert(block.data), *Assert(block.undo_data))};
     const uint256& header = filter.ComputeHeader(m_last_header);
     bool res = Write(filter, block.height, header);
-    if (res) m_last_header = header; // update last header
+    if (res) {
+        m_last_header = header; // update last header
+
+        LOCK(m_recent_filters_mutex);
+        if (m_recent_filters.empty() || block.height != m_recent_filters_height + static_cast<int>(m_recent_filters.size())) {
+            // Not extending the cached chain (first block, or after a rewind past the cache).
+            m_recent_filters.clear();
+            m_recent_filters_height = block.height;
+        }
+        m_recent_filters.push_back({block.hash, filter.GetHash(), header});
+        if (m_recent_filters.size() > RECENT_FILTERS_CACHE_SIZE) {
+            m_recent_filters.pop_front();
+            ++m_recent_filters_height;
+        }
+    }
     return res;
 }
 
@@ -342,6 +377,15 @@ bool BlockFilterIndex::CustomRemove(const interfaces::BlockInfo& block)
 
     // Update cached header to the previous block hash
     m_last_header = *Assert(ReadFilterHeader(block.height - 1, *Assert(block.prev_hash)));
+
+    LOCK(m_recent_filters_mutex);
+    if (!m_recent_filters.empty() &&
+        block.height == m_recent_filters_height + static_cast<int>(m_recent_filters.size()) - 1 &&
+        m_recent_filters.back().block_hash == block.hash) {
+        m_recent_filters.pop_back();
+    } else {
+        m_recent_filters.clear();
+    }
     return true;
 }
 
@@ -422,6 +466,21 @@ static bool LookupRange(CDBWrapper& db, const std::string& index_name, int start
     return true;
 }
 
+bool BlockFilterIndex::LookupRecentFilters(int start_height, const CBlockIndex* stop_index,
+                                           std::vector<RecentFilter>& entries_out) const
+{
+    LOCK(m_recent_filters_mutex);
+    if (start_height < m_recent_filters_height || start_height > stop_index->nHeight) return false;
+    const size_t stop_offset{static_cast<size_t>(stop_index->nHeight - m_recent_filters_height)};
+    if (stop_offset >= m_recent_filters.size()) return false;
+    // The cached entries form a chain, so if the stop block matches, all its
+    // ancestors in the range match as well.
+    if (m_recent_filters[stop_offset].block_hash != stop_index->GetBlockHash()) return false;
+    const auto begin{m_recent_filters.begin() + (start_height - m_recent_filters_height)};
+    entries_out.assign(begin, m_recent_filters.begin() + stop_offset + 1);
+    return true;
+}
+
 bool BlockFilterIndex::LookupFilter(const CBlockIndex* block_index, BlockFilter& filter_out) const
 {
     DBVal entry;
@@ -434,6 +493,12 @@ bool BlockFilterIndex::LookupFilter(const CBlockIndex* block_index, BlockFilter&
 
 bool BlockFilterIndex::LookupFilterHeader(const CBlockIndex* block_index, uint256& header_out)
 {
+    std::vector<RecentFilter> recent;
+    if (LookupRecentFilters(block_index->nHeight, block_index, recent)) {
+        header_out = recent.front().header;
+        return true;
+    }
+
     LOCK(m_cs_headers_cache);
 
     bool is_checkpoint{block_index->nHeight % CFCHECKPT_INTERVAL == 0};
@@ -486,6 +551,16 @@ bool BlockFilterIndex::LookupFilterHashRange(int start_height, const CBlockIndex
                                              std::vector<uint256>& hashes_out) const
 
 {
+    std::vector<RecentFilter> recent;
+    if (LookupRecentFilters(start_height, stop_index, recent)) {
+        hashes_out.clear();
+        hashes_out.reserve(recent.size());
+        for (const auto& entry : recent) {
+            hashes_out.push_back(entry.filter_hash);
+        }
+        return true;
+    }
+
     std::vector<DBVal> entries;
     if (!LookupRange(*m_db, m_name, start_height, stop_index, entries)) {
         return false;
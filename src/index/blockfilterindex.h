@@ -12,6 +12,7 @@
 #include <index/base.h>
 #include <util/hasher.h>
 
+#include <deque>
 #include <unordered_map>
 
 static const char* const DEFAULT_BLOCKFILTERINDEX = "0";
@@ -28,6 +29,8 @@ static constexpr int CFCHECKPT_INTERVAL = 1000;
  */
 class BlockFilterIndex final : public BaseIndex
 {
+    friend class BlockFilterIndexTester;
+
 private:
     BlockFilterType m_filter_type;
     std::unique_ptr<BaseIndex::DB> m_db;
@@ -42,9 +45,31 @@ private:
     /** cache of block hash to filter header, to avoid disk access when responding to getcfcheckpt. */
     std::unordered_map<uint256, uint256, FilterHeaderHasher> m_headers_cache GUARDED_BY(m_cs_headers_cache);
 
+    struct RecentFilter {
+        uint256 block_hash;
+        uint256 filter_hash;
+        uint256 header;
+    };
+
+    mutable Mutex m_recent_filters_mutex;
+    /** Filter hashes and headers of the blocks most recently appended to the index, in height
+     *  order starting at m_recent_filters_height. They always form a chain, which lets filter
+     *  header and filter hash lookups near the tip (getcfheaders, getcfcheckpt) skip the
+     *  database. Filters themselves are not cached, so getcfilters still reads them from disk. */
+    std::deque<RecentFilter> m_recent_filters GUARDED_BY(m_recent_filters_mutex);
+    int m_recent_filters_height GUARDED_BY(m_recent_filters_mutex){0};
+
+    /** Get the cached entries for heights start_height to stop_index, if all of them are cached. */
+    bool LookupRecentFilters(int start_height, const CBlockIndex* stop_index,
+                             std::vector<RecentFilter>& entries_out) const EXCLUSIVE_LOCKS_REQUIRED(!m_recent_filters_mutex);
+
     // Last computed header to avoid disk reads on every new block.
     uint256 m_last_header{};
 
+    Mutex m_prepared_filters_mutex;
+    /** Filters computed by CustomPrepare during the initial sync, waiting for CustomAppend. */
+    std::unordered_map<uint256, BlockFilter, SaltedUint256Hasher> m_prepared_filters GUARDED_BY(m_prepared_filters_mutex);
+
     bool AllowPrune() const override { return true; }
 
     bool Write(const BlockFilter& filter, uint32_t block_height, const uint256& filter_header);
@@ -58,9 +83,13 @@ protected:
 
     bool CustomCommit(CDBBatch& batch) override;
 
-    bool CustomAppend(const interfaces::BlockInfo& block) override;
+    bool CustomPrepare(const interfaces::BlockInfo& block) override EXCLUSIVE_LOCKS_REQUIRED(!m_prepared_filters_mutex);
+
+    void CustomDiscardPrepared() override EXCLUSIVE_LOCKS_REQUIRED(!m_prepared_filters_mutex);
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override EXCLUSIVE_LOCKS_REQUIRED(!m_prepared_filters_mutex, !m_recent_filters_mutex);
 
-    bool CustomRemove(const interfaces::BlockInfo& block) override;
+    bool CustomRemove(const interfaces::BlockInfo& block) override EXCLUSIVE_LOCKS_REQUIRED(!m_recent_filters_mutex);
 
     BaseIndex::DB& GetDB() const LIFETIMEBOUND override { return *m_db; }
 
@@ -75,7 +104,7 @@ public:
     bool LookupFilter(const CBlockIndex* block_index, BlockFilter& filter_out) const;
 
     /** Get a single filter header by block. */
-    bool LookupFilterHeader(const CBlockIndex* block_index, uint256& header_out) EXCLUSIVE_LOCKS_REQUIRED(!m_cs_headers_cache);
+    bool LookupFilterHeader(const CBlockIndex* block_index, uint256& header_out) EXCLUSIVE_LOCKS_REQUIRED(!m_cs_headers_cache, !m_recent_filters_mutex);
 
     /** Get a range of filters between two heights on a chain. */
     bool LookupFilterRange(int start_height, const CBlockIndex* stop_index,
@@ -83,7 +112,7 @@ public:
 
     /** Get a range of filter hashes between two heights on a chain. */
     bool LookupFilterHashRange(int start_height, const CBlockIndex* stop_index,
-                               std::vector<uint256>& hashes_out) const;
+                               std::vector<uint256>& hashes_out) const EXCLUSIVE_LOCKS_REQUIRED(!m_recent_filters_mutex);
 };
 
 /**
@@ -0,0 +1,220 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/scripthashindex.h>
+
+#include <common/args.h>
+#include <compressor.h>
+#include <crypto/sha256.h>
+#include <dbwrapper.h>
+#include <logging.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <undo.h>
+#include <util/check.h>
+#include <validation.h>
+
+#include <set>
+
+static constexpr uint8_t DB_SCRIPTHASH{'h'};
+
+std::unique_ptr<ScriptHashIndex> g_scripthash_index;
+
+uint256 ComputeScriptHash(const CScript& script)
+{
+    uint256 hash;
+    CSHA256().Write(script.data(), script.size()).Finalize(hash.begin());
+    return hash;
+}
+
+namespace {
+
+/**
+ * Heights and positions are stored big-endian so that the entries of one
+ * script are iterated in chain order.
+ */
+struct DBKey {
+    uint256 script_hash;
+    int height{0};
+    uint32_t tx_pos{0};
+    bool spending{false};
+    uint32_t n{0};
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_SCRIPTHASH);
+        s << script_hash;
+        ser_writedata32be(s, height);
+        ser_writedata32be(s, tx_pos);
+        ser_writedata8(s, spending);
+        ser_writedata32be(s, n);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        if (ser_readdata8(s) != DB_SCRIPTHASH) {
+            throw std::ios_base::failure("Invalid format for scripthashindex DB key");
+        }
+        s >> script_hash;
+        height = ser_readdata32be(s);
+        tx_pos = ser_readdata32be(s);
+        spending = ser_readdata8(s) != 0;
+        n = ser_readdata32be(s);
+    }
+};
+
+struct DBFundingVal {
+    Txid txid;
+    CAmount amount{0};
+
+    SERIALIZE_METHODS(DBFundingVal, obj) { READWRITE(obj.txid, Using<AmountCompression>(obj.amount)); }
+};
+
+struct DBSpendingVal {
+    Txid txid;
+    CAmount amount{0};
+    Txid prev_txid;
+    uint32_t prev_n{0};
+
+    SERIALIZE_METHODS(DBSpendingVal, obj) { READWRITE(obj.txid, Using<AmountCompression>(obj.amount), obj.prev_txid, VARINT(obj.prev_n)); }
+};
+
+/** Write (or erase) all entries created by a block. */
+void AddBlockToBatch(CDBBatch& batch, const interfaces::BlockInfo& block, bool erase)
+{
+    // The genesis coinbase is not spendable.
+    if (block.height == 0) return;
+
+    assert(block.data);
+    for (uint32_t i = 0; i < block.data->vtx.size(); ++i) {
+        const CTransaction& tx{*block.data->vtx[i]};
+
+        // Duplicate coinbase transactions overwrote the outputs of the original (BIP30).
+        if (tx.IsCoinBase() && IsBIP30Unspendable(block.hash, block.height)) continue;
+
+        for (uint32_t j = 0; j < tx.vout.size(); ++j) {
+            const CTxOut& out{tx.vout[j]};
+            if (out.scriptPubKey.IsUnspendable()) continue;
+            const DBKey key{ComputeScriptHash(out.scriptPubKey), block.height, i, /*spending=*/false, j};
+            if (erase) {
+                batch.Erase(key);
+            } else {
+                batch.Write(key, DBFundingVal{tx.GetHash(), out.nValue});
+            }
+        }
+
+        // The coinbase tx has no undo data since no former output is spent
+        if (tx.IsCoinBase()) continue;
+        const CTxUndo& tx_undo{Assert(block.undo_data)->vtxundo.at(i - 1)};
+        for (uint32_t j = 0; j < tx.vin.size(); ++j) {
+            const Coin& coin{tx_undo.vprevout.at(j)};
+            const DBKey key{ComputeScriptHash(coin.out.scriptPubKey), block.height, i, /*spending=*/true, j};
+            if (erase) {
+                batch.Erase(key);
+            } else {
+                batch.Write(key, DBSpendingVal{tx.GetHash(), coin.out.nValue, tx.vin[j].prevout.hash, tx.vin[j].prevout.n});
+            }
+        }
+    }
+}
+
+} // namespace
+
+/** Access to the scripthash index database (indexes/scripthash/) */
+class ScriptHashIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+ScriptHashIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "scripthash", n_cache_size, f_memory, f_wipe)
+{}
+
+ScriptHashIndex::ScriptHashIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "scripthashindex"), m_db(std::make_unique<ScriptHashIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+ScriptHashIndex::~ScriptHashIndex() = default;
+
+interfaces::Chain::NotifyOptions ScriptHashIndex::CustomOptions()
+{
+    interfaces::Chain::NotifyOptions options;
+    options.connect_undo_data = true;
+    options.disconnect_data = true;
+    options.disconnect_undo_data = true;
+    return options;
+}
+
+bool ScriptHashIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    CDBBatch batch(*m_db);
+    AddBlockToBatch(batch, block, /*erase=*/false);
+    return m_db->WriteBatch(batch);
+}
+
+bool ScriptHashIndex::CustomRemove(const interfaces::BlockInfo& block)
+{
+    CDBBatch batch(*m_db);
+    AddBlockToBatch(batch, block, /*erase=*/true);
+    return m_db->WriteBatch(batch);
+}
+
+BaseIndex::DB& ScriptHashIndex::GetDB() const { return *m_db; }
+
+std::optional<std::vector<ScriptHashIndex::HistoryEntry>> ScriptHashIndex::FindHistory(const uint256& script_hash, int from_height) const
+{
+    std::vector<HistoryEntry> result;
+    std::unique_ptr<CDBIterator> it{m_db->NewIterator()};
+    for (it->Seek(DBKey{script_hash, std::max(from_height, 0), 0, false, 0}); it->Valid(); it->Next()) {
+        DBKey key;
+        if (!it->GetKey(key) || key.script_hash != script_hash) break;
+
+        HistoryEntry& entry{result.emplace_back()};
+        entry.height = key.height;
+        entry.tx_pos = key.tx_pos;
+        entry.spending = key.spending;
+        entry.n = key.n;
+        if (key.spending) {
+            DBSpendingVal value;
+            if (!it->GetValue(value)) {
+                LogError("Unable to read entry of %s at height %d; index may be corrupted", GetName(), key.height);
+                return std::nullopt;
+            }
+            entry.txid = value.txid;
+            entry.amount = value.amount;
+            entry.outpoint = COutPoint{value.prev_txid, value.prev_n};
+        } else {
+            DBFundingVal value;
+            if (!it->GetValue(value)) {
+                LogError("Unable to read entry of %s at height %d; index may be corrupted", GetName(), key.height);
+                return std::nullopt;
+            }
+            entry.txid = value.txid;
+            entry.amount = value.amount;
+            entry.outpoint = COutPoint{value.txid, key.n};
+        }
+    }
+    return result;
+}
+
+std::optional<std::vector<ScriptHashIndex::HistoryEntry>> ScriptHashIndex::FindUnspent(const uint256& script_hash) const
+{
+    auto history{FindHistory(script_hash)};
+    if (!history) return std::nullopt;
+
+    // An output can only be spent by an input spending from the same script.
+    std::set<COutPoint> spent;
+    for (const HistoryEntry& entry : *history) {
+        if (entry.spending) spent.insert(entry.outpoint);
+    }
+
+    std::vector<HistoryEntry> result;
+    for (HistoryEntry& entry : *history) {
+        if (!entry.spending && !spent.contains(entry.outpoint)) result.push_back(std::move(entry));
+    }
+    return result;
+}
@@ -0,0 +1,91 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITQUANTUM_INDEX_SCRIPTHASHINDEX_H
+#define BITQUANTUM_INDEX_SCRIPTHASHINDEX_H
+
+#include <consensus/amount.h>
+#include <index/base.h>
+#include <primitives/transaction.h>
+#include <uint256.h>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+class CScript;
+
+static constexpr bool DEFAULT_SCRIPTHASHINDEX{false};
+
+/** Key of a script in the scripthash index: the single SHA256 of the scriptPubKey. */
+uint256 ComputeScriptHash(const CScript& script);
+
+/**
+ * ScriptHashIndex records, for every scriptPubKey, the confirmed transactions
+ * that fund it (one entry per output) or spend from it (one entry per input).
+ *
+ * Entries are keyed by (script hash, height, position of the transaction in
+ * the block), so the history of a script is a single ordered range scan
+ * instead of a scan of the whole UTXO set or of every block.
+ */
+class ScriptHashIndex final : public BaseIndex
+{
+public:
+    struct HistoryEntry {
+        int height;
+        //! Position of the transaction in its block.
+        uint32_t tx_pos;
+        Txid txid;
+        //! False for an output paying to the script, true for an input spending from it.
+        bool spending;
+        //! Output index for funding entries, input index for spending entries.
+        uint32_t n;
+        CAmount amount;
+        //! The output created (funding) or spent (spending) by this entry.
+        COutPoint outpoint;
+    };
+
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    bool AllowPrune() const override { return true; }
+
+protected:
+    interfaces::Chain::NotifyOptions CustomOptions() override;
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRemove(const interfaces::BlockInfo& block) override;
+
+    /// Entries are keyed by script hash and block height and written in their own batch per block.
+    bool AllowParallelAppend() const override { return true; }
+
+    BaseIndex::DB& GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit ScriptHashIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~ScriptHashIndex() override;
+
+    /// Look up all confirmed entries for a script hash, in chain order.
+    ///
+    /// @param[in]  script_hash  See ComputeScriptHash().
+    /// @param[in]  from_height  Skip entries below this height.
+    /// @return  std::nullopt on a database error.
+    std::optional<std::vector<HistoryEntry>> FindHistory(const uint256& script_hash, int from_height = 0) const;
+
+    /// Look up the outputs paying to a script hash that are not spent in the
+    /// indexed chain. The returned entries are funding entries, in chain order.
+    std::optional<std::vector<HistoryEntry>> FindUnspent(const uint256& script_hash) const;
+};
+
+/// The global scripthash index. May be null.
+extern std::unique_ptr<ScriptHashIndex> g_scripthash_index;
+
+#endif // BITQUANTUM_INDEX_SCRIPTHASHINDEX_H
@@ -0,0 +1,115 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/synccoordinator.h>
+
+#include <chain.h>
+#include <node/blockstorage.h>
+
+#include <utility>
+
+IndexSyncCoordinator::IndexSyncCoordinator(const node::BlockManager& blockman, int worker_threads)
+    : m_blockman{blockman},
+      m_queue{/*batch_size=*/1, worker_threads, "idxsync", "Index sync"}
+{
+}
+
+void IndexSyncCoordinator::AddConsumer()
+{
+    LOCK(m_mutex);
+    ++m_consumers;
+}
+
+void IndexSyncCoordinator::RemoveConsumer()
+{
+    LOCK(m_mutex);
+    --m_consumers;
+}
+
+std::optional<IndexSyncCoordinator::BlockData> IndexSyncCoordinator::Fetch(const CBlockIndex& index, bool need_undo)
+{
+    const uint256 hash{index.GetBlockHash()};
+    need_undo = need_undo && index.nHeight > 0;
+
+    BlockData data;
+    {
+        WAIT_LOCK(m_mutex, lock);
+        auto it{m_cache.find(hash)};
+        while (it != m_cache.end() && it->second.loading) {
+            m_cv.wait(lock);
+            it = m_cache.find(hash);
+        }
+        if (it != m_cache.end() && (!need_undo || it->second.data.undo)) {
+            ++m_stats.cache_hits;
+            data = it->second.data;
+            if (++it->second.fetches >= m_consumers) m_cache.erase(it);
+            return data;
+        }
+        if (it == m_cache.end()) {
+            it = m_cache.try_emplace(hash).first;
+            m_cache_order.push_back(hash);
+        }
+        // Either a new entry, or one that was read without undo data.
+        it->second.loading = true;
+        data = it->second.data;
+    }
+
+    bool ok{true};
+    if (!data.block) {
+        auto block{std::make_shared<CBlock>()};
+        ok = m_blockman.ReadBlock(*block, index);
+        data.block = std::move(block);
+    }
+    if (ok && need_undo) {
+        auto undo{std::make_shared<CBlockUndo>()};
+        ok = m_blockman.ReadBlockUndo(*undo, index);
+        data.undo = std::move(undo);
+    }
+
+    {
+        LOCK(m_mutex);
+        auto it{m_cache.find(hash)};
+        if (ok) {
+            ++m_stats.block_reads;
+            it->second.data = data;
+            it->second.loading = false;
+            if (++it->second.fetches >= m_consumers) m_cache.erase(it);
+        } else {
+            m_cache.erase(it);
+        }
+        while (m_cache_order.size() > INDEX_SYNC_CACHE_BLOCKS) {
+            const uint256 oldest{m_cache_order.front()};
+            m_cache_order.pop_front();
+            const auto old_it{m_cache.find(oldest)};
+            if (old_it == m_cache.end()) continue;
+            if (old_it->second.loading) {
+                // Still being read by another thread, keep it for now.
+                m_cache_order.push_back(oldest);
+                break;
+            }
+            m_cache.erase(old_it);
+        }
+    }
+    m_cv.notify_all();
+
+    if (!ok) return std::nullopt;
+    return data;
+}
+
+bool IndexSyncCoordinator::RunParallel(std::vector<std::function<bool()>>&& jobs)
+{
+    std::vector<Job> queued;
+    queued.reserve(jobs.size());
+    for (auto& fn : jobs) queued.push_back(Job{std::move(fn)});
+
+    CCheckQueueControl<Job> control{m_queue};
+    control.Add(std::move(queued));
+    return !control.Complete().has_value();
+}
+
+IndexSyncCoordinator::Stats IndexSyncCoordinator::GetStats() const
+{
+    LOCK(m_mutex);
+    return m_stats;
+}
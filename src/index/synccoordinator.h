@@ -0,0 +1,105 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITQUANTUM_INDEX_SYNCCOORDINATOR_H
+#define BITQUANTUM_INDEX_SYNCCOORDINATOR_H
+
+#include <checkqueue.h>
+#include <primitives/block.h>
+#include <sync.h>
+#include <uint256.h>
+#include <undo.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+class CBlockIndex;
+namespace node {
+class BlockManager;
+} // namespace node
+
+//! Maximum number of worker threads used to sync indexes in parallel.
+static constexpr int MAX_INDEX_SYNC_THREADS{4};
+//! Number of blocks read and deserialized ahead of the slowest catching-up index.
+static constexpr size_t INDEX_SYNC_CACHE_BLOCKS{256};
+
+/**
+ * Shared helper for the initial sync of several indexes.
+ *
+ * Without it, every index catching up reads and deserializes each block (and
+ * possibly its undo data) on its own. Indexes register with the coordinator
+ * while they are catching up and fetch block data through it: each block is
+ * read from disk once and kept until every registered index has fetched it,
+ * or until it falls out of a bounded cache.
+ *
+ * The coordinator also owns a small thread pool that indexes use to process
+ * batches of blocks in parallel, see BaseIndex::CustomPrepare.
+ */
+class IndexSyncCoordinator
+{
+public:
+    struct BlockData {
+        std::shared_ptr<const CBlock> block;
+        //! Only set if undo data was requested and the block is not the genesis block.
+        std::shared_ptr<const CBlockUndo> undo;
+    };
+
+    struct Stats {
+        uint64_t block_reads{0};
+        uint64_t cache_hits{0};
+    };
+
+    IndexSyncCoordinator(const node::BlockManager& blockman, int worker_threads);
+
+    /** Account for an index that starts (or stops) fetching blocks for its initial sync. */
+    void AddConsumer() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void RemoveConsumer() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Return the block (and undo data, if requested) for `index`, reading it
+     * from disk unless another index has already done so. Concurrent requests
+     * for the same block wait for a single read.
+     */
+    std::optional<BlockData> Fetch(const CBlockIndex& index, bool need_undo) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Run all jobs on the thread pool. Returns false if any job returned false. */
+    bool RunParallel(std::vector<std::function<bool()>>&& jobs);
+
+    Stats GetStats() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Job {
+        std::function<bool()> fn;
+        std::optional<int> operator()() { return fn() ? std::nullopt : std::make_optional(0); }
+    };
+
+    struct Entry {
+        BlockData data;
+        //! Set while a thread reads the entry, other requesters wait on m_cv.
+        bool loading{false};
+        //! Number of consumers that have fetched the entry.
+        int fetches{0};
+    };
+
+    const node::BlockManager& m_blockman;
+
+    mutable Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<uint256, Entry> m_cache GUARDED_BY(m_mutex);
+    //! Cached block hashes in insertion order, used to bound the cache.
+    std::deque<uint256> m_cache_order GUARDED_BY(m_mutex);
+    int m_consumers GUARDED_BY(m_mutex){0};
+    Stats m_stats GUARDED_BY(m_mutex);
+
+    CCheckQueue<Job> m_queue;
+};
+
+#endif // BITQUANTUM_INDEX_SYNCCOORDINATOR_H
@@ -4,18 +4,61 @@
 
 #include <index/txindex.h>
 
+#include <chain.h>
 #include <clientversion.h>
 #include <common/args.h>
 #include <index/disktxpos.h>
 #include <logging.h>
 #include <node/blockstorage.h>
 #include <primitives/transaction_identifier.h>
+#include <streams.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+
 constexpr uint8_t DB_TXINDEX{'t'};
+constexpr uint8_t DB_TXINDEX_SHORT{'s'};
+constexpr uint8_t DB_KEY_FORMAT{'F'};
+
+/** Values of DB_KEY_FORMAT. Indexes created before it was introduced use full keys. */
+constexpr uint8_t KEY_FORMAT_FULL{0};
+constexpr uint8_t KEY_FORMAT_SHORT{1};
 
 std::unique_ptr<TxIndex> g_txindex;
 
+namespace {
+
+/** Number of leading txid bytes in a short key. */
+constexpr size_t SHORT_KEY_SIZE{8};
+using ShortTxid = std::array<unsigned char, SHORT_KEY_SIZE>;
+
+ShortTxid GetShortTxid(const Txid& txid)
+{
+    ShortTxid prefix;
+    std::memcpy(prefix.data(), txid.data(), SHORT_KEY_SIZE);
+    return prefix;
+}
+
+/** Key of a transaction in the short format. The position makes it unique if prefixes collide. */
+struct DBShortTxKey {
+    ShortTxid prefix{};
+    CDiskTxPos pos;
+
+    SERIALIZE_METHODS(DBShortTxKey, obj)
+    {
+        uint8_t tag{DB_TXINDEX_SHORT};
+        READWRITE(tag);
+        if (tag != DB_TXINDEX_SHORT) {
+            throw std::ios_base::failure("Invalid format for txindex short key");
+        }
+        READWRITE(obj.prefix, obj.pos);
+    }
+};
+
+} // namespace
 
 /** Access to the txindex database (indexes/txindex/) */
 class TxIndex::DB : public BaseIndex::DB
@@ -23,9 +66,14 @@ class TxIndex::DB : public BaseIndex::DB
 public:
     explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
 
-    /// Read the disk location of the transaction data with the given hash. Returns false if the
-    /// transaction hash is not indexed.
-    bool ReadTxPos(const Txid& txid, CDiskTxPos& pos) const;
+    /// Whether transactions are stored under short keys. Set during CustomInit, before any
+    /// transaction is written or read.
+    bool m_short_keys{false};
+
+    /// Read the disk locations stored for each of the given hashes. With full keys there is at
+    /// most one per hash. With short keys all locations sharing the hash prefix are returned,
+    /// and the caller has to check the hash of the transaction found there.
+    std::vector<std::vector<CDiskTxPos>> ReadTxPositions(std::span<const Txid> txids);
 
     /// Write a batch of transaction positions to the DB.
     [[nodiscard]] bool WriteTxs(const std::vector<std::pair<Txid, CDiskTxPos>>& v_pos);
@@ -35,26 +83,75 @@ TxIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
     BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "txindex", n_cache_size, f_memory, f_wipe)
 {}
 
-bool TxIndex::DB::ReadTxPos(const Txid& txid, CDiskTxPos& pos) const
+std::vector<std::vector<CDiskTxPos>> TxIndex::DB::ReadTxPositions(std::span<const Txid> txids)
 {
-    return Read(std::make_pair(DB_TXINDEX, txid.ToUint256()), pos);
+    std::vector<std::vector<CDiskTxPos>> result(txids.size());
+    if (!m_short_keys) {
+        std::vector<std::pair<uint8_t, uint256>> keys;
+        keys.reserve(txids.size());
+        for (const Txid& txid : txids) keys.emplace_back(DB_TXINDEX, txid.ToUint256());
+        const auto positions{MultiRead<std::pair<uint8_t, uint256>, CDiskTxPos>(keys)};
+        for (size_t i = 0; i < txids.size(); ++i) {
+            if (positions[i]) result[i].push_back(*positions[i]);
+        }
+        return result;
+    }
+
+    // Seek in key order so that the iterator only moves forward.
+    std::vector<size_t> order(txids.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return GetShortTxid(txids[a]) < GetShortTxid(txids[b]); });
+    std::unique_ptr<CDBIterator> it{NewIterator()};
+    for (size_t i : order) {
+        const ShortTxid prefix{GetShortTxid(txids[i])};
+        it->Seek(std::make_pair(DB_TXINDEX_SHORT, prefix));
+        DBShortTxKey key;
+        for (; it->Valid() && it->GetKey(key) && key.prefix == prefix; it->Next()) {
+            result[i].push_back(key.pos);
+        }
+    }
+    return result;
 }
 
 bool TxIndex::DB::WriteTxs(const std::vector<std::pair<Txid, CDiskTxPos>>& v_pos)
 {
     CDBBatch batch(*this);
     for (const auto& [txid, pos] : v_pos) {
-        batch.Write(std::make_pair(DB_TXINDEX, txid.ToUint256()), pos);
+        if (m_short_keys) {
+            batch.Write(DBShortTxKey{GetShortTxid(txid), pos}, uint8_t{0});
+        } else {
+            batch.Write(std::make_pair(DB_TXINDEX, txid.ToUint256()), pos);
+        }
     }
     return WriteBatch(batch);
 }
 
-TxIndex::TxIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
-    : BaseIndex(std::move(chain), "txindex"), m_db(std::make_unique<TxIndex::DB>(n_cache_size, f_memory, f_wipe))
+TxIndex::TxIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe, bool short_keys)
+    : BaseIndex(std::move(chain), "txindex"), m_db(std::make_unique<TxIndex::DB>(n_cache_size, f_memory, f_wipe)),
+      m_short_keys_requested{short_keys}
 {}
 
 TxIndex::~TxIndex() = default;
 
+bool TxIndex::CustomInit(const std::optional<interfaces::BlockRef>& block)
+{
+    uint8_t format;
+    if (!m_db->Read(DB_KEY_FORMAT, format)) {
+        // An index with data but without the marker predates short keys.
+        format = block || !m_short_keys_requested ? KEY_FORMAT_FULL : KEY_FORMAT_SHORT;
+        if (!m_db->Write(DB_KEY_FORMAT, format)) {
+            LogError("Cannot write %s key format", GetName());
+            return false;
+        }
+    }
+    m_db->m_short_keys = format == KEY_FORMAT_SHORT;
+    if (m_db->m_short_keys != m_short_keys_requested) {
+        LogWarning("%s uses %s keys, -txindexshortkeys only takes effect when the index is rebuilt with -reindex",
+                   GetName(), m_db->m_short_keys ? "short" : "full");
+    }
+    return true;
+}
+
 bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
 {
     // Exclude genesis block transaction because outputs are not spendable.
@@ -73,31 +170,107 @@ bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
 
 BaseIndex::DB& TxIndex::GetDB() const { return *m_db; }
 
-bool TxIndex::FindTx(const Txid& tx_hash, uint256& block_hash, CTransactionRef& tx) const
+std::unique_ptr<AutoFile> TxIndex::TakeBlockFile(int file_num) const
 {
-    CDiskTxPos postx;
-    if (!m_db->ReadTxPos(tx_hash, postx)) {
-        return false;
+    {
+        LOCK(m_open_files_mutex);
+        const auto it{std::find_if(m_open_files.begin(), m_open_files.end(), [&](const auto& entry) { return entry.first == file_num; })};
+        if (it != m_open_files.end()) {
+            auto file{std::move(it->second)};
+            m_open_files.erase(it);
+            // The file may have been appended to since the handle was opened.
+            m_chainstate->m_blockman.WaitForBlockFile(file_num);
+            return file;
+        }
     }
-
-    AutoFile file{m_chainstate->m_blockman.OpenBlockFile(postx, true)};
-    if (file.IsNull()) {
+    std::unique_ptr<AutoFile> file{new AutoFile(m_chainstate->m_blockman.OpenBlockFile({file_num, 0}, /*fReadOnly=*/true))};
+    if (file->IsNull()) {
         LogError("OpenBlockFile failed");
-        return false;
+        return nullptr;
     }
-    CBlockHeader header;
-    try {
-        file >> header;
-        file.seek(postx.nTxOffset, SEEK_CUR);
-        file >> TX_WITH_WITNESS(tx);
-    } catch (const std::exception& e) {
-        LogError("Deserialize or I/O error - %s", e.what());
-        return false;
+    return file;
+}
+
+void TxIndex::ReturnBlockFile(int file_num, std::unique_ptr<AutoFile> file) const
+{
+    LOCK(m_open_files_mutex);
+    m_open_files.emplace_back(file_num, std::move(file));
+    if (m_open_files.size() > TXINDEX_MAX_OPEN_FILES) m_open_files.pop_front();
+}
+
+bool TxIndex::FindTx(const Txid& tx_hash, uint256& block_hash, CTransactionRef& tx) const
+{
+    auto result{FindTxs(std::span{&tx_hash, 1})};
+    if (!result[0]) return false;
+    std::tie(block_hash, tx) = std::move(*result[0]);
+    return true;
+}
+
+std::vector<std::optional<std::pair<uint256, CTransactionRef>>> TxIndex::FindTxs(std::span<const Txid> tx_hashes) const
+{
+    std::vector<std::optional<std::pair<uint256, CTransactionRef>>> result(tx_hashes.size());
+
+    // Candidate locations with the index of the hash they were found for, in file order.
+    std::vector<std::pair<CDiskTxPos, size_t>> reads;
+    const auto positions{m_db->ReadTxPositions(tx_hashes)};
+    for (size_t i = 0; i < positions.size(); ++i) {
+        for (const CDiskTxPos& pos : positions[i]) reads.emplace_back(pos, i);
     }
-    if (tx->GetHash() != tx_hash) {
-        LogError("txid mismatch");
-        return false;
+    std::sort(reads.begin(), reads.end(), [](const auto& a, const auto& b) {
+        return std::tie(a.first.nFile, a.first.nPos, a.first.nTxOffset) < std::tie(b.first.nFile, b.first.nPos, b.first.nTxOffset);
+    });
+
+    std::unique_ptr<AutoFile> file;
+    int file_num{-1};
+    // Block whose header was read last (null if none), the hash of that block and the start of its transactions.
+    FlatFilePos header_pos;
+    uint256 block_hash;
+    int64_t txs_start{0};
+    for (const auto& [pos, i] : reads) {
+        if (pos.nFile != file_num) {
+            if (file) ReturnBlockFile(file_num, std::move(file));
+            file_num = pos.nFile;
+            file = TakeBlockFile(file_num);
+            header_pos = FlatFilePos{};
+        }
+        if (!file) continue;
+
+        CTransactionRef tx;
+        try {
+            if (header_pos != FlatFilePos{pos.nFile, pos.nPos}) {
+                file->seek(pos.nPos, SEEK_SET);
+                CBlockHeader header;
+                *file >> header;
+                block_hash = header.GetHash();
+                txs_start = file->tell();
+                header_pos = FlatFilePos{pos.nFile, pos.nPos};
+            }
+            file->seek(txs_start + pos.nTxOffset, SEEK_SET);
+            *file >> TX_WITH_WITNESS(tx);
+        } catch (const std::exception& e) {
+            LogError("Deserialize or I/O error - %s", e.what());
+            // Do not reuse a handle in an unknown state.
+            file.reset();
+            file_num = -1;
+            continue;
+        }
+        if (tx->GetHash() != tx_hashes[i]) {
+            // Expected for the other transactions sharing a short key.
+            if (!m_db->m_short_keys) LogError("txid mismatch");
+            continue;
+        }
+        if (result[i]) {
+            // With short keys, a transaction that was reorganized into another block is found at
+            // both locations. Prefer the block on the active chain.
+            const bool prefer_new{WITH_LOCK(::cs_main, {
+                const CBlockIndex* block_index{m_chainstate->m_blockman.LookupBlockIndex(result[i]->first)};
+                return !block_index || !m_chainstate->m_chain.Contains(block_index);
+            })};
+            if (!prefer_new) continue;
+        }
+        result[i].emplace(block_hash, std::move(tx));
     }
-    block_hash = header.GetHash();
-    return true;
+    if (file) ReturnBlockFile(file_num, std::move(file));
+
+    return result;
 }
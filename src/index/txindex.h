@@ -6,8 +6,22 @@
 #define BITQUANTUM_INDEX_TXINDEX_H
 
 #include <index/base.h>
+#include <sync.h>
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+class AutoFile;
 
 static constexpr bool DEFAULT_TXINDEX{false};
+static constexpr bool DEFAULT_TXINDEX_SHORT_KEYS{false};
+//! Number of block files kept open between transaction lookups.
+static constexpr size_t TXINDEX_MAX_OPEN_FILES{8};
 
 /**
  * TxIndex is used to look up transactions included in the blockchain by hash.
@@ -16,22 +30,45 @@ static constexpr bool DEFAULT_TXINDEX{false};
  */
 class TxIndex final : public BaseIndex
 {
+    friend class TxIndexTester;
+
 protected:
     class DB;
 
 private:
     const std::unique_ptr<DB> m_db;
+    const bool m_short_keys_requested;
+
+    /// Block files kept open between lookups, least recently used first.
+    mutable Mutex m_open_files_mutex;
+    mutable std::list<std::pair<int, std::unique_ptr<AutoFile>>> m_open_files GUARDED_BY(m_open_files_mutex);
+
+    /// Take an open handle to a block file out of the cache, or open the file.
+    std::unique_ptr<AutoFile> TakeBlockFile(int file_num) const EXCLUSIVE_LOCKS_REQUIRED(!m_open_files_mutex);
+    /// Put a handle back into the cache, closing the least recently used one if it is full.
+    void ReturnBlockFile(int file_num, std::unique_ptr<AutoFile> file) const EXCLUSIVE_LOCKS_REQUIRED(!m_open_files_mutex);
 
     bool AllowPrune() const override { return false; }
 
 protected:
+    bool CustomInit(const std::optional<interfaces::BlockRef>& block) override;
+
     bool CustomAppend(const interfaces::BlockInfo& block) override;
 
+    /// Entries are keyed by txid and written in their own batch per block.
+    bool AllowParallelAppend() const override { return true; }
+
     BaseIndex::DB& GetDB() const override;
 
 public:
     /// Constructs the index, which becomes available to be queried.
-    explicit TxIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+    ///
+    /// With short_keys, a new index stores each transaction under the first 8 bytes of its hash
+    /// and its position, which makes the database about half the size. Lookups then check the
+    /// hash of the transactions read from disk. An existing index keeps the format it was
+    /// created with.
+    explicit TxIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false,
+                     bool short_keys = DEFAULT_TXINDEX_SHORT_KEYS);
 
     // Destructor is declared because this class contains a unique_ptr to an incomplete type.
     virtual ~TxIndex() override;
@@ -42,7 +79,15 @@ public:
     /// @param[out]  block_hash  The hash of the block the transaction is found in.
     /// @param[out]  tx  The transaction itself.
     /// @return  true if transaction is found, false otherwise
-    bool FindTx(const Txid& tx_hash, uint256& block_hash, CTransactionRef& tx) const;
+    bool FindTx(const Txid& tx_hash, uint256& block_hash, CTransactionRef& tx) const EXCLUSIVE_LOCKS_REQUIRED(!m_open_files_mutex);
+
+    /// Look up several transactions at once. Their positions are read from the database in one
+    /// pass, and the transactions are read grouped by block file, in file order, so each block
+    /// header is read once.
+    ///
+    /// @return  For each hash, the hash of the block the transaction is found in and the
+    ///          transaction itself, or std::nullopt if it is not found.
+    std::vector<std::optional<std::pair<uint256, CTransactionRef>>> FindTxs(std::span<const Txid> tx_hashes) const EXCLUSIVE_LOCKS_REQUIRED(!m_open_files_mutex);
 };
 
 /// The global transaction index, used in GetTransaction. May be null.
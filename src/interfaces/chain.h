@@ -17,6 +17,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 class ArgsManager;
@@ -155,6 +156,12 @@ public:
     //! or std::nullopt if the block filter for this block couldn't be found.
     virtual std::optional<bool> blockFilterMatchesAny(BlockFilterType filter_type, const uint256& block_hash, const GCSFilter::ElementSet& filter_set) = 0;
 
+    //! Like blockFilterMatchesAny, for up to max_blocks blocks of the active chain
+    //! starting at start_block, with the filters decoded in parallel. Returns the
+    //! hash of each block with its result, or nothing if start_block is not on
+    //! the active chain.
+    virtual std::vector<std::pair<uint256, std::optional<bool>>> blockFiltersMatchAny(BlockFilterType filter_type, const uint256& start_block, int max_blocks, const GCSFilter::ElementSet& filter_set) = 0;
+
     //! Return whether node has the block and optionally return block metadata
     //! or contents.
     virtual bool findBlock(const uint256& hash, const FoundBlock& block={}) = 0;
@@ -16,6 +16,8 @@ class CChainParams;
 namespace kernel {
 
 static constexpr bool DEFAULT_XOR_BLOCKSDIR{true};
+static constexpr bool DEFAULT_ASYNC_BLOCK_WRITES{false};
+static constexpr bool DEFAULT_PERSIST_BLOCK_INDEX{false};
 
 /**
  * An options struct for `BlockManager`, more ergonomically referred to as
@@ -26,6 +28,13 @@ struct BlockManagerOpts {
     bool use_xor{DEFAULT_XOR_BLOCKSDIR};
     uint64_t prune_target{0};
     bool fast_prune{false};
+    //! Write block and undo data on a background thread instead of the
+    //! validation thread.
+    bool async_block_writes{DEFAULT_ASYNC_BLOCK_WRITES};
+    //! Dump the in-memory block index to a flat file on shutdown and load it
+    //! from there on the next start, instead of iterating the block tree
+    //! database.
+    bool persist_block_index{DEFAULT_PERSIST_BLOCK_INDEX};
     const fs::path blocks_dir;
     Notifications& notifications;
     DBParams block_tree_db_params;
@@ -20,15 +20,23 @@
 #include <uint256.h>
 #include <util/check.h>
 #include <util/overflow.h>
+#include <util/thread.h>
 #include <validation.h>
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <iosfwd>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace kernel {
 
@@ -55,6 +63,11 @@ static void TxOutSer(T& ss, const COutPoint& outpoint, const Coin& coin)
     ss << coin.out;
 }
 
+void SerializeCoinForHash(DataStream& ss, const COutPoint& outpoint, const Coin& coin)
+{
+    TxOutSer(ss, outpoint, coin);
+}
+
 static void ApplyCoinHash(HashWriter& ss, const COutPoint& outpoint, const Coin& coin)
 {
     TxOutSer(ss, outpoint, coin);
@@ -76,6 +89,85 @@ void RemoveCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& c
 
 static void ApplyCoinHash(std::nullptr_t, const COutPoint& outpoint, const Coin& coin) {}
 
+namespace {
+
+//! Size of the serialized chunks a shard hands over to the thread computing HASH_SERIALIZED.
+constexpr size_t HASH_CHUNK_SIZE{1 << 20};
+//! Number of chunks a shard may queue before it waits for the hashing thread.
+constexpr size_t MAX_QUEUED_CHUNKS{4};
+
+//! Thrown inside a shard worker when the computation is aborted.
+struct ShardInterrupted {
+};
+
+/** State shared between the shard workers and the thread combining their results. */
+struct ShardContext {
+    struct Shard {
+        //! Serialized coins not yet consumed by the hashing thread (HASH_SERIALIZED only).
+        std::deque<DataStream> chunks;
+        bool done{false};
+        bool ok{false};
+    };
+
+    Mutex mutex;
+    //! Signalled when a shard queues a chunk or finishes, and when a chunk is consumed.
+    std::condition_variable cv;
+    std::vector<Shard> shards GUARDED_BY(mutex);
+    std::atomic<bool> stop{false};
+
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!mutex)
+    {
+        WITH_LOCK(mutex, stop = true);
+        cv.notify_all();
+    }
+};
+
+/**
+ * Hash object of a shard worker when computing HASH_SERIALIZED. The
+ * serialization of the coins is handed to the hashing thread in chunks, so
+ * that reading and decoding the coins happens in parallel to the (strictly
+ * ordered) SHA256 computation.
+ */
+class ChunkWriter
+{
+public:
+    ChunkWriter(ShardContext& ctx, size_t shard) : m_ctx{ctx}, m_shard{shard} {}
+
+    DataStream& Stream() { return m_stream; }
+
+    void MaybeFlush()
+    {
+        if (m_stream.size() >= HASH_CHUNK_SIZE) Flush();
+    }
+
+    void Flush() EXCLUSIVE_LOCKS_REQUIRED(!m_ctx.mutex)
+    {
+        if (m_stream.empty()) return;
+        {
+            WAIT_LOCK(m_ctx.mutex, lock);
+            auto& shard{m_ctx.shards[m_shard]};
+            m_ctx.cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_ctx.mutex) { return shard.chunks.size() < MAX_QUEUED_CHUNKS || m_ctx.stop; });
+            if (m_ctx.stop) throw ShardInterrupted{};
+            shard.chunks.push_back(std::move(m_stream));
+        }
+        m_ctx.cv.notify_all();
+        m_stream = DataStream{};
+    }
+
+private:
+    ShardContext& m_ctx;
+    const size_t m_shard;
+    DataStream m_stream;
+};
+
+} // namespace
+
+static void ApplyCoinHash(ChunkWriter& writer, const COutPoint& outpoint, const Coin& coin)
+{
+    TxOutSer(writer.Stream(), outpoint, coin);
+    writer.MaybeFlush();
+}
+
 //! Warning: be very careful when changing this! assumeutxo and UTXO snapshot
 //! validation commitments are reliant on the hash constructed by this
 //! function.
@@ -111,20 +203,20 @@ static void ApplyStats(CCoinsStats& stats, const std::map<uint32_t, Coin>& outpu
     }
 }
 
-//! Calculate statistics about the unspent transaction output set
+//! Apply the coins of a cursor to the statistics and hash object, stopping
+//! before the first txid whose first serialized byte is `end` or higher.
 template <typename T>
-static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point)
+static bool ApplyCoins(CCoinsViewCursor& cursor, CCoinsStats& stats, T& hash_obj, const std::function<void()>& interruption_point, unsigned int end = 256)
 {
-    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
-    assert(pcursor);
-
     Txid prevkey;
     std::map<uint32_t, Coin> outputs;
-    while (pcursor->Valid()) {
+    while (cursor.Valid()) {
         if (interruption_point) interruption_point();
         COutPoint key;
         Coin coin;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
+        const bool have_key{cursor.GetKey(key)};
+        if (have_key && std::to_integer<unsigned int>(*key.hash.begin()) >= end) break;
+        if (have_key && cursor.GetValue(coin)) {
             if (!outputs.empty() && key.hash != prevkey) {
                 ApplyStats(stats, outputs);
                 ApplyHash(hash_obj, prevkey, outputs);
@@ -137,12 +229,151 @@ static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, c
             LogError("%s: unable to read value\n", __func__);
             return false;
         }
-        pcursor->Next();
+        cursor.Next();
     }
     if (!outputs.empty()) {
         ApplyStats(stats, outputs);
         ApplyHash(hash_obj, prevkey, outputs);
     }
+    return true;
+}
+
+static void MergeStats(CCoinsStats& stats, const CCoinsStats& shard)
+{
+    stats.nTransactions += shard.nTransactions;
+    stats.nTransactionOutputs += shard.nTransactionOutputs;
+    stats.nBogoSize += shard.nBogoSize;
+    stats.coins_count += shard.coins_count;
+    if (stats.total_amount.has_value() && shard.total_amount.has_value()) {
+        stats.total_amount = CheckedAdd(*stats.total_amount, *shard.total_amount);
+    } else {
+        stats.total_amount = std::nullopt;
+    }
+}
+
+/**
+ * Compute the statistics with the coins database split into `num_shards`
+ * key ranges by the first byte of the txid, each read by its own thread.
+ *
+ * A txid never spans two ranges, so per-shard statistics simply add up. The
+ * MuHash of the set is the product of the MuHash of each range. The
+ * HASH_SERIALIZED hash depends on the order of the coins: the shards
+ * serialize their coins in parallel, and the calling thread feeds the
+ * serialization into the hash writer range by range.
+ *
+ * The cursors are all created while holding cs_main, which prevents a
+ * chainstate flush in between so they all see the same state.
+ */
+template <typename T>
+static bool ComputeUTXOStatsSharded(CCoinsView* view, CCoinsStats& stats, T& hash_obj, const std::function<void()>& interruption_point, int num_shards)
+{
+    std::vector<unsigned int> bounds;
+    for (int i = 0; i <= num_shards; ++i) bounds.push_back(256 * i / num_shards);
+
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    {
+        LOCK(::cs_main);
+        for (int i = 0; i < num_shards; ++i) {
+            uint256 start;
+            start.data()[0] = bounds[i];
+            cursors.push_back(view->CursorFrom(Txid::FromUint256(start)));
+            if (!cursors.back()) return false;
+        }
+    }
+
+    ShardContext ctx;
+    WITH_LOCK(ctx.mutex, ctx.shards.resize(num_shards));
+    std::vector<CCoinsStats> shard_stats(num_shards);
+    std::vector<MuHash3072> shard_muhash(num_shards);
+
+    std::vector<std::thread> threads;
+    // Stop and join the workers on every exit path, including an exception
+    // thrown by the caller's interruption point.
+    struct ThreadJoiner {
+        ShardContext& ctx;
+        std::vector<std::thread>& threads;
+        ~ThreadJoiner()
+        {
+            ctx.Stop();
+            for (auto& thread : threads) thread.join();
+        }
+    } joiner{ctx, threads};
+
+    for (int i = 0; i < num_shards; ++i) {
+        threads.emplace_back(&util::TraceThread, strprintf("utxohash.%d", i), [&, i] {
+            const std::function<void()> check_stop{[&] {
+                if (ctx.stop.load(std::memory_order_relaxed)) throw ShardInterrupted{};
+            }};
+            bool ok{false};
+            try {
+                if constexpr (std::is_same_v<T, HashWriter>) {
+                    ChunkWriter writer{ctx, size_t(i)};
+                    ok = ApplyCoins(*cursors[i], shard_stats[i], writer, check_stop, bounds[i + 1]);
+                    if (ok) writer.Flush();
+                } else if constexpr (std::is_same_v<T, MuHash3072>) {
+                    ok = ApplyCoins(*cursors[i], shard_stats[i], shard_muhash[i], check_stop, bounds[i + 1]);
+                } else {
+                    std::nullptr_t none;
+                    ok = ApplyCoins(*cursors[i], shard_stats[i], none, check_stop, bounds[i + 1]);
+                }
+            } catch (const ShardInterrupted&) {
+                ok = false;
+            } catch (const std::exception& e) {
+                LogError("%s: %s\n", __func__, e.what());
+                ok = false;
+            }
+            {
+                LOCK(ctx.mutex);
+                ctx.shards[i].done = true;
+                ctx.shards[i].ok = ok;
+            }
+            ctx.cv.notify_all();
+        });
+    }
+
+    for (int i = 0; i < num_shards; ++i) {
+        while (true) {
+            if (interruption_point) interruption_point();
+            std::optional<DataStream> chunk;
+            bool done{false};
+            {
+                WAIT_LOCK(ctx.mutex, lock);
+                auto& shard{ctx.shards[i]};
+                ctx.cv.wait_for(lock, std::chrono::milliseconds{100}, [&]() EXCLUSIVE_LOCKS_REQUIRED(ctx.mutex) { return !shard.chunks.empty() || shard.done; });
+                if (!shard.chunks.empty()) {
+                    chunk = std::move(shard.chunks.front());
+                    shard.chunks.pop_front();
+                } else if (shard.done) {
+                    if (!shard.ok) return false;
+                    done = true;
+                }
+            }
+            if (done) break;
+            if (chunk) {
+                ctx.cv.notify_all();
+                if constexpr (std::is_same_v<T, HashWriter>) hash_obj.write(*chunk);
+            }
+        }
+        MergeStats(stats, shard_stats[i]);
+        if constexpr (std::is_same_v<T, MuHash3072>) hash_obj *= shard_muhash[i];
+    }
+    return true;
+}
+
+//! Calculate statistics about the unspent transaction output set
+template <typename T>
+static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point, int num_threads)
+{
+    // Views without support for range cursors are read on the calling thread.
+    if (num_threads > 1 && view->CursorFrom(Txid{})) {
+        if (!ComputeUTXOStatsSharded(view, stats, hash_obj, interruption_point, std::min(num_threads, MAX_UTXO_HASH_THREADS))) {
+            return false;
+        }
+    } else {
+        std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
+        assert(pcursor);
+        if (!ApplyCoins(*pcursor, stats, hash_obj, interruption_point)) return false;
+    }
 
     FinalizeHash(hash_obj, stats);
 
@@ -151,7 +382,7 @@ static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, c
     return true;
 }
 
-std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView* view, node::BlockManager& blockman, const std::function<void()>& interruption_point)
+std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView* view, node::BlockManager& blockman, const std::function<void()>& interruption_point, int num_threads)
 {
     CBlockIndex* pindex = WITH_LOCK(::cs_main, return blockman.LookupBlockIndex(view->GetBestBlock()));
     CCoinsStats stats{Assert(pindex)->nHeight, pindex->GetBlockHash()};
@@ -160,14 +391,14 @@ std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsV
         switch (hash_type) {
         case(CoinStatsHashType::HASH_SERIALIZED): {
             HashWriter ss{};
-            return ComputeUTXOStats(view, stats, ss, interruption_point);
+            return ComputeUTXOStats(view, stats, ss, interruption_point, num_threads);
         }
         case(CoinStatsHashType::MUHASH): {
             MuHash3072 muhash;
-            return ComputeUTXOStats(view, stats, muhash, interruption_point);
+            return ComputeUTXOStats(view, stats, muhash, interruption_point, num_threads);
         }
         case(CoinStatsHashType::NONE): {
-            return ComputeUTXOStats(view, stats, nullptr, interruption_point);
+            return ComputeUTXOStats(view, stats, nullptr, interruption_point, num_threads);
         }
         } // no default case, so the compiler can warn about missing cases
         assert(false);
@@ -23,6 +23,9 @@ class BlockManager;
 } // namespace node
 
 namespace kernel {
+//! Maximum number of threads used to compute statistics about the UTXO set.
+static constexpr int MAX_UTXO_HASH_THREADS{16};
+
 enum class CoinStatsHashType {
     HASH_SERIALIZED,
     MUHASH,
@@ -73,10 +76,20 @@ struct CCoinsStats {
 
 uint64_t GetBogoSize(const CScript& script_pub_key);
 
+/** Append the serialization of a coin that the UTXO set hashes commit to. */
+void SerializeCoinForHash(DataStream& ss, const COutPoint& outpoint, const Coin& coin);
+
 void ApplyCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
 void RemoveCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
 
-std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView* view, node::BlockManager& blockman, const std::function<void()>& interruption_point = {});
+/**
+ * Calculate statistics about the UTXO set in `view`.
+ *
+ * With num_threads > 1 (capped at MAX_UTXO_HASH_THREADS) the coins database
+ * is split into that many key ranges, each read on its own thread. This
+ * requires the view to support CCoinsView::CursorFrom().
+ */
+std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView* view, node::BlockManager& blockman, const std::function<void()>& interruption_point = {}, int num_threads = 1);
 } // namespace kernel
 
 #endif // BITQUANTUM_KERNEL_COINSTATS_H
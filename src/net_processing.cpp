@@ -165,6 +165,9 @@ static constexpr auto INBOUND_INVENTORY_BROADCAST_INTERVAL{5s};
  *  Use a smaller delay as there is less privacy concern for them.
  *  Blocks and peers with NetPermissionFlags::NoBan permission bypass this. */
 static constexpr auto OUTBOUND_INVENTORY_BROADCAST_INTERVAL{2s};
+/** Delay between the reconciliation requests we send to each peer we initiate
+ *  transaction reconciliation with (see BIP 330). */
+static constexpr auto RECON_REQUEST_INTERVAL{8s};
 /** Maximum rate of inventory items to send per second.
  *  Limits the impact of low-fee transaction floods. */
 static constexpr unsigned int INVENTORY_BROADCAST_PER_SECOND = 7;
@@ -285,6 +288,9 @@ struct Peer {
     /** Timestamp after which we will send the next BIP133 `feefilter` message
       * to the peer. */
     std::chrono::microseconds m_next_send_feefilter GUARDED_BY(NetEventsInterface::g_msgproc_mutex){0};
+    /** Timestamp after which we will send the next BIP330 `reqrecon` message
+     *  to the peer. Zero if we do not initiate reconciliations with the peer. */
+    std::chrono::microseconds m_next_recon_request GUARDED_BY(NetEventsInterface::g_msgproc_mutex){0};
 
     struct TxRelay {
         mutable RecursiveMutex m_bloom_filter_mutex;
@@ -523,7 +529,7 @@ public:
     void FinalizeNode(const CNode& node) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_headers_presync_mutex, !m_tx_download_mutex);
     bool HasAllDesirableServiceFlags(ServiceFlags services) const override;
     bool ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, !m_headers_presync_mutex, g_msgproc_mutex, !m_tx_download_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, !m_block_request_stats_mutex, !m_headers_presync_mutex, g_msgproc_mutex, !m_tx_download_mutex);
     bool SendMessages(CNode* pto) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, g_msgproc_mutex, !m_tx_download_mutex);
 
@@ -534,7 +540,7 @@ public:
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     bool GetNodeStateStats(NodeId nodeid, CNodeStateStats& stats) const override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     std::vector<node::TxOrphanage::OrphanInfo> GetOrphanTransactions() override EXCLUSIVE_LOCKS_REQUIRED(!m_tx_download_mutex);
-    PeerManagerInfo GetInfo() const override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
+    PeerManagerInfo GetInfo() const override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_block_request_stats_mutex);
     void SendPings() override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void RelayTransaction(const Txid& txid, const Wtxid& wtxid) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void SetBestBlock(int height, std::chrono::seconds time) override
@@ -545,7 +551,7 @@ public:
     void UnitTestMisbehaving(NodeId peer_id) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex) { Misbehaving(*Assert(GetPeerRef(peer_id)), ""); };
     void ProcessMessage(CNode& pfrom, const std::string& msg_type, DataStream& vRecv,
                         const std::chrono::microseconds time_received, const std::atomic<bool>& interruptMsgProc) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, !m_headers_presync_mutex, g_msgproc_mutex, !m_tx_download_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, !m_block_request_stats_mutex, !m_headers_presync_mutex, g_msgproc_mutex, !m_tx_download_mutex);
     void UpdateLastBlockAnnounceTime(NodeId node, int64_t time_in_seconds) override;
     ServiceFlags GetDesirableServiceFlags(ServiceFlags services) const override;
 
@@ -742,6 +748,18 @@ private:
     /** Send `feefilter` message. */
     void MaybeSendFeefilter(CNode& node, Peer& peer, std::chrono::microseconds current_time) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
 
+    /** Send a `reqrecon` message every RECON_REQUEST_INTERVAL to the peers we initiate reconciliations with. */
+    void MaybeRequestReconciliation(CNode& node, Peer& peer, std::chrono::microseconds current_time) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
+
+    /** Announce the transactions that are still in our mempool out of those found by a reconciliation round. */
+    void AnnounceReconciledTxs(CNode& node, Peer& peer, std::span<const Wtxid> wtxids) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
+
+    /** Fall back to flooding to a peer which stopped taking part in reconciliation rounds. */
+    void MaybeExpireReconciliation(CNode& node, Peer& peer) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
+
+    /** Number of full outbound peers we flood transactions to, as we do not reconcile with them. */
+    size_t CountOutboundFloodingPeers() const;
+
     FastRandomContext m_rng GUARDED_BY(NetEventsInterface::g_msgproc_mutex);
 
     FeeFilterRounder m_fee_filter_rounder GUARDED_BY(NetEventsInterface::g_msgproc_mutex);
@@ -812,6 +830,13 @@ private:
     /** Number of nodes with fSyncStarted. */
     int nSyncStarted GUARDED_BY(cs_main) = 0;
 
+    enum class BlockRequestResult { SERVED, PRUNED, MISSING, LIMITED };
+    /** Account for a getdata block request. depth is -1 for blocks outside the active chain. */
+    void RecordBlockRequest(int depth, BlockRequestResult result) EXCLUSIVE_LOCKS_REQUIRED(!m_block_request_stats_mutex);
+
+    mutable Mutex m_block_request_stats_mutex;
+    BlockRequestStats m_block_request_stats GUARDED_BY(m_block_request_stats_mutex);
+
     /** Hash of the last block we received via INV */
     uint256 m_last_block_inv_triggering_headers_sync GUARDED_BY(g_msgproc_mutex){};
 
@@ -945,7 +970,7 @@ private:
         EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, NetEventsInterface::g_msgproc_mutex);
 
     void ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic<bool>& interruptMsgProc)
-        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, peer.m_getdata_requests_mutex, NetEventsInterface::g_msgproc_mutex)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, !m_block_request_stats_mutex, peer.m_getdata_requests_mutex, NetEventsInterface::g_msgproc_mutex)
         LOCKS_EXCLUDED(::cs_main);
 
     /** Process a new block. Perform any post-processing housekeeping */
@@ -999,7 +1024,7 @@ private:
     bool BlockRequestAllowed(const CBlockIndex* pindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     bool AlreadyHaveBlock(const uint256& block_hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     void ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv& inv)
-        EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex, !m_most_recent_block_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex, !m_most_recent_block_mutex, !m_block_request_stats_mutex);
 
     /**
      * Validation logic for compact filters request handling.
@@ -1759,9 +1784,25 @@ PeerManagerInfo PeerManagerImpl::GetInfo() const
     return PeerManagerInfo{
         .median_outbound_time_offset = m_outbound_time_offsets.Median(),
         .ignores_incoming_txs = m_opts.ignore_incoming_txs,
+        .block_requests = WITH_LOCK(m_block_request_stats_mutex, return m_block_request_stats),
     };
 }
 
+void PeerManagerImpl::RecordBlockRequest(int depth, BlockRequestResult result)
+{
+    LOCK(m_block_request_stats_mutex);
+    switch (result) {
+    case BlockRequestResult::SERVED: ++m_block_request_stats.served; break;
+    case BlockRequestResult::PRUNED: ++m_block_request_stats.pruned; break;
+    case BlockRequestResult::MISSING: ++m_block_request_stats.missing; break;
+    case BlockRequestResult::LIMITED: ++m_block_request_stats.limited; break;
+    } // no default case, so the compiler can warn about missing cases
+    if (depth < 0) return;
+    const auto& limits{BlockRequestStats::DEPTH_LIMITS};
+    const size_t bucket = std::lower_bound(limits.begin(), limits.end(), depth) - limits.begin();
+    ++m_block_request_stats.depth_buckets[bucket];
+}
+
 void PeerManagerImpl::AddToCompactExtraTransactions(const CTransactionRef& tx)
 {
     if (m_opts.max_extra_txs <= 0)
@@ -1897,8 +1938,7 @@ PeerManagerImpl::PeerManagerImpl(CConnman& connman, AddrMan& addrman,
       m_warnings{warnings},
       m_opts{opts}
 {
-    // While Erlay support is incomplete, it must be enabled explicitly via -txreconciliation.
-    // This argument can go away after Erlay support is complete.
+    // Erlay is not enabled by default yet, it must be enabled explicitly via -txreconciliation.
     if (opts.reconcile_txs) {
         m_txreconciliation = std::make_unique<TxReconciliationTracker>(TXRECONCILIATION_VERSION);
     }
@@ -2247,10 +2287,12 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
             return;
         }
         tip = m_chainman.ActiveChain().Tip();
+        const int depth{m_chainman.ActiveChain().Contains(pindex) ? tip->nHeight - pindex->nHeight : -1};
         // Avoid leaking prune-height by never sending blocks below the NODE_NETWORK_LIMITED threshold
         if (!pfrom.HasPermission(NetPermissionFlags::NoBan) && (
                 (((peer.m_our_services & NODE_NETWORK_LIMITED) == NODE_NETWORK_LIMITED) && ((peer.m_our_services & NODE_NETWORK) != NODE_NETWORK) && (tip->nHeight - pindex->nHeight > (int)NODE_NETWORK_LIMITED_MIN_BLOCKS + 2 /* add two blocks buffer extension for possible races */) )
            )) {
+            RecordBlockRequest(depth, BlockRequestResult::LIMITED);
             LogDebug(BCLog::NET, "Ignore block request below NODE_NETWORK_LIMITED threshold, %s\n", pfrom.DisconnectMsg(fLogIPs));
             //disconnect node and prevent it from stalling (would otherwise wait for the missing block)
             pfrom.fDisconnect = true;
@@ -2259,8 +2301,10 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         // Pruned nodes may have deleted the block, so check whether
         // it's available before trying to send.
         if (!(pindex->nStatus & BLOCK_HAVE_DATA)) {
+            RecordBlockRequest(depth, m_chainman.m_blockman.IsBlockPruned(*pindex) ? BlockRequestResult::PRUNED : BlockRequestResult::MISSING);
             return;
         }
+        RecordBlockRequest(depth, BlockRequestResult::SERVED);
         can_direct_fetch = CanDirectFetch();
         block_pos = pindex->GetBlockPos();
     }
@@ -3800,6 +3844,8 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             LogDebug(BCLog::NET, "Ignore unexpected txreconciliation signal from peer=%d\n", pfrom.GetId());
             break;
         case ReconciliationRegisterResult::SUCCESS:
+            // We initiate reconciliations with the peers we connected to.
+            if (!pfrom.IsInboundConn()) peer->m_next_recon_request = GetTime<std::chrono::microseconds>() + RECON_REQUEST_INTERVAL;
             break;
         case ReconciliationRegisterResult::ALREADY_REGISTERED:
             LogDebug(BCLog::NET, "txreconciliation protocol violation (sendtxrcncl received from already registered peer), %s\n", pfrom.DisconnectMsg(fLogIPs));
@@ -3965,6 +4011,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                 }
                 const GenTxid gtxid = ToGenTxid(inv);
                 AddKnownTx(*peer, inv.hash);
+                if (m_txreconciliation && inv.IsMsgWtx()) m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), Wtxid::FromUint256(inv.hash));
 
                 if (!m_chainman.IsInitialBlockDownload()) {
                     const bool fAlreadyHave{m_txdownloadman.AddTxAnnouncement(pfrom.GetId(), gtxid, current_time)};
@@ -4252,6 +4299,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
 
         const uint256& hash = peer->m_wtxid_relay ? wtxid.ToUint256() : txid.ToUint256();
         AddKnownTx(*peer, hash);
+        if (m_txreconciliation && peer->m_wtxid_relay) m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), wtxid);
 
         LOCK2(cs_main, m_tx_download_mutex);
 
@@ -4892,6 +4940,52 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    if (msg_type == NetMsgType::REQRECON || msg_type == NetMsgType::SKETCH ||
+        msg_type == NetMsgType::REQSKTCHEXT || msg_type == NetMsgType::RECONCILDIFF) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogDebug(BCLog::NET, "%s from peer=%d ignored, as we do not reconcile transactions with it\n", msg_type, pfrom.GetId());
+            return;
+        }
+
+        if (msg_type == NetMsgType::REQRECON) {
+            ReconciliationRequest request;
+            vRecv >> request.set_size >> request.q;
+            if (const auto sketch{m_txreconciliation->HandleReconciliationRequest(pfrom.GetId(), request)}) {
+                MakeAndPushMessage(pfrom, NetMsgType::SKETCH, *sketch);
+                return;
+            }
+        } else if (msg_type == NetMsgType::SKETCH) {
+            std::vector<unsigned char> sketch;
+            vRecv >> sketch;
+            if (const auto result{m_txreconciliation->HandleSketch(pfrom.GetId(), sketch)}) {
+                if (result->outcome == ReconciliationOutcome::EXTENSION_NEEDED) {
+                    MakeAndPushMessage(pfrom, NetMsgType::REQSKTCHEXT);
+                    return;
+                }
+                const bool success{result->outcome == ReconciliationOutcome::SUCCESS};
+                MakeAndPushMessage(pfrom, NetMsgType::RECONCILDIFF, uint8_t{success}, result->request);
+                AnnounceReconciledTxs(pfrom, *peer, result->announce);
+                return;
+            }
+        } else if (msg_type == NetMsgType::REQSKTCHEXT) {
+            if (const auto extension{m_txreconciliation->HandleExtensionRequest(pfrom.GetId())}) {
+                MakeAndPushMessage(pfrom, NetMsgType::SKETCH, *extension);
+                return;
+            }
+        } else {
+            uint8_t success;
+            std::vector<uint32_t> ask_shortids;
+            vRecv >> success >> ask_shortids;
+            if (const auto announce{m_txreconciliation->HandleReconciliationDifference(pfrom.GetId(), success, ask_shortids)}) {
+                AnnounceReconciledTxs(pfrom, *peer, *announce);
+                return;
+            }
+        }
+        LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected %s), %s\n", msg_type, pfrom.DisconnectMsg(fLogIPs));
+        pfrom.fDisconnect = true;
+        return;
+    }
+
     if (msg_type == NetMsgType::NOTFOUND) {
         std::vector<CInv> vInv;
         vRecv >> vInv;
@@ -5396,6 +5490,62 @@ void PeerManagerImpl::MaybeSendFeefilter(CNode& pto, Peer& peer, std::chrono::mi
     }
 }
 
+void PeerManagerImpl::MaybeRequestReconciliation(CNode& node, Peer& peer, std::chrono::microseconds current_time)
+{
+    if (!m_txreconciliation || peer.m_next_recon_request == 0us || current_time < peer.m_next_recon_request) return;
+    peer.m_next_recon_request = current_time + RECON_REQUEST_INTERVAL;
+
+    // No request is made while the previous round is ongoing.
+    if (const auto request{m_txreconciliation->InitiateReconciliationRequest(node.GetId())}) {
+        MakeAndPushMessage(node, NetMsgType::REQRECON, request->set_size, request->q);
+    }
+}
+
+void PeerManagerImpl::MaybeExpireReconciliation(CNode& node, Peer& peer)
+{
+    if (!m_txreconciliation) return;
+    if (const auto announce{m_txreconciliation->ExpireReconciliation(node.GetId())}) {
+        LogDebug(BCLog::NET, "txreconciliation with peer=%d timed out, flooding transactions to it instead\n", node.GetId());
+        peer.m_next_recon_request = 0us;
+        AnnounceReconciledTxs(node, peer, *announce);
+    }
+}
+
+size_t PeerManagerImpl::CountOutboundFloodingPeers() const
+{
+    size_t outbound_flooding_peers{0};
+    m_connman.ForEachNode([&](const CNode* node) {
+        if (node->IsFullOutboundConn() && !m_txreconciliation->IsPeerRegistered(node->GetId())) ++outbound_flooding_peers;
+    });
+    return outbound_flooding_peers;
+}
+
+void PeerManagerImpl::AnnounceReconciledTxs(CNode& node, Peer& peer, std::span<const Wtxid> wtxids)
+{
+    auto tx_relay = peer.GetTxRelay();
+    if (!tx_relay) return;
+
+    std::vector<CInv> invs;
+    {
+        LOCK(tx_relay->m_tx_inventory_mutex);
+        const CFeeRate filterrate{tx_relay->m_fee_filter_received.load()};
+        for (const Wtxid& wtxid : wtxids) {
+            const auto txinfo{m_mempool.info(wtxid)};
+            if (!txinfo.tx || txinfo.fee < filterrate.GetFee(txinfo.vsize)) continue;
+            tx_relay->m_tx_inventory_known_filter.insert(wtxid.ToUint256());
+            invs.emplace_back(MSG_WTX, wtxid.ToUint256());
+            if (invs.size() == MAX_INV_SZ) {
+                MakeAndPushMessage(node, NetMsgType::INV, invs);
+                invs.clear();
+            }
+        }
+        // Ensure we'll respond to GETDATA requests for anything we've just announced
+        LOCK(m_mempool.cs);
+        tx_relay->m_last_inv_sequence = m_mempool.GetSequence();
+    }
+    if (!invs.empty()) MakeAndPushMessage(node, NetMsgType::INV, invs);
+}
+
 namespace {
 class CompareInvMempoolOrder
 {
@@ -5692,6 +5842,11 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         }
 
         if (auto tx_relay = peer->GetTxRelay(); tx_relay != nullptr) {
+                const bool reconcile{m_txreconciliation && peer->m_wtxid_relay && m_txreconciliation->IsPeerRegistered(pto->GetId())};
+                // Outbound peers we reconcile with may have to get transactions flooded to them,
+                // see ShouldFanoutTo. Counted before taking the inventory lock, which RelayTransaction
+                // takes after m_peer_mutex.
+                const size_t outbound_flooding_peers{reconcile && !pto->IsInboundConn() ? CountOutboundFloodingPeers() : 0};
                 LOCK(tx_relay->m_tx_inventory_mutex);
                 // Check whether periodic sends should happen
                 bool fSendTrickle = pto->HasPermission(NetPermissionFlags::NoBan);
@@ -5789,6 +5944,13 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                             continue;
                         }
                         if (tx_relay->m_bloom_filter && !tx_relay->m_bloom_filter->IsRelevantAndUpdate(*txinfo.tx)) continue;
+                        // Leave it to the next reconciliation round, unless it is flooded to the peer
+                        // or the peer's set is full.
+                        if (reconcile && !m_txreconciliation->ShouldFanoutTo(pto->GetId(), wtxid, outbound_flooding_peers) &&
+                            m_txreconciliation->AddToSet(pto->GetId(), wtxid)) {
+                            tx_relay->m_tx_inventory_known_filter.insert(inv.hash);
+                            continue;
+                        }
                         // Send
                         vInv.push_back(inv);
                         nRelayedTransactions++;
@@ -5931,5 +6093,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
             MakeAndPushMessage(*pto, NetMsgType::GETDATA, vGetData);
     } // release cs_main
     MaybeSendFeefilter(*pto, *peer, current_time);
+    MaybeExpireReconciliation(*pto, *peer);
+    MaybeRequestReconciliation(*pto, *peer, current_time);
     return true;
 }
@@ -13,6 +13,7 @@
 #include <threadsafety.h>
 #include <validationinterface.h>
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -63,9 +64,27 @@ struct CNodeStateStats {
     std::chrono::seconds time_offset{0};
 };
 
+/** Counters for historical block requests from peers, to help size -prune. */
+struct BlockRequestStats {
+    //! Inclusive upper bounds of the depth buckets, the last bucket is unbounded.
+    static constexpr std::array<int, 4> DEPTH_LIMITS{288, 1008, 4032, 52560};
+
+    //! Requests for blocks we had on disk or in memory.
+    uint64_t served{0};
+    //! Requests for blocks we no longer have because they were pruned.
+    uint64_t pruned{0};
+    //! Requests for blocks we have not downloaded, such as those below an assumeutxo snapshot.
+    uint64_t missing{0};
+    //! Requests ignored because they were below the NODE_NETWORK_LIMITED threshold.
+    uint64_t limited{0};
+    //! Requests for active chain blocks by depth below our tip, whether served or not.
+    std::array<uint64_t, DEPTH_LIMITS.size() + 1> depth_buckets{};
+};
+
 struct PeerManagerInfo {
     std::chrono::seconds median_outbound_time_offset{0s};
     bool ignores_incoming_txs{false};
+    BlockRequestStats block_requests;
 };
 
 class PeerManager : public CValidationInterface, public NetEventsInterface
@@ -34,8 +34,10 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, BlockManager::Op
     opts.prune_target = nPruneTarget;
 
     if (auto value{args.GetBoolArg("-fastprune")}) opts.fast_prune = *value;
+    if (auto value{args.GetBoolArg("-asyncblockwrites")}) opts.async_block_writes = *value;
+    if (auto value{args.GetBoolArg("-persistblockindex")}) opts.persist_block_index = *value;
 
-    ReadDatabaseArgs(args, opts.block_tree_db_params.options);
+    if (auto result{ReadDatabaseArgs(args, opts.block_tree_db_params.options, DB_TYPE_BLOCKS)}; !result) return result;
 
     return {};
 }
@@ -16,6 +16,7 @@
 #include <kernel/messagestartchars.h>
 #include <kernel/notifications_interface.h>
 #include <logging.h>
+#include <logging/timer.h>
 #include <pow.h>
 #include <primitives/block.h>
 #include <primitives/transaction.h>
@@ -31,16 +32,22 @@
 #include <util/batchpriority.h>
 #include <util/check.h>
 #include <util/fs.h>
+#include <util/fs_helpers.h>
 #include <util/obfuscation.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
 #include <util/syserror.h>
+#include <util/thread.h>
+#include <util/time.h>
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <cstddef>
+#include <limits>
 #include <map>
 #include <optional>
+#include <stdexcept>
 #include <unordered_map>
 
 namespace kernel {
@@ -49,6 +56,7 @@ static constexpr uint8_t DB_BLOCK_INDEX{'b'};
 static constexpr uint8_t DB_FLAG{'F'};
 static constexpr uint8_t DB_REINDEX_FLAG{'R'};
 static constexpr uint8_t DB_LAST_BLOCK{'l'};
+static constexpr uint8_t DB_BLOCK_INDEX_DUMP{'D'};
 // Keys used in previous version that might still be found in the DB:
 // BlockTreeDB::DB_TXINDEX_BLOCK{'T'};
 // BlockTreeDB::DB_TXINDEX{'t'}
@@ -88,9 +96,23 @@ bool BlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFi
     for (const CBlockIndex* bi : blockinfo) {
         batch.Write(std::make_pair(DB_BLOCK_INDEX, bi->GetBlockHash()), CDiskBlockIndex{bi});
     }
+    // Any block index dump no longer reflects the database after this batch.
+    batch.Erase(DB_BLOCK_INDEX_DUMP);
     return WriteBatch(batch, true);
 }
 
+std::optional<uint256> BlockTreeDB::ReadBlockIndexDumpId()
+{
+    uint256 id;
+    if (!Read(DB_BLOCK_INDEX_DUMP, id)) return std::nullopt;
+    return id;
+}
+
+bool BlockTreeDB::WriteBlockIndexDumpId(const uint256& id)
+{
+    return Write(DB_BLOCK_INDEX_DUMP, id, /*fSync=*/true);
+}
+
 bool BlockTreeDB::WriteFlag(const std::string& name, bool fValue)
 {
     return Write(std::make_pair(DB_FLAG, name), fValue ? uint8_t{'1'} : uint8_t{'0'});
@@ -248,13 +270,19 @@ CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, CBlockInde
 }
 
 void BlockManager::PruneOneBlockFile(const int fileNumber)
+{
+    PruneBlockFiles({fileNumber});
+}
+
+void BlockManager::PruneBlockFiles(const std::set<int>& files)
 {
     AssertLockHeld(cs_main);
     LOCK(cs_LastBlockFile);
+    if (files.empty()) return;
 
     for (auto& entry : m_block_index) {
         CBlockIndex* pindex = &entry.second;
-        if (pindex->nFile == fileNumber) {
+        if (files.contains(pindex->nFile)) {
             pindex->nStatus &= ~BLOCK_HAVE_DATA;
             pindex->nStatus &= ~BLOCK_HAVE_UNDO;
             pindex->nFile = 0;
@@ -277,8 +305,10 @@ void BlockManager::PruneOneBlockFile(const int fileNumber)
         }
     }
 
-    m_blockfile_info.at(fileNumber) = CBlockFileInfo{};
-    m_dirty_fileinfo.insert(fileNumber);
+    for (const int file_number : files) {
+        m_blockfile_info.at(file_number) = CBlockFileInfo{};
+        m_dirty_fileinfo.insert(file_number);
+    }
 }
 
 void BlockManager::FindFilesToPruneManual(
@@ -296,17 +326,18 @@ void BlockManager::FindFilesToPruneManual(
 
     const auto [min_block_to_prune, last_block_can_prune] = chainman.GetPruneRange(chain, nManualPruneHeight);
 
-    int count = 0;
+    std::set<int> files;
     for (int fileNumber = 0; fileNumber < this->MaxBlockfileNum(); fileNumber++) {
         const auto& fileinfo = m_blockfile_info[fileNumber];
         if (fileinfo.nSize == 0 || fileinfo.nHeightLast > (unsigned)last_block_can_prune || fileinfo.nHeightFirst < (unsigned)min_block_to_prune) {
             continue;
         }
 
-        PruneOneBlockFile(fileNumber);
-        setFilesToPrune.insert(fileNumber);
-        count++;
+        files.insert(fileNumber);
     }
+    PruneBlockFiles(files);
+    setFilesToPrune.insert(files.begin(), files.end());
+    const int count{static_cast<int>(files.size())};
     LogInfo("[%s] Prune (Manual): prune_height=%d removed %d blk/rev pairs",
         chain.GetRole(), last_block_can_prune, count);
 }
@@ -338,7 +369,7 @@ void BlockManager::FindFilesToPrune(
     // before the next pruning.
     uint64_t nBuffer = BLOCKFILE_CHUNK_SIZE + UNDOFILE_CHUNK_SIZE;
     uint64_t nBytesToPrune;
-    int count = 0;
+    std::set<int> files;
 
     if (nCurrentUsage + nBuffer >= target) {
         // On a prune event, the chainstate DB is flushed.
@@ -371,13 +402,14 @@ void BlockManager::FindFilesToPrune(
                 continue;
             }
 
-            PruneOneBlockFile(fileNumber);
             // Queue up the files for removal
-            setFilesToPrune.insert(fileNumber);
+            files.insert(fileNumber);
             nCurrentUsage -= nBytesToPrune;
-            count++;
         }
+        PruneBlockFiles(files);
+        setFilesToPrune.insert(files.begin(), files.end());
     }
+    const int count{static_cast<int>(files.size())};
 
     LogDebug(BCLog::PRUNE, "[%s] target=%dMiB actual=%dMiB diff=%dMiB min_height=%d max_prune_height=%d removed %d blk/rev pairs\n",
              chain.GetRole(), target / 1024 / 1024, nCurrentUsage / 1024 / 1024,
@@ -406,9 +438,223 @@ CBlockIndex* BlockManager::InsertBlockIndex(const uint256& hash)
     return pindex;
 }
 
+namespace {
+//! Version of the block index dump file format.
+constexpr uint32_t BLOCK_INDEX_DUMP_VERSION{1};
+//! Parent position of entries without a parent (the genesis block).
+constexpr uint32_t BLOCK_INDEX_DUMP_NO_PREV{std::numeric_limits<uint32_t>::max()};
+
+/** One CBlockIndex as stored in the block index dump, see DumpBlockIndex(). */
+struct BlockIndexDumpEntry {
+    uint256 hash;
+    //! Position of the parent entry in the file. Parents always come first.
+    uint32_t prev{BLOCK_INDEX_DUMP_NO_PREV};
+    int32_t height{0};
+    uint32_t status{0};
+    int32_t file{0};
+    uint32_t data_pos{0};
+    uint32_t undo_pos{0};
+    uint32_t tx{0};
+    int32_t version{0};
+    uint256 merkle_root;
+    uint32_t time{0};
+    uint32_t bits{0};
+    uint32_t nonce{0};
+    uint32_t time_max{0};
+    uint256 chain_work;
+
+    SERIALIZE_METHODS(BlockIndexDumpEntry, obj)
+    {
+        READWRITE(obj.hash, obj.prev, obj.height, obj.status, obj.file, obj.data_pos, obj.undo_pos, obj.tx,
+                  obj.version, obj.merkle_root, obj.time, obj.bits, obj.nonce, obj.time_max, obj.chain_work);
+    }
+};
+} // namespace
+
+fs::path BlockManager::GetBlockIndexDumpPath() const
+{
+    return m_opts.block_tree_db_params.path.parent_path() / "blockindex.dat";
+}
+
+bool BlockManager::DumpBlockIndex()
+{
+    AssertLockHeld(::cs_main);
+    if (!m_opts.persist_block_index || m_opts.block_tree_db_params.memory_only || !m_blockfiles_indexed) return true;
+
+    const auto start{SteadyClock::now()};
+    // The dump is only valid for the database state it was created from, so
+    // bring the database up to date first.
+    if (!WriteBlockIndexDB()) return false;
+
+    std::vector<CBlockIndex*> sorted{GetAllBlockIndices()};
+    std::sort(sorted.begin(), sorted.end(), CBlockIndexHeightOnlyComparator());
+    std::unordered_map<const CBlockIndex*, uint32_t> positions;
+    positions.reserve(sorted.size());
+
+    const uint256 id{GetRandHash()};
+    const fs::path path{GetBlockIndexDumpPath()};
+    const fs::path path_tmp{path + ".new"};
+    try {
+        AutoFile file{fsbridge::fopen(path_tmp, "wb")};
+        if (file.IsNull()) {
+            throw std::runtime_error(strprintf("Failed to open %s", fs::PathToString(path_tmp)));
+        }
+        uint256 checksum;
+        {
+            BufferedWriter buffered{file};
+            HashedSourceWriter writer{buffered};
+            writer << GetParams().MessageStart() << BLOCK_INDEX_DUMP_VERSION << id << uint64_t{sorted.size()};
+            for (const CBlockIndex* index : sorted) {
+                BlockIndexDumpEntry entry;
+                entry.hash = index->GetBlockHash();
+                if (index->pprev) entry.prev = positions.at(index->pprev);
+                entry.height = index->nHeight;
+                entry.status = index->nStatus;
+                entry.file = index->nFile;
+                entry.data_pos = index->nDataPos;
+                entry.undo_pos = index->nUndoPos;
+                entry.tx = index->nTx;
+                entry.version = index->nVersion;
+                entry.merkle_root = index->hashMerkleRoot;
+                entry.time = index->nTime;
+                entry.bits = index->nBits;
+                entry.nonce = index->nNonce;
+                entry.time_max = index->nTimeMax;
+                entry.chain_work = ArithToUint256(index->nChainWork);
+                writer << entry;
+                positions.emplace(index, positions.size());
+            }
+            checksum = writer.GetHash();
+            buffered << checksum;
+        }
+        if (!file.Commit()) {
+            (void)file.fclose();
+            throw std::runtime_error("Commit failed");
+        }
+        if (file.fclose() != 0) {
+            throw std::runtime_error(strprintf("Error closing %s: %s", fs::PathToString(path_tmp), SysErrorString(errno)));
+        }
+        if (!RenameOver(path_tmp, path)) {
+            throw std::runtime_error("Rename failed");
+        }
+    } catch (const std::exception& e) {
+        LogError("Failed to dump the block index: %s", e.what());
+        fs::remove(path_tmp);
+        return false;
+    }
+    // Only tie the file to the database once it is complete on disk.
+    if (!m_block_tree_db->WriteBlockIndexDumpId(id)) {
+        LogError("Failed to record the block index dump in the block tree database");
+        return false;
+    }
+    LogInfo("Dumped %u block index entries to %s in %dms", sorted.size(), fs::PathToString(path),
+            Ticks<std::chrono::milliseconds>(SteadyClock::now() - start));
+    return true;
+}
+
+bool BlockManager::LoadBlockIndexDump(std::vector<CBlockIndex*>& sorted_by_height)
+{
+    AssertLockHeld(::cs_main);
+    if (!m_block_index.empty()) return false;
+    const fs::path path{GetBlockIndexDumpPath()};
+    const auto expected_id{m_block_tree_db->ReadBlockIndexDumpId()};
+    if (!expected_id) {
+        if (fs::exists(path)) LogInfo("Ignoring outdated block index dump %s", fs::PathToString(path));
+        return false;
+    }
+
+    const auto start{SteadyClock::now()};
+    try {
+        AutoFile file{fsbridge::fopen(path, "rb")};
+        if (file.IsNull()) {
+            throw std::runtime_error("Failed to open file");
+        }
+        // Read the whole file at once, the checksum needs to be verified
+        // before anything is inserted into the block index.
+        const auto file_size{fs::file_size(path)};
+        if (file_size < uint256::size()) {
+            throw std::runtime_error("File too small");
+        }
+        std::vector<std::byte> data(file_size);
+        file.read(data);
+        const auto payload{std::span{data}.first(data.size() - uint256::size())};
+        uint256 checksum;
+        SpanReader{std::span{data}.last(uint256::size())} >> checksum;
+        HashWriter hasher;
+        hasher.write(payload);
+        if (hasher.GetHash() != checksum) {
+            throw std::runtime_error("Checksum mismatch");
+        }
+
+        SpanReader reader{payload};
+        MessageStartChars message_start;
+        uint32_t version;
+        uint256 id;
+        uint64_t count;
+        reader >> message_start >> version >> id >> count;
+        if (message_start != GetParams().MessageStart()) {
+            throw std::runtime_error("Network magic mismatch");
+        }
+        if (version != BLOCK_INDEX_DUMP_VERSION) {
+            throw std::runtime_error(strprintf("Unsupported version %u", version));
+        }
+        if (id != *expected_id) {
+            throw std::runtime_error("File does not match the block tree database");
+        }
+
+        sorted_by_height.clear();
+        sorted_by_height.reserve(count);
+        m_block_index.reserve(count);
+        for (uint64_t i{0}; i < count; ++i) {
+            if (m_interrupt) throw std::runtime_error("Interrupted");
+            BlockIndexDumpEntry entry;
+            reader >> entry;
+            const auto [it, inserted]{m_block_index.try_emplace(entry.hash)};
+            if (!inserted) {
+                throw std::runtime_error(strprintf("Duplicate entry %s", entry.hash.ToString()));
+            }
+            CBlockIndex* index{&it->second};
+            index->phashBlock = &it->first;
+            if (entry.prev != BLOCK_INDEX_DUMP_NO_PREV) {
+                if (entry.prev >= sorted_by_height.size()) {
+                    throw std::runtime_error(strprintf("Entry %s precedes its parent", entry.hash.ToString()));
+                }
+                index->pprev = sorted_by_height[entry.prev];
+            }
+            index->nHeight = entry.height;
+            index->nStatus = entry.status;
+            index->nFile = entry.file;
+            index->nDataPos = entry.data_pos;
+            index->nUndoPos = entry.undo_pos;
+            index->nTx = entry.tx;
+            index->nVersion = entry.version;
+            index->hashMerkleRoot = entry.merkle_root;
+            index->nTime = entry.time;
+            index->nBits = entry.bits;
+            index->nNonce = entry.nonce;
+            index->nTimeMax = entry.time_max;
+            index->nChainWork = UintToArith256(entry.chain_work);
+            sorted_by_height.push_back(index);
+        }
+        if (!reader.empty()) {
+            throw std::runtime_error("Trailing data");
+        }
+    } catch (const std::exception& e) {
+        LogWarning("Unable to use block index dump %s, falling back to the block tree database: %s", fs::PathToString(path), e.what());
+        sorted_by_height.clear();
+        m_block_index.clear();
+        return false;
+    }
+    LogInfo("Loaded %u block index entries from %s in %dms", sorted_by_height.size(), fs::PathToString(path),
+            Ticks<std::chrono::milliseconds>(SteadyClock::now() - start));
+    return true;
+}
+
 bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockhash)
 {
-    if (!m_block_tree_db->LoadBlockIndexGuts(
+    std::vector<CBlockIndex*> vSortedByHeight;
+    const bool from_dump{m_opts.persist_block_index && LoadBlockIndexDump(vSortedByHeight)};
+    if (!from_dump && !m_block_tree_db->LoadBlockIndexGuts(
             GetConsensus(), [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }, m_interrupt)) {
         return false;
     }
@@ -437,10 +683,13 @@ bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockha
 
     Assert(m_snapshot_height.has_value() == snapshot_blockhash.has_value());
 
-    // Calculate nChainWork
-    std::vector<CBlockIndex*> vSortedByHeight{GetAllBlockIndices()};
-    std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
-              CBlockIndexHeightOnlyComparator());
+    // Calculate nChainWork. A block index dump is already sorted and
+    // includes it.
+    if (!from_dump) {
+        vSortedByHeight = GetAllBlockIndices();
+        std::sort(vSortedByHeight.begin(), vSortedByHeight.end(),
+                  CBlockIndexHeightOnlyComparator());
+    }
 
     CBlockIndex* previous_index{nullptr};
     for (CBlockIndex* pindex : vSortedByHeight) {
@@ -450,8 +699,10 @@ bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockha
             return false;
         }
         previous_index = pindex;
-        pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
-        pindex->nTimeMax = (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime) : pindex->nTime);
+        if (!from_dump) {
+            pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
+            pindex->nTimeMax = (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime) : pindex->nTime);
+        }
 
         // We can link the chain of blocks for which we've received transactions at some point, or
         // blocks that are assumed-valid on the basis of snapshot load (see
@@ -488,6 +739,12 @@ bool BlockManager::LoadBlockIndex(const std::optional<uint256>& snapshot_blockha
 bool BlockManager::WriteBlockIndexDB()
 {
     AssertLockHeld(::cs_main);
+    // Block index entries and block file info may refer to data that is
+    // still queued for writing. Only persist them once that data is durable.
+    if (m_write_queue && !m_write_queue->Sync()) {
+        LogError("Queued block or undo data could not be written, not writing block index");
+        return false;
+    }
     std::vector<std::pair<int, const CBlockFileInfo*>> vFiles;
     vFiles.reserve(m_dirty_fileinfo.size());
     for (std::set<int>::iterator it = m_dirty_fileinfo.begin(); it != m_dirty_fileinfo.end();) {
@@ -670,7 +927,11 @@ CBlockFileInfo* BlockManager::GetBlockFileInfo(size_t n)
 bool BlockManager::ReadBlockUndo(CBlockUndo& blockundo, const CBlockIndex& index) const
 {
     const FlatFilePos pos{WITH_LOCK(::cs_main, return index.GetUndoPos())};
+    return ReadBlockUndo(blockundo, pos, index.pprev->GetBlockHash());
+}
 
+bool BlockManager::ReadBlockUndo(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& prev_hash) const
+{
     // Open history file to read
     AutoFile file{OpenUndoFile(pos, true)};
     if (file.IsNull()) {
@@ -683,7 +944,7 @@ bool BlockManager::ReadBlockUndo(CBlockUndo& blockundo, const CBlockIndex& index
         // Read block
         HashVerifier verifier{filein}; // Use HashVerifier, as reserializing may lose data, c.f. commit d3424243
 
-        verifier << index.pprev->GetBlockHash();
+        verifier << prev_hash;
         verifier >> blockundo;
 
         uint256 hashChecksum;
@@ -705,6 +966,11 @@ bool BlockManager::ReadBlockUndo(CBlockUndo& blockundo, const CBlockIndex& index
 bool BlockManager::FlushUndoFile(int block_file, bool finalize)
 {
     FlatFilePos undo_pos_old(block_file, m_blockfile_info[block_file].nUndoSize);
+    if (m_write_queue) {
+        // Ordered after all undo data queued so far, failures are reported by the queue.
+        m_write_queue->Flush(BlockFileKind::UNDO, undo_pos_old, finalize);
+        return true;
+    }
     if (!m_undo_file_seq.Flush(undo_pos_old, finalize)) {
         m_opts.notifications.flushError(_("Flushing undo file to disk failed. This is likely the result of an I/O error."));
         return false;
@@ -727,7 +993,9 @@ bool BlockManager::FlushBlockFile(int blockfile_num, bool fFinalize, bool finali
     assert(static_cast<int>(m_blockfile_info.size()) > blockfile_num);
 
     FlatFilePos block_pos_old(blockfile_num, m_blockfile_info[blockfile_num].nSize);
-    if (!m_block_file_seq.Flush(block_pos_old, fFinalize)) {
+    if (m_write_queue) {
+        m_write_queue->Flush(BlockFileKind::BLOCK, block_pos_old, fFinalize);
+    } else if (!m_block_file_seq.Flush(block_pos_old, fFinalize)) {
         m_opts.notifications.flushError(_("Flushing block file to disk failed. This is likely the result of an I/O error."));
         success = false;
     }
@@ -776,6 +1044,8 @@ uint64_t BlockManager::CalculateCurrentUsage()
 
 void BlockManager::UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const
 {
+    // Make sure no queued job recreates a file after it has been removed.
+    if (m_write_queue) m_write_queue->Sync();
     std::error_code ec;
     for (std::set<int>::iterator it = setFilesToPrune.begin(); it != setFilesToPrune.end(); ++it) {
         FlatFilePos pos(*it, 0);
@@ -787,17 +1057,68 @@ void BlockManager::UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const
     }
 }
 
+void BlockManager::ScheduleUnlinkPrunedFiles(const std::set<int>& setFilesToPrune)
+{
+    if (setFilesToPrune.empty()) return;
+    {
+        LOCK(m_unlink_mutex);
+        m_files_to_unlink.insert(setFilesToPrune.begin(), setFilesToPrune.end());
+        if (!m_unlink_thread.joinable()) {
+            m_unlink_thread = std::thread(&util::TraceThread, "pruneunlink", [this] { ThreadUnlinkPrunedFiles(); });
+        }
+    }
+    m_unlink_cv.notify_all();
+}
+
+void BlockManager::WaitForPrunedFileUnlinks()
+{
+    WAIT_LOCK(m_unlink_mutex, lock);
+    m_unlink_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_unlink_mutex) { return m_files_to_unlink.empty() && !m_unlinking; });
+}
+
+void BlockManager::ThreadUnlinkPrunedFiles()
+{
+    while (true) {
+        std::set<int> files;
+        {
+            WAIT_LOCK(m_unlink_mutex, lock);
+            m_unlinking = false;
+            m_unlink_cv.notify_all();
+            m_unlink_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_unlink_mutex) { return !m_files_to_unlink.empty() || m_unlink_stop; });
+            // Drain the queue before stopping, the block index no longer references these files.
+            if (m_files_to_unlink.empty()) return;
+            files.swap(m_files_to_unlink);
+            m_unlinking = true;
+        }
+        LOG_TIME_MILLIS_WITH_CATEGORY(strprintf("unlink %d pruned blk/rev pairs", files.size()), BCLog::BENCH);
+        UnlinkPrunedFiles(files);
+    }
+}
+
 AutoFile BlockManager::OpenBlockFile(const FlatFilePos& pos, bool fReadOnly) const
 {
+    if (m_write_queue && fReadOnly) m_write_queue->WaitForFile(BlockFileKind::BLOCK, pos.nFile);
     return AutoFile{m_block_file_seq.Open(pos, fReadOnly), m_obfuscation};
 }
 
+void BlockManager::WaitForBlockFile(int file_num) const
+{
+    if (m_write_queue) m_write_queue->WaitForFile(BlockFileKind::BLOCK, file_num);
+}
+
 /** Open an undo file (rev?????.dat) */
 AutoFile BlockManager::OpenUndoFile(const FlatFilePos& pos, bool fReadOnly) const
 {
+    if (m_write_queue && fReadOnly) m_write_queue->WaitForFile(BlockFileKind::UNDO, pos.nFile);
     return AutoFile{m_undo_file_seq.Open(pos, fReadOnly), m_obfuscation};
 }
 
+std::optional<BlockWriteQueue::Stats> BlockManager::GetWriteQueueStats() const
+{
+    if (!m_write_queue) return std::nullopt;
+    return m_write_queue->GetStats();
+}
+
 fs::path BlockManager::GetBlockPosFilename(const FlatFilePos& pos) const
 {
     return m_block_file_seq.FileName(pos);
@@ -952,32 +1273,42 @@ bool BlockManager::WriteBlockUndo(const CBlockUndo& blockundo, BlockValidationSt
             return false;
         }
 
-        // Open history file to append
-        AutoFile file{OpenUndoFile(pos)};
-        if (file.IsNull()) {
-            LogError("OpenUndoFile failed for %s while writing block undo", pos.ToString());
-            return FatalError(m_opts.notifications, state, _("Failed to write undo data."));
-        }
-        {
-            BufferedWriter fileout{file};
-
-            // Write index header
-            fileout << GetParams().MessageStart() << blockundo_size;
+        if (m_write_queue) {
+            DataStream data;
+            data.reserve(blockundo_size + UNDO_DATA_DISK_OVERHEAD);
+            HashWriter hasher{};
+            hasher << block.pprev->GetBlockHash() << blockundo;
+            data << GetParams().MessageStart() << blockundo_size << blockundo << hasher.GetHash();
+            m_write_queue->Write(BlockFileKind::UNDO, pos, std::move(data));
             pos.nPos += STORAGE_HEADER_BYTES;
+        } else {
+            // Open history file to append
+            AutoFile file{OpenUndoFile(pos)};
+            if (file.IsNull()) {
+                LogError("OpenUndoFile failed for %s while writing block undo", pos.ToString());
+                return FatalError(m_opts.notifications, state, _("Failed to write undo data."));
+            }
             {
-                // Calculate checksum
-                HashWriter hasher{};
-                hasher << block.pprev->GetBlockHash() << blockundo;
-                // Write undo data & checksum
-                fileout << blockundo << hasher.GetHash();
+                BufferedWriter fileout{file};
+
+                // Write index header
+                fileout << GetParams().MessageStart() << blockundo_size;
+                pos.nPos += STORAGE_HEADER_BYTES;
+                {
+                    // Calculate checksum
+                    HashWriter hasher{};
+                    hasher << block.pprev->GetBlockHash() << blockundo;
+                    // Write undo data & checksum
+                    fileout << blockundo << hasher.GetHash();
+                }
+                // BufferedWriter will flush pending data to file when fileout goes out of scope.
             }
-            // BufferedWriter will flush pending data to file when fileout goes out of scope.
-        }
 
-        // Make sure that the file is closed before we call `FlushUndoFile`.
-        if (file.fclose() != 0) {
-            LogError("Failed to close block undo file %s: %s", pos.ToString(), SysErrorString(errno));
-            return FatalError(m_opts.notifications, state, _("Failed to close block undo file."));
+            // Make sure that the file is closed before we call `FlushUndoFile`.
+            if (file.fclose() != 0) {
+                LogError("Failed to close block undo file %s: %s", pos.ToString(), SysErrorString(errno));
+                return FatalError(m_opts.notifications, state, _("Failed to close block undo file."));
+            }
         }
 
         // rev files are written in block height order, whereas blk files are written as blocks come in (often out of order)
@@ -1104,6 +1435,14 @@ FlatFilePos BlockManager::WriteBlock(const CBlock& block, int nHeight)
         LogError("FindNextBlockPos failed for %s while writing block", pos.ToString());
         return FlatFilePos();
     }
+    if (m_write_queue) {
+        DataStream data;
+        data.reserve(block_size + STORAGE_HEADER_BYTES);
+        data << GetParams().MessageStart() << block_size << TX_WITH_WITNESS(block);
+        m_write_queue->Write(BlockFileKind::BLOCK, pos, std::move(data));
+        pos.nPos += STORAGE_HEADER_BYTES;
+        return pos;
+    }
     AutoFile file{OpenBlockFile(pos, /*fReadOnly=*/false)};
     if (file.IsNull()) {
         LogError("OpenBlockFile failed for %s while writing block", pos.ToString());
@@ -1196,6 +1535,10 @@ BlockManager::BlockManager(const util::SignalInterrupt& interrupt, Options opts)
 {
     m_block_tree_db = std::make_unique<BlockTreeDB>(m_opts.block_tree_db_params);
 
+    if (m_opts.async_block_writes) {
+        m_write_queue = std::make_unique<BlockWriteQueue>(m_block_file_seq, m_undo_file_seq, m_obfuscation, m_opts.notifications);
+    }
+
     if (m_opts.block_tree_db_params.wipe_data) {
         m_block_tree_db->WriteReindexing(true);
         m_blockfiles_indexed = false;
@@ -1206,6 +1549,15 @@ BlockManager::BlockManager(const util::SignalInterrupt& interrupt, Options opts)
     }
 }
 
+BlockManager::~BlockManager()
+{
+    if (m_unlink_thread.joinable()) {
+        WITH_LOCK(m_unlink_mutex, m_unlink_stop = true);
+        m_unlink_cv.notify_all();
+        m_unlink_thread.join();
+    }
+}
+
 class ImportingNow
 {
     std::atomic<bool>& m_importing;
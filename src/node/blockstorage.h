@@ -13,8 +13,10 @@
 #include <kernel/chainparams.h>
 #include <kernel/cs_main.h>
 #include <kernel/messagestartchars.h>
+#include <node/blockwritequeue.h>
 #include <primitives/block.h>
 #include <streams.h>
+#include <support/allocators/pool.h>
 #include <sync.h>
 #include <uint256.h>
 #include <util/fs.h>
@@ -22,6 +24,7 @@
 
 #include <array>
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <limits>
@@ -31,6 +34,7 @@
 #include <set>
 #include <span>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -61,6 +65,10 @@ public:
     bool ReadFlag(const std::string& name, bool& fValue);
     bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, const util::SignalInterrupt& interrupt)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    //! Identifier of the block index dump matching the current database
+    //! contents, if any. Cleared by every WriteBatchSync().
+    std::optional<uint256> ReadBlockIndexDumpId();
+    bool WriteBlockIndexDumpId(const uint256& id);
 };
 } // namespace kernel
 
@@ -84,7 +92,21 @@ static constexpr uint32_t UNDO_DATA_DISK_OVERHEAD{STORAGE_HEADER_BYTES + uint256
 // we ever switch to another associative container, we need to either use a
 // container that has stable addressing (true of all std associative
 // containers), or make the key a `std::unique_ptr<CBlockIndex>`
-using BlockMap = std::unordered_map<uint256, CBlockIndex, BlockHasher>;
+//
+// Entries are only ever added, mostly in height order, so the map nodes are
+// carved out of a PoolResource instead of being allocated one by one. This
+// saves the per-allocation overhead of the system allocator and keeps a block
+// close to its ancestors in memory, which matters for the pprev/pskip walks
+// done by GetAncestor() and LastCommonAncestor(). See CCoinsMap for the node
+// size reasoning.
+using BlockMap = std::unordered_map<uint256,
+                                    CBlockIndex,
+                                    BlockHasher,
+                                    std::equal_to<uint256>,
+                                    PoolAllocator<std::pair<const uint256, CBlockIndex>,
+                                                  sizeof(std::pair<const uint256, CBlockIndex>) + sizeof(void*) * 4>>;
+
+using BlockMapMemoryResource = BlockMap::allocator_type::ResourceType;
 
 struct CBlockIndexWorkComparator {
     bool operator()(const CBlockIndex* pa, const CBlockIndex* pb) const;
@@ -151,6 +173,18 @@ private:
     bool LoadBlockIndex(const std::optional<uint256>& snapshot_blockhash)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Load all block index entries from the file written by DumpBlockIndex(),
+     * if it exists and still matches the block tree database.
+     *
+     * @param[out] sorted_by_height  The loaded entries, parents before children.
+     * @returns false if the dump could not be used, in which case
+     *          m_block_index is left empty.
+     */
+    bool LoadBlockIndexDump(std::vector<CBlockIndex*>& sorted_by_height)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    fs::path GetBlockIndexDumpPath() const;
+
     /** Return false if block file or undo file flushing fails. */
     [[nodiscard]] bool FlushBlockFile(int blockfile_num, bool fFinalize, bool finalize_undo);
 
@@ -258,10 +292,30 @@ private:
     const FlatFileSeq m_block_file_seq;
     const FlatFileSeq m_undo_file_seq;
 
+    //! Background writer for block and undo data, only set if
+    //! BlockManagerOpts::async_block_writes is enabled.
+    std::unique_ptr<BlockWriteQueue> m_write_queue;
+
+    //! Backing memory for m_block_index nodes. Declared first so it outlives the map.
+    BlockMapMemoryResource m_block_index_memory_resource;
+
+    void ThreadUnlinkPrunedFiles() EXCLUSIVE_LOCKS_REQUIRED(!m_unlink_mutex);
+
+    //! State of the background thread used by ScheduleUnlinkPrunedFiles(),
+    //! which is only started the first time files are scheduled.
+    Mutex m_unlink_mutex;
+    std::condition_variable m_unlink_cv;
+    std::set<int> m_files_to_unlink GUARDED_BY(m_unlink_mutex);
+    //! Whether the thread is currently unlinking files taken from m_files_to_unlink.
+    bool m_unlinking GUARDED_BY(m_unlink_mutex){false};
+    bool m_unlink_stop GUARDED_BY(m_unlink_mutex){false};
+    std::thread m_unlink_thread;
+
 public:
     using Options = kernel::BlockManagerOpts;
 
     explicit BlockManager(const util::SignalInterrupt& interrupt, Options opts);
+    ~BlockManager();
 
     const util::SignalInterrupt& m_interrupt;
     std::atomic<bool> m_importing{false};
@@ -274,7 +328,7 @@ public:
      */
     std::atomic_bool m_blockfiles_indexed{true};
 
-    BlockMap m_block_index GUARDED_BY(cs_main);
+    BlockMap m_block_index GUARDED_BY(cs_main){0, BlockHasher{}, std::equal_to<uint256>{}, &m_block_index_memory_resource};
 
     /**
      * The height of the base block of an assumeutxo snapshot, if one is in use.
@@ -301,6 +355,15 @@ public:
     std::unique_ptr<BlockTreeDB> m_block_tree_db GUARDED_BY(::cs_main);
 
     bool WriteBlockIndexDB() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    /**
+     * Write the complete in-memory block index, including chain work, to a
+     * flat file that LoadBlockIndexDB() can read in a single pass on the next
+     * start. Only does something if -persistblockindex is enabled. The block
+     * tree database is flushed first, and the dump is tied to its state, so
+     * that it is ignored if the database changes afterwards.
+     */
+    bool DumpBlockIndex() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
     bool LoadBlockIndexDB(const std::optional<uint256>& snapshot_blockhash)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
@@ -317,6 +380,8 @@ public:
 
     //! Mark one block file as pruned (modify associated database entries)
     void PruneOneBlockFile(const int fileNumber) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    //! Mark a set of block files as pruned, walking the block index only once
+    void PruneBlockFiles(const std::set<int>& files) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     CBlockIndex* LookupBlockIndex(const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
     const CBlockIndex* LookupBlockIndex(const uint256& hash) const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
@@ -345,6 +410,9 @@ public:
      */
     void UpdateBlockInfo(const CBlock& block, unsigned int nHeight, const FlatFilePos& pos);
 
+    /** Statistics of the background block writer, if -asyncblockwrites is enabled. */
+    std::optional<BlockWriteQueue::Stats> GetWriteQueueStats() const;
+
     /** Whether running in -prune mode. */
     [[nodiscard]] bool IsPruneMode() const { return m_prune_mode; }
 
@@ -402,6 +470,9 @@ public:
     /** Open a block file (blk?????.dat) */
     AutoFile OpenBlockFile(const FlatFilePos& pos, bool fReadOnly) const;
 
+    /** Wait for queued writes to a block file, before reading it through a handle opened earlier. */
+    void WaitForBlockFile(int file_num) const;
+
     /** Translation to a filesystem path */
     fs::path GetBlockPosFilename(const FlatFilePos& pos) const;
 
@@ -410,11 +481,22 @@ public:
      */
     void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune) const;
 
+    /**
+     * Unlink the specified files on a background thread, so that deleting a
+     * large number of files does not hold up validation. Must only be called
+     * once the block index no longer references the files.
+     */
+    void ScheduleUnlinkPrunedFiles(const std::set<int>& setFilesToPrune) EXCLUSIVE_LOCKS_REQUIRED(!m_unlink_mutex);
+
+    /** Wait until all files passed to ScheduleUnlinkPrunedFiles() have been unlinked. */
+    void WaitForPrunedFileUnlinks() EXCLUSIVE_LOCKS_REQUIRED(!m_unlink_mutex);
+
     /** Functions for disk access for blocks */
     bool ReadBlock(CBlock& block, const FlatFilePos& pos, const std::optional<uint256>& expected_hash) const;
     bool ReadBlock(CBlock& block, const CBlockIndex& index) const;
     bool ReadRawBlock(std::vector<std::byte>& block, const FlatFilePos& pos) const;
 
+    bool ReadBlockUndo(CBlockUndo& blockundo, const FlatFilePos& pos, const uint256& prev_hash) const;
     bool ReadBlockUndo(CBlockUndo& blockundo, const CBlockIndex& index) const;
 
     void CleanupBlockRevFiles() const;
@@ -0,0 +1,162 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockwritequeue.h>
+
+#include <kernel/notifications_interface.h>
+#include <logging.h>
+#include <streams.h>
+#include <util/syserror.h>
+#include <util/thread.h>
+#include <util/time.h>
+#include <util/translation.h>
+
+#include <algorithm>
+#include <exception>
+
+namespace node {
+
+BlockWriteQueue::BlockWriteQueue(const FlatFileSeq& block_file_seq, const FlatFileSeq& undo_file_seq, const Obfuscation& obfuscation, kernel::Notifications& notifications)
+    : m_block_file_seq{block_file_seq},
+      m_undo_file_seq{undo_file_seq},
+      m_obfuscation{obfuscation},
+      m_notifications{notifications}
+{
+    m_thread = std::thread(&util::TraceThread, "blkwrite", [this] { ThreadWrite(); });
+}
+
+BlockWriteQueue::~BlockWriteQueue()
+{
+    // Drain the queue before stopping, so that no accepted data is lost.
+    Sync();
+    WITH_LOCK(m_mutex, m_request_stop = true);
+    m_work_cv.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void BlockWriteQueue::Enqueue(Job&& job)
+{
+    {
+        LOCK(m_mutex);
+        job.seq = m_next_seq++;
+        if (!job.is_flush) {
+            m_last_write[{job.kind, job.pos.nFile}] = job.seq;
+            m_stats.bytes_pending += job.data.size();
+        }
+        m_jobs.push_back(std::move(job));
+        m_stats.queue_depth = m_next_seq - 1 - m_done_seq;
+        m_stats.max_queue_depth = std::max(m_stats.max_queue_depth, m_stats.queue_depth);
+    }
+    m_work_cv.notify_one();
+}
+
+void BlockWriteQueue::Write(BlockFileKind kind, const FlatFilePos& pos, DataStream&& data)
+{
+    Enqueue(Job{.seq = 0, .kind = kind, .pos = pos, .data = std::move(data)});
+}
+
+void BlockWriteQueue::Flush(BlockFileKind kind, const FlatFilePos& pos, bool finalize)
+{
+    Enqueue(Job{.seq = 0, .kind = kind, .pos = pos, .data = DataStream{}, .is_flush = true, .finalize = finalize});
+}
+
+void BlockWriteQueue::WaitForFile(BlockFileKind kind, int file_num)
+{
+    WAIT_LOCK(m_mutex, lock);
+    const auto it{m_last_write.find({kind, file_num})};
+    if (it == m_last_write.end()) return;
+    const uint64_t seq{it->second};
+    m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_done_seq >= seq; });
+}
+
+bool BlockWriteQueue::Sync()
+{
+    WAIT_LOCK(m_mutex, lock);
+    const uint64_t seq{m_next_seq - 1};
+    m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_done_seq >= seq; });
+    return m_stats.failures == 0;
+}
+
+BlockWriteQueue::Stats BlockWriteQueue::GetStats() const
+{
+    LOCK(m_mutex);
+    return m_stats;
+}
+
+bool BlockWriteQueue::DoWrite(Job& job) const
+{
+    AutoFile file{SeqFor(job.kind).Open(job.pos), m_obfuscation};
+    if (file.IsNull()) {
+        LogError("Failed to open %s for queued write", job.pos.ToString());
+        return false;
+    }
+    try {
+        // The payload is owned by the job, so obfuscate it in place.
+        file.write_buffer(MakeWritableByteSpan(job.data));
+    } catch (const std::exception& e) {
+        LogError("Queued write failed for %s: %s", job.pos.ToString(), e.what());
+        return false;
+    }
+    if (file.fclose() != 0) {
+        LogError("Failed to close file %s after queued write: %s", job.pos.ToString(), SysErrorString(errno));
+        return false;
+    }
+    return true;
+}
+
+bool BlockWriteQueue::DoFlush(const Job& job)
+{
+    const auto start{SteadyClock::now()};
+    const bool ret{SeqFor(job.kind).Flush(job.pos, job.finalize)};
+    const auto elapsed{std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - start)};
+
+    LOCK(m_mutex);
+    ++m_stats.fsyncs;
+    m_stats.fsync_time_total += elapsed;
+    m_stats.fsync_time_last = elapsed;
+    m_stats.fsync_time_max = std::max(m_stats.fsync_time_max, elapsed);
+    return ret;
+}
+
+void BlockWriteQueue::ThreadWrite()
+{
+    while (true) {
+        Job job;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_work_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return !m_jobs.empty() || m_request_stop; });
+            if (m_jobs.empty()) return; // stop requested and nothing left to do
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        const bool ok{job.is_flush ? DoFlush(job) : DoWrite(job)};
+        if (!ok) {
+            const bool undo{job.kind == BlockFileKind::UNDO};
+            if (job.is_flush) {
+                m_notifications.flushError(undo ? _("Flushing undo file to disk failed. This is likely the result of an I/O error.") :
+                                                  _("Flushing block file to disk failed. This is likely the result of an I/O error."));
+            } else {
+                m_notifications.fatalError(undo ? _("Failed to write undo data.") : _("Failed to write block."));
+            }
+        }
+
+        {
+            LOCK(m_mutex);
+            if (!job.is_flush) {
+                ++m_stats.writes;
+                m_stats.bytes_written += job.data.size();
+                m_stats.bytes_pending -= job.data.size();
+                const auto it{m_last_write.find({job.kind, job.pos.nFile})};
+                if (it != m_last_write.end() && it->second == job.seq) m_last_write.erase(it);
+            }
+            if (!ok) ++m_stats.failures;
+            m_done_seq = job.seq;
+            m_stats.queue_depth = m_next_seq - 1 - m_done_seq;
+        }
+        m_done_cv.notify_all();
+    }
+}
+
+} // namespace node
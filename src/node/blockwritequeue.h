@@ -0,0 +1,144 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITQUANTUM_NODE_BLOCKWRITEQUEUE_H
+#define BITQUANTUM_NODE_BLOCKWRITEQUEUE_H
+
+#include <flatfile.h>
+#include <streams.h>
+#include <sync.h>
+#include <util/obfuscation.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <thread>
+#include <utility>
+
+namespace kernel {
+class Notifications;
+} // namespace kernel
+
+namespace node {
+
+//! Flat file sequence a queued job applies to.
+enum class BlockFileKind : uint8_t {
+    BLOCK, //!< blk?????.dat
+    UNDO,  //!< rev?????.dat
+};
+
+/**
+ * Write-behind queue for block and undo data.
+ *
+ * Callers reserve space in a flat file as usual (FindNextBlockPos /
+ * FindUndoPos) and hand the fully serialized record over together with its
+ * pre-assigned position. A single background thread performs the writes and
+ * the fsyncs in submission order, so a flush that is queued after a write is
+ * guaranteed to cover it.
+ *
+ * Readers that may access a record that is still queued must call
+ * WaitForFile() first. Before persisting block index entries that reference
+ * queued data, Sync() must be called so that only durable positions end up in
+ * the block tree database.
+ *
+ * Errors on the background thread cannot be returned to the caller that
+ * submitted the job, so they are reported through the kernel notifications
+ * interface and make subsequent Sync() calls fail.
+ */
+class BlockWriteQueue
+{
+public:
+    struct Stats {
+        //! Number of jobs (writes and flushes) not yet completed.
+        size_t queue_depth{0};
+        //! Highest queue_depth observed.
+        size_t max_queue_depth{0};
+        //! Bytes of serialized data waiting to be written.
+        uint64_t bytes_pending{0};
+        uint64_t writes{0};
+        uint64_t bytes_written{0};
+        uint64_t fsyncs{0};
+        std::chrono::microseconds fsync_time_total{0};
+        std::chrono::microseconds fsync_time_max{0};
+        std::chrono::microseconds fsync_time_last{0};
+        //! Number of failed background writes or flushes.
+        uint64_t failures{0};
+    };
+
+    BlockWriteQueue(const FlatFileSeq& block_file_seq, const FlatFileSeq& undo_file_seq, const Obfuscation& obfuscation, kernel::Notifications& notifications);
+    ~BlockWriteQueue();
+
+    BlockWriteQueue(const BlockWriteQueue&) = delete;
+    BlockWriteQueue& operator=(const BlockWriteQueue&) = delete;
+
+    /** Queue serialized data to be written to the file at `pos`. */
+    void Write(BlockFileKind kind, const FlatFilePos& pos, DataStream&& data) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Queue a commit of the file containing `pos`, truncating it to pos.nPos if `finalize` is set. */
+    void Flush(BlockFileKind kind, const FlatFilePos& pos, bool finalize) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Wait until all writes queued so far for the given file have reached the OS. */
+    void WaitForFile(BlockFileKind kind, int file_num) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Wait until every job queued so far has completed.
+     *
+     * @return false if any background write or flush has failed since the
+     *         queue was created.
+     */
+    bool Sync() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    Stats GetStats() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Job {
+        uint64_t seq;
+        BlockFileKind kind;
+        FlatFilePos pos;
+        //! Data to write. Empty for flush jobs.
+        DataStream data;
+        bool is_flush{false};
+        bool finalize{false};
+    };
+
+    const FlatFileSeq& SeqFor(BlockFileKind kind) const
+    {
+        return kind == BlockFileKind::BLOCK ? m_block_file_seq : m_undo_file_seq;
+    }
+
+    void Enqueue(Job&& job) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void ThreadWrite() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    bool DoWrite(Job& job) const;
+    bool DoFlush(const Job& job) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    const FlatFileSeq& m_block_file_seq;
+    const FlatFileSeq& m_undo_file_seq;
+    const Obfuscation m_obfuscation;
+    kernel::Notifications& m_notifications;
+
+    mutable Mutex m_mutex;
+    //! Signalled when a job is queued or a stop is requested.
+    std::condition_variable m_work_cv;
+    //! Signalled when a job completes.
+    std::condition_variable m_done_cv;
+
+    std::deque<Job> m_jobs GUARDED_BY(m_mutex);
+    //! Sequence number assigned to the next queued job (starts at 1).
+    uint64_t m_next_seq GUARDED_BY(m_mutex){1};
+    //! All jobs with a sequence number up to and including this have completed.
+    uint64_t m_done_seq GUARDED_BY(m_mutex){0};
+    //! Sequence number of the last write queued per file.
+    std::map<std::pair<BlockFileKind, int>, uint64_t> m_last_write GUARDED_BY(m_mutex);
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+    Stats m_stats GUARDED_BY(m_mutex);
+
+    std::thread m_thread;
+};
+
+} // namespace node
+
+#endif // BITQUANTUM_NODE_BLOCKWRITEQUEUE_H
@@ -7,10 +7,13 @@
 #include <common/args.h>
 #include <txdb.h>
 
+#include <algorithm>
+
 namespace node {
 void ReadCoinsViewArgs(const ArgsManager& args, CoinsViewOptions& options)
 {
     if (auto value = args.GetIntArg("-dbbatchsize")) options.batch_write_bytes = *value;
     if (auto value = args.GetIntArg("-dbcrashratio")) options.simulate_crash_ratio = *value;
+    if (auto value = args.GetIntArg("-dbreadthreads")) options.read_threads = std::max<int64_t>(*value, 1);
 }
 } // namespace node
@@ -23,6 +23,7 @@ class CScheduler;
 class CTxMemPool;
 class ChainstateManager;
 class ECC_Context;
+class IndexSyncCoordinator;
 class NetGroupManager;
 class PeerManager;
 namespace interfaces {
@@ -73,6 +74,8 @@ struct NodeContext {
     std::unique_ptr<BanMan> banman;
     ArgsManager* args{nullptr}; // Currently a raw pointer because the memory is not managed by this struct
     std::vector<BaseIndex*> indexes; // raw pointers because memory is not managed by this struct
+    //! Shared by the indexes during their initial sync, must outlive their sync threads
+    std::unique_ptr<IndexSyncCoordinator> index_sync_coordinator;
     std::unique_ptr<interfaces::Chain> chain;
     //! List of all chain clients (wallet processes or other client) connected to node.
     std::vector<std::unique_ptr<interfaces::ChainClient>> chain_clients;
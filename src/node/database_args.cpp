@@ -6,13 +6,66 @@
 
 #include <common/args.h>
 #include <dbwrapper.h>
+#include <tinyformat.h>
+#include <util/strencodings.h>
+#include <util/translation.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
 
 namespace node {
-void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options)
+namespace {
+constexpr std::array DB_TYPES{DB_TYPE_CHAINSTATE, DB_TYPE_BLOCKS, DB_TYPE_INDEXES};
+
+//! Return the value of a per-database option for `db_type`, or an error if
+//! any value is malformed or out of [min, max].
+util::Result<std::optional<int64_t>> GetDatabaseIntArg(const ArgsManager& args, const std::string& name, std::string_view db_type, int64_t min, int64_t max)
+{
+    std::optional<int64_t> result;
+    for (const std::string& arg : args.GetArgs(name)) {
+        std::string_view value{arg};
+        bool matches{true};
+        if (const auto pos{value.find(':')}; pos != std::string_view::npos) {
+            const std::string_view type{value.substr(0, pos)};
+            if (std::ranges::find(DB_TYPES, type) == DB_TYPES.end()) {
+                return util::Error{Untranslated(strprintf("Unknown database type in %s=%s, must be one of chainstate, blocks or indexes", name, arg))};
+            }
+            matches = type == db_type;
+            value = value.substr(pos + 1);
+        }
+        const auto parsed{ToIntegral<int64_t>(value)};
+        if (!parsed || *parsed < min || *parsed > max) {
+            return util::Error{Untranslated(strprintf("Invalid value for %s=%s, must be between %d and %d", name, arg, min, max))};
+        }
+        if (matches) result = *parsed;
+    }
+    return result;
+}
+} // namespace
+
+util::Result<void> ReadDatabaseArgs(const ArgsManager& args, DBOptions& options, std::string_view db_type)
 {
-    // Settings here apply to all databases (chainstate, blocks, and index
-    // databases), but it'd be easy to parse database-specific options by adding
-    // a database_type string or enum parameter to this function.
     if (auto value = args.GetBoolArg("-forcecompactdb")) options.force_compact = *value;
+
+    auto bloom_bits{GetDatabaseIntArg(args, "-dbbloombits", db_type, 0, 64)};
+    if (!bloom_bits) return util::Error{util::ErrorString(bloom_bits)};
+    if (*bloom_bits) options.bloom_bits = **bloom_bits;
+
+    auto block_cache_percent{GetDatabaseIntArg(args, "-dbblockcachepercent", db_type, 0, 100)};
+    if (!block_cache_percent) return util::Error{util::ErrorString(block_cache_percent)};
+    if (*block_cache_percent) options.block_cache_percent = **block_cache_percent;
+
+    auto max_file_size{GetDatabaseIntArg(args, "-dbmaxfilesize", db_type, 2, 1024)};
+    if (!max_file_size) return util::Error{util::ErrorString(max_file_size)};
+    if (*max_file_size) options.max_file_size = size_t(**max_file_size) << 20;
+
+    auto compact_after{GetDatabaseIntArg(args, "-dbcompactafter", db_type, 0, 1 << 20)};
+    if (!compact_after) return util::Error{util::ErrorString(compact_after)};
+    if (*compact_after) options.compact_after_bytes = size_t(**compact_after) << 20;
+
+    return {};
 }
 } // namespace node
@@ -5,11 +5,28 @@
 #ifndef BITQUANTUM_NODE_DATABASE_ARGS_H
 #define BITQUANTUM_NODE_DATABASE_ARGS_H
 
+#include <util/result.h>
+
+#include <string_view>
+
 class ArgsManager;
 struct DBOptions;
 
 namespace node {
-void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options);
+//! Names selecting the databases a "<db>:<value>" option applies to.
+inline constexpr std::string_view DB_TYPE_CHAINSTATE{"chainstate"};
+inline constexpr std::string_view DB_TYPE_BLOCKS{"blocks"};
+inline constexpr std::string_view DB_TYPE_INDEXES{"indexes"};
+
+/**
+ * Read the options of the databases of type `db_type`. Tuning options may be
+ * given as "<value>" to apply to all databases, or as "<db>:<value>" to
+ * apply to one type only; the last matching value wins.
+ *
+ * Errors are reported for malformed values of any database type, so a
+ * single call at startup validates all of them.
+ */
+util::Result<void> ReadDatabaseArgs(const ArgsManager& args, DBOptions& options, std::string_view db_type);
 } // namespace node
 
 #endif // BITQUANTUM_NODE_DATABASE_ARGS_H
@@ -67,6 +67,7 @@
 #include <any>
 #include <memory>
 #include <optional>
+#include <thread>
 #include <utility>
 
 #include <boost/signals2/signal.hpp>
@@ -581,6 +582,43 @@ public:
         if (index == nullptr || !block_filter_index->LookupFilter(index, filter)) return std::nullopt;
         return filter.GetFilter().MatchAny(filter_set);
     }
+    std::vector<std::pair<uint256, std::optional<bool>>> blockFiltersMatchAny(BlockFilterType filter_type, const uint256& start_block, int max_blocks, const GCSFilter::ElementSet& filter_set) override
+    {
+        std::vector<std::pair<uint256, std::optional<bool>>> results;
+        std::vector<const CBlockIndex*> blocks;
+        {
+            LOCK(::cs_main);
+            const CChain& active{chainman().ActiveChain()};
+            const CBlockIndex* block{chainman().m_blockman.LookupBlockIndex(start_block)};
+            if (!block || !active.Contains(block)) return results;
+            for (; block && std::ssize(blocks) < max_blocks; block = active.Next(block)) {
+                blocks.push_back(block);
+                results.emplace_back(block->GetBlockHash(), std::nullopt);
+            }
+        }
+        const BlockFilterIndex* block_filter_index{GetBlockFilterIndex(filter_type)};
+        if (!block_filter_index || blocks.empty()) return results;
+
+        std::vector<BlockFilter> filters;
+        std::vector<size_t> filter_blocks;
+        if (block_filter_index->LookupFilterRange(blocks.front()->nHeight, blocks.back(), filters)) {
+            for (size_t i = 0; i < blocks.size(); ++i) filter_blocks.push_back(i);
+        } else {
+            // Some filters are missing, e.g. while the index is still syncing.
+            filters.clear();
+            for (size_t i = 0; i < blocks.size(); ++i) {
+                BlockFilter filter;
+                if (!block_filter_index->LookupFilter(blocks[i], filter)) continue;
+                filters.push_back(std::move(filter));
+                filter_blocks.push_back(i);
+            }
+        }
+
+        const int num_threads{static_cast<int>(std::thread::hardware_concurrency())};
+        const std::vector<bool> matches{BlockFiltersMatchAny(filters, filter_set, num_threads)};
+        for (size_t i = 0; i < matches.size(); ++i) results[filter_blocks[i]].second = matches[i];
+        return results;
+    }
     bool findBlock(const uint256& hash, const FoundBlock& block) override
     {
         WAIT_LOCK(cs_main, lock);
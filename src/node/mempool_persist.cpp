@@ -4,11 +4,16 @@
 
 #include <node/mempool_persist.h>
 
+#include <checkqueue.h>
 #include <clientversion.h>
+#include <coins.h>
 #include <consensus/amount.h>
+#include <kernel/mempool_entry.h>
 #include <logging.h>
+#include <policy/policy.h>
 #include <primitives/transaction.h>
 #include <random.h>
+#include <script/interpreter.h>
 #include <serialize.h>
 #include <streams.h>
 #include <sync.h>
@@ -16,20 +21,25 @@
 #include <uint256.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
+#include <util/hasher.h>
 #include <util/obfuscation.h>
 #include <util/signalinterrupt.h>
 #include <util/syserror.h>
 #include <util/time.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <exception>
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
+#include <span>
 #include <stdexcept>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -39,6 +49,93 @@ namespace node {
 
 static const uint64_t MEMPOOL_DUMP_VERSION_NO_XOR_KEY{1};
 static const uint64_t MEMPOOL_DUMP_VERSION{2};
+//! Number of transactions read from the file before their scripts are checked together.
+static constexpr size_t LOAD_BATCH_SIZE{1'000};
+//! Size of the serialized transactions collected before they are written to the file.
+static constexpr size_t DUMP_BUFFER_SIZE{1 << 20};
+
+/**
+ * Look up the outputs spent by a batch of transactions, in the batch itself,
+ * the mempool and the UTXO set. Transactions with missing inputs get no
+ * outputs.
+ */
+static std::vector<std::vector<CTxOut>> FindSpentOutputs(const CTxMemPool& pool, Chainstate& active_chainstate, std::span<const CTransactionRef> txs)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    AssertLockHeld(cs_main);
+    std::unordered_map<Txid, const CTransaction*, SaltedTxidHasher> batch_txs;
+    std::vector<COutPoint> confirmed_prevouts;
+    for (const auto& tx : txs) batch_txs.emplace(tx->GetHash(), tx.get());
+    for (const auto& tx : txs) {
+        for (const auto& txin : tx->vin) {
+            if (!batch_txs.contains(txin.prevout.hash) && !pool.exists(txin.prevout.hash)) confirmed_prevouts.push_back(txin.prevout);
+        }
+    }
+    const CCoinsViewCache& coins_tip{active_chainstate.CoinsTip()};
+    coins_tip.PrefetchCoins(confirmed_prevouts);
+
+    const auto find_output{[&](const COutPoint& prevout) -> std::optional<CTxOut> {
+        const CTransaction* parent{nullptr};
+        CTransactionRef mempool_parent;
+        if (const auto it{batch_txs.find(prevout.hash)}; it != batch_txs.end()) {
+            parent = it->second;
+        } else if ((mempool_parent = pool.get(prevout.hash))) {
+            parent = mempool_parent.get();
+        } else if (const Coin& coin{coins_tip.AccessCoin(prevout)}; !coin.IsSpent()) {
+            return coin.out;
+        }
+        if (!parent || prevout.n >= parent->vout.size()) return std::nullopt;
+        return parent->vout[prevout.n];
+    }};
+
+    std::vector<std::vector<CTxOut>> spent_outputs(txs.size());
+    for (size_t i{0}; i < txs.size(); ++i) {
+        spent_outputs[i].reserve(txs[i]->vin.size());
+        for (const auto& txin : txs[i]->vin) {
+            auto output{find_output(txin.prevout)};
+            if (!output) {
+                spent_outputs[i].clear();
+                break;
+            }
+            spent_outputs[i].push_back(std::move(*output));
+        }
+    }
+    return spent_outputs;
+}
+
+/**
+ * Check the input scripts of a batch of transactions on the mempool script
+ * check threads, so that their signatures are in the signature cache when the
+ * transactions are accepted to the mempool one by one. Transactions without
+ * spent outputs are skipped, and invalid ones are left to mempool acceptance
+ * to reject.
+ *
+ * This runs without cs_main. Mempool acceptance waits for the queue while a
+ * batch is checked, which is bounded by LOAD_BATCH_SIZE.
+ */
+static void PrimeSignatureCache(ChainstateManager& chainman, std::span<const CTransactionRef> txs, std::vector<std::vector<CTxOut>>&& spent_outputs)
+    EXCLUSIVE_LOCKS_REQUIRED(!cs_main)
+{
+    // The checks point into txdata, which must outlive the control.
+    std::vector<PrecomputedTransactionData> txdata(txs.size());
+    CCheckQueueControl<CScriptCheck> control{chainman.GetMempoolCheckQueue()};
+    for (size_t i{0}; i < txs.size(); ++i) {
+        const CTransaction& tx{*txs[i]};
+        if (spent_outputs[i].size() != tx.vin.size()) continue;
+        txdata[i].Init(tx, std::move(spent_outputs[i]));
+
+        std::vector<CScriptCheck> checks;
+        checks.reserve(tx.vin.size());
+        for (unsigned int n{0}; n < tx.vin.size(); ++n) {
+            checks.emplace_back(txdata[i].m_spent_outputs[n], tx, chainman.m_validation_cache.m_signature_cache, n,
+                                STANDARD_SCRIPT_VERIFY_FLAGS, /*cacheIn=*/true, &txdata[i]);
+        }
+        control.Add(std::move(checks));
+    }
+    // A failure only stops the priming early, the transaction is rejected by
+    // mempool acceptance.
+    (void)control.Complete();
+}
 
 bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active_chainstate, ImportMempoolOptions&& opts)
 {
@@ -56,6 +153,8 @@ bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active
     int64_t already_there = 0;
     int64_t unbroadcast = 0;
     const auto now{NodeClock::now()};
+    const auto time_start{SteadyClock::now()};
+    SteadyClock::duration time_priming{};
 
     try {
         uint64_t version;
@@ -76,6 +175,11 @@ bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active
         uint64_t txns_tried = 0;
         LogInfo("Loading %u mempool transactions from file...\n", total_txns_to_load);
         int next_tenth_to_report = 0;
+        // The file is in topological order. Transactions are read in batches,
+        // whose scripts are checked in parallel before the transactions are
+        // accepted to the mempool in file order.
+        std::vector<CTransactionRef> batch;
+        std::vector<int64_t> batch_times;
         while (txns_tried < total_txns_to_load) {
             const int percentage_done(100.0 * txns_tried / total_txns_to_load);
             if (next_tenth_to_report < percentage_done / 10) {
@@ -101,8 +205,23 @@ bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active
                 pool.PrioritiseTransaction(tx->GetHash(), amountdelta);
             }
             if (nTime > TicksSinceEpoch<std::chrono::seconds>(now - pool.m_opts.expiry)) {
+                batch.push_back(std::move(tx));
+                batch_times.push_back(nTime);
+            } else {
+                ++expired;
+            }
+            if (batch.size() < LOAD_BATCH_SIZE && txns_tried < total_txns_to_load) continue;
+
+            if (active_chainstate.m_chainman.GetMempoolCheckQueue().HasThreads()) {
+                // Only the lookups of the spent outputs need cs_main.
+                const auto time_priming_start{SteadyClock::now()};
+                auto spent_outputs{WITH_LOCK(cs_main, return FindSpentOutputs(pool, active_chainstate, batch))};
+                PrimeSignatureCache(active_chainstate.m_chainman, batch, std::move(spent_outputs));
+                time_priming += SteadyClock::now() - time_priming_start;
+            }
+            for (size_t i{0}; i < batch.size(); ++i) {
                 LOCK(cs_main);
-                const auto& accepted = AcceptToMemoryPool(active_chainstate, tx, nTime, /*bypass_limits=*/false, /*test_accept=*/false);
+                const auto& accepted = AcceptToMemoryPool(active_chainstate, batch[i], batch_times[i], /*bypass_limits=*/false, /*test_accept=*/false);
                 if (accepted.m_result_type == MempoolAcceptResult::ResultType::VALID) {
                     ++count;
                 } else {
@@ -110,17 +229,17 @@ bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active
                     // wallet(s) having loaded it while we were processing
                     // mempool transactions; consider these as valid, instead of
                     // failed, but mark them as 'already there'
-                    if (pool.exists(tx->GetHash())) {
+                    if (pool.exists(batch[i]->GetHash())) {
                         ++already_there;
                     } else {
                         ++failed;
                     }
                 }
-            } else {
-                ++expired;
+                if (active_chainstate.m_chainman.m_interrupt)
+                    return false;
             }
-            if (active_chainstate.m_chainman.m_interrupt)
-                return false;
+            batch.clear();
+            batch_times.clear();
         }
         std::map<Txid, CAmount> mapDeltas;
         file >> mapDeltas;
@@ -147,6 +266,8 @@ bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active
     }
 
     LogInfo("Imported mempool transactions from file: %i succeeded, %i failed, %i expired, %i already there, %i waiting for initial broadcast\n", count, failed, expired, already_there, unbroadcast);
+    LogInfo("Imported mempool in %.3fs, %.3fs of which checking scripts in parallel\n",
+            Ticks<SecondsDouble>(SteadyClock::now() - time_start), Ticks<SecondsDouble>(time_priming));
     return true;
 }
 
@@ -154,24 +275,38 @@ bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path, FopenFn mock
 {
     auto start = SteadyClock::now();
 
+    struct DumpEntry {
+        CTransactionRef tx;
+        int64_t time;
+        int64_t fee_delta;
+        uint64_t ancestor_count;
+    };
     std::map<Txid, CAmount> mapDeltas;
-    std::vector<TxMempoolInfo> vinfo;
+    std::vector<DumpEntry> entries;
     std::set<Txid> unbroadcast_txids;
 
     static Mutex dump_mutex;
     LOCK(dump_mutex);
 
     {
+        // Only take references to the transactions while holding the lock,
+        // everything else is done without it.
         LOCK(pool.cs);
         for (const auto &i : pool.mapDeltas) {
             mapDeltas[i.first] = i.second;
         }
-        vinfo = pool.infoAll();
+        entries.reserve(pool.mapTx.size());
+        for (const CTxMemPoolEntry& entry : pool.mapTx) {
+            entries.push_back({entry.GetSharedTx(), count_seconds(entry.GetTime()), entry.GetModifiedFee() - entry.GetFee(), entry.GetCountWithAncestors()});
+        }
         unbroadcast_txids = pool.GetUnbroadcastTxs();
     }
 
     auto mid = SteadyClock::now();
 
+    // Write parents before their children, so that the file can be loaded in order.
+    std::ranges::sort(entries, {}, &DumpEntry::ancestor_count);
+
     const fs::path file_fspath{dump_path + ".new"};
     AutoFile file{mockable_fopen_function(file_fspath, "wb")};
     if (file.IsNull()) {
@@ -190,15 +325,19 @@ bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path, FopenFn mock
             file.SetObfuscation({});
         }
 
-        uint64_t mempool_transactions_to_write(vinfo.size());
+        uint64_t mempool_transactions_to_write(entries.size());
         file << mempool_transactions_to_write;
         LogInfo("Writing %u mempool transactions to file...\n", mempool_transactions_to_write);
-        for (const auto& i : vinfo) {
-            file << TX_WITH_WITNESS(*(i.tx));
-            file << int64_t{count_seconds(i.m_time)};
-            file << int64_t{i.nFeeDelta};
-            mapDeltas.erase(i.tx->GetHash());
+        DataStream buffer;
+        for (const auto& entry : entries) {
+            buffer << TX_WITH_WITNESS(*entry.tx) << entry.time << entry.fee_delta;
+            mapDeltas.erase(entry.tx->GetHash());
+            if (buffer.size() >= DUMP_BUFFER_SIZE) {
+                file.write(buffer);
+                buffer.clear();
+            }
         }
+        file.write(buffer);
 
         file << mapDeltas;
 
@@ -218,7 +357,8 @@ bool DumpMempool(const CTxMemPool& pool, const fs::path& dump_path, FopenFn mock
         }
         auto last = SteadyClock::now();
 
-        LogInfo("Dumped mempool: %.3fs to copy, %.3fs to dump, %d bytes dumped to file\n",
+        LogInfo("Dumped mempool: %u transactions, %.3fs to copy, %.3fs to dump, %d bytes dumped to file\n",
+                  mempool_transactions_to_write,
                   Ticks<SecondsDouble>(mid - start),
                   Ticks<SecondsDouble>(last - mid),
                   fs::file_size(dump_path));
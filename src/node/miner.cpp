@@ -148,7 +148,11 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock()
     int nPackagesSelected = 0;
     int nDescendantsUpdated = 0;
     if (m_mempool) {
-        addPackageTxs(nPackagesSelected, nDescendantsUpdated);
+        // Ancestor feerate selection is also the fallback for a mempool with
+        // clusters too large for the transaction graph to linearize.
+        if (m_options.ancestor_score_selection || !addChunks(nPackagesSelected)) {
+            addPackageTxs(nPackagesSelected, nDescendantsUpdated);
+        }
     }
 
     const auto time_1{SteadyClock::now()};
@@ -247,6 +251,61 @@ void BlockAssembler::AddToBlock(CTxMemPool::txiter iter)
     }
 }
 
+bool BlockAssembler::addChunks(int& nPackagesSelected)
+{
+    const auto& mempool{*Assert(m_mempool)};
+    LOCK(mempool.cs);
+
+    const auto builder{mempool.GetBlockBuilder()};
+    if (!builder) return false;
+
+    // Same heuristic as in addPackageTxs() to finish quickly once the block
+    // is close to full.
+    const int64_t MAX_CONSECUTIVE_FAILURES = 1000;
+    constexpr int32_t BLOCK_FULL_ENOUGH_WEIGHT_DELTA = 4000;
+    int64_t nConsecutiveFailed = 0;
+
+    CTxMemPool::setEntries chunk_entries;
+    while (const auto chunk{builder->GetCurrentChunk()}) {
+        const auto& [refs, chunk_feerate] = *chunk;
+        if (chunk_feerate.fee < m_options.blockMinFeeRate.GetFee(chunk_feerate.size)) {
+            // Chunks are drawn in order of decreasing feerate
+            break;
+        }
+
+        int64_t chunk_sigops_cost{0};
+        chunk_entries.clear();
+        for (const TxGraph::Ref* ref : refs) {
+            const auto& entry{static_cast<const CTxMemPoolEntry&>(*ref)};
+            chunk_sigops_cost += entry.GetSigOpCost();
+            chunk_entries.insert(mempool.mapTx.iterator_to(entry));
+        }
+
+        if (!TestPackage(chunk_feerate.size, chunk_sigops_cost) || !TestPackageTransactions(chunk_entries)) {
+            // Later chunks of the cluster may depend on this one
+            builder->Skip();
+            ++nConsecutiveFailed;
+            if (nConsecutiveFailed > MAX_CONSECUTIVE_FAILURES && nBlockWeight >
+                    m_options.nBlockMaxWeight - BLOCK_FULL_ENOUGH_WEIGHT_DELTA) {
+                // Give up if we're close to full and haven't succeeded in a while
+                break;
+            }
+            continue;
+        }
+        nConsecutiveFailed = 0;
+
+        // The chunk is in linearization order, which is topological.
+        for (const TxGraph::Ref* ref : refs) {
+            AddToBlock(mempool.mapTx.iterator_to(static_cast<const CTxMemPoolEntry&>(*ref)));
+        }
+        builder->Include();
+
+        ++nPackagesSelected;
+        pblocktemplate->m_package_feerates.emplace_back(chunk_feerate.fee, chunk_feerate.size);
+    }
+    return true;
+}
+
 /** Add descendants of given transactions to mapModifiedTx with ancestor
  * state updated assuming given transactions are inBlock. Returns number
  * of updated descendants. */
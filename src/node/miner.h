@@ -176,6 +176,9 @@ public:
         // Whether to call TestBlockValidity() at the end of CreateNewBlock().
         bool test_block_validity{true};
         bool print_modified_fee{DEFAULT_PRINT_MODIFIED_FEE};
+        // Whether to select transactions by ancestor feerate instead of from
+        // the mempool's cluster linearizations. Only used for comparisons.
+        bool ancestor_score_selection{false};
     };
 
     explicit BlockAssembler(Chainstate& chainstate, const CTxMemPool* mempool, const Options& options);
@@ -198,6 +201,14 @@ private:
     void AddToBlock(CTxMemPool::txiter iter);
 
     // Methods for how to add transactions to a block.
+    /** Add the chunks of the mempool's cluster linearizations in order of
+      * decreasing feerate. A chunk that does not fit excludes the rest of its
+      * cluster. Increments nPackagesSelected with the number of chunks added.
+      *
+      * @pre BlockAssembler::m_mempool must not be nullptr
+      * @return false if the mempool has no linearizations to build from
+    */
+    bool addChunks(int& nPackagesSelected) EXCLUSIVE_LOCKS_REQUIRED(!m_mempool->cs);
     /** Add transactions based on feerate including unconfirmed ancestors
       * Increments nPackagesSelected / nDescendantsUpdated with corresponding
       * statistics from the package selection (for logging statistics).
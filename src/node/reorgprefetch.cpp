@@ -0,0 +1,105 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/reorgprefetch.h>
+
+#include <chain.h>
+#include <node/blockstorage.h>
+#include <tinyformat.h>
+#include <util/thread.h>
+
+#include <algorithm>
+
+namespace node {
+
+ReorgPrefetcher::ReorgPrefetcher(const BlockManager& blockman, const std::vector<const CBlockIndex*>& path, int num_threads)
+    : m_blockman{blockman}
+{
+    AssertLockHeld(::cs_main);
+    {
+        LOCK(m_mutex);
+        m_slots.reserve(path.size());
+        for (const CBlockIndex* index : path) {
+            Slot& slot{m_slots.emplace_back()};
+            slot.index = index;
+            slot.hash = index->GetBlockHash();
+            if (index->pprev && (index->nStatus & BLOCK_HAVE_DATA) && (index->nStatus & BLOCK_HAVE_UNDO)) {
+                slot.prev_hash = index->pprev->GetBlockHash();
+                slot.block_pos = index->GetBlockPos();
+                slot.undo_pos = index->GetUndoPos();
+            } else {
+                // Nothing to read, leave it to the caller to report.
+                slot.done = true;
+            }
+        }
+    }
+
+    const int threads{std::min<int>(num_threads, path.size())};
+    for (int n = 0; n < threads; ++n) {
+        m_threads.emplace_back(&util::TraceThread, strprintf("reorgread.%i", n), [this] { ThreadRead(); });
+    }
+}
+
+ReorgPrefetcher::~ReorgPrefetcher()
+{
+    WITH_LOCK(m_mutex, m_request_stop = true);
+    m_work_cv.notify_all();
+    for (std::thread& t : m_threads) t.join();
+}
+
+std::optional<ReorgPrefetcher::Entry> ReorgPrefetcher::Take(const CBlockIndex& index)
+{
+    std::optional<Entry> ret;
+    {
+        WAIT_LOCK(m_mutex, lock);
+        if (m_next_take >= m_slots.size() || m_slots[m_next_take].index != &index) return std::nullopt;
+        Slot& slot{m_slots[m_next_take]};
+        m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return slot.done; });
+        if (slot.ok) ret = std::move(slot.entry);
+        slot.entry = {};
+        ++m_next_take;
+    }
+    // Taking a slot moves the read window forward.
+    m_work_cv.notify_all();
+    return ret;
+}
+
+void ReorgPrefetcher::ThreadRead()
+{
+    while (true) {
+        size_t pos;
+        FlatFilePos block_pos, undo_pos;
+        uint256 hash, prev_hash;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            const auto have_work{[&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                while (m_next_read < m_slots.size() && m_slots[m_next_read].done) ++m_next_read;
+                return m_next_read < m_slots.size() && m_next_read < m_next_take + REORG_PREFETCH_WINDOW;
+            }};
+            m_work_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_request_stop || have_work(); });
+            if (m_request_stop) return;
+            pos = m_next_read++;
+            const Slot& slot{m_slots[pos]};
+            block_pos = slot.block_pos;
+            undo_pos = slot.undo_pos;
+            hash = slot.hash;
+            prev_hash = slot.prev_hash;
+        }
+
+        Entry entry{.block = std::make_shared<CBlock>(), .undo = {}};
+        const bool ok{m_blockman.ReadBlock(*entry.block, block_pos, hash) &&
+                      m_blockman.ReadBlockUndo(entry.undo, undo_pos, prev_hash)};
+
+        {
+            LOCK(m_mutex);
+            Slot& slot{m_slots[pos]};
+            if (ok) slot.entry = std::move(entry);
+            slot.ok = ok;
+            slot.done = true;
+        }
+        m_done_cv.notify_all();
+    }
+}
+
+} // namespace node
@@ -0,0 +1,105 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITQUANTUM_NODE_REORGPREFETCH_H
+#define BITQUANTUM_NODE_REORGPREFETCH_H
+
+#include <flatfile.h>
+#include <primitives/block.h>
+#include <sync.h>
+#include <uint256.h>
+#include <undo.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+class CBlockIndex;
+
+namespace node {
+class BlockManager;
+
+//! Number of threads reading blocks and undo data ahead of a disconnect.
+static constexpr int DEFAULT_REORG_PREFETCH_THREADS{4};
+//! Maximum number of blocks held in memory ahead of the disconnect position.
+static constexpr size_t REORG_PREFETCH_WINDOW{16};
+
+/**
+ * Reads blocks and their undo data for a known disconnect path in parallel.
+ *
+ * A reorg or invalidateblock knows every block it is going to disconnect
+ * before it starts. Reading those one by one from DisconnectTip() leaves the
+ * disk idle while the UTXO set is being updated and vice versa. This class is
+ * given the whole path (tip first) and lets a small pool of threads read
+ * ahead, bounded by REORG_PREFETCH_WINDOW, while the caller consumes the
+ * entries strictly in order through Take().
+ *
+ * The file positions are captured under cs_main at construction, so the
+ * worker threads never need cs_main and the caller may hold it while
+ * waiting on them.
+ */
+class ReorgPrefetcher
+{
+public:
+    /** Data prefetched for one block of the path. */
+    struct Entry {
+        std::shared_ptr<CBlock> block;
+        CBlockUndo undo;
+    };
+
+    ReorgPrefetcher(const BlockManager& blockman, const std::vector<const CBlockIndex*>& path, int num_threads = DEFAULT_REORG_PREFETCH_THREADS)
+        EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    ~ReorgPrefetcher();
+
+    ReorgPrefetcher(const ReorgPrefetcher&) = delete;
+    ReorgPrefetcher& operator=(const ReorgPrefetcher&) = delete;
+
+    /**
+     * Return the prefetched data for the next block of the path, waiting for
+     * it if necessary.
+     *
+     * @return an empty optional if `index` is not the next block of the path
+     *         or if either read failed. The caller is expected to fall back to
+     *         reading the data itself, which also produces the usual errors.
+     */
+    std::optional<Entry> Take(const CBlockIndex& index) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Slot {
+        const CBlockIndex* index;
+        uint256 hash;
+        uint256 prev_hash;
+        FlatFilePos block_pos;
+        FlatFilePos undo_pos;
+        Entry entry;
+        bool done{false};
+        bool ok{false};
+    };
+
+    void ThreadRead() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    const BlockManager& m_blockman;
+
+    Mutex m_mutex;
+    //! Signalled when a slot becomes available for reading or a stop is requested.
+    std::condition_variable m_work_cv;
+    //! Signalled when a slot has been read.
+    std::condition_variable m_done_cv;
+
+    std::vector<Slot> m_slots GUARDED_BY(m_mutex);
+    //! Next slot to be picked up by a worker.
+    size_t m_next_read GUARDED_BY(m_mutex){0};
+    //! Next slot to be handed out by Take().
+    size_t m_next_take GUARDED_BY(m_mutex){0};
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace node
+
+#endif // BITQUANTUM_NODE_REORGPREFETCH_H
@@ -0,0 +1,390 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/snapshotloader.h>
+
+#include <coins.h>
+#include <compressor.h>
+#include <consensus/amount.h>
+#include <dbwrapper.h>
+#include <hash.h>
+#include <kernel/coinstats.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <streams.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <txdb.h>
+#include <util/thread.h>
+#include <util/translation.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace node {
+namespace {
+
+//! Number of batches that may be queued or in flight per worker thread.
+constexpr size_t BATCHES_PER_THREAD{2};
+
+/** A coin as found in the snapshot file, not decoded yet. */
+struct CoinRecord {
+    Txid txid;
+    uint32_t n;
+    //! Position of the serialized Coin in RawBatch::data.
+    size_t offset;
+    size_t size;
+};
+
+struct RawBatch {
+    //! Position of the first record among all coins of the snapshot.
+    uint64_t first_coin{0};
+    std::vector<std::byte> data;
+    std::vector<CoinRecord> records;
+};
+
+/** An error, and the position of the coin that caused it. */
+struct LoadError {
+    uint64_t coin;
+    std::string message;
+};
+
+/** Stream wrapper that appends every byte it reads to a buffer. */
+template <typename S>
+class RecordingReader
+{
+    S& m_src;
+    std::vector<std::byte>& m_out;
+
+public:
+    RecordingReader(S& src, std::vector<std::byte>& out) : m_src{src}, m_out{out} {}
+
+    void read(std::span<std::byte> dst)
+    {
+        m_src.read(dst);
+        m_out.insert(m_out.end(), dst.begin(), dst.end());
+    }
+
+    template <typename T>
+    RecordingReader& operator>>(T&& obj)
+    {
+        ::Unserialize(*this, obj);
+        return *this;
+    }
+};
+
+/**
+ * Copy the serialization of one Coin from `s` to the end of `out`, reading
+ * only as much of it as is needed to find where it ends.
+ *
+ * Oversized scripts are stored as the short invalid script they decode to,
+ * see ScriptCompression::Unser().
+ */
+template <typename Stream>
+void ReadCoinRecord(Stream& s, std::vector<std::byte>& out)
+{
+    RecordingReader rec{s, out};
+    uint32_t code;
+    uint64_t amount;
+    rec >> VARINT(code) >> VARINT(amount);
+
+    const size_t script_pos{out.size()};
+    unsigned int script_size;
+    rec >> VARINT(script_size);
+    if (script_size < ScriptCompression::nSpecialScripts) {
+        const size_t len{GetSpecialScriptSize(script_size)};
+        out.resize(out.size() + len);
+        s.read(std::span{out}.last(len));
+        return;
+    }
+    size_t len{script_size - ScriptCompression::nSpecialScripts};
+    if (len <= MAX_SCRIPT_SIZE) {
+        out.resize(out.size() + len);
+        s.read(std::span{out}.last(len));
+        return;
+    }
+    std::array<std::byte, 4096> skip;
+    while (len > 0) {
+        const size_t chunk{std::min(len, skip.size())};
+        s.read(std::span{skip}.first(chunk));
+        len -= chunk;
+    }
+    out.resize(script_pos);
+    const unsigned int replacement_size{ScriptCompression::nSpecialScripts + 1};
+    DataStream replacement;
+    replacement << VARINT(replacement_size) << static_cast<uint8_t>(OP_RETURN);
+    out.insert(out.end(), replacement.begin(), replacement.end());
+}
+
+/**
+ * Decodes, checks and writes batches of raw coins on a pool of threads, and
+ * hashes them in file order on a dedicated thread.
+ */
+class SnapshotPipeline
+{
+public:
+    SnapshotPipeline(CCoinsViewDB& coins_db, int base_height, int num_threads)
+        : m_coins_db{coins_db}, m_base_height{base_height}, m_max_in_flight{BATCHES_PER_THREAD * num_threads + 1}
+    {
+        for (int n = 0; n < num_threads; ++n) {
+            m_threads.emplace_back(&util::TraceThread, strprintf("snapload.%i", n), [this] { ThreadWork(); });
+        }
+        m_threads.emplace_back(&util::TraceThread, "snaphash", [this] { ThreadHash(); });
+    }
+
+    ~SnapshotPipeline()
+    {
+        WITH_LOCK(m_mutex, m_request_stop = true);
+        m_work_cv.notify_all();
+        m_hash_cv.notify_all();
+        for (std::thread& t : m_threads) t.join();
+    }
+
+    SnapshotPipeline(const SnapshotPipeline&) = delete;
+    SnapshotPipeline& operator=(const SnapshotPipeline&) = delete;
+
+    /** Queue a batch, waiting while too many batches are in flight. */
+    void Submit(RawBatch&& batch) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_submitted - m_hashed < m_max_in_flight; });
+            m_queue.push_back(std::move(batch));
+            ++m_submitted;
+        }
+        m_work_cv.notify_one();
+    }
+
+    /** Wait until every submitted batch has been written and hashed. */
+    void Finish() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_done_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_hashed == m_submitted; });
+    }
+
+    /** The error of the earliest coin found so far, if any. */
+    std::optional<LoadError> Error() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        return m_error;
+    }
+
+    uint64_t CoinsWritten() const { return m_coins_written.load(std::memory_order_relaxed); }
+
+    /** Hash of all submitted coins. Only valid after Finish(). */
+    uint256 GetHash() { return m_hasher.GetHash(); }
+
+private:
+    void ThreadWork() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            RawBatch batch;
+            uint64_t seq;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_work_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_request_stop || !m_queue.empty(); });
+                if (m_request_stop) return;
+                batch = std::move(m_queue.front());
+                m_queue.pop_front();
+                seq = m_next_seq++;
+            }
+
+            DataStream hash_data;
+            std::optional<LoadError> error{Process(batch, hash_data)};
+
+            {
+                LOCK(m_mutex);
+                if (error && (!m_error || error->coin < m_error->coin)) m_error = std::move(error);
+                m_hash_queue.emplace(seq, std::move(hash_data));
+            }
+            m_hash_cv.notify_one();
+        }
+    }
+
+    std::optional<LoadError> Process(const RawBatch& batch, DataStream& hash_data)
+    {
+        std::vector<std::pair<COutPoint, Coin>> coins;
+        coins.reserve(batch.records.size());
+        for (size_t i = 0; i < batch.records.size(); ++i) {
+            const CoinRecord& record{batch.records[i]};
+            const uint64_t coin_pos{batch.first_coin + i};
+            COutPoint outpoint{record.txid, record.n};
+            Coin coin;
+            try {
+                SpanReader{std::span{batch.data}.subspan(record.offset, record.size)} >> coin;
+            } catch (const std::ios_base::failure&) {
+                return LoadError{coin_pos, strprintf("Bad snapshot format or truncated snapshot after deserializing %d coins", coin_pos)};
+            }
+            if (coin.nHeight > m_base_height ||
+                outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
+            ) {
+                return LoadError{coin_pos, strprintf("Bad snapshot data after deserializing %d coins", coin_pos)};
+            }
+            if (!MoneyRange(coin.out.nValue)) {
+                return LoadError{coin_pos, strprintf("Bad snapshot data after deserializing %d coins - bad tx out value", coin_pos)};
+            }
+            kernel::SerializeCoinForHash(hash_data, outpoint, coin);
+            coins.emplace_back(std::move(outpoint), std::move(coin));
+        }
+
+        // Snapshots written by dumptxoutset are already in database order.
+        const auto by_outpoint{[](const auto& a, const auto& b) { return a.first < b.first; }};
+        if (!std::ranges::is_sorted(coins, by_outpoint)) std::ranges::sort(coins, by_outpoint);
+        try {
+            m_coins_db.WriteCoins(coins);
+        } catch (const dbwrapper_error& e) {
+            return LoadError{batch.first_coin, strprintf("Failed to write snapshot coins: %s", e.what())};
+        }
+        m_coins_written.fetch_add(coins.size(), std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    void ThreadHash() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            DataStream data;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_hash_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_request_stop || m_hash_queue.contains(m_hashed); });
+                if (m_request_stop) return;
+                auto node{m_hash_queue.extract(m_hashed)};
+                data = std::move(node.mapped());
+            }
+            m_hasher.write(data);
+            WITH_LOCK(m_mutex, ++m_hashed);
+            m_done_cv.notify_all();
+        }
+    }
+
+    CCoinsViewDB& m_coins_db;
+    const int m_base_height;
+    const size_t m_max_in_flight;
+
+    mutable Mutex m_mutex;
+    //! Signalled when a batch is queued or a stop is requested.
+    std::condition_variable m_work_cv;
+    //! Signalled when the hash data of a batch is ready or a stop is requested.
+    std::condition_variable m_hash_cv;
+    //! Signalled when a batch has been hashed.
+    std::condition_variable m_done_cv;
+
+    std::deque<RawBatch> m_queue GUARDED_BY(m_mutex);
+    //! Sequence number of the next batch taken from m_queue.
+    uint64_t m_next_seq GUARDED_BY(m_mutex){0};
+    uint64_t m_submitted GUARDED_BY(m_mutex){0};
+    //! Serialized coins of processed batches, by sequence number.
+    std::map<uint64_t, DataStream> m_hash_queue GUARDED_BY(m_mutex);
+    //! Number of batches hashed, which is also the sequence number of the next one.
+    uint64_t m_hashed GUARDED_BY(m_mutex){0};
+    std::optional<LoadError> m_error GUARDED_BY(m_mutex);
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+
+    std::atomic<uint64_t> m_coins_written{0};
+    //! Only used by the hashing thread until Finish() returns.
+    HashWriter m_hasher{};
+
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace
+
+util::Result<SnapshotLoadResult> LoadSnapshotCoins(AutoFile& coins_file, CCoinsViewDB& coins_db, const SnapshotLoadOptions& options)
+{
+    SnapshotPipeline pipeline{coins_db, options.base_height, std::clamp(options.num_threads, 1, MAX_SNAPSHOT_LOAD_THREADS)};
+    BufferedReader reader{std::move(coins_file)};
+
+    uint64_t coins_left{options.coins_count};
+    uint64_t coins_read{0};
+    //! Whether the coins are in database order, without duplicates.
+    bool ordered{true};
+    std::optional<Txid> last_txid;
+    std::optional<LoadError> read_error;
+    RawBatch batch;
+
+    const auto submit{[&] {
+        if (batch.records.empty()) return;
+        batch.first_coin = coins_read - batch.records.size();
+        pipeline.Submit(std::move(batch));
+        batch = {};
+        if (options.progress) options.progress(pipeline.CoinsWritten());
+    }};
+
+    try {
+        while (coins_left > 0 && !read_error) {
+            Txid txid;
+            reader >> txid;
+            const size_t coins_per_txid{ReadCompactSize(reader)};
+            if (coins_per_txid > coins_left) {
+                read_error = LoadError{coins_read, "Mismatch in coins count in snapshot metadata and actual snapshot data"};
+                break;
+            }
+            if (last_txid && !(*last_txid < txid)) ordered = false;
+            last_txid = txid;
+
+            std::optional<uint32_t> last_n;
+            for (size_t i = 0; i < coins_per_txid; ++i) {
+                const auto n{static_cast<uint32_t>(ReadCompactSize(reader))};
+                if (last_n && n <= *last_n) ordered = false;
+                last_n = n;
+
+                const size_t offset{batch.data.size()};
+                ReadCoinRecord(reader, batch.data);
+                batch.records.push_back(CoinRecord{txid, n, offset, batch.data.size() - offset});
+                --coins_left;
+                ++coins_read;
+
+                if (batch.records.size() >= SNAPSHOT_LOAD_BATCH_COINS) {
+                    submit();
+                    if (options.interrupted && options.interrupted()) {
+                        return util::Error{Untranslated("Aborting after an interrupt was requested")};
+                    }
+                    // Later coins cannot take precedence over an error that was already found.
+                    if (pipeline.Error()) break;
+                }
+            }
+            if (pipeline.Error()) break;
+        }
+    } catch (const std::ios_base::failure&) {
+        read_error = LoadError{coins_read, strprintf("Bad snapshot format or truncated snapshot after deserializing %d coins", coins_read)};
+    }
+
+    // Coins read before an error are still checked, so that the error of the
+    // earliest coin is reported.
+    submit();
+    pipeline.Finish();
+    if (options.progress) options.progress(pipeline.CoinsWritten());
+
+    std::optional<LoadError> error{pipeline.Error()};
+    if (read_error && (!error || read_error->coin < error->coin)) error = std::move(read_error);
+    if (error) return util::Error{Untranslated(std::move(error->message))};
+
+    bool out_of_coins{false};
+    try {
+        std::byte left_over_byte;
+        reader >> left_over_byte;
+    } catch (const std::ios_base::failure&) {
+        // We expect an exception since we should be out of coins.
+        out_of_coins = true;
+    }
+    if (!out_of_coins) {
+        return util::Error{Untranslated(strprintf("Bad snapshot - coins left over after deserializing %d coins", options.coins_count))};
+    }
+
+    SnapshotLoadResult result;
+    result.coins_loaded = coins_read;
+    if (ordered) result.hash_serialized = pipeline.GetHash();
+    return result;
+}
+
+} // namespace node
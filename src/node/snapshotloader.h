@@ -0,0 +1,71 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITQUANTUM_NODE_SNAPSHOTLOADER_H
+#define BITQUANTUM_NODE_SNAPSHOTLOADER_H
+
+#include <uint256.h>
+#include <util/result.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+class AutoFile;
+class CCoinsViewDB;
+
+namespace node {
+
+//! Maximum number of threads decoding and writing snapshot coins.
+static constexpr int MAX_SNAPSHOT_LOAD_THREADS{8};
+//! Number of coins handed to a worker at once.
+static constexpr size_t SNAPSHOT_LOAD_BATCH_COINS{50'000};
+
+struct SnapshotLoadOptions {
+    //! Height of the snapshot base block. Coins above it are rejected.
+    int base_height{0};
+    //! Number of coins announced by the snapshot metadata.
+    uint64_t coins_count{0};
+    //! Number of threads decoding coins and writing them to the database.
+    int num_threads{1};
+    //! Polled between batches, the load is aborted if it returns true.
+    std::function<bool()> interrupted;
+    //! Called from the loading thread with the number of coins written so far.
+    std::function<void(uint64_t coins_loaded)> progress;
+};
+
+struct SnapshotLoadResult {
+    uint64_t coins_loaded{0};
+    /**
+     * HASH_SERIALIZED of the loaded coins, computed while they were read.
+     *
+     * Only set if the snapshot lists its coins in database order without
+     * duplicates, in which case it equals the hash ComputeUTXOStats() would
+     * return for the database. Otherwise the caller has to compute it from
+     * the database.
+     */
+    std::optional<uint256> hash_serialized;
+};
+
+/**
+ * Load the coins of a UTXO snapshot (as written by dumptxoutset, positioned
+ * right after the metadata) into an empty coins database.
+ *
+ * The calling thread only reads the file and splits it into batches of raw
+ * coin records. A pool of `num_threads` workers decodes and checks each
+ * batch and writes it to `coins_db` through its own CDBBatch, bypassing the
+ * coins cache. A separate thread feeds the coins, in file order, to the
+ * HASH_SERIALIZED hasher, so the content hash is ready as soon as the last
+ * batch has been written.
+ *
+ * Errors are reported with the same messages as the previous sequential
+ * loader; when several batches fail, the error of the earliest coin wins.
+ * The best block of `coins_db` is not touched.
+ */
+util::Result<SnapshotLoadResult> LoadSnapshotCoins(AutoFile& coins_file, CCoinsViewDB& coins_db, const SnapshotLoadOptions& options);
+
+} // namespace node
+
+#endif // BITQUANTUM_NODE_SNAPSHOTLOADER_H
@@ -0,0 +1,232 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/snapshotwriter.h>
+
+#include <coins.h>
+#include <hash.h>
+#include <kernel/coinstats.h>
+#include <logging.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <streams.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <util/check.h>
+#include <util/thread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace node {
+namespace {
+
+//! Size of the snapshot data a range worker collects before handing it over.
+constexpr size_t WRITE_CHUNK_SIZE{1 << 18};
+//! Number of chunks a range worker may queue before it waits for the writing thread.
+constexpr size_t MAX_QUEUED_WRITE_CHUNKS{4};
+
+struct Chunk {
+    //! The coins in the snapshot format.
+    DataStream data{};
+    //! The coins as committed to by HASH_SERIALIZED.
+    DataStream hash_data{};
+    uint64_t coins{0};
+};
+
+//! Thrown inside a range worker when the dump is aborted.
+struct RangeInterrupted {
+};
+
+struct WriteContext {
+    struct Range {
+        std::deque<Chunk> chunks;
+        bool done{false};
+        //! Set if the range could not be read.
+        std::string error;
+    };
+
+    Mutex mutex;
+    //! Signalled when a range queues a chunk or finishes, and when a chunk is consumed.
+    std::condition_variable cv;
+    std::vector<Range> ranges GUARDED_BY(mutex);
+    bool stop GUARDED_BY(mutex){false};
+
+    void Push(size_t range, Chunk&& chunk) EXCLUSIVE_LOCKS_REQUIRED(!mutex)
+    {
+        {
+            WAIT_LOCK(mutex, lock);
+            cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(mutex) { return ranges[range].chunks.size() < MAX_QUEUED_WRITE_CHUNKS || stop; });
+            if (stop) throw RangeInterrupted{};
+            ranges[range].chunks.push_back(std::move(chunk));
+        }
+        cv.notify_all();
+    }
+};
+
+//! Serialize the coins of one txid in the snapshot format.
+void SerializeTxCoins(Chunk& chunk, const Txid& txid, const std::vector<std::pair<uint32_t, Coin>>& coins)
+{
+    chunk.data << txid;
+    WriteCompactSize(chunk.data, coins.size());
+    for (const auto& [n, coin] : coins) {
+        WriteCompactSize(chunk.data, n);
+        chunk.data << coin;
+    }
+    chunk.coins += coins.size();
+
+    // HASH_SERIALIZED orders the outputs of a txid by index, which differs
+    // from the database order (by VARINT serialization) for very large indexes.
+    const auto hash_coins{[&](const auto& sorted) {
+        for (const auto& [n, coin] : sorted) kernel::SerializeCoinForHash(chunk.hash_data, COutPoint{txid, n}, coin);
+    }};
+    if (std::ranges::is_sorted(coins, {}, &std::pair<uint32_t, Coin>::first)) {
+        hash_coins(coins);
+    } else {
+        auto sorted{coins};
+        std::ranges::sort(sorted, {}, &std::pair<uint32_t, Coin>::first);
+        hash_coins(sorted);
+    }
+}
+
+/**
+ * Read the coins of a cursor up to the first txid whose first byte is `end`
+ * or higher, and queue them in chunks.
+ *
+ * To reduce space the serialization format of the snapshot avoids
+ * duplication of tx hashes. The code takes advantage of the guarantee by
+ * leveldb that keys are lexicographically sorted: all coins of a txid are
+ * collected, and written once the next txid is reached.
+ */
+void ReadRange(WriteContext& ctx, size_t range, CCoinsViewCursor& cursor, unsigned int end)
+{
+    Chunk chunk;
+    Txid last_hash;
+    std::vector<std::pair<uint32_t, Coin>> coins;
+    while (cursor.Valid()) {
+        COutPoint key;
+        Coin coin;
+        if (!cursor.GetKey(key)) throw std::runtime_error("Unable to read UTXO set");
+        if (std::to_integer<unsigned int>(*key.hash.begin()) >= end) break;
+        if (!cursor.GetValue(coin)) throw std::runtime_error("Unable to read UTXO set");
+        if (!coins.empty() && key.hash != last_hash) {
+            SerializeTxCoins(chunk, last_hash, coins);
+            coins.clear();
+            if (chunk.data.size() >= WRITE_CHUNK_SIZE) {
+                ctx.Push(range, std::move(chunk));
+                chunk = Chunk{};
+            }
+        }
+        last_hash = key.hash;
+        coins.emplace_back(key.n, std::move(coin));
+        cursor.Next();
+    }
+    if (!coins.empty()) SerializeTxCoins(chunk, last_hash, coins);
+    if (chunk.coins > 0) ctx.Push(range, std::move(chunk));
+}
+
+} // namespace
+
+SnapshotCoinsWriter::SnapshotCoinsWriter(const CCoinsView& view, int num_threads)
+{
+    const int num_ranges{std::clamp(num_threads, 1, MAX_SNAPSHOT_WRITE_THREADS)};
+    for (int i = 0; i <= num_ranges; ++i) m_bounds.push_back(256 * i / num_ranges);
+    for (int i = 0; i < num_ranges; ++i) {
+        uint256 start;
+        start.data()[0] = m_bounds[i];
+        auto cursor{view.CursorFrom(Txid::FromUint256(start))};
+        if (!cursor) {
+            // Views without support for range cursors are read on a single thread.
+            m_cursors.clear();
+            m_cursors.push_back(Assert(view.Cursor()));
+            m_bounds = {0, 256};
+            break;
+        }
+        m_cursors.push_back(std::move(cursor));
+    }
+}
+
+SnapshotCoinsWriter::~SnapshotCoinsWriter() = default;
+
+SnapshotWriteResult SnapshotCoinsWriter::Write(AutoFile& file,
+                                               const std::function<void()>& interruption_point,
+                                               const std::function<void(const SnapshotWriteResult&)>& progress)
+{
+    WriteContext ctx;
+    WITH_LOCK(ctx.mutex, ctx.ranges.resize(m_cursors.size()));
+
+    std::vector<std::thread> threads;
+    // Stop and join the workers on every exit path, including an exception
+    // thrown by the interruption point or by a file write.
+    struct ThreadJoiner {
+        WriteContext& ctx;
+        std::vector<std::thread>& threads;
+        ~ThreadJoiner()
+        {
+            WITH_LOCK(ctx.mutex, ctx.stop = true);
+            ctx.cv.notify_all();
+            for (auto& thread : threads) thread.join();
+        }
+    } joiner{ctx, threads};
+
+    for (size_t i = 0; i < m_cursors.size(); ++i) {
+        threads.emplace_back(&util::TraceThread, strprintf("utxodump.%d", i), [&, i] {
+            std::string error;
+            try {
+                ReadRange(ctx, i, *m_cursors[i], m_bounds[i + 1]);
+            } catch (const RangeInterrupted&) {
+            } catch (const std::exception& e) {
+                LogError("%s: %s\n", __func__, e.what());
+                error = e.what();
+            }
+            {
+                LOCK(ctx.mutex);
+                ctx.ranges[i].done = true;
+                ctx.ranges[i].error = std::move(error);
+            }
+            ctx.cv.notify_all();
+        });
+    }
+
+    SnapshotWriteResult result;
+    HashWriter hasher{};
+    for (size_t i = 0; i < m_cursors.size(); ++i) {
+        while (true) {
+            if (interruption_point) interruption_point();
+            std::optional<Chunk> chunk;
+            {
+                WAIT_LOCK(ctx.mutex, lock);
+                auto& range{ctx.ranges[i]};
+                // Wake up regularly to run the interruption point.
+                ctx.cv.wait_for(lock, std::chrono::milliseconds{100}, [&]() EXCLUSIVE_LOCKS_REQUIRED(ctx.mutex) { return !range.chunks.empty() || range.done; });
+                if (!range.chunks.empty()) {
+                    chunk = std::move(range.chunks.front());
+                    range.chunks.pop_front();
+                } else if (range.done) {
+                    if (!range.error.empty()) throw std::runtime_error(range.error);
+                    break;
+                }
+            }
+            if (!chunk) continue;
+            ctx.cv.notify_all();
+            file.write(chunk->data);
+            hasher.write(chunk->hash_data);
+            result.coins_written += chunk->coins;
+            result.bytes_written += chunk->data.size();
+            if (progress) progress(result);
+        }
+    }
+    result.hash_serialized = hasher.GetHash();
+    return result;
+}
+
+} // namespace node
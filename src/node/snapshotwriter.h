@@ -0,0 +1,76 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITQUANTUM_NODE_SNAPSHOTWRITER_H
+#define BITQUANTUM_NODE_SNAPSHOTWRITER_H
+
+#include <uint256.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class AutoFile;
+class CCoinsView;
+class CCoinsViewCursor;
+
+namespace node {
+
+//! Maximum number of key ranges of the coins database read in parallel by dumptxoutset.
+static constexpr int MAX_SNAPSHOT_WRITE_THREADS{16};
+
+struct SnapshotWriteResult {
+    uint64_t coins_written{0};
+    uint64_t bytes_written{0};
+    //! HASH_SERIALIZED of the written coins, see kernel::ComputeUTXOStats().
+    uint256 hash_serialized;
+};
+
+/**
+ * Writes the coins of a UTXO snapshot (everything after the metadata).
+ *
+ * The coins database is split into `num_threads` key ranges by the first
+ * byte of the txid. Each range is read on its own thread, which serializes
+ * its coins into chunks in the snapshot format. The calling thread writes
+ * the chunks to the file range by range and computes the content hash, so
+ * the output is byte-identical to a sequential dump and no separate pass
+ * over the database is needed to compute the hash or the coins count.
+ */
+class SnapshotCoinsWriter
+{
+public:
+    /**
+     * Open the range cursors. All cursors must see the same state of the
+     * database, so the caller has to make sure it is not written to during
+     * the call (by holding cs_main). The state seen by the cursors is not
+     * affected by later writes.
+     */
+    SnapshotCoinsWriter(const CCoinsView& view, int num_threads);
+    ~SnapshotCoinsWriter();
+
+    SnapshotCoinsWriter(const SnapshotCoinsWriter&) = delete;
+    SnapshotCoinsWriter& operator=(const SnapshotCoinsWriter&) = delete;
+
+    /**
+     * Write the coins to `file`. The interruption point runs on the calling
+     * thread between chunks and may throw to abort. `progress` is called
+     * after each chunk with the totals so far.
+     *
+     * @throws std::ios_base::failure if writing the file or reading the
+     *         database fails.
+     */
+    SnapshotWriteResult Write(AutoFile& file,
+                              const std::function<void()>& interruption_point = {},
+                              const std::function<void(const SnapshotWriteResult&)>& progress = {});
+
+private:
+    std::vector<std::unique_ptr<CCoinsViewCursor>> m_cursors;
+    //! First byte of the txids of each range, followed by 256.
+    std::vector<unsigned int> m_bounds;
+};
+
+} // namespace node
+
+#endif // BITQUANTUM_NODE_SNAPSHOTWRITER_H
@@ -17,9 +17,12 @@
 #include <boost/multi_index/tag.hpp>
 #include <boost/multi_index_container.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 
 namespace node {
 /** Minimum NodeId for lower_bound lookups (in practice, NodeIds start at 0). */
@@ -50,9 +53,9 @@ class TxOrphanageImpl final : public TxOrphanage {
         { }
 
         /** Get an approximation for "memory usage". The total memory is a function of the memory used to store the
-         * transaction itself, each entry in m_orphans, and each entry in m_outpoint_to_orphan_wtxids. We use weight because
+         * transaction itself, each entry in m_orphans, and each entry in m_parent_to_orphan_wtxids. We use weight because
          * it is often higher than the actual memory usage of the transaction. This metric conveniently encompasses
-         * m_outpoint_to_orphan_wtxids usage since input data does not get the witness discount, and makes it easier to
+         * m_parent_to_orphan_wtxids usage since input data does not get the witness discount, and makes it easier to
          * reason about each peer's limits using well-understood transaction attributes. */
         TxOrphanage::Usage GetMemUsage()  const {
             return GetTransactionWeight(*m_tx);
@@ -60,7 +63,7 @@ class TxOrphanageImpl final : public TxOrphanage {
 
         /** Get an approximation of how much this transaction contributes to latency in EraseForBlock and EraseForPeer.
          * The computation time is a function of the number of entries in m_orphans (thus 1 per announcement) and the
-         * number of entries in m_outpoint_to_orphan_wtxids (thus an additional 1 for every 10 inputs). Transactions with a
+         * number of entries in m_parent_to_orphan_wtxids (thus an additional 1 for every 10 inputs). Transactions with a
          * small number of inputs (9 or fewer) are counted as 1 to make it easier to reason about each peer's limits in
          * terms of "normal" transactions. */
         TxOrphanage::Count GetLatencyScore() const {
@@ -115,9 +118,12 @@ class TxOrphanageImpl final : public TxOrphanage {
      * the number of entries in m_orphans. */
     TxOrphanage::Count m_unique_rounded_input_scores{0};
 
-    /** Index from the parents' outputs to wtxids that exist in m_orphans. Used to find children of
-     * a transaction that can be reconsidered and to remove entries that conflict with a block.*/
-    std::unordered_map<COutPoint, std::set<Wtxid>, SaltedOutpointHasher> m_outpoint_to_orphan_wtxids;
+    /** Spent output indexes and wtxids of the orphans spending a parent, ordered by output index. */
+    using Spenders = std::set<std::pair<uint32_t, Wtxid>>;
+    /** Index from the parents' txids to the wtxids that exist in m_orphans and spend their outputs. All children of a
+     * transaction are found with a single lookup, and the spenders of one outpoint are a range of its Spenders. Used to
+     * find children of a transaction that can be reconsidered and to remove entries that conflict with a block.*/
+    std::unordered_map<Txid, Spenders, SaltedTxidHasher> m_parent_to_orphan_wtxids;
 
     /** Set of Wtxids for which (exactly) one announcement with m_reconsider=true exists. */
     std::set<Wtxid> m_reconsiderable_wtxids;
@@ -250,15 +256,15 @@ void TxOrphanageImpl::Erase(Iter<Tag> it)
         m_unique_rounded_input_scores -= it->GetLatencyScore() - 1;
         m_unique_orphan_usage -= it->GetMemUsage();
 
-        // Remove references in m_outpoint_to_orphan_wtxids
+        // Remove references in m_parent_to_orphan_wtxids
         const auto& wtxid{it->m_tx->GetWitnessHash()};
         for (const auto& input : it->m_tx->vin) {
-            auto it_prev = m_outpoint_to_orphan_wtxids.find(input.prevout);
-            if (it_prev != m_outpoint_to_orphan_wtxids.end()) {
-                it_prev->second.erase(wtxid);
+            auto it_parent = m_parent_to_orphan_wtxids.find(input.prevout.hash);
+            if (it_parent != m_parent_to_orphan_wtxids.end()) {
+                it_parent->second.erase({input.prevout.n, wtxid});
                 // Clean up keys if they point to an empty set.
-                if (it_prev->second.empty()) {
-                    m_outpoint_to_orphan_wtxids.erase(it_prev);
+                if (it_parent->second.empty()) {
+                    m_parent_to_orphan_wtxids.erase(it_parent);
                 }
             }
         }
@@ -326,19 +332,18 @@ bool TxOrphanageImpl::AddTx(const CTransactionRef& tx, NodeId peer)
     auto& peer_info = m_peer_orphanage_info.try_emplace(peer).first->second;
     peer_info.Add(*iter);
 
-    // Add links in m_outpoint_to_orphan_wtxids
+    // Add links in m_parent_to_orphan_wtxids
     if (brand_new) {
         for (const auto& input : tx->vin) {
-            auto& wtxids_for_prevout = m_outpoint_to_orphan_wtxids.try_emplace(input.prevout).first->second;
-            wtxids_for_prevout.emplace(wtxid);
+            m_parent_to_orphan_wtxids[input.prevout.hash].emplace(input.prevout.n, wtxid);
         }
 
         m_unique_orphans += 1;
         m_unique_orphan_usage += iter->GetMemUsage();
         m_unique_rounded_input_scores += iter->GetLatencyScore() - 1;
 
-        LogDebug(BCLog::TXPACKAGES, "stored orphan tx %s (wtxid=%s), weight: %u (mapsz %u outsz %u)\n",
-                    txid.ToString(), wtxid.ToString(), sz, m_orphans.size(), m_outpoint_to_orphan_wtxids.size());
+        LogDebug(BCLog::TXPACKAGES, "stored orphan tx %s (wtxid=%s), weight: %u (mapsz %u parentsz %u)\n",
+                    txid.ToString(), wtxid.ToString(), sz, m_orphans.size(), m_parent_to_orphan_wtxids.size());
         Assume(IsUnique(iter));
     } else {
         LogDebug(BCLog::TXPACKAGES, "added peer=%d as announcer of orphan tx %s (wtxid=%s)\n",
@@ -421,7 +426,7 @@ void TxOrphanageImpl::EraseForPeer(NodeId peer)
 
     unsigned int num_ann{0};
     while (it != index_by_peer.end() && it->m_announcer == peer) {
-        // Delete item, cleaning up m_outpoint_to_orphan_wtxids iff this entry is unique by wtxid.
+        // Delete item, cleaning up m_parent_to_orphan_wtxids iff this entry is unique by wtxid.
         Erase<ByPeer>(it++);
         num_ann += 1;
     }
@@ -528,37 +533,38 @@ std::vector<std::pair<Wtxid, NodeId>> TxOrphanageImpl::AddChildrenToWorkSet(cons
 {
     std::vector<std::pair<Wtxid, NodeId>> ret;
     auto& index_by_wtxid = m_orphans.get<ByWtxid>();
-    for (unsigned int i = 0; i < tx.vout.size(); i++) {
-        const auto it_by_prev = m_outpoint_to_orphan_wtxids.find(COutPoint(tx.GetHash(), i));
-        if (it_by_prev != m_outpoint_to_orphan_wtxids.end()) {
-            for (const auto& wtxid : it_by_prev->second) {
-                // If a reconsiderable announcement for this wtxid already exists, skip it.
-                if (m_reconsiderable_wtxids.contains(wtxid)) continue;
-
-                // Belt and suspenders, each entry in m_outpoint_to_orphan_wtxids should always have at least 1 announcement.
-                auto it = index_by_wtxid.lower_bound(ByWtxidView{wtxid, MIN_PEER});
-                if (!Assume(it != index_by_wtxid.end() && it->m_tx->GetWitnessHash() == wtxid)) continue;
-
-                // Select a random peer to assign orphan processing, reducing wasted work if the orphan is still missing
-                // inputs. However, we don't want to create an issue in which the assigned peer can purposefully stop us
-                // from processing the orphan by disconnecting.
-                auto it_end = index_by_wtxid.upper_bound(ByWtxidView{wtxid, MAX_PEER});
-                const auto num_announcers{std::distance(it, it_end)};
-                if (!Assume(num_announcers > 0)) continue;
-                std::advance(it, rng.randrange(num_announcers));
-
-                if (!Assume(it->m_tx->GetWitnessHash() == wtxid)) break;
-
-                // Mark this orphan as ready to be reconsidered.
-                static constexpr auto mark_reconsidered_modifier = [](auto& ann) { ann.m_reconsider = true; };
-                Assume(!it->m_reconsider);
-                index_by_wtxid.modify(it, mark_reconsidered_modifier);
-                ret.emplace_back(wtxid, it->m_announcer);
-                m_reconsiderable_wtxids.insert(wtxid);
-
-                LogDebug(BCLog::TXPACKAGES, "added %s (wtxid=%s) to peer %d workset\n",
-                            it->m_tx->GetHash().ToString(), it->m_tx->GetWitnessHash().ToString(), it->m_announcer);
-            }
+    const auto it_parent = m_parent_to_orphan_wtxids.find(tx.GetHash());
+    if (it_parent != m_parent_to_orphan_wtxids.end()) {
+        for (const auto& [n, wtxid] : it_parent->second) {
+            // Spenders are sorted by output index, the remaining ones spend outputs tx doesn't have.
+            if (n >= tx.vout.size()) break;
+
+            // If a reconsiderable announcement for this wtxid already exists, skip it.
+            if (m_reconsiderable_wtxids.contains(wtxid)) continue;
+
+            // Belt and suspenders, each entry in m_parent_to_orphan_wtxids should always have at least 1 announcement.
+            auto it = index_by_wtxid.lower_bound(ByWtxidView{wtxid, MIN_PEER});
+            if (!Assume(it != index_by_wtxid.end() && it->m_tx->GetWitnessHash() == wtxid)) continue;
+
+            // Select a random peer to assign orphan processing, reducing wasted work if the orphan is still missing
+            // inputs. However, we don't want to create an issue in which the assigned peer can purposefully stop us
+            // from processing the orphan by disconnecting.
+            auto it_end = index_by_wtxid.upper_bound(ByWtxidView{wtxid, MAX_PEER});
+            const auto num_announcers{std::distance(it, it_end)};
+            if (!Assume(num_announcers > 0)) continue;
+            std::advance(it, rng.randrange(num_announcers));
+
+            if (!Assume(it->m_tx->GetWitnessHash() == wtxid)) break;
+
+            // Mark this orphan as ready to be reconsidered.
+            static constexpr auto mark_reconsidered_modifier = [](auto& ann) { ann.m_reconsider = true; };
+            Assume(!it->m_reconsider);
+            index_by_wtxid.modify(it, mark_reconsidered_modifier);
+            ret.emplace_back(wtxid, it->m_announcer);
+            m_reconsiderable_wtxids.insert(wtxid);
+
+            LogDebug(BCLog::TXPACKAGES, "added %s (wtxid=%s) to peer %d workset\n",
+                        it->m_tx->GetHash().ToString(), it->m_tx->GetWitnessHash().ToString(), it->m_announcer);
         }
     }
     return ret;
@@ -617,10 +623,12 @@ void TxOrphanageImpl::EraseForBlock(const CBlock& block)
 
         // Which orphan pool entries must we evict?
         for (const auto& input : block_tx.vin) {
-            auto it_prev = m_outpoint_to_orphan_wtxids.find(input.prevout);
-            if (it_prev != m_outpoint_to_orphan_wtxids.end()) {
-                // Copy all wtxids to wtxids_to_erase.
-                std::copy(it_prev->second.cbegin(), it_prev->second.cend(), std::inserter(wtxids_to_erase, wtxids_to_erase.end()));
+            auto it_parent = m_parent_to_orphan_wtxids.find(input.prevout.hash);
+            if (it_parent == m_parent_to_orphan_wtxids.end()) continue;
+            // Copy the wtxids of all spenders of this outpoint to wtxids_to_erase.
+            const auto& spenders{it_parent->second};
+            for (auto it{spenders.lower_bound({input.prevout.n, Wtxid{}})}; it != spenders.end() && it->first == input.prevout.n; ++it) {
+                wtxids_to_erase.insert(it->second);
             }
         }
     }
@@ -645,27 +653,30 @@ void TxOrphanageImpl::EraseForBlock(const CBlock& block)
 std::vector<CTransactionRef> TxOrphanageImpl::GetChildrenFromSamePeer(const CTransactionRef& parent, NodeId peer) const
 {
     std::vector<CTransactionRef> children_found;
-    const auto& parent_txid{parent->GetHash()};
-
-    // Iterate through all orphans from this peer, in reverse order, so that more recent
-    // transactions are added first. Doing so helps avoid work when one of the orphans replaced
-    // an earlier one. Since we require the NodeId to match, one peer's announcement order does
-    // not bias how we process other peer's orphans.
-    auto& index_by_peer = m_orphans.get<ByPeer>();
-    auto it_upper = index_by_peer.upper_bound(ByPeerView{peer, true, std::numeric_limits<uint64_t>::max()});
-    auto it_lower = index_by_peer.lower_bound(ByPeerView{peer, false, 0});
-
-    while (it_upper != it_lower) {
-        --it_upper;
-        if (!Assume(it_upper->m_announcer == peer)) break;
-        // Check if this tx spends from parent.
-        for (const auto& input : it_upper->m_tx->vin) {
-            if (input.prevout.hash == parent_txid) {
-                children_found.emplace_back(it_upper->m_tx);
-                break;
-            }
-        }
+    const auto it_parent = m_parent_to_orphan_wtxids.find(parent->GetHash());
+    if (it_parent == m_parent_to_orphan_wtxids.end()) return children_found;
+
+    // Look up this peer's announcement of each child. A child spending several outputs of the
+    // parent is listed once per output, so its announcement is deduplicated below.
+    const auto& index_by_wtxid = m_orphans.get<ByWtxid>();
+    std::vector<Iter<ByWtxid>> announcements;
+    for (const auto& [_, wtxid] : it_parent->second) {
+        const auto it = index_by_wtxid.find(ByWtxidView{wtxid, peer});
+        if (it != index_by_wtxid.end()) announcements.push_back(it);
     }
+
+    // Return reconsiderable announcements first, then more recent ones, matching the reverse
+    // order of this peer's ByPeer index. Doing so helps avoid work when one of the orphans
+    // replaced an earlier one. Since we require the NodeId to match, one peer's announcement
+    // order does not bias how we process other peer's orphans.
+    static constexpr auto later_first = [](const auto& left, const auto& right) {
+        return std::tie(left->m_reconsider, left->m_entry_sequence) > std::tie(right->m_reconsider, right->m_entry_sequence);
+    };
+    std::sort(announcements.begin(), announcements.end(), later_first);
+    announcements.erase(std::unique(announcements.begin(), announcements.end()), announcements.end());
+
+    children_found.reserve(announcements.size());
+    for (const auto& it : announcements) children_found.emplace_back(it->m_tx);
     return children_found;
 }
 
@@ -696,12 +707,12 @@ void TxOrphanageImpl::SanityCheck() const
 {
     std::unordered_map<NodeId, PeerDoSInfo> reconstructed_peer_info;
     std::map<Wtxid, std::pair<TxOrphanage::Usage, TxOrphanage::Count>> unique_wtxids_to_scores;
-    std::set<COutPoint> all_outpoints;
+    std::set<std::pair<COutPoint, Wtxid>> all_spends;
     std::set<Wtxid> reconstructed_reconsiderable_wtxids;
 
     for (auto it = m_orphans.begin(); it != m_orphans.end(); ++it) {
         for (const auto& input : it->m_tx->vin) {
-            all_outpoints.insert(input.prevout);
+            all_spends.emplace(input.prevout, it->m_tx->GetWitnessHash());
         }
         unique_wtxids_to_scores.emplace(it->m_tx->GetWitnessHash(), std::make_pair(it->GetMemUsage(), it->GetLatencyScore() - 1));
 
@@ -724,16 +735,17 @@ void TxOrphanageImpl::SanityCheck() const
     // Recalculated set of reconsiderable wtxids must match.
     assert(m_reconsiderable_wtxids == reconstructed_reconsiderable_wtxids);
 
-    // All outpoints exist in m_outpoint_to_orphan_wtxids, all keys in m_outpoint_to_orphan_wtxids correspond to some
-    // orphan, and all wtxids referenced in m_outpoint_to_orphan_wtxids are also in m_orphans.
-    // This ensures m_outpoint_to_orphan_wtxids is cleaned up.
-    assert(all_outpoints.size() == m_outpoint_to_orphan_wtxids.size());
-    for (const auto& [outpoint, wtxid_set] : m_outpoint_to_orphan_wtxids) {
-        assert(all_outpoints.contains(outpoint));
-        for (const auto& wtxid : wtxid_set) {
-            assert(unique_wtxids_to_scores.contains(wtxid));
+    // m_parent_to_orphan_wtxids contains exactly the inputs of all orphans, and no empty sets.
+    // This ensures m_parent_to_orphan_wtxids is cleaned up.
+    size_t num_indexed_spends{0};
+    for (const auto& [parent_txid, spenders] : m_parent_to_orphan_wtxids) {
+        assert(!spenders.empty());
+        for (const auto& [n, wtxid] : spenders) {
+            assert(all_spends.contains({COutPoint{parent_txid, n}, wtxid}));
         }
+        num_indexed_spends += spenders.size();
     }
+    assert(num_indexed_spends == all_spends.size());
 
     // Cached m_unique_orphans value is correct.
     assert(m_orphans.size() >= m_unique_orphans);
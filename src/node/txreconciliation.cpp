@@ -5,10 +5,18 @@
 #include <node/txreconciliation.h>
 
 #include <common/system.h>
+#include <crypto/siphash.h>
 #include <logging.h>
+#include <minisketch.h>
+#include <node/minisketchwrapper.h>
 #include <util/check.h>
+#include <util/hasher.h>
+#include <util/time.h>
 
+#include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <variant>
 
 
@@ -29,6 +37,17 @@ uint256 ComputeSalt(uint64_t salt1, uint64_t salt2)
     return (HashWriter(RECON_SALT_HASHER) << std::min(salt1, salt2) << std::max(salt1, salt2)).GetSHA256();
 }
 
+/**
+ * Capacity of the sketch a responder sends, based on both set sizes and the coefficient q
+ * (see BIP-330): the difference between the set sizes, plus q times the smaller set, plus one.
+ */
+uint32_t EstimateSketchCapacity(size_t local_size, size_t remote_size, double q)
+{
+    const size_t size_diff{local_size > remote_size ? local_size - remote_size : remote_size - local_size};
+    const size_t capacity{size_diff + static_cast<size_t>(q * std::min(local_size, remote_size)) + 1};
+    return static_cast<uint32_t>(std::min<size_t>(capacity, MAX_SKETCH_CAPACITY));
+}
+
 /**
  * Keeps track of txreconciliation-related per-peer state.
  */
@@ -36,9 +55,6 @@ class TxReconciliationState
 {
 public:
     /**
-     * TODO: This field is public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * Reconciliation protocol assumes using one role consistently: either a reconciliation
      * initiator (requesting sketches), or responder (sending sketches). This defines our role,
      * based on the direction of the p2p connection.
@@ -47,14 +63,127 @@ public:
     bool m_we_initiate;
 
     /**
-     * TODO: These fields are public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * These values are used to salt short IDs, which is necessary for transaction reconciliations.
      */
     uint64_t m_k0, m_k1;
 
-    TxReconciliationState(bool we_initiate, uint64_t k0, uint64_t k1) : m_we_initiate(we_initiate), m_k0(k0), m_k1(k1) {}
+    /** Transactions to be reconciled in the next round. */
+    std::unordered_set<Wtxid, SaltedWtxidHasher> m_local_set;
+
+    /** Transactions frozen for the ongoing round, by short ID. */
+    std::unordered_map<uint32_t, Wtxid> m_round_set;
+
+    bool m_round_ongoing{false};
+
+    /** Capacity of the initial sketch of the ongoing round (0 until it is sent or received). */
+    uint32_t m_sketch_capacity{0};
+
+    /** Initiator: the initial sketch received, kept until the extension arrives. */
+    std::vector<unsigned char> m_remote_sketch;
+
+    /** Responder: whether the extension of the ongoing round was already sent. */
+    bool m_extension_sent{false};
+
+    /** Initiator: coefficient q to send with the next request, learnt from the previous round. */
+    double m_q{DEFAULT_RECON_Q};
+
+    /**
+     * When we fall back to flooding if the peer has not made progress: completed the ongoing
+     * round, or (as initiator) started the next one.
+     */
+    NodeClock::time_point m_deadline;
+
+    TxReconciliationState(bool we_initiate, uint64_t k0, uint64_t k1) : m_we_initiate(we_initiate), m_k0(k0), m_k1(k1)
+    {
+        SetIdleDeadline();
+    }
+
+    /** Between rounds, only an initiator which fails to start the next one is timed out. */
+    void SetIdleDeadline()
+    {
+        m_deadline = m_we_initiate ? NodeClock::time_point::max() : NodeClock::now() + RECON_REQUEST_TIMEOUT;
+    }
+
+    /** Short ID of a transaction as specified by BIP-330: 1 + (SipHash(wtxid) mod 0xFFFFFFFF). */
+    uint32_t ComputeShortID(const Wtxid& wtxid) const
+    {
+        return 1 + static_cast<uint32_t>(SipHashUint256(m_k0, m_k1, wtxid.ToUint256()) % 0xFFFFFFFF);
+    }
+
+    /**
+     * Freeze the current set for a new round. On a short ID collision the later transaction is
+     * kept for the next round, as the two would cancel out in a sketch.
+     */
+    void StartRound()
+    {
+        Assume(!m_round_ongoing);
+        for (auto it{m_local_set.begin()}; it != m_local_set.end();) {
+            if (m_round_set.emplace(ComputeShortID(*it), *it).second) {
+                it = m_local_set.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        m_round_ongoing = true;
+        m_deadline = NodeClock::now() + RECON_ROUND_TIMEOUT;
+    }
+
+    void EndRound()
+    {
+        m_round_set.clear();
+        m_round_ongoing = false;
+        m_sketch_capacity = 0;
+        m_remote_sketch.clear();
+        m_extension_sent = false;
+        SetIdleDeadline();
+    }
+
+    Minisketch ComputeSketch(uint32_t capacity) const
+    {
+        Minisketch sketch{node::MakeMinisketch32(capacity)};
+        for (const auto& [short_id, _] : m_round_set) sketch.Add(short_id);
+        return sketch;
+    }
+
+    std::vector<Wtxid> RoundTransactions() const
+    {
+        std::vector<Wtxid> wtxids;
+        wtxids.reserve(m_round_set.size());
+        for (const auto& [_, wtxid] : m_round_set) wtxids.push_back(wtxid);
+        return wtxids;
+    }
+
+    /**
+     * Initiator: try to decode the combination of the remote sketch with ours, and end the round
+     * if that succeeds. The coefficient q for the next round is derived from the decoded
+     * difference.
+     */
+    std::optional<ReconciliationResult> TryDecode(const Minisketch& remote_sketch)
+    {
+        const size_t capacity{remote_sketch.GetCapacity()};
+        const auto difference{ComputeSketch(capacity).Merge(remote_sketch).Decode(capacity)};
+        if (!difference) return std::nullopt;
+
+        ReconciliationResult result{ReconciliationOutcome::SUCCESS, {}, {}};
+        for (const uint64_t short_id : *difference) {
+            const auto it{m_round_set.find(static_cast<uint32_t>(short_id))};
+            if (it != m_round_set.end()) {
+                result.announce.push_back(it->second);
+            } else {
+                result.request.push_back(static_cast<uint32_t>(short_id));
+            }
+        }
+
+        const size_t local_size{m_round_set.size()};
+        const size_t remote_size{local_size - result.announce.size() + result.request.size()};
+        const size_t min_size{std::min(local_size, remote_size)};
+        if (min_size > 0) {
+            const size_t size_diff{local_size > remote_size ? local_size - remote_size : remote_size - local_size};
+            m_q = std::clamp(double(difference->size() - size_diff) / min_size, 0.0, 2.0);
+        }
+        EndRound();
+        return result;
+    }
 };
 
 } // namespace
@@ -76,6 +205,26 @@ private:
      */
     std::unordered_map<NodeId, std::variant<uint64_t, TxReconciliationState>> m_states GUARDED_BY(m_txreconciliation_mutex);
 
+    /** Salt to pick the outbound peers each transaction is flooded to. */
+    const uint64_t m_fanout_k0{FastRandomContext().rand64()};
+    const uint64_t m_fanout_k1{FastRandomContext().rand64()};
+
+    TxReconciliationState* GetRegisteredPeerState(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        AssertLockHeld(m_txreconciliation_mutex);
+        auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&recon_state->second);
+    }
+
+    const TxReconciliationState* GetRegisteredPeerState(NodeId peer_id) const EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        AssertLockHeld(m_txreconciliation_mutex);
+        auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&recon_state->second);
+    }
+
 public:
     explicit Impl(uint32_t recon_version) : m_recon_version(recon_version) {}
 
@@ -121,7 +270,7 @@ public:
                       peer_id, is_peer_inbound);
 
         const uint256 full_salt{ComputeSalt(local_salt, remote_salt)};
-        recon_state->second = TxReconciliationState(!is_peer_inbound, full_salt.GetUint64(0), full_salt.GetUint64(1));
+        recon_state->second.emplace<TxReconciliationState>(!is_peer_inbound, full_salt.GetUint64(0), full_salt.GetUint64(1));
         return ReconciliationRegisterResult::SUCCESS;
     }
 
@@ -142,6 +291,205 @@ public:
         return (recon_state != m_states.end() &&
                 std::holds_alternative<TxReconciliationState>(recon_state->second));
     }
+
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || peer_state->m_local_set.size() >= MAX_RECONSET_SIZE) return false;
+        return peer_state->m_local_set.insert(wtxid).second;
+    }
+
+    bool TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        return peer_state && peer_state->m_local_set.erase(wtxid) > 0;
+    }
+
+    size_t GetSetSize(NodeId peer_id) const EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        const auto* peer_state{GetRegisteredPeerState(peer_id)};
+        return peer_state ? peer_state->m_local_set.size() : 0;
+    }
+
+    bool ShouldFanoutTo(NodeId peer_id, const Wtxid& wtxid, size_t outbound_flooding_peers) const EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        if (outbound_flooding_peers >= OUTBOUND_FANOUT_DESTINATIONS) return false;
+        LOCK(m_txreconciliation_mutex);
+        const auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || !peer_state->m_we_initiate) return false;
+
+        // Flood to the outbound peers whose keys for this transaction are the smallest.
+        auto fanout_key = [&](NodeId id) { return SipHashUint256Extra(m_fanout_k0, m_fanout_k1, wtxid.ToUint256(), static_cast<uint32_t>(id)); };
+        const uint64_t key{fanout_key(peer_id)};
+        size_t smaller_keys{0};
+        for (const auto& [id, state] : m_states) {
+            const auto* other_state{std::get_if<TxReconciliationState>(&state)};
+            if (id != peer_id && other_state && other_state->m_we_initiate && fanout_key(id) < key) ++smaller_keys;
+        }
+        return smaller_keys < OUTBOUND_FANOUT_DESTINATIONS - outbound_flooding_peers;
+    }
+
+    std::optional<std::vector<Wtxid>> ExpireReconciliation(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        const auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || NodeClock::now() < peer_state->m_deadline) return std::nullopt;
+
+        std::vector<Wtxid> announce{peer_state->RoundTransactions()};
+        announce.insert(announce.end(), peer_state->m_local_set.begin(), peer_state->m_local_set.end());
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d timed out (round ongoing=%i), flooding %u transactions\n",
+                      peer_id, peer_state->m_round_ongoing, announce.size());
+        m_states.erase(peer_id);
+        return announce;
+    }
+
+    std::optional<ReconciliationRequest> InitiateReconciliationRequest(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || !peer_state->m_we_initiate || peer_state->m_round_ongoing) return std::nullopt;
+
+        peer_state->StartRound();
+        const ReconciliationRequest request{
+            .set_size = static_cast<uint16_t>(peer_state->m_round_set.size()),
+            .q = static_cast<uint16_t>(peer_state->m_q * Q_PRECISION / 2),
+        };
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Initiate reconciliation with peer=%d (set size=%u, q=%u)\n",
+                      peer_id, request.set_size, request.q);
+        return request;
+    }
+
+    std::optional<std::vector<unsigned char>> HandleReconciliationRequest(NodeId peer_id, const ReconciliationRequest& request)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || peer_state->m_we_initiate || peer_state->m_round_ongoing) return std::nullopt;
+
+        peer_state->StartRound();
+        const double q{request.q * 2.0 / Q_PRECISION};
+        peer_state->m_sketch_capacity = EstimateSketchCapacity(peer_state->m_round_set.size(), request.set_size, q);
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Send sketch to peer=%d (set size=%u, capacity=%u)\n",
+                      peer_id, peer_state->m_round_set.size(), peer_state->m_sketch_capacity);
+        return peer_state->ComputeSketch(peer_state->m_sketch_capacity).Serialize();
+    }
+
+    std::optional<ReconciliationResult> HandleSketch(NodeId peer_id, std::span<const unsigned char> sketch) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        // BIP-330 sends the extension in a sketch message as well.
+        if (peer_state && !peer_state->m_remote_sketch.empty()) return HandleSketchExtension(peer_id, *peer_state, sketch);
+        if (!peer_state || !peer_state->m_we_initiate || !peer_state->m_round_ongoing || peer_state->m_sketch_capacity != 0) {
+            return std::nullopt;
+        }
+        const uint32_t capacity{static_cast<uint32_t>(sketch.size() / sizeof(uint32_t))};
+        if (sketch.size() % sizeof(uint32_t) != 0 || capacity == 0 || capacity > MAX_SKETCH_CAPACITY) return std::nullopt;
+
+        peer_state->m_sketch_capacity = capacity;
+        Minisketch remote_sketch{node::MakeMinisketch32(capacity)};
+        remote_sketch.Deserialize(sketch);
+        if (auto result{peer_state->TryDecode(remote_sketch)}) {
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d succeeded (announce=%u, request=%u)\n",
+                          peer_id, result->announce.size(), result->request.size());
+            return result;
+        }
+        peer_state->m_remote_sketch.assign(sketch.begin(), sketch.end());
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Request sketch extension from peer=%d\n", peer_id);
+        return ReconciliationResult{ReconciliationOutcome::EXTENSION_NEEDED, {}, {}};
+    }
+
+    std::optional<std::vector<unsigned char>> HandleExtensionRequest(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || peer_state->m_we_initiate || !peer_state->m_round_ongoing || peer_state->m_extension_sent) {
+            return std::nullopt;
+        }
+        peer_state->m_extension_sent = true;
+        // A sketch serializes its syndromes in order, so the initial sketch is a prefix of the
+        // sketch with twice its capacity and only the remainder has to be sent.
+        std::vector<unsigned char> extension{peer_state->ComputeSketch(2 * peer_state->m_sketch_capacity).Serialize()};
+        extension.erase(extension.begin(), extension.begin() + peer_state->m_sketch_capacity * sizeof(uint32_t));
+        return extension;
+    }
+
+    std::optional<ReconciliationResult> HandleSketchExtension(NodeId peer_id, std::span<const unsigned char> extension)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state) return std::nullopt;
+        return HandleSketchExtension(peer_id, *peer_state, extension);
+    }
+
+    std::optional<ReconciliationResult> HandleSketchExtension(NodeId peer_id, TxReconciliationState& peer_state, std::span<const unsigned char> extension)
+        EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        AssertLockHeld(m_txreconciliation_mutex);
+        if (!peer_state.m_we_initiate || peer_state.m_remote_sketch.empty() || extension.size() != peer_state.m_remote_sketch.size()) {
+            return std::nullopt;
+        }
+
+        std::vector<unsigned char> extended_sketch{std::move(peer_state.m_remote_sketch)};
+        extended_sketch.insert(extended_sketch.end(), extension.begin(), extension.end());
+        Minisketch remote_sketch{node::MakeMinisketch32(2 * peer_state.m_sketch_capacity)};
+        remote_sketch.Deserialize(extended_sketch);
+        if (auto result{peer_state.TryDecode(remote_sketch)}) {
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Extended reconciliation with peer=%d succeeded (announce=%u, request=%u)\n",
+                          peer_id, result->announce.size(), result->request.size());
+            return result;
+        }
+
+        ReconciliationResult result{ReconciliationOutcome::FAILURE, peer_state.RoundTransactions(), {}};
+        peer_state.EndRound();
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d failed, announcing %u transactions\n",
+                      peer_id, result.announce.size());
+        return result;
+    }
+
+    std::optional<std::vector<Wtxid>> HandleReconciliationDifference(NodeId peer_id, bool success, std::span<const uint32_t> ask_shortids)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state || peer_state->m_we_initiate || !peer_state->m_round_ongoing) return std::nullopt;
+
+        std::vector<Wtxid> announce;
+        if (success) {
+            for (const uint32_t short_id : ask_shortids) {
+                const auto it{peer_state->m_round_set.find(short_id)};
+                if (it != peer_state->m_round_set.end()) announce.push_back(it->second);
+            }
+        } else {
+            announce = peer_state->RoundTransactions();
+        }
+        peer_state->EndRound();
+        return announce;
+    }
+
+    std::optional<uint32_t> ComputeShortID(NodeId peer_id, const Wtxid& wtxid) const EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        const auto* peer_state{GetRegisteredPeerState(peer_id)};
+        if (!peer_state) return std::nullopt;
+        return peer_state->ComputeShortID(wtxid);
+    }
 };
 
 TxReconciliationTracker::TxReconciliationTracker(uint32_t recon_version) : m_impl{std::make_unique<TxReconciliationTracker::Impl>(recon_version)} {}
@@ -168,3 +516,64 @@ bool TxReconciliationTracker::IsPeerRegistered(NodeId peer_id) const
 {
     return m_impl->IsPeerRegistered(peer_id);
 }
+
+bool TxReconciliationTracker::AddToSet(NodeId peer_id, const Wtxid& wtxid)
+{
+    return m_impl->AddToSet(peer_id, wtxid);
+}
+
+bool TxReconciliationTracker::TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid)
+{
+    return m_impl->TryRemovingFromSet(peer_id, wtxid);
+}
+
+size_t TxReconciliationTracker::GetSetSize(NodeId peer_id) const
+{
+    return m_impl->GetSetSize(peer_id);
+}
+
+bool TxReconciliationTracker::ShouldFanoutTo(NodeId peer_id, const Wtxid& wtxid, size_t outbound_flooding_peers) const
+{
+    return m_impl->ShouldFanoutTo(peer_id, wtxid, outbound_flooding_peers);
+}
+
+std::optional<std::vector<Wtxid>> TxReconciliationTracker::ExpireReconciliation(NodeId peer_id)
+{
+    return m_impl->ExpireReconciliation(peer_id);
+}
+
+std::optional<ReconciliationRequest> TxReconciliationTracker::InitiateReconciliationRequest(NodeId peer_id)
+{
+    return m_impl->InitiateReconciliationRequest(peer_id);
+}
+
+std::optional<std::vector<unsigned char>> TxReconciliationTracker::HandleReconciliationRequest(NodeId peer_id, const ReconciliationRequest& request)
+{
+    return m_impl->HandleReconciliationRequest(peer_id, request);
+}
+
+std::optional<ReconciliationResult> TxReconciliationTracker::HandleSketch(NodeId peer_id, std::span<const unsigned char> sketch)
+{
+    return m_impl->HandleSketch(peer_id, sketch);
+}
+
+std::optional<std::vector<unsigned char>> TxReconciliationTracker::HandleExtensionRequest(NodeId peer_id)
+{
+    return m_impl->HandleExtensionRequest(peer_id);
+}
+
+std::optional<ReconciliationResult> TxReconciliationTracker::HandleSketchExtension(NodeId peer_id, std::span<const unsigned char> extension)
+{
+    return m_impl->HandleSketchExtension(peer_id, extension);
+}
+
+std::optional<std::vector<Wtxid>> TxReconciliationTracker::HandleReconciliationDifference(NodeId peer_id, bool success,
+                                                                                          std::span<const uint32_t> ask_shortids)
+{
+    return m_impl->HandleReconciliationDifference(peer_id, success, ask_shortids);
+}
+
+std::optional<uint32_t> TxReconciliationTracker::ComputeShortID(NodeId peer_id, const Wtxid& wtxid) const
+{
+    return m_impl->ComputeShortID(peer_id, wtxid);
+}
@@ -6,14 +6,51 @@
 #define BITQUANTUM_NODE_TXRECONCILIATION_H
 
 #include <net.h>
+#include <primitives/transaction_identifier.h>
 #include <sync.h>
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <tuple>
+#include <vector>
 
 /** Supported transaction reconciliation protocol version */
 static constexpr uint32_t TXRECONCILIATION_VERSION{1};
 
+/** Maximum number of transactions kept in a per-peer reconciliation set. */
+static constexpr size_t MAX_RECONSET_SIZE{3000};
+
+/**
+ * Maximum capacity of an initial sketch (an extension doubles it). Decoding cost grows
+ * quadratically with the capacity, and for larger differences flooding is cheaper anyway.
+ */
+static constexpr uint32_t MAX_SKETCH_CAPACITY{256};
+
+/** Coefficient q (see BIP-330) used for the first reconciliation with a peer. */
+static constexpr double DEFAULT_RECON_Q{0.25};
+
+/** q is transmitted as an integer in [0, Q_PRECISION], scaled from [0, 2]. */
+static constexpr uint16_t Q_PRECISION{(2 << 14) - 1};
+
+/** Time the peer has to complete a reconciliation round before we fall back to flooding. */
+static constexpr std::chrono::seconds RECON_ROUND_TIMEOUT{30};
+
+/**
+ * Time a peer we respond to has to start a round, after registering or after the previous
+ * round, before we fall back to flooding. The initiator requests one every few seconds.
+ */
+static constexpr std::chrono::seconds RECON_REQUEST_TIMEOUT{120};
+
+/**
+ * Number of outbound peers each transaction is flooded to, rather than added to their
+ * reconciliation sets, as recommended by BIP-330. Outbound peers we do not reconcile with
+ * count towards it.
+ */
+static constexpr size_t OUTBOUND_FANOUT_DESTINATIONS{1};
+
 enum class ReconciliationRegisterResult {
     NOT_FOUND,
     SUCCESS,
@@ -21,6 +58,32 @@ enum class ReconciliationRegisterResult {
     PROTOCOL_VIOLATION,
 };
 
+/** Contents of a reconciliation request (reqrecon message), see BIP-330. */
+struct ReconciliationRequest {
+    //! Size of the initiator's reconciliation set.
+    uint16_t set_size;
+    //! Coefficient q, scaled by Q_PRECISION / 2.
+    uint16_t q;
+};
+
+enum class ReconciliationOutcome {
+    //! The difference was decoded. Announce and request the transactions in the result.
+    SUCCESS,
+    //! The sketch was insufficient. Request an extension (reqsktchext message).
+    EXTENSION_NEEDED,
+    //! The extended sketch was insufficient too. Announce the whole set.
+    FAILURE,
+};
+
+/** What the initiator learnt from a sketch received from the peer. */
+struct ReconciliationResult {
+    ReconciliationOutcome outcome;
+    //! Transactions the peer is missing (or, on failure, the whole set), to be announced via inv.
+    std::vector<Wtxid> announce;
+    //! Short IDs of the transactions we are missing, to be requested via reconcildiff.
+    std::vector<uint32_t> request;
+};
+
 /**
  * Transaction reconciliation is a way for nodes to efficiently announce transactions.
  * This object keeps track of all txreconciliation-related communications with the peers.
@@ -43,6 +106,10 @@ enum class ReconciliationRegisterResult {
  * FAILURE. The initiator notifies the peer about the failure and announces all transactions from
  *          the corresponding set. Once the peer received the failure notification, the peer
  *          announces all transactions from their set.
+ *
+ * TIMEOUT. A peer which does not complete a round, or does not start one while we respond to it,
+ *          in time is no longer reconciled with. Its sets are announced and further transactions
+ *          are flooded to it.
 
  * This is a modification of the Erlay protocol (https://arxiv.org/abs/1905.10518) with two
  * changes (sketch extensions instead of bisections, and an extra INV exchange round), both
@@ -84,6 +151,84 @@ public:
      * Check if a peer is registered to reconcile transactions with us.
      */
     bool IsPeerRegistered(NodeId peer_id) const;
+
+    /**
+     * Step 1. Add a transaction to the set of transactions to be reconciled with the peer, instead
+     * of announcing it. Returns false if the peer is not registered, the transaction is already
+     * in the set, or the set is full (in which case the caller should fall back to flooding).
+     */
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid);
+
+    /**
+     * Remove a transaction from the set of the peer, e.g. because it was announced to us by the
+     * peer or evicted from the mempool. Returns whether it was in the set.
+     */
+    bool TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid);
+
+    /** Number of transactions waiting to be reconciled with the peer. */
+    size_t GetSetSize(NodeId peer_id) const;
+
+    /**
+     * Whether to flood a transaction to the peer instead of adding it to its set. Each
+     * transaction is flooded to OUTBOUND_FANOUT_DESTINATIONS outbound peers, picked
+     * pseudorandomly per transaction among those we reconcile with after counting the
+     * outbound_flooding_peers we do not reconcile with.
+     */
+    bool ShouldFanoutTo(NodeId peer_id, const Wtxid& wtxid, size_t outbound_flooding_peers) const;
+
+    /**
+     * Fall back to flooding if the peer did not complete the ongoing round within
+     * RECON_ROUND_TIMEOUT or, if we respond to it, did not start a round within
+     * RECON_REQUEST_TIMEOUT. The peer's state is forgotten, so transactions are flooded to it
+     * from then on, and the transactions of its sets are returned to be announced. Returns
+     * nullopt if the peer is not registered or did not miss a deadline.
+     */
+    std::optional<std::vector<Wtxid>> ExpireReconciliation(NodeId peer_id);
+
+    /**
+     * Step 2 (initiator). Start a reconciliation round with the peer. The current set is frozen
+     * for the round; transactions added meanwhile go to the next round. Returns the request to
+     * send, or nullopt if we are not the initiator for this peer or a round is ongoing.
+     */
+    std::optional<ReconciliationRequest> InitiateReconciliationRequest(NodeId peer_id);
+
+    /**
+     * Step 2 (responder). Handle a reconciliation request from the peer, freezing our set for the
+     * round. Returns the serialized sketch to send back, or nullopt on a protocol violation.
+     */
+    std::optional<std::vector<unsigned char>> HandleReconciliationRequest(NodeId peer_id, const ReconciliationRequest& request);
+
+    /**
+     * Step 3 (initiator). Combine the peer's sketch with ours and try to decode the difference.
+     * Once an extension was requested, the next sketch is the extension (see
+     * HandleSketchExtension), as BIP-330 sends both in sketch messages.
+     * Returns nullopt on a protocol violation (unexpected or malformed sketch).
+     */
+    std::optional<ReconciliationResult> HandleSketch(NodeId peer_id, std::span<const unsigned char> sketch);
+
+    /**
+     * Step 4b (responder). Returns the extension of the sketch sent for the ongoing round (the
+     * additional syndromes of a sketch with twice its capacity), or nullopt on a protocol violation.
+     */
+    std::optional<std::vector<unsigned char>> HandleExtensionRequest(NodeId peer_id);
+
+    /**
+     * Step 4b (initiator). Append the extension to the initial sketch and try to decode the
+     * difference again. The outcome is either SUCCESS or FAILURE. Returns nullopt on a protocol
+     * violation.
+     */
+    std::optional<ReconciliationResult> HandleSketchExtension(NodeId peer_id, std::span<const unsigned char> extension);
+
+    /**
+     * Final step (responder). Handle the outcome of the round reported by the initiator and return
+     * the transactions to announce: those requested on success, the whole set on failure. Unknown
+     * short IDs are ignored. Returns nullopt on a protocol violation.
+     */
+    std::optional<std::vector<Wtxid>> HandleReconciliationDifference(NodeId peer_id, bool success,
+                                                                     std::span<const uint32_t> ask_shortids);
+
+    /** Short ID of a transaction in reconciliations with the peer (nullopt if not registered). */
+    std::optional<uint32_t> ComputeShortID(NodeId peer_id, const Wtxid& wtxid) const;
 };
 
 #endif // BITQUANTUM_NODE_TXRECONCILIATION_H
@@ -0,0 +1,129 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/validation_cache_persist.h>
+
+#include <clientversion.h>
+#include <common/args.h>
+#include <logging.h>
+#include <serialize.h>
+#include <streams.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <uint256.h>
+#include <util/fs.h>
+#include <util/fs_helpers.h>
+#include <util/syserror.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using fsbridge::FopenFn;
+
+namespace node {
+
+static const uint64_t SCRIPT_CACHE_DUMP_VERSION{2};
+
+bool ShouldPersistScriptCache(const ArgsManager& argsman)
+{
+    return argsman.GetBoolArg("-persistscriptcache", DEFAULT_PERSIST_SCRIPT_CACHE);
+}
+
+fs::path ScriptCachePath(const ArgsManager& argsman)
+{
+    return argsman.GetDataDirNet() / "scriptcache.dat";
+}
+
+bool DumpScriptExecutionCache(const ValidationCache& validation_cache, const fs::path& dump_path, FopenFn mockable_fopen_function)
+{
+    AssertLockHeld(::cs_main);
+    const auto start{SteadyClock::now()};
+
+    std::vector<uint256> entries;
+    validation_cache.m_script_execution_cache.for_each([&](const uint256& entry) { entries.push_back(entry); });
+
+    const fs::path file_fspath{dump_path + ".new"};
+    AutoFile file{mockable_fopen_function(file_fspath, "wb")};
+    if (file.IsNull()) {
+        return false;
+    }
+
+    try {
+        file << SCRIPT_CACHE_DUMP_VERSION << FormatFullVersion() << validation_cache.ScriptExecutionCacheSalt() << entries;
+
+        if (!file.Commit()) {
+            (void)file.fclose();
+            throw std::runtime_error("Commit failed");
+        }
+        if (file.fclose() != 0) {
+            throw std::runtime_error(
+                strprintf("Error closing %s: %s", fs::PathToString(file_fspath), SysErrorString(errno)));
+        }
+        if (!RenameOver(dump_path + ".new", dump_path)) {
+            throw std::runtime_error("Rename failed");
+        }
+        LogInfo("Dumped script execution cache: %u entries in %.3fs\n",
+                entries.size(), Ticks<SecondsDouble>(SteadyClock::now() - start));
+    } catch (const std::exception& e) {
+        LogInfo("Failed to dump script execution cache: %s. Continuing anyway.\n", e.what());
+        (void)file.fclose();
+        return false;
+    }
+    return true;
+}
+
+bool LoadScriptExecutionCache(ValidationCache& validation_cache, const fs::path& load_path, FopenFn mockable_fopen_function)
+{
+    AssertLockHeld(::cs_main);
+
+    AutoFile file{mockable_fopen_function(load_path, "rb")};
+    if (file.IsNull()) {
+        LogInfo("Failed to open script execution cache file. Continuing anyway.\n");
+        return false;
+    }
+
+    try {
+        uint64_t version;
+        file >> version;
+        if (version != SCRIPT_CACHE_DUMP_VERSION) {
+            LogInfo("Unknown script execution cache file version %u. Continuing anyway.\n", version);
+            return false;
+        }
+
+        // The entries record that scripts passed the checks of the build
+        // which wrote them, so do not trust them after an upgrade which may
+        // have changed the script interpreter.
+        std::string build;
+        file >> build;
+        if (build != FormatFullVersion()) {
+            LogInfo("Discarding script execution cache file written by a different build (%s). Continuing anyway.\n", build);
+            return false;
+        }
+
+        uint256 salt;
+        std::vector<uint256> entries;
+        file >> salt >> entries;
+
+        // The entries are hashes of the salt, the wtxid and the script
+        // verification flags, so they only match with the salt they were
+        // stored with.
+        validation_cache.SetScriptExecutionCacheSalt(salt);
+        for (const uint256& entry : entries) {
+            validation_cache.m_script_execution_cache.insert(entry);
+        }
+        LogInfo("Loaded %u script execution cache entries from file\n", entries.size());
+    } catch (const std::exception& e) {
+        LogInfo("Failed to deserialize script execution cache file: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    return true;
+}
+
+} // namespace node
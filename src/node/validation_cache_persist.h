@@ -0,0 +1,45 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITQUANTUM_NODE_VALIDATION_CACHE_PERSIST_H
+#define BITQUANTUM_NODE_VALIDATION_CACHE_PERSIST_H
+
+#include <kernel/cs_main.h>
+#include <sync.h>
+#include <util/fs.h>
+
+class ArgsManager;
+class ValidationCache;
+
+namespace node {
+
+/**
+ * Default for -persistscriptcache, indicating whether the node should save the
+ * script execution cache on shutdown and load it on start.
+ */
+static constexpr bool DEFAULT_PERSIST_SCRIPT_CACHE{false};
+
+bool ShouldPersistScriptCache(const ArgsManager& argsman);
+fs::path ScriptCachePath(const ArgsManager& argsman);
+
+/**
+ * Dump the entries of the script execution cache, along with their salt and
+ * the version of this build, to a file.
+ */
+bool DumpScriptExecutionCache(const ValidationCache& validation_cache, const fs::path& dump_path,
+                              fsbridge::FopenFn mockable_fopen_function = fsbridge::fopen)
+    EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+/**
+ * Load a file written by DumpScriptExecutionCache of the same build. The salt
+ * of the cache is replaced with the one of the file, so this should be called
+ * before the cache is used.
+ */
+bool LoadScriptExecutionCache(ValidationCache& validation_cache, const fs::path& load_path,
+                              fsbridge::FopenFn mockable_fopen_function = fsbridge::fopen)
+    EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+} // namespace node
+
+#endif // BITQUANTUM_NODE_VALIDATION_CACHE_PERSIST_H
@@ -23,6 +23,7 @@
 #include <util/time.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cmath>
@@ -557,6 +558,7 @@ CBlockPolicyEstimator::CBlockPolicyEstimator(const fs::path& estimation_filepath
     feeStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE));
     shortStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE));
     longStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE));
+    WITH_LOCK(m_cs_fee_estimator, RefreshSnapshot());
 
     AutoFile est_file{fsbridge::fopen(m_estimation_filepath, "rb")};
 
@@ -713,6 +715,8 @@ void CBlockPolicyEstimator::processBlock(const std::vector<RemovedMempoolTransac
 
     trackedTxs = 0;
     untrackedTxs = 0;
+
+    RefreshSnapshot();
 }
 
 CFeeRate CBlockPolicyEstimator::estimateFee(int confTarget) const
@@ -868,9 +872,9 @@ double CBlockPolicyEstimator::estimateConservativeFee(unsigned int doubleTarget,
  * estimates, however, required the 95% threshold at 2 * target be met for any
  * longer time horizons also.
  */
-CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const
+CFeeRate CBlockPolicyEstimator::estimateSmartFeeLocked(int confTarget, FeeCalculation* feeCalc, bool conservative) const
 {
-    LOCK(m_cs_fee_estimator);
+    AssertLockHeld(m_cs_fee_estimator);
 
     if (feeCalc) {
         feeCalc->desiredTarget = confTarget;
@@ -954,6 +958,75 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
     return CFeeRate(llround(median));
 }
 
+struct CBlockPolicyEstimator::SmartFeeSnapshot {
+    struct Slot {
+        //! Set with release semantics once feerate and calc are filled in.
+        std::atomic<bool> ready{false};
+        CFeeRate feerate;
+        FeeCalculation calc;
+    };
+
+    //! Highest target that can be requested.
+    unsigned int max_confirms;
+    //! Highest target an estimate is given for, higher ones are clamped to it.
+    unsigned int max_usable;
+    //! Economical and conservative answers for targets 2 to max_usable.
+    std::vector<Slot> slots;
+
+    SmartFeeSnapshot(unsigned int max_confirms_in, unsigned int max_usable_in)
+        : max_confirms{max_confirms_in}, max_usable{max_usable_in},
+          slots(max_usable > 1 ? 2 * (max_usable - 1) : 0) {}
+};
+
+void CBlockPolicyEstimator::RefreshSnapshot()
+{
+    AssertLockHeld(m_cs_fee_estimator);
+    auto snapshot{std::make_shared<SmartFeeSnapshot>(longStats->GetMaxConfirms(), MaxUsableEstimate())};
+    WITH_LOCK(m_snapshot_mutex, m_snapshot.swap(snapshot));
+}
+
+CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const
+{
+    // Answers are deliberately frozen per block: each one is computed once
+    // under m_cs_fee_estimator and then served from the snapshot until the
+    // next block is processed, even though transactions entering or leaving
+    // the mempool in between change the unconfirmed counts. The
+    // snapshot pointer is copied under its own mutex as std::atomic<std::shared_ptr>
+    // is not available on all supported standard libraries.
+    const std::shared_ptr<SmartFeeSnapshot> snapshot{WITH_LOCK(m_snapshot_mutex, return m_snapshot)};
+
+    if (feeCalc) {
+        feeCalc->desiredTarget = confTarget;
+        feeCalc->returnedTarget = confTarget;
+    }
+
+    // Return failure if trying to analyze a target we're not tracking
+    if (confTarget <= 0 || (unsigned int)confTarget > snapshot->max_confirms) {
+        return CFeeRate(0);  // error condition
+    }
+
+    // Mirror the target adjustments of estimateSmartFeeLocked.
+    const unsigned int target{std::min(std::max<unsigned int>(confTarget, 2), snapshot->max_usable)};
+    if (target <= 1) {
+        if (feeCalc) feeCalc->returnedTarget = target;
+        return CFeeRate(0); // error condition
+    }
+
+    auto& slot{snapshot->slots[2 * (target - 2) + conservative]};
+    if (!slot.ready.load(std::memory_order_acquire)) {
+        LOCK(m_cs_fee_estimator);
+        if (!slot.ready.load(std::memory_order_relaxed)) {
+            slot.feerate = estimateSmartFeeLocked(target, &slot.calc, conservative);
+            slot.ready.store(true, std::memory_order_release);
+        }
+    }
+    if (feeCalc) {
+        *feeCalc = slot.calc;
+        feeCalc->desiredTarget = confTarget;
+    }
+    return slot.feerate;
+}
+
 void CBlockPolicyEstimator::Flush() {
     FlushUnconfirmed();
     FlushFeeEstimates();
@@ -1052,6 +1125,7 @@ bool CBlockPolicyEstimator::Read(AutoFile& filein)
             nBestSeenHeight = nFileBestSeenHeight;
             historicalFirst = nFileHistoricalFirst;
             historicalBest = nFileHistoricalBest;
+            RefreshSnapshot();
         }
     }
     catch (const std::exception& e) {
@@ -1071,6 +1145,7 @@ void CBlockPolicyEstimator::FlushUnconfirmed()
         auto mi = mapMemPoolTxs.begin();
         _removeTx(mi->first, false); // this calls erase() on mapMemPoolTxs
     }
+    RefreshSnapshot();
     const auto endclear{SteadyClock::now()};
     LogDebug(BCLog::ESTIMATEFEE, "Recorded %u unconfirmed txs from mempool in %.3fs\n", num_entries, Ticks<SecondsDouble>(endclear - startclear));
 }
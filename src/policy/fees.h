@@ -147,6 +147,8 @@ struct FeeCalculation
  */
 class CBlockPolicyEstimator : public CValidationInterface
 {
+    friend class CBlockPolicyEstimatorTester;
+
 private:
     /** Track confirm delays up to 12 blocks for short horizon */
     static constexpr unsigned int SHORT_BLOCK_PERIODS = 12;
@@ -205,7 +207,7 @@ public:
     /** Process all the transactions that have been included in a block */
     void processBlock(const std::vector<RemovedMempoolTransactionInfo>& txs_removed_for_block,
                       unsigned int nBlockHeight)
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator, !m_snapshot_mutex);
 
     /** Process a transaction accepted to the mempool*/
     void processTransaction(const NewMempoolTransactionInfo& tx)
@@ -223,9 +225,15 @@ public:
      *  blocks. If no answer can be given at confTarget, return an estimate at
      *  the closest target where one can be given.  'conservative' estimates are
      *  valid over longer time horizons also.
+     *
+     *  Answers are computed at most once per target and block, and served from
+     *  a snapshot without taking m_cs_fee_estimator afterwards. The answer for
+     *  a target is frozen at its first query after processBlock, Read or
+     *  FlushUnconfirmed: transactions that enter (processTransaction) or leave
+     *  the mempool in between are only reflected after the next block.
      */
     CFeeRate estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator, !m_snapshot_mutex);
 
     /** Return a specific fee estimate calculation with a given success
      * threshold and time horizon, and optionally return detailed data about
@@ -241,11 +249,11 @@ public:
 
     /** Read estimation data from a file */
     bool Read(AutoFile& filein)
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator, !m_snapshot_mutex);
 
     /** Empty mempool transactions on shutdown to record failure to confirm for txs still in mempool */
     void FlushUnconfirmed()
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator, !m_snapshot_mutex);
 
     /** Calculation of highest target that estimates are tracked for */
     unsigned int HighestTargetTracked(FeeEstimateHorizon horizon) const
@@ -253,7 +261,7 @@ public:
 
     /** Drop still unconfirmed transactions and record current estimations, if the fee estimation file is present. */
     void Flush()
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator, !m_snapshot_mutex);
 
     /** Record current fee estimations. */
     void FlushFeeEstimates()
@@ -269,11 +277,17 @@ protected:
     void TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason /*unused*/, uint64_t /*unused*/) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
     void MempoolTransactionsRemovedForBlock(const std::vector<RemovedMempoolTransactionInfo>& txs_removed_for_block, unsigned int nBlockHeight) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator, !m_snapshot_mutex);
 
 private:
     mutable Mutex m_cs_fee_estimator;
 
+    /** estimateSmartFee answers for the current block, filled on first use */
+    struct SmartFeeSnapshot;
+    /** Only held to copy or replace m_snapshot, never while computing estimates */
+    mutable Mutex m_snapshot_mutex;
+    std::shared_ptr<SmartFeeSnapshot> m_snapshot GUARDED_BY(m_snapshot_mutex);
+
     unsigned int nBestSeenHeight GUARDED_BY(m_cs_fee_estimator){0};
     unsigned int firstRecordedHeight GUARDED_BY(m_cs_fee_estimator){0};
     unsigned int historicalFirst GUARDED_BY(m_cs_fee_estimator){0};
@@ -303,6 +317,10 @@ private:
     /** Process a transaction confirmed in a block*/
     bool processBlockTx(unsigned int nBlockHeight, const RemovedMempoolTransactionInfo& tx) EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
 
+    /** Compute the estimateSmartFee answer for a target */
+    CFeeRate estimateSmartFeeLocked(int confTarget, FeeCalculation* feeCalc, bool conservative) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
+    /** Replace the estimateSmartFee snapshot after the tracked data changed */
+    void RefreshSnapshot() EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator, !m_snapshot_mutex);
     /** Helper for estimateSmartFee */
     double estimateCombinedFee(unsigned int confTarget, double successThreshold, bool checkShorterHorizon, EstimationResult *result) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
     /** Helper for estimateSmartFee */
@@ -264,6 +264,28 @@ inline constexpr const char* WTXIDRELAY{"wtxidrelay"};
  * txreconciliation, as described by BIP 330.
  */
 inline constexpr const char* SENDTXRCNCL{"sendtxrcncl"};
+/**
+ * Contains a 2-byte reconciliation set size and a 2-byte coefficient q.
+ * Requests a sketch of the peer's reconciliation set, as described by BIP 330.
+ */
+inline constexpr const char* REQRECON{"reqrecon"};
+/**
+ * Contains a sketch of the sender's reconciliation set, sent in response to
+ * reqrecon or reqsktchext, as described by BIP 330.
+ */
+inline constexpr const char* SKETCH{"sketch"};
+/**
+ * Requests an extension of the sketch last received, after the difference
+ * could not be decoded from it, as described by BIP 330.
+ */
+inline constexpr const char* REQSKTCHEXT{"reqsktchext"};
+/**
+ * Contains a 1-byte success flag and a vector of 4-byte short txids. Finishes
+ * a reconciliation round, requesting the announcement of the transactions
+ * with the given short txids (or the whole set, on failure), as described by
+ * BIP 330.
+ */
+inline constexpr const char* RECONCILDIFF{"reconcildiff"};
 }; // namespace NetMsgType
 
 /** All known message types (see above). Keep this in the same order as the list of messages above. */
@@ -303,6 +325,10 @@ inline const std::array ALL_NET_MESSAGE_TYPES{std::to_array<std::string>({
     NetMsgType::CFCHECKPT,
     NetMsgType::WTXIDRELAY,
     NetMsgType::SENDTXRCNCL,
+    NetMsgType::REQRECON,
+    NetMsgType::SKETCH,
+    NetMsgType::REQSKTCHEXT,
+    NetMsgType::RECONCILDIFF,
 })};
 
 /** nServices flags */
@@ -14,6 +14,7 @@
 #include <flatfile.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
+#include <index/scripthashindex.h>
 #include <index/txindex.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
@@ -754,6 +755,51 @@ static bool rest_deploymentinfo(const std::any& context, HTTPRequest* req, const
 
 }
 
+RPCHelpMan getscripthashhistory();
+RPCHelpMan getscripthashunspent();
+
+static bool rest_scripthash(const std::any& context, HTTPRequest* req, const std::string& uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, uri_part);
+
+    // request is sent over URI scheme /rest/scripthash/<history|unspent>/<scripthash>
+    std::vector<std::string> uri_parts = SplitString(param, '/');
+    if (uri_parts.size() != 2 || (uri_parts[0] != "history" && uri_parts[0] != "unspent")) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/scripthash/<history|unspent>/<scripthash>");
+    }
+
+    if (!uint256::FromHex(uri_parts[1])) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + uri_parts[1]);
+    }
+
+    if (!g_scripthash_index) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Requires -scripthashindex");
+    }
+    if (!g_scripthash_index->BlockUntilSyncedToCurrentChain()) {
+        return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, "Scripthash index is still syncing");
+    }
+
+    switch (rf) {
+    case RESTResponseFormat::JSON: {
+        JSONRPCRequest jsonRequest;
+        jsonRequest.context = context;
+        jsonRequest.params = UniValue(UniValue::VARR);
+        jsonRequest.params.push_back(uri_parts[1]);
+        const UniValue result{uri_parts[0] == "history" ? getscripthashhistory().HandleRequest(jsonRequest) :
+                                                          getscripthashunspent().HandleRequest(jsonRequest)};
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, result.write() + "\n");
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+    }
+}
+
 static bool rest_mempool(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
 {
     if (!CheckWarmup(req))
@@ -1130,6 +1176,7 @@ static const struct {
       {"/rest/deploymentinfo", rest_deploymentinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
       {"/rest/spenttxouts/", rest_spent_txouts},
+      {"/rest/scripthash/", rest_scripthash},
 };
 
 void StartREST(const std::any& context)
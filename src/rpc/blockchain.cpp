@@ -12,6 +12,7 @@
 #include <clientversion.h>
 #include <coins.h>
 #include <common/args.h>
+#include <common/system.h>
 #include <consensus/amount.h>
 #include <consensus/params.h>
 #include <consensus/validation.h>
@@ -22,6 +23,7 @@
 #include <hash.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/scripthashindex.h>
 #include <interfaces/mining.h>
 #include <kernel/coinstats.h>
 #include <logging/timer.h>
@@ -29,6 +31,7 @@
 #include <net_processing.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
+#include <node/snapshotwriter.h>
 #include <node/transaction.h>
 #include <node/utxo_snapshot.h>
 #include <node/warnings.h>
@@ -48,6 +51,7 @@
 #include <util/fs.h>
 #include <util/strencodings.h>
 #include <util/syserror.h>
+#include <util/time.h>
 #include <util/translation.h>
 #include <validation.h>
 #include <validationinterface.h>
@@ -72,16 +76,13 @@ using node::NodeContext;
 using node::SnapshotMetadata;
 using util::MakeUnorderedList;
 
-std::tuple<std::unique_ptr<CCoinsViewCursor>, CCoinsStats, const CBlockIndex*>
-PrepareUTXOSnapshot(
-    Chainstate& chainstate,
-    const std::function<void()>& interruption_point = {})
+std::pair<std::unique_ptr<node::SnapshotCoinsWriter>, const CBlockIndex*>
+PrepareUTXOSnapshot(Chainstate& chainstate)
     EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
 UniValue WriteUTXOSnapshot(
     Chainstate& chainstate,
-    CCoinsViewCursor* pcursor,
-    CCoinsStats* maybe_stats,
+    node::SnapshotCoinsWriter& writer,
     const CBlockIndex* tip,
     AutoFile&& afile,
     const fs::path& path,
@@ -976,7 +977,7 @@ static std::optional<kernel::CCoinsStats> GetUTXOStats(CCoinsView* view, node::B
     // best block.
     CHECK_NONFATAL(!pindex || pindex->GetBlockHash() == view->GetBestBlock());
 
-    return kernel::ComputeUTXOStats(hash_type, view, blockman, interruption_point);
+    return kernel::ComputeUTXOStats(hash_type, view, blockman, interruption_point, std::clamp(GetNumCores(), 1, kernel::MAX_UTXO_HASH_THREADS));
 }
 
 static RPCHelpMan gettxoutsetinfo()
@@ -1343,6 +1344,19 @@ RPCHelpMan getblockchaininfo()
                 {RPCResult::Type::BOOL, "automatic_pruning", /*optional=*/true, "whether automatic pruning is enabled (only present if pruning is enabled)"},
                 {RPCResult::Type::NUM, "prune_target_size", /*optional=*/true, "the target size used by pruning (only present if automatic pruning is enabled)"},
                 {RPCResult::Type::STR_HEX, "signet_challenge", /*optional=*/true, "the block challenge (aka. block script), in hexadecimal (only present if the current network is a signet)"},
+                {RPCResult::Type::OBJ, "blockwritequeue", /*optional=*/true, "statistics of the background block writer (only present if -asyncblockwrites is enabled)",
+                {
+                    {RPCResult::Type::NUM, "queue_depth", "number of queued writes and flushes not yet completed"},
+                    {RPCResult::Type::NUM, "max_queue_depth", "highest queue depth observed"},
+                    {RPCResult::Type::NUM, "bytes_pending", "bytes of block and undo data waiting to be written"},
+                    {RPCResult::Type::NUM, "writes", "number of completed writes"},
+                    {RPCResult::Type::NUM, "bytes_written", "number of bytes written"},
+                    {RPCResult::Type::NUM, "fsyncs", "number of completed file flushes"},
+                    {RPCResult::Type::NUM, "fsync_time_total_us", "total time spent flushing files, in microseconds"},
+                    {RPCResult::Type::NUM, "fsync_time_max_us", "longest single file flush, in microseconds"},
+                    {RPCResult::Type::NUM, "fsync_time_last_us", "duration of the most recent file flush, in microseconds"},
+                    {RPCResult::Type::NUM, "failures", "number of failed writes or flushes"},
+                }},
                 (IsDeprecatedRPCEnabled("warnings") ?
                     RPCResult{RPCResult::Type::STR, "warnings", "any network and blockchain warnings (DEPRECATED)"} :
                     RPCResult{RPCResult::Type::ARR, "warnings", "any network and blockchain warnings (run with `-deprecatedrpc=warnings` to return the latest warning as a single string)",
@@ -1394,6 +1408,20 @@ RPCHelpMan getblockchaininfo()
             chainman.GetParams().GetConsensus().signet_challenge;
         obj.pushKV("signet_challenge", HexStr(signet_challenge));
     }
+    if (const auto write_stats{chainman.m_blockman.GetWriteQueueStats()}) {
+        UniValue queue(UniValue::VOBJ);
+        queue.pushKV("queue_depth", write_stats->queue_depth);
+        queue.pushKV("max_queue_depth", write_stats->max_queue_depth);
+        queue.pushKV("bytes_pending", write_stats->bytes_pending);
+        queue.pushKV("writes", write_stats->writes);
+        queue.pushKV("bytes_written", write_stats->bytes_written);
+        queue.pushKV("fsyncs", write_stats->fsyncs);
+        queue.pushKV("fsync_time_total_us", Ticks<std::chrono::microseconds>(write_stats->fsync_time_total));
+        queue.pushKV("fsync_time_max_us", Ticks<std::chrono::microseconds>(write_stats->fsync_time_max));
+        queue.pushKV("fsync_time_last_us", Ticks<std::chrono::microseconds>(write_stats->fsync_time_last));
+        queue.pushKV("failures", write_stats->failures);
+        obj.pushKV("blockwritequeue", std::move(queue));
+    }
 
     NodeContext& node = EnsureAnyNodeContext(request.context);
     obj.pushKV("warnings", node::GetWarningsForRpc(*CHECK_NONFATAL(node.warnings), IsDeprecatedRPCEnabled("warnings")));
@@ -2958,6 +2986,148 @@ static RPCHelpMan getblockfilter()
     };
 }
 
+/** Return the scripthash index after waiting for it to catch up with the active chain. */
+static ScriptHashIndex& EnsureSyncedScriptHashIndex()
+{
+    if (!g_scripthash_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Requires -scripthashindex");
+    }
+    if (!g_scripthash_index->BlockUntilSyncedToCurrentChain()) {
+        const IndexSummary summary{g_scripthash_index->GetSummary()};
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Unable to get data because scripthashindex is still syncing. Current height: %d", summary.best_block_height));
+    }
+    return *g_scripthash_index;
+}
+
+static const std::vector<RPCResult> SCRIPTHASH_ENTRY_FIELDS{
+    {RPCResult::Type::STR_HEX, "txid", "The transaction id"},
+    {RPCResult::Type::NUM, "height", "The height of the block containing the transaction"},
+    {RPCResult::Type::STR_HEX, "blockhash", "The hash of the block containing the transaction"},
+    {RPCResult::Type::NUM, "position", "The position of the transaction in its block"},
+    {RPCResult::Type::STR_AMOUNT, "amount", "The amount received or spent in " + CURRENCY_UNIT},
+};
+
+static UniValue ScriptHashEntryToJSON(const ScriptHashIndex::HistoryEntry& entry, const CChain& active_chain) EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("txid", entry.txid.GetHex());
+    obj.pushKV("height", entry.height);
+    const CBlockIndex* pindex{active_chain[entry.height]};
+    obj.pushKV("blockhash", pindex ? pindex->GetBlockHash().GetHex() : uint256{}.GetHex());
+    obj.pushKV("position", entry.tx_pos);
+    obj.pushKV("amount", ValueFromAmount(entry.amount));
+    return obj;
+}
+
+RPCHelpMan getscripthashhistory()
+{
+    std::vector<RPCResult> entry_fields{SCRIPTHASH_ENTRY_FIELDS};
+    entry_fields.emplace_back(RPCResult::Type::STR, "type", "\"receive\" for an output paying to the script, \"spend\" for an input spending from it");
+    entry_fields.emplace_back(RPCResult::Type::NUM, "vout", /*optional=*/true, "The output index (receive only)");
+    entry_fields.emplace_back(RPCResult::Type::NUM, "vin", /*optional=*/true, "The input index (spend only)");
+    entry_fields.emplace_back(RPCResult::Type::OBJ, "prevout", /*optional=*/true, "The spent output (spend only)",
+        std::vector<RPCResult>{
+            {RPCResult::Type::STR_HEX, "txid", "The id of the transaction that created the output"},
+            {RPCResult::Type::NUM, "vout", "The output index"},
+        });
+    return RPCHelpMan{
+        "getscripthashhistory",
+        "Return the confirmed transactions paying to or spending from a script.\n"
+        "Requires -scripthashindex.\n",
+        {
+            {"scripthash", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The SHA256 hash of the scriptPubKey, in byte-reversed hex"},
+            {"from_height", RPCArg::Type::NUM, RPCArg::Default{0}, "Only return transactions in blocks at or above this height"},
+        },
+        RPCResult{
+            RPCResult::Type::ARR, "", "The transactions, in chain order",
+            {
+                {RPCResult::Type::OBJ, "", "", entry_fields},
+            }},
+        RPCExamples{
+            HelpExampleCli("getscripthashhistory", "\"8b01df4e368ea28f8dc0423bcf7a4923e3a12d307c875e47a0cfbf90b5c39161\"") +
+            HelpExampleRpc("getscripthashhistory", "\"8b01df4e368ea28f8dc0423bcf7a4923e3a12d307c875e47a0cfbf90b5c39161\", 100000")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const uint256 script_hash{ParseHashV(request.params[0], "scripthash")};
+    const int from_height{request.params[1].isNull() ? 0 : request.params[1].getInt<int>()};
+    if (from_height < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid from_height");
+    }
+
+    const ScriptHashIndex& index{EnsureSyncedScriptHashIndex()};
+    const auto history{index.FindHistory(script_hash, from_height)};
+    if (!history) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read the scripthash index");
+    }
+
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    LOCK(cs_main);
+    UniValue ret(UniValue::VARR);
+    for (const auto& entry : *history) {
+        UniValue obj{ScriptHashEntryToJSON(entry, chainman.ActiveChain())};
+        if (entry.spending) {
+            obj.pushKV("type", "spend");
+            obj.pushKV("vin", entry.n);
+            UniValue prevout(UniValue::VOBJ);
+            prevout.pushKV("txid", entry.outpoint.hash.GetHex());
+            prevout.pushKV("vout", entry.outpoint.n);
+            obj.pushKV("prevout", std::move(prevout));
+        } else {
+            obj.pushKV("type", "receive");
+            obj.pushKV("vout", entry.n);
+        }
+        ret.push_back(std::move(obj));
+    }
+    return ret;
+},
+    };
+}
+
+RPCHelpMan getscripthashunspent()
+{
+    std::vector<RPCResult> entry_fields{SCRIPTHASH_ENTRY_FIELDS};
+    entry_fields.emplace_back(RPCResult::Type::NUM, "vout", "The output index");
+    return RPCHelpMan{
+        "getscripthashunspent",
+        "Return the confirmed outputs paying to a script that are not spent in the active chain.\n"
+        "Outputs spent by mempool transactions are included.\n"
+        "Requires -scripthashindex.\n",
+        {
+            {"scripthash", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The SHA256 hash of the scriptPubKey, in byte-reversed hex"},
+        },
+        RPCResult{
+            RPCResult::Type::ARR, "", "The unspent outputs, in chain order",
+            {
+                {RPCResult::Type::OBJ, "", "", entry_fields},
+            }},
+        RPCExamples{
+            HelpExampleCli("getscripthashunspent", "\"8b01df4e368ea28f8dc0423bcf7a4923e3a12d307c875e47a0cfbf90b5c39161\"") +
+            HelpExampleRpc("getscripthashunspent", "\"8b01df4e368ea28f8dc0423bcf7a4923e3a12d307c875e47a0cfbf90b5c39161\"")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const uint256 script_hash{ParseHashV(request.params[0], "scripthash")};
+
+    const ScriptHashIndex& index{EnsureSyncedScriptHashIndex()};
+    const auto unspent{index.FindUnspent(script_hash)};
+    if (!unspent) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read the scripthash index");
+    }
+
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    LOCK(cs_main);
+    UniValue ret(UniValue::VARR);
+    for (const auto& entry : *unspent) {
+        UniValue obj{ScriptHashEntryToJSON(entry, chainman.ActiveChain())};
+        obj.pushKV("vout", entry.n);
+        ret.push_back(std::move(obj));
+    }
+    return ret;
+},
+    };
+}
+
 /**
  * RAII class that disables the network in its constructor and enables it in its
  * destructor.
@@ -3006,6 +3176,8 @@ static RPCHelpMan dumptxoutset()
         "Write the serialized UTXO set to a file. This can be used in loadtxoutset afterwards if this snapshot height is supported in the chainparams as well.\n\n"
         "Unless the \"latest\" type is requested, the node will roll back to the requested height and network activity will be suspended during this process. "
         "Because of this it is discouraged to interact with the node in any other way during the execution of this call to avoid inconsistent results and race conditions, particularly RPCs that interact with blockstorage.\n\n"
+        "The UTXO set is read on several threads from a database snapshot, so a rolled back chain is restored (and network activity resumed) before the file is written. "
+        "Progress, including the write rate, is logged.\n\n"
         "This call may take several minutes. Make sure to use no RPC timeout (bitquantum-cli -rpcclienttimeout=0)",
         {
             {"path", RPCArg::Type::STR, RPCArg::Optional::NO, "Path to the output file. If relative, will be prefixed by datadir."},
@@ -3027,6 +3199,8 @@ static RPCHelpMan dumptxoutset()
                     {RPCResult::Type::STR, "path", "the absolute path that the snapshot was written to"},
                     {RPCResult::Type::STR_HEX, "txoutset_hash", "the hash of the UTXO set contents"},
                     {RPCResult::Type::NUM, "nchaintx", "the number of transactions in the chain up to and including the base block"},
+                    {RPCResult::Type::NUM, "bytes_written", "the size of the snapshot file"},
+                    {RPCResult::Type::NUM, "bytes_per_second", "the average rate at which the snapshot was written"},
                 }
         },
         RPCExamples{
@@ -3079,48 +3253,50 @@ static RPCHelpMan dumptxoutset()
     }
 
     CConnman& connman = EnsureConnman(node);
-    const CBlockIndex* invalidate_index{nullptr};
-    std::optional<NetworkDisable> disable_network;
-    std::optional<TemporaryRollback> temporary_rollback;
-
-    // If the user wants to dump the txoutset of the current tip, we don't have
-    // to roll back at all
-    if (target_index != tip) {
-        // If the node is running in pruned mode we ensure all necessary block
-        // data is available before starting to roll back.
-        if (node.chainman->m_blockman.IsPruneMode()) {
-            LOCK(node.chainman->GetMutex());
-            const CBlockIndex* current_tip{node.chainman->ActiveChain().Tip()};
-            const CBlockIndex* first_block{node.chainman->m_blockman.GetFirstBlock(*current_tip, /*status_mask=*/BLOCK_HAVE_MASK)};
-            if (first_block->nHeight > target_index->nHeight) {
-                throw JSONRPCError(RPC_MISC_ERROR, "Could not roll back to requested height since necessary block data is already pruned.");
+    Chainstate* chainstate;
+    std::unique_ptr<node::SnapshotCoinsWriter> writer;
+    {
+        // The cursors see the chainstate at the target block, so the chain is
+        // rolled forward and the network resumed at the end of this scope,
+        // before the snapshot is written.
+        const CBlockIndex* invalidate_index{nullptr};
+        std::optional<NetworkDisable> disable_network;
+        std::optional<TemporaryRollback> temporary_rollback;
+
+        // If the user wants to dump the txoutset of the current tip, we don't have
+        // to roll back at all
+        if (target_index != tip) {
+            // If the node is running in pruned mode we ensure all necessary block
+            // data is available before starting to roll back.
+            if (node.chainman->m_blockman.IsPruneMode()) {
+                LOCK(node.chainman->GetMutex());
+                const CBlockIndex* current_tip{node.chainman->ActiveChain().Tip()};
+                const CBlockIndex* first_block{node.chainman->m_blockman.GetFirstBlock(*current_tip, /*status_mask=*/BLOCK_HAVE_MASK)};
+                if (first_block->nHeight > target_index->nHeight) {
+                    throw JSONRPCError(RPC_MISC_ERROR, "Could not roll back to requested height since necessary block data is already pruned.");
+                }
             }
-        }
 
-        // Suspend network activity for the duration of the process when we are
-        // rolling back the chain to get a utxo set from a past height. We do
-        // this so we don't punish peers that send us that send us data that
-        // seems wrong in this temporary state. For example a normal new block
-        // would be classified as a block connecting an invalid block.
-        // Skip if the network is already disabled because this
-        // automatically re-enables the network activity at the end of the
-        // process which may not be what the user wants.
-        if (connman.GetNetworkActive()) {
-            disable_network.emplace(connman);
-        }
+            // Suspend network activity for the duration of the process when we are
+            // rolling back the chain to get a utxo set from a past height. We do
+            // this so we don't punish peers that send us that send us data that
+            // seems wrong in this temporary state. For example a normal new block
+            // would be classified as a block connecting an invalid block.
+            // Skip if the network is already disabled because this
+            // automatically re-enables the network activity at the end of the
+            // process which may not be what the user wants.
+            if (connman.GetNetworkActive()) {
+                disable_network.emplace(connman);
+            }
 
-        invalidate_index = WITH_LOCK(::cs_main, return node.chainman->ActiveChain().Next(target_index));
-        temporary_rollback.emplace(*node.chainman, *invalidate_index);
-    }
+            invalidate_index = WITH_LOCK(::cs_main, return node.chainman->ActiveChain().Next(target_index));
+            temporary_rollback.emplace(*node.chainman, *invalidate_index);
+        }
 
-    Chainstate* chainstate;
-    std::unique_ptr<CCoinsViewCursor> cursor;
-    CCoinsStats stats;
-    {
         // Lock the chainstate before calling PrepareUtxoSnapshot, to be able
-        // to get a UTXO database cursor while the chain is pointing at the
+        // to get UTXO database cursors while the chain is pointing at the
         // target block. After that, release the lock while calling
-        // WriteUTXOSnapshot. The cursor will remain valid and be used by
+        // WriteUTXOSnapshot. The cursors will remain valid and be used by
         // WriteUTXOSnapshot to write a consistent snapshot even if the
         // chainstate changes.
         LOCK(node.chainman->GetMutex());
@@ -3135,13 +3311,12 @@ static RPCHelpMan dumptxoutset()
             LogWarning("dumptxoutset failed to roll back to requested height, reverting to tip.\n");
             throw JSONRPCError(RPC_MISC_ERROR, "Could not roll back to requested height.");
         } else {
-            std::tie(cursor, stats, tip) = PrepareUTXOSnapshot(*chainstate, node.rpc_interruption_point);
+            std::tie(writer, tip) = PrepareUTXOSnapshot(*chainstate);
         }
     }
 
     UniValue result = WriteUTXOSnapshot(*chainstate,
-                                        cursor.get(),
-                                        &stats,
+                                        *writer,
                                         tip,
                                         std::move(afile),
                                         path,
@@ -3155,48 +3330,33 @@ static RPCHelpMan dumptxoutset()
     };
 }
 
-std::tuple<std::unique_ptr<CCoinsViewCursor>, CCoinsStats, const CBlockIndex*>
-PrepareUTXOSnapshot(
-    Chainstate& chainstate,
-    const std::function<void()>& interruption_point)
+std::pair<std::unique_ptr<node::SnapshotCoinsWriter>, const CBlockIndex*>
+PrepareUTXOSnapshot(Chainstate& chainstate)
 {
-    std::unique_ptr<CCoinsViewCursor> pcursor;
-    std::optional<CCoinsStats> maybe_stats;
-    const CBlockIndex* tip;
-
-    {
-        // We need to lock cs_main to ensure that the coinsdb isn't written to
-        // between (i) flushing coins cache to disk (coinsdb), (ii) getting stats
-        // based upon the coinsdb, and (iii) constructing a cursor to the
-        // coinsdb for use in WriteUTXOSnapshot.
-        //
-        // Cursors returned by leveldb iterate over snapshots, so the contents
-        // of the pcursor will not be affected by simultaneous writes during
-        // use below this block.
-        //
-        // See discussion here:
-        //   https://github.com/bitquantumcore/bitquantum /pull/15606#discussion_r274479369
-        //
-        AssertLockHeld(::cs_main);
-
-        chainstate.ForceFlushStateToDisk();
+    // We need to lock cs_main to ensure that the coinsdb isn't written to
+    // between (i) flushing coins cache to disk (coinsdb) and (ii) constructing
+    // the cursors to the coinsdb for use in WriteUTXOSnapshot.
+    //
+    // Cursors returned by leveldb iterate over snapshots, so the contents
+    // of the cursors will not be affected by simultaneous writes during
+    // use below this block.
+    //
+    // See discussion here:
+    //   https://github.com/bitquantumcore/bitquantum /pull/15606#discussion_r274479369
+    //
+    AssertLockHeld(::cs_main);
 
-        maybe_stats = GetUTXOStats(&chainstate.CoinsDB(), chainstate.m_blockman, CoinStatsHashType::HASH_SERIALIZED, interruption_point);
-        if (!maybe_stats) {
-            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
-        }
+    chainstate.ForceFlushStateToDisk();
 
-        pcursor = chainstate.CoinsDB().Cursor();
-        tip = CHECK_NONFATAL(chainstate.m_blockman.LookupBlockIndex(maybe_stats->hashBlock));
-    }
+    auto writer{std::make_unique<node::SnapshotCoinsWriter>(chainstate.CoinsDB(), std::clamp(GetNumCores(), 1, node::MAX_SNAPSHOT_WRITE_THREADS))};
+    const CBlockIndex* tip{CHECK_NONFATAL(chainstate.m_blockman.LookupBlockIndex(chainstate.CoinsDB().GetBestBlock()))};
 
-    return {std::move(pcursor), *CHECK_NONFATAL(maybe_stats), tip};
+    return {std::move(writer), tip};
 }
 
 UniValue WriteUTXOSnapshot(
     Chainstate& chainstate,
-    CCoinsViewCursor* pcursor,
-    CCoinsStats* maybe_stats,
+    node::SnapshotCoinsWriter& writer,
     const CBlockIndex* tip,
     AutoFile&& afile,
     const fs::path& path,
@@ -3207,55 +3367,30 @@ UniValue WriteUTXOSnapshot(
         tip->nHeight, tip->GetBlockHash().ToString(),
         fs::PathToString(path), fs::PathToString(temppath)));
 
-    SnapshotMetadata metadata{chainstate.m_chainman.GetParams().MessageStart(), tip->GetBlockHash(), maybe_stats->coins_count};
-
+    // The number of coins is only known once they are all written. The
+    // metadata has a fixed size, so write it with a zero count first and
+    // overwrite it at the end.
+    SnapshotMetadata metadata{chainstate.m_chainman.GetParams().MessageStart(), tip->GetBlockHash(), /*coins_count=*/0};
+    const int64_t metadata_pos{afile.tell()};
     afile << metadata;
 
-    COutPoint key;
-    Txid last_hash;
-    Coin coin;
-    unsigned int iter{0};
-    size_t written_coins_count{0};
-    std::vector<std::pair<uint32_t, Coin>> coins;
-
-    // To reduce space the serialization format of the snapshot avoids
-    // duplication of tx hashes. The code takes advantage of the guarantee by
-    // leveldb that keys are lexicographically sorted.
-    // In the coins vector we collect all coins that belong to a certain tx hash
-    // (key.hash) and when we have them all (key.hash != last_hash) we write
-    // them to file using the below lambda function.
-    // See also https://github.com/bitquantumcore/bitquantum /issues/25675
-    auto write_coins_to_file = [&](AutoFile& afile, const Txid& last_hash, const std::vector<std::pair<uint32_t, Coin>>& coins, size_t& written_coins_count) {
-        afile << last_hash;
-        WriteCompactSize(afile, coins.size());
-        for (const auto& [n, coin] : coins) {
-            WriteCompactSize(afile, n);
-            afile << coin;
-            ++written_coins_count;
-        }
-    };
-
-    pcursor->GetKey(key);
-    last_hash = key.hash;
-    while (pcursor->Valid()) {
-        if (iter % 5000 == 0) interruption_point();
-        ++iter;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
-            if (key.hash != last_hash) {
-                write_coins_to_file(afile, last_hash, coins, written_coins_count);
-                last_hash = key.hash;
-                coins.clear();
-            }
-            coins.emplace_back(key.n, coin);
-        }
-        pcursor->Next();
-    }
-
-    if (!coins.empty()) {
-        write_coins_to_file(afile, last_hash, coins, written_coins_count);
-    }
-
-    CHECK_NONFATAL(written_coins_count == maybe_stats->coins_count);
+    const auto start{SteadyClock::now()};
+    const auto rate{[&](uint64_t bytes) {
+        const double seconds{Ticks<SecondsDouble>(SteadyClock::now() - start)};
+        return seconds > 0 ? bytes / seconds : 0.0;
+    }};
+    uint64_t next_log{1'000'000};
+    const node::SnapshotWriteResult written{writer.Write(afile, interruption_point, [&](const node::SnapshotWriteResult& progress) {
+        if (progress.coins_written < next_log) return;
+        next_log = progress.coins_written + 1'000'000;
+        LogInfo("[snapshot] %d coins written (%.2f MB, %.2f MB/s)",
+            progress.coins_written, progress.bytes_written / 1e6, rate(progress.bytes_written) / 1e6);
+    })};
+
+    metadata.m_coins_count = written.coins_written;
+    const int64_t file_size{afile.tell()};
+    afile.seek(metadata_pos, SEEK_SET);
+    afile << metadata;
 
     if (afile.fclose() != 0) {
         throw std::ios_base::failure(
@@ -3263,12 +3398,14 @@ UniValue WriteUTXOSnapshot(
     }
 
     UniValue result(UniValue::VOBJ);
-    result.pushKV("coins_written", written_coins_count);
+    result.pushKV("coins_written", written.coins_written);
     result.pushKV("base_hash", tip->GetBlockHash().ToString());
     result.pushKV("base_height", tip->nHeight);
     result.pushKV("path", path.utf8string());
-    result.pushKV("txoutset_hash", maybe_stats->hashSerialized.ToString());
+    result.pushKV("txoutset_hash", written.hash_serialized.ToString());
     result.pushKV("nchaintx", tip->m_chain_tx_count);
+    result.pushKV("bytes_written", file_size);
+    result.pushKV("bytes_per_second", rate(file_size));
     return result;
 }
 
@@ -3279,10 +3416,9 @@ UniValue CreateUTXOSnapshot(
     const fs::path& path,
     const fs::path& tmppath)
 {
-    auto [cursor, stats, tip]{WITH_LOCK(::cs_main, return PrepareUTXOSnapshot(chainstate, node.rpc_interruption_point))};
+    auto [writer, tip]{WITH_LOCK(::cs_main, return PrepareUTXOSnapshot(chainstate))};
     return WriteUTXOSnapshot(chainstate,
-                             cursor.get(),
-                             &stats,
+                             *writer,
                              tip,
                              std::move(afile),
                              path,
@@ -3306,6 +3442,10 @@ static RPCHelpMan loadtxoutset()
         "third-party sources (HTTP, torrent, etc.) which is reasonable since their "
         "contents are always checked by hash.\n\n"
 
+        "The coins are decoded and written on several threads while the file is read, and "
+        "hashed as they are loaded. Progress is logged and reported in the \"snapshot_load\" "
+        "field of getchainstates until the call returns.\n\n"
+
         "You can find more information on this process in the `assumeutxo` design "
         "document (<https://github.com/bitquantum/bitquantum/blob/master/doc/design/assumeutxo.md>).",
         {
@@ -3394,6 +3534,12 @@ return RPCHelpMan{
             RPCResult::Type::OBJ, "", "", {
                 {RPCResult::Type::NUM, "headers", "the number of headers seen so far"},
                 {RPCResult::Type::ARR, "chainstates", "list of the chainstates ordered by work, with the most-work (active) chainstate last", {{RPCResult::Type::OBJ, "", "", RPCHelpForChainstate},}},
+                {RPCResult::Type::OBJ, "snapshot_load", /*optional=*/true, "progress of the snapshot being loaded by loadtxoutset, if any",
+                {
+                    {RPCResult::Type::NUM, "coins_loaded", "the number of coins written so far"},
+                    {RPCResult::Type::NUM, "coins_total", "the number of coins in the snapshot"},
+                    {RPCResult::Type::NUM, "progress", "the fraction of coins loaded, between 0 and 1"},
+                }},
             }
         },
         RPCExamples{
@@ -3439,6 +3585,13 @@ return RPCHelpMan{
       obj_chainstates.push_back(make_chain_data(*cs, !cs->m_from_snapshot_blockhash || chainstates.size() == 1));
     }
     obj.pushKV("chainstates", std::move(obj_chainstates));
+    if (const auto load{chainman.GetSnapshotLoadProgress()}) {
+        UniValue obj_load{UniValue::VOBJ};
+        obj_load.pushKV("coins_loaded", load->coins_loaded);
+        obj_load.pushKV("coins_total", load->coins_total);
+        obj_load.pushKV("progress", static_cast<double>(load->coins_loaded) / load->coins_total);
+        obj.pushKV("snapshot_load", std::move(obj_load));
+    }
     return obj;
 }
     };
@@ -3469,6 +3622,8 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &scanblocks},
         {"blockchain", &getdescriptoractivity},
         {"blockchain", &getblockfilter},
+        {"blockchain", &getscripthashhistory},
+        {"blockchain", &getscripthashunspent},
         {"blockchain", &dumptxoutset},
         {"blockchain", &loadtxoutset},
         {"blockchain", &getchainstates},
@@ -642,6 +642,21 @@ static RPCHelpMan getnetworkinfo()
                         }},
                         {RPCResult::Type::BOOL, "localrelay", "true if transaction relay is requested from peers"},
                         {RPCResult::Type::NUM, "timeoffset", "the time offset"},
+                        {RPCResult::Type::OBJ, "blockrequests", "block requests from peers since startup, to help choose a -prune target",
+                        {
+                            {RPCResult::Type::NUM, "served", "requests for blocks that were available"},
+                            {RPCResult::Type::NUM, "pruned", "requests for blocks that had been pruned"},
+                            {RPCResult::Type::NUM, "missing", "requests for blocks that were never downloaded, such as blocks below an assumeutxo snapshot"},
+                            {RPCResult::Type::NUM, "limited", "requests ignored because they were deeper than the NODE_NETWORK_LIMITED threshold"},
+                            {RPCResult::Type::ARR, "depth_histogram", "requests for active chain blocks by depth below the tip, whether served or not",
+                            {
+                                {RPCResult::Type::OBJ, "", "",
+                                {
+                                    {RPCResult::Type::NUM, "max_depth", /*optional=*/true, "inclusive upper bound of the bucket, omitted for the last bucket"},
+                                    {RPCResult::Type::NUM, "count", "number of requests"},
+                                }},
+                            }},
+                        }},
                         {RPCResult::Type::NUM, "connections", "the total number of connections"},
                         {RPCResult::Type::NUM, "connections_in", "the number of inbound connections"},
                         {RPCResult::Type::NUM, "connections_out", "the number of outbound connections"},
@@ -699,6 +714,21 @@ static RPCHelpMan getnetworkinfo()
         auto peerman_info{node.peerman->GetInfo()};
         obj.pushKV("localrelay", !peerman_info.ignores_incoming_txs);
         obj.pushKV("timeoffset", Ticks<std::chrono::seconds>(peerman_info.median_outbound_time_offset));
+        const BlockRequestStats& block_requests{peerman_info.block_requests};
+        UniValue requests(UniValue::VOBJ);
+        requests.pushKV("served", block_requests.served);
+        requests.pushKV("pruned", block_requests.pruned);
+        requests.pushKV("missing", block_requests.missing);
+        requests.pushKV("limited", block_requests.limited);
+        UniValue histogram(UniValue::VARR);
+        for (size_t i = 0; i < block_requests.depth_buckets.size(); ++i) {
+            UniValue bucket(UniValue::VOBJ);
+            if (i < BlockRequestStats::DEPTH_LIMITS.size()) bucket.pushKV("max_depth", BlockRequestStats::DEPTH_LIMITS[i]);
+            bucket.pushKV("count", block_requests.depth_buckets[i]);
+            histogram.push_back(std::move(bucket));
+        }
+        requests.pushKV("depth_histogram", std::move(histogram));
+        obj.pushKV("blockrequests", std::move(requests));
     }
     if (node.connman) {
         obj.pushKV("networkactive", node.connman->GetNetworkActive());
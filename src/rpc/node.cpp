@@ -6,9 +6,11 @@
 #include <bitquantum-build-config.h> // IWYU pragma: keep
 
 #include <chainparams.h>
+#include <dbwrapper.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/scripthashindex.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
 #include <interfaces/echo.h>
@@ -16,15 +18,19 @@
 #include <interfaces/ipc.h>
 #include <kernel/cs_main.h>
 #include <logging.h>
+#include <node/blockstorage.h>
 #include <node/context.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
 #include <scheduler.h>
+#include <tinyformat.h>
 #include <univalue.h>
 #include <util/any.h>
 #include <util/check.h>
 #include <util/time.h>
+#include <util/vector.h>
+#include <validation.h>
 
 #include <cstdint>
 #ifdef HAVE_MALLOC_INFO
@@ -353,6 +359,7 @@ static UniValue SummaryToJSON(const IndexSummary&& summary, std::string index_na
     UniValue entry(UniValue::VOBJ);
     entry.pushKV("synced", summary.synced);
     entry.pushKV("best_block_height", summary.best_block_height);
+    if (summary.blocks_per_second) entry.pushKV("blocks_per_second", *summary.blocks_per_second);
     ret_summary.pushKV(summary.name, std::move(entry));
     return ret_summary;
 }
@@ -372,6 +379,7 @@ static RPCHelpMan getindexinfo()
                             {
                                 {RPCResult::Type::BOOL, "synced", "Whether the index is synced or not"},
                                 {RPCResult::Type::NUM, "best_block_height", "The block height to which the index is synced"},
+                                {RPCResult::Type::NUM, "blocks_per_second", /*optional=*/true, "Average speed of the initial sync, only present while the index is catching up"},
                             }
                         },
                     },
@@ -395,6 +403,10 @@ static RPCHelpMan getindexinfo()
         result.pushKVs(SummaryToJSON(g_coin_stats_index->GetSummary(), index_name));
     }
 
+    if (g_scripthash_index) {
+        result.pushKVs(SummaryToJSON(g_scripthash_index->GetSummary(), index_name));
+    }
+
     ForEachBlockFilterIndex([&result, &index_name](const BlockFilterIndex& index) {
         result.pushKVs(SummaryToJSON(index.GetSummary(), index_name));
     });
@@ -404,11 +416,232 @@ static RPCHelpMan getindexinfo()
     };
 }
 
+static UniValue DBStatsToJSON(const DBStats& stats)
+{
+    UniValue entry(UniValue::VOBJ);
+    UniValue files(UniValue::VARR);
+    for (int count : stats.files_per_level) files.push_back(count);
+    entry.pushKV("files_per_level", std::move(files));
+    entry.pushKV("memory_usage", stats.memory_usage);
+    entry.pushKV("block_cache_bytes", stats.block_cache_bytes);
+    entry.pushKV("write_buffer_bytes", stats.write_buffer_bytes);
+    entry.pushKV("bloom_bits", stats.bloom_bits);
+    entry.pushKV("max_file_size", stats.max_file_size);
+    entry.pushKV("batches_written", stats.batches_written);
+    entry.pushKV("bytes_written", stats.bytes_written);
+    UniValue compactions(UniValue::VOBJ);
+    compactions.pushKV("scheduled", stats.compactions_scheduled);
+    compactions.pushKV("completed", stats.compactions_completed);
+    compactions.pushKV("time_ms", count_milliseconds(stats.compaction_time));
+    compactions.pushKV("running", stats.compaction_running);
+    entry.pushKV("background_compactions", std::move(compactions));
+    entry.pushKV("leveldb_stats", stats.leveldb_stats);
+    return entry;
+}
+
+static RPCHelpMan getdbstats()
+{
+    return RPCHelpMan{
+        "getdbstats",
+        "Returns LevelDB statistics of the chainstate, block index and index databases.\n"
+        "Write and compaction counters start when a database is opened; the chainstate database is reopened when its cache is resized.\n",
+                {},
+                RPCResult{
+                    RPCResult::Type::OBJ_DYN, "", "", {
+                        {
+                            RPCResult::Type::OBJ, "name", "The database: chainstate, chainstate_snapshot, blocks, or the name of an index",
+                            {
+                                {RPCResult::Type::ARR, "files_per_level", "Number of table files at each level", {{RPCResult::Type::NUM, "", ""}}},
+                                {RPCResult::Type::NUM, "memory_usage", "Approximate memory used by LevelDB, in bytes"},
+                                {RPCResult::Type::NUM, "block_cache_bytes", "Size of the block cache"},
+                                {RPCResult::Type::NUM, "write_buffer_bytes", "Size of each write buffer"},
+                                {RPCResult::Type::NUM, "bloom_bits", "Bits per key of the bloom filters, 0 if disabled"},
+                                {RPCResult::Type::NUM, "max_file_size", "Target size of the table files"},
+                                {RPCResult::Type::NUM, "batches_written", "Number of write batches"},
+                                {RPCResult::Type::NUM, "bytes_written", "Approximate size of the write batches, in bytes"},
+                                {RPCResult::Type::OBJ, "background_compactions", "Compactions scheduled after large flushes (see -dbcompactafter)",
+                                {
+                                    {RPCResult::Type::NUM, "scheduled", "Number of compactions requested"},
+                                    {RPCResult::Type::NUM, "completed", "Number of compactions finished"},
+                                    {RPCResult::Type::NUM, "time_ms", "Total time spent compacting, in milliseconds"},
+                                    {RPCResult::Type::BOOL, "running", "Whether a compaction is in progress"},
+                                }},
+                                {RPCResult::Type::STR, "leveldb_stats", "LevelDB's own per-level compaction statistics"},
+                            }
+                        },
+                    },
+                },
+                RPCExamples{
+                    HelpExampleCli("getdbstats", "")
+                  + HelpExampleRpc("getdbstats", "")
+                },
+                [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    UniValue result(UniValue::VOBJ);
+    {
+        LOCK(cs_main);
+        for (Chainstate* chainstate : chainman.GetAll()) {
+            if (!chainstate->CanFlushToDisk()) continue;
+            const DBStats stats{chainstate->CoinsDB().GetDBStats()};
+            result.pushKV(stats.name, DBStatsToJSON(stats));
+        }
+        result.pushKV("blocks", DBStatsToJSON(chainman.m_blockman.m_block_tree_db->GetStats()));
+    }
+
+    if (g_txindex) {
+        result.pushKV(g_txindex->GetName(), DBStatsToJSON(g_txindex->GetDBStats()));
+    }
+
+    if (g_coin_stats_index) {
+        result.pushKV(g_coin_stats_index->GetName(), DBStatsToJSON(g_coin_stats_index->GetDBStats()));
+    }
+
+    if (g_scripthash_index) {
+        result.pushKV(g_scripthash_index->GetName(), DBStatsToJSON(g_scripthash_index->GetDBStats()));
+    }
+
+    ForEachBlockFilterIndex([&result](const BlockFilterIndex& index) {
+        result.pushKV(index.GetName(), DBStatsToJSON(index.GetDBStats()));
+    });
+
+    return result;
+},
+    };
+}
+
+//! Blocks connected after initial block download needed to recommend a cache size.
+static constexpr uint64_t MIN_BLOCKS_FOR_CACHE_RECOMMENDATION{6};
+
+static UniValue CacheLookupsToJSON(uint64_t hits, uint64_t misses)
+{
+    UniValue entry(UniValue::VOBJ);
+    entry.pushKV("hits", hits);
+    entry.pushKV("misses", misses);
+    if (hits + misses > 0) entry.pushKV("hit_rate", double(hits) / (hits + misses));
+    return entry;
+}
+
+static UniValue ValidationCacheStatsToJSON(const ValidationCacheStats& stats)
+{
+    UniValue entry(UniValue::VOBJ);
+    entry.pushKV("script_execution", CacheLookupsToJSON(stats.script_execution_hits, stats.script_execution_misses));
+    entry.pushKV("signature", CacheLookupsToJSON(stats.signature_hits, stats.signature_misses));
+    return entry;
+}
+
+static std::vector<RPCResult> ValidationCacheStatsDoc()
+{
+    const std::vector<RPCResult> lookups{
+        {RPCResult::Type::NUM, "hits", "Number of lookups which found their entry"},
+        {RPCResult::Type::NUM, "misses", "Number of lookups which did not find their entry"},
+        {RPCResult::Type::NUM, "hit_rate", /*optional=*/true, "Share of the lookups which found their entry, if there were any"},
+    };
+    return {
+        {RPCResult::Type::OBJ, "script_execution", "Lookups of whole transactions in the script execution cache", lookups},
+        {RPCResult::Type::OBJ, "signature", "Lookups of single signatures in the signature cache", lookups},
+    };
+}
+
+static RPCHelpMan getvalidationcacheinfo()
+{
+    return RPCHelpMan{
+        "getvalidationcacheinfo",
+        "Returns the usage and the hit rates of the script execution cache and the signature cache, and a suggested -maxsigcachesize.\n"
+        "Transactions checked when they entered the mempool should be found in the caches when they are mined.\n",
+                {},
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "", {
+                        {RPCResult::Type::OBJ, "script_execution_cache", "", {
+                            {RPCResult::Type::NUM, "capacity", "Number of entries the cache can hold"},
+                            {RPCResult::Type::NUM, "entries", "Number of entries in the cache"},
+                        }},
+                        {RPCResult::Type::OBJ, "signature_cache", "", {
+                            {RPCResult::Type::NUM, "capacity", "Number of entries the cache can hold"},
+                            {RPCResult::Type::NUM, "entries", "Number of entries in the cache"},
+                        }},
+                        {RPCResult::Type::OBJ, "lookups", "All lookups since startup, including those for mempool acceptance", ValidationCacheStatsDoc()},
+                        {RPCResult::Type::OBJ, "last_block", /*optional=*/true, "Lookups while connecting the most recent block, if one was connected since startup",
+                            Cat<std::vector<RPCResult>>({{RPCResult::Type::NUM, "height", "The height of the block"}}, ValidationCacheStatsDoc())},
+                        {RPCResult::Type::OBJ, "synced_blocks", "Lookups while connecting blocks after initial block download",
+                            Cat<std::vector<RPCResult>>({{RPCResult::Type::NUM, "blocks", "The number of blocks"}}, ValidationCacheStatsDoc())},
+                        {RPCResult::Type::NUM, "recommended_maxsigcachesize", "Suggested -maxsigcachesize in MiB, based on the hit rates of the synced blocks"},
+                        {RPCResult::Type::STR, "recommendation", "The reason for the suggested size"},
+                    },
+                },
+                RPCExamples{
+                    HelpExampleCli("getvalidationcacheinfo", "")
+                  + HelpExampleRpc("getvalidationcacheinfo", "")
+                },
+                [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    ValidationCache& cache{chainman.m_validation_cache};
+    UniValue result(UniValue::VOBJ);
+
+    LOCK(cs_main);
+    const uint32_t script_capacity{cache.m_script_execution_cache.capacity()};
+    size_t script_entries{0};
+    cache.m_script_execution_cache.for_each([&](const uint256&) { ++script_entries; });
+    UniValue script_cache(UniValue::VOBJ);
+    script_cache.pushKV("capacity", script_capacity);
+    script_cache.pushKV("entries", script_entries);
+    result.pushKV("script_execution_cache", std::move(script_cache));
+
+    const uint32_t signature_capacity{cache.m_signature_cache.GetCapacity()};
+    UniValue signature_cache(UniValue::VOBJ);
+    signature_cache.pushKV("capacity", signature_capacity);
+    signature_cache.pushKV("entries", cache.m_signature_cache.CountEntries());
+    result.pushKV("signature_cache", std::move(signature_cache));
+
+    result.pushKV("lookups", ValidationCacheStatsToJSON(cache.m_lookups));
+    if (cache.m_last_block_height >= 0) {
+        UniValue last_block(UniValue::VOBJ);
+        last_block.pushKV("height", cache.m_last_block_height);
+        last_block.pushKVs(ValidationCacheStatsToJSON(cache.m_last_block_stats));
+        result.pushKV("last_block", std::move(last_block));
+    }
+    UniValue synced_blocks(UniValue::VOBJ);
+    synced_blocks.pushKV("blocks", cache.m_synced_blocks);
+    synced_blocks.pushKVs(ValidationCacheStatsToJSON(cache.m_synced_blocks_stats));
+    result.pushKV("synced_blocks", std::move(synced_blocks));
+
+    // Misses of transactions which were never in our mempool are not helped
+    // by a larger cache, so only recommend one when the script execution
+    // cache is full, i.e. when it evicts entries before they are used.
+    const size_t current_mib{(size_t{script_capacity} + signature_capacity) * sizeof(uint256) >> 20};
+    const uint64_t lookups{cache.m_synced_blocks_stats.script_execution_hits + cache.m_synced_blocks_stats.script_execution_misses};
+    const double occupancy{double(script_entries) / script_capacity};
+    size_t recommended_mib{current_mib};
+    std::string recommendation;
+    if (cache.m_synced_blocks < MIN_BLOCKS_FOR_CACHE_RECOMMENDATION) {
+        recommendation = strprintf("Fewer than %u blocks were connected after initial block download.", MIN_BLOCKS_FOR_CACHE_RECOMMENDATION);
+    } else if (lookups == 0) {
+        recommendation = "The blocks connected after initial block download had no transactions to check.";
+    } else if (const double hit_rate{double(cache.m_synced_blocks_stats.script_execution_hits) / lookups}; hit_rate < 0.9 && occupancy >= 0.9) {
+        recommended_mib = 2 * current_mib;
+        recommendation = strprintf("The script execution cache is full and %.0f%% of the transactions in blocks missed it, "
+                                   "a larger cache keeps more transactions cached until they are mined.", 100 * (1 - hit_rate));
+    } else if (occupancy < 0.25 && current_mib > DEFAULT_VALIDATION_CACHE_BYTES >> 20) {
+        recommended_mib = DEFAULT_VALIDATION_CACHE_BYTES >> 20;
+        recommendation = "The script execution cache is mostly empty, the default size is sufficient.";
+    } else {
+        recommendation = "The current size suits the observed hit rates.";
+    }
+    result.pushKV("recommended_maxsigcachesize", recommended_mib);
+    result.pushKV("recommendation", recommendation);
+    return result;
+},
+    };
+}
+
 void RegisterNodeRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
         {"control", &getmemoryinfo},
         {"control", &logging},
+        {"control", &getdbstats},
+        {"control", &getvalidationcacheinfo},
         {"util", &getindexinfo},
         {"hidden", &setmocktime},
         {"hidden", &mockscheduler},
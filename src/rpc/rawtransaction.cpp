@@ -415,6 +415,90 @@ static RPCHelpMan getrawtransaction()
     };
 }
 
+static RPCHelpMan getrawtransactions()
+{
+    return RPCHelpMan{
+        "getrawtransactions",
+        "Look up several transactions at once, in the mempool and, if -txindex is enabled, in any block.\n"
+        "Transactions found in blocks are read from disk in one pass, grouped by block file.\n",
+        {
+            {"txids", RPCArg::Type::ARR, RPCArg::Optional::NO, "The transaction ids",
+                {
+                    {"txid", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "A transaction id"},
+                },
+            },
+            {"verbose", RPCArg::Type::BOOL, RPCArg::Default{false}, "Return JSON objects as getrawtransaction with verbosity 1 instead of hex-encoded data"},
+        },
+        {
+            RPCResult{"if verbose is not set or set to false",
+                RPCResult::Type::ARR, "", "One entry per requested txid, in order",
+                {
+                    {RPCResult::Type::STR_HEX, "data", /*optional=*/true, "The serialized transaction as a hex-encoded string, or null if it was not found", {}, /*skip_type_check=*/true},
+                }},
+            RPCResult{"if verbose is set to true",
+                RPCResult::Type::ARR, "", "One entry per requested txid, in order",
+                {
+                    {RPCResult::Type::OBJ, "", /*optional=*/true, "Same output as getrawtransaction with verbosity 1, or null if the transaction was not found",
+                        {{RPCResult::Type::ELISION, "", ""}}, /*skip_type_check=*/true},
+                }},
+        },
+        RPCExamples{
+            HelpExampleCli("getrawtransactions", "'[\"mytxid\",\"mytxid2\"]'")
+            + HelpExampleCli("getrawtransactions", "'[\"mytxid\",\"mytxid2\"]' true")
+            + HelpExampleRpc("getrawtransactions", "[\"mytxid\",\"mytxid2\"], true")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const NodeContext& node = EnsureAnyNodeContext(request.context);
+    ChainstateManager& chainman = EnsureChainman(node);
+    const bool verbose{request.params[1].isNull() ? false : request.params[1].get_bool()};
+
+    const UniValue& txid_values{request.params[0].get_array()};
+    std::vector<Txid> txids;
+    txids.reserve(txid_values.size());
+    for (size_t i = 0; i < txid_values.size(); ++i) {
+        txids.push_back(Txid::FromUint256(ParseHashV(txid_values[i], strprintf("txids[%d]", i))));
+    }
+
+    std::vector<CTransactionRef> txs(txids.size());
+    std::vector<uint256> block_hashes(txids.size());
+    if (node.mempool) {
+        for (size_t i = 0; i < txids.size(); ++i) txs[i] = node.mempool->get(txids[i]);
+    }
+    if (g_txindex) {
+        g_txindex->BlockUntilSyncedToCurrentChain();
+        std::vector<Txid> missing;
+        std::vector<size_t> missing_pos;
+        for (size_t i = 0; i < txids.size(); ++i) {
+            // The genesis block coinbase is not considered an ordinary transaction.
+            if (txs[i] || txids[i].ToUint256() == chainman.GetParams().GenesisBlock().hashMerkleRoot) continue;
+            missing.push_back(txids[i]);
+            missing_pos.push_back(i);
+        }
+        auto found{g_txindex->FindTxs(missing)};
+        for (size_t i = 0; i < found.size(); ++i) {
+            if (!found[i]) continue;
+            std::tie(block_hashes[missing_pos[i]], txs[missing_pos[i]]) = std::move(*found[i]);
+        }
+    }
+
+    UniValue result(UniValue::VARR);
+    for (size_t i = 0; i < txs.size(); ++i) {
+        if (!txs[i]) {
+            result.push_back(NullUniValue);
+        } else if (!verbose) {
+            result.push_back(EncodeHexTx(*txs[i]));
+        } else {
+            UniValue entry(UniValue::VOBJ);
+            TxToJSON(*txs[i], block_hashes[i], entry, chainman.ActiveChainstate());
+            result.push_back(std::move(entry));
+        }
+    }
+    return result;
+},
+    };
+}
+
 static RPCHelpMan createrawtransaction()
 {
     return RPCHelpMan{
@@ -2119,6 +2203,7 @@ void RegisterRawTransactionRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
         {"rawtransactions", &getrawtransaction},
+        {"rawtransactions", &getrawtransactions},
         {"rawtransactions", &createrawtransaction},
         {"rawtransactions", &decoderawtransaction},
         {"rawtransactions", &decodescript},
@@ -60,11 +60,26 @@ void SignatureCache::Set(const uint256& entry)
     setValid.insert(entry);
 }
 
+size_t SignatureCache::CountEntries()
+{
+    std::shared_lock<std::shared_mutex> lock(cs_sigcache);
+    size_t entries{0};
+    setValid.for_each([&](const uint256&) { ++entries; });
+    return entries;
+}
+
+bool CachingTransactionSignatureChecker::Lookup(const uint256& entry) const
+{
+    const bool found{m_signature_cache.Get(entry, !store)};
+    if (m_lookups) ++(found ? m_lookups->hits : m_lookups->misses);
+    return found;
+}
+
 bool CachingTransactionSignatureChecker::VerifyECDSASignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
 {
     uint256 entry;
     m_signature_cache.ComputeEntryECDSA(entry, sighash, vchSig, pubkey);
-    if (m_signature_cache.Get(entry, !store))
+    if (Lookup(entry))
         return true;
     if (!TransactionSignatureChecker::VerifyECDSASignature(vchSig, pubkey, sighash))
         return false;
@@ -77,7 +92,7 @@ bool CachingTransactionSignatureChecker::VerifySchnorrSignature(std::span<const
 {
     uint256 entry;
     m_signature_cache.ComputeEntrySchnorr(entry, sighash, sig, pubkey);
-    if (m_signature_cache.Get(entry, !store)) return true;
+    if (Lookup(entry)) return true;
     if (!TransactionSignatureChecker::VerifySchnorrSignature(sig, pubkey, sighash)) return false;
     if (store) m_signature_cache.Set(entry);
     return true;
@@ -15,6 +15,7 @@
 #include <util/hasher.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <shared_mutex>
 #include <vector>
 
@@ -58,6 +59,18 @@ public:
     bool Get(const uint256& entry, const bool erase);
 
     void Set(const uint256& entry);
+
+    //! Number of entries the cache can hold.
+    uint32_t GetCapacity() const { return setValid.capacity(); }
+
+    //! Number of entries in the cache which have not been marked for erasure.
+    size_t CountEntries();
+};
+
+/** Signature cache lookups which found, or did not find, their entry. */
+struct SignatureCacheLookups {
+    uint64_t hits{0};
+    uint64_t misses{0};
 };
 
 class CachingTransactionSignatureChecker : public TransactionSignatureChecker
@@ -65,9 +78,13 @@ class CachingTransactionSignatureChecker : public TransactionSignatureChecker
 private:
     bool store;
     SignatureCache& m_signature_cache;
+    //! Where to count the lookups, if not nullptr. Not shared with other threads, so not atomic.
+    SignatureCacheLookups* m_lookups;
+
+    bool Lookup(const uint256& entry) const;
 
 public:
-    CachingTransactionSignatureChecker(const CTransaction* txToIn, unsigned int nInIn, const CAmount& amountIn, bool storeIn, SignatureCache& signature_cache, PrecomputedTransactionData& txdataIn) : TransactionSignatureChecker(txToIn, nInIn, amountIn, txdataIn, MissingDataBehavior::ASSERT_FAIL), store(storeIn), m_signature_cache(signature_cache)  {}
+    CachingTransactionSignatureChecker(const CTransaction* txToIn, unsigned int nInIn, const CAmount& amountIn, bool storeIn, SignatureCache& signature_cache, PrecomputedTransactionData& txdataIn, SignatureCacheLookups* lookups = nullptr) : TransactionSignatureChecker(txToIn, nInIn, amountIn, txdataIn, MissingDataBehavior::ASSERT_FAIL), store(storeIn), m_signature_cache(signature_cache), m_lookups(lookups)  {}
 
     bool VerifyECDSASignature(const std::vector<unsigned char>& vchSig, const CPubKey& vchPubKey, const uint256& sighash) const override;
     bool VerifySchnorrSignature(std::span<const unsigned char> sig, const XOnlyPubKey& pubkey, const uint256& sighash) const override;
@@ -8,11 +8,14 @@
 #include <consensus/merkle.h>
 #include <consensus/validation.h>
 #include <index/blockfilterindex.h>
+#include <index/synccoordinator.h>
+#include <index/txindex.h>
 #include <interfaces/chain.h>
 #include <node/miner.h>
 #include <pow.h>
 #include <test/util/blockfilter.h>
 #include <test/util/setup_common.h>
+#include <undo.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
@@ -22,6 +25,32 @@ using node::BlockAssembler;
 using node::BlockManager;
 using node::CBlockTemplate;
 
+/** Gives the tests access to the recent filters cache of a BlockFilterIndex. */
+class BlockFilterIndexTester
+{
+public:
+    static bool Init(BlockFilterIndex& index) { return index.CustomInit(std::nullopt); }
+    static bool Append(BlockFilterIndex& index, const interfaces::BlockInfo& block) { return index.CustomAppend(block); }
+    static bool Remove(BlockFilterIndex& index, const interfaces::BlockInfo& block) { return index.CustomRemove(block); }
+
+    /** Returns the filter hashes of the cached entries, if the lookup hits. */
+    static std::optional<std::vector<uint256>> LookupRecent(const BlockFilterIndex& index, int start_height, const CBlockIndex* stop_index)
+    {
+        std::vector<BlockFilterIndex::RecentFilter> entries;
+        if (!index.LookupRecentFilters(start_height, stop_index, entries)) return std::nullopt;
+        std::vector<uint256> hashes;
+        for (const auto& entry : entries) hashes.push_back(entry.filter_hash);
+        return hashes;
+    }
+
+    /** Returns the height of the first cached entry and the number of cached entries. */
+    static std::pair<int, size_t> CachedRange(const BlockFilterIndex& index)
+    {
+        LOCK(index.m_recent_filters_mutex);
+        return {index.m_recent_filters_height, index.m_recent_filters.size()};
+    }
+};
+
 BOOST_AUTO_TEST_SUITE(blockfilter_index_tests)
 
 struct BuildChainTestingSetup : public TestChain100Setup {
@@ -269,6 +298,51 @@ BOOST_FIXTURE_TEST_CASE(blockfilter_index_initial_sync, BuildChainTestingSetup)
     filter_index.Stop();
 }
 
+BOOST_FIXTURE_TEST_CASE(index_shared_sync, BuildChainTestingSetup)
+{
+    IndexSyncCoordinator coordinator{m_node.chainman->m_blockman, /*worker_threads=*/2};
+    BlockFilterIndex filter_index(interfaces::MakeChain(m_node), BlockFilterType::BASIC, 1 << 20, true);
+    TxIndex txindex(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(filter_index.Init());
+    BOOST_REQUIRE(txindex.Init());
+    filter_index.SetSyncCoordinator(&coordinator);
+    txindex.SetSyncCoordinator(&coordinator);
+    BOOST_REQUIRE(filter_index.StartBackgroundSync());
+    BOOST_REQUIRE(txindex.StartBackgroundSync());
+
+    for (int i = 0; i < 1000 && !(filter_index.GetSummary().synced && txindex.GetSummary().synced); ++i) {
+        UninterruptibleSleep(10ms);
+    }
+    BOOST_REQUIRE(filter_index.GetSummary().synced);
+    BOOST_REQUIRE(txindex.GetSummary().synced);
+    BOOST_CHECK(!filter_index.GetSummary().blocks_per_second);
+
+    // Every block was fetched once per index, either from disk or from the other index's read.
+    const int num_blocks{WITH_LOCK(cs_main, return m_node.chainman->ActiveHeight() + 1)};
+    const auto stats{coordinator.GetStats()};
+    BOOST_CHECK_EQUAL(stats.block_reads + stats.cache_hits, 2U * num_blocks);
+
+    {
+        LOCK(cs_main);
+        uint256 last_header;
+        for (const CBlockIndex* block_index = m_node.chainman->ActiveChain().Genesis();
+             block_index != nullptr;
+             block_index = m_node.chainman->ActiveChain().Next(block_index)) {
+            CheckFilterLookups(filter_index, block_index, last_header, m_node.chainman->m_blockman);
+        }
+    }
+    uint256 block_hash;
+    CTransactionRef tx_disk;
+    for (const auto& txn : m_coinbase_txns) {
+        BOOST_CHECK(txindex.FindTx(txn->GetHash(), block_hash, tx_disk));
+    }
+
+    filter_index.Interrupt();
+    txindex.Interrupt();
+    filter_index.Stop();
+    txindex.Stop();
+}
+
 BOOST_FIXTURE_TEST_CASE(blockfilter_index_init_destroy, BasicTestingSetup)
 {
     BlockFilterIndex* filter_index;
@@ -306,6 +380,94 @@ BOOST_FIXTURE_TEST_CASE(blockfilter_index_init_destroy, BasicTestingSetup)
     BOOST_CHECK(filter_index == nullptr);
 }
 
+BOOST_FIXTURE_TEST_CASE(blockfilter_index_recent_filters, BasicTestingSetup)
+{
+    BlockFilterIndex filter_index(interfaces::MakeChain(m_node), BlockFilterType::BASIC, 1 << 20, true);
+    BOOST_REQUIRE(BlockFilterIndexTester::Init(filter_index));
+
+    // Blocks only need distinct hashes and coinbase outputs to get distinct filters.
+    const CBlockUndo block_undo;
+    auto make_block = [](const uint256& prev_hash, uint32_t nonce) {
+        CMutableTransaction coinbase;
+        coinbase.vin.resize(1);
+        coinbase.vout.emplace_back(1, CScript() << OP_TRUE << nonce);
+        CBlock block;
+        block.hashPrevBlock = prev_hash;
+        block.nNonce = nonce;
+        block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+        block.hashMerkleRoot = BlockMerkleRoot(block);
+        return block;
+    };
+    std::vector<CBlock> blocks;
+    for (uint32_t i = 0; i < 5; ++i) {
+        blocks.push_back(make_block(blocks.empty() ? uint256{} : blocks.back().GetHash(), i));
+    }
+    const CBlock fork_block{make_block(blocks[3].GetHash(), 100)};
+
+    std::vector<uint256> hashes;
+    std::vector<CBlockIndex> block_indexes(blocks.size());
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        hashes.push_back(blocks[i].GetHash());
+        block_indexes[i].nHeight = i;
+    }
+    for (size_t i = 0; i < blocks.size(); ++i) block_indexes[i].phashBlock = &hashes[i];
+    const uint256 fork_hash{fork_block.GetHash()};
+    CBlockIndex fork_index;
+    fork_index.nHeight = 4;
+    fork_index.phashBlock = &fork_hash;
+
+    auto block_info = [&](const CBlock& block, const uint256& hash, int height) {
+        interfaces::BlockInfo info{hash};
+        info.prev_hash = &block.hashPrevBlock;
+        info.height = height;
+        info.data = &block;
+        info.undo_data = &block_undo;
+        return info;
+    };
+    auto filter_hash = [&](const CBlock& block) { return BlockFilter(BlockFilterType::BASIC, block, block_undo).GetHash(); };
+
+    // Appending at the tip extends the cache.
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        BOOST_REQUIRE(BlockFilterIndexTester::Append(filter_index, block_info(blocks[i], hashes[i], i)));
+    }
+    BOOST_CHECK(BlockFilterIndexTester::CachedRange(filter_index) == std::make_pair(0, size_t{5}));
+
+    auto recent{BlockFilterIndexTester::LookupRecent(filter_index, 0, &block_indexes[4])};
+    BOOST_REQUIRE(recent);
+    BOOST_REQUIRE_EQUAL(recent->size(), 5U);
+    for (size_t i = 0; i < blocks.size(); ++i) BOOST_CHECK_EQUAL((*recent)[i], filter_hash(blocks[i]));
+    recent = BlockFilterIndexTester::LookupRecent(filter_index, 2, &block_indexes[3]);
+    BOOST_REQUIRE(recent);
+    BOOST_CHECK(*recent == std::vector<uint256>({filter_hash(blocks[2]), filter_hash(blocks[3])}));
+
+    // Lookups miss for a stop block that is not cached, or an empty range.
+    BOOST_CHECK(!BlockFilterIndexTester::LookupRecent(filter_index, 0, &fork_index));
+    BOOST_CHECK(!BlockFilterIndexTester::LookupRecent(filter_index, 4, &block_indexes[3]));
+
+    // Removing the tip pops it from the cache, and the fork block takes its place.
+    BOOST_REQUIRE(BlockFilterIndexTester::Remove(filter_index, block_info(blocks[4], hashes[4], 4)));
+    BOOST_CHECK(BlockFilterIndexTester::CachedRange(filter_index) == std::make_pair(0, size_t{4}));
+    BOOST_CHECK(!BlockFilterIndexTester::LookupRecent(filter_index, 4, &block_indexes[4]));
+    BOOST_REQUIRE(BlockFilterIndexTester::Append(filter_index, block_info(fork_block, fork_hash, 4)));
+    BOOST_CHECK(BlockFilterIndexTester::CachedRange(filter_index) == std::make_pair(0, size_t{5}));
+    BOOST_CHECK(!BlockFilterIndexTester::LookupRecent(filter_index, 0, &block_indexes[4]));
+    recent = BlockFilterIndexTester::LookupRecent(filter_index, 3, &fork_index);
+    BOOST_REQUIRE(recent);
+    BOOST_CHECK(*recent == std::vector<uint256>({filter_hash(blocks[3]), filter_hash(fork_block)}));
+
+    // Appending a block that does not extend the cached chain starts a new one.
+    CBlock far_block{make_block(uint256::ONE, 200)};
+    const uint256 far_hash{far_block.GetHash()};
+    BOOST_REQUIRE(BlockFilterIndexTester::Append(filter_index, block_info(far_block, far_hash, 10)));
+    BOOST_CHECK(BlockFilterIndexTester::CachedRange(filter_index) == std::make_pair(10, size_t{1}));
+    BOOST_CHECK(!BlockFilterIndexTester::LookupRecent(filter_index, 0, &block_indexes[3]));
+
+    // Removing a block that is not the cached tip drops the whole cache.
+    BOOST_REQUIRE(BlockFilterIndexTester::Remove(filter_index, block_info(fork_block, fork_hash, 4)));
+    BOOST_CHECK_EQUAL(BlockFilterIndexTester::CachedRange(filter_index).second, 0U);
+    BOOST_CHECK(!BlockFilterIndexTester::LookupRecent(filter_index, 3, &fork_index));
+}
+
 class IndexReorgCrash : public BaseIndex
 {
 private:
@@ -8,6 +8,7 @@
 #include <blockfilter.h>
 #include <core_io.h>
 #include <primitives/block.h>
+#include <random.h>
 #include <serialize.h>
 #include <streams.h>
 #include <undo.h>
@@ -16,6 +17,10 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(blockfilter_tests)
 
 BOOST_AUTO_TEST_CASE(gcsfilter_test)
@@ -54,6 +59,46 @@ BOOST_AUTO_TEST_CASE(gcsfilter_default_constructor)
     BOOST_CHECK_EQUAL(params.m_M, 1U);
 }
 
+BOOST_AUTO_TEST_CASE(blockfilters_match_any)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    const auto random_elements{[&](size_t count) {
+        GCSFilter::ElementSet elements;
+        while (elements.size() < count) elements.insert(rng.randbytes(1 + rng.randrange(40)));
+        return elements;
+    }};
+
+    const GCSFilter::ElementSet queries{random_elements(50)};
+    std::vector<BlockFilter> filters;
+    for (int i = 0; i < 200; ++i) {
+        const uint256 block_hash{rng.rand256()};
+        GCSFilter::ElementSet elements{random_elements(rng.randrange(100))};
+        // Some filters contain one of the queried elements.
+        if (i % 7 == 0) elements.insert(*std::next(queries.begin(), rng.randrange(queries.size())));
+        const GCSFilter filter({block_hash.GetUint64(0), block_hash.GetUint64(1), BASIC_FILTER_P, BASIC_FILTER_M}, elements);
+        filters.emplace_back(BlockFilterType::BASIC, block_hash, filter.GetEncoded(), /*skip_decode_check=*/false);
+    }
+
+    std::vector<bool> expected;
+    GCSFilterQuery query{queries};
+    for (const BlockFilter& filter : filters) {
+        expected.push_back(filter.GetFilter().MatchAny(queries));
+        BOOST_CHECK_EQUAL(query.MatchAny(filter.GetFilter()), expected.back());
+        // The hashed set is reused for the same filter.
+        BOOST_CHECK_EQUAL(query.MatchAny(filter.GetFilter()), expected.back());
+    }
+    BOOST_CHECK_GE(std::count(expected.begin(), expected.end(), true), 200 / 7);
+
+    for (int threads : {1, 3, 8}) {
+        BOOST_CHECK(BlockFiltersMatchAny(filters, queries, threads) == expected);
+    }
+    BOOST_CHECK(BlockFiltersMatchAny({}, queries, 4).empty());
+
+    // A malformed filter is reported to the caller.
+    filters[150] = BlockFilter{BlockFilterType::BASIC, rng.rand256(), {200}, /*skip_decode_check=*/true};
+    BOOST_CHECK_THROW(BlockFiltersMatchAny(filters, queries, 4), std::ios_base::failure);
+}
+
 BOOST_AUTO_TEST_CASE(blockfilter_basic_test)
 {
     CScript included_scripts[5], excluded_scripts[4];
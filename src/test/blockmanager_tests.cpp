@@ -8,6 +8,7 @@
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <node/kernel_notifications.h>
+#include <node/reorgprefetch.h>
 #include <script/solver.h>
 #include <primitives/block.h>
 #include <util/chaintype.h>
@@ -21,6 +22,7 @@ using node::STORAGE_HEADER_BYTES;
 using node::BlockManager;
 using node::KernelNotifications;
 using node::MAX_BLOCKFILE_SIZE;
+using node::ReorgPrefetcher;
 
 // use BasicTestingSetup here for the data directory configuration, setup, and cleanup
 BOOST_FIXTURE_TEST_SUITE(blockmanager_tests, BasicTestingSetup)
@@ -98,6 +100,33 @@ BOOST_FIXTURE_TEST_CASE(blockmanager_scan_unlink_already_pruned_files, TestChain
     BOOST_CHECK(!blockman.OpenBlockFile(new_pos, true).IsNull());
 }
 
+BOOST_FIXTURE_TEST_CASE(blockmanager_background_unlink, TestChain100Setup)
+{
+    const auto& chainman = Assert(m_node.chainman);
+    auto& blockman = chainman->m_blockman;
+    const CBlockIndex* old_tip{WITH_LOCK(chainman->GetMutex(), return chainman->ActiveChain().Tip())};
+    WITH_LOCK(chainman->GetMutex(), blockman.GetBlockFileInfo(old_tip->GetBlockPos().nFile)->nSize = MAX_BLOCKFILE_SIZE);
+    CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+
+    int file_number;
+    {
+        LOCK(chainman->GetMutex());
+        file_number = old_tip->GetBlockPos().nFile;
+        blockman.PruneBlockFiles({file_number});
+        BOOST_CHECK(!(old_tip->nStatus & BLOCK_HAVE_DATA));
+    }
+    const FlatFilePos pos(file_number, 0);
+    BOOST_CHECK(!blockman.OpenBlockFile(pos, true).IsNull());
+
+    blockman.ScheduleUnlinkPrunedFiles({file_number});
+    blockman.WaitForPrunedFileUnlinks();
+    BOOST_CHECK(blockman.OpenBlockFile(pos, true).IsNull());
+
+    // The file holding the tip is untouched.
+    const int new_file_number{WITH_LOCK(chainman->GetMutex(), return chainman->ActiveChain().Tip()->GetBlockPos().nFile)};
+    BOOST_CHECK(!blockman.OpenBlockFile(FlatFilePos(new_file_number, 0), true).IsNull());
+}
+
 BOOST_FIXTURE_TEST_CASE(blockmanager_block_data_availability, TestChain100Setup)
 {
     // The goal of the function is to return the first not pruned block in the range [upper_block, lower_block].
@@ -222,4 +251,154 @@ BOOST_AUTO_TEST_CASE(blockmanager_flush_block_file)
     BOOST_CHECK_EQUAL(read_block.nVersion, 2);
 }
 
+BOOST_AUTO_TEST_CASE(blockmanager_async_block_writes)
+{
+    KernelNotifications notifications{Assert(m_node.shutdown_request), m_node.exit_status, *Assert(m_node.warnings)};
+    node::BlockManager::Options blockman_opts{
+        .chainparams = Params(),
+        .async_block_writes = true,
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+        .block_tree_db_params = DBParams{
+            .path = m_args.GetDataDirNet() / "blocks" / "index",
+            .cache_bytes = 0,
+        },
+    };
+    BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+    BOOST_REQUIRE(blockman.GetWriteQueueStats());
+
+    CBlock block1;
+    block1.nVersion = 1;
+    CBlock block2;
+    block2.nVersion = 2;
+    constexpr int TEST_BLOCK_SIZE{81};
+
+    // Positions are assigned synchronously, the data is written in the background.
+    FlatFilePos pos1{blockman.WriteBlock(block1, /*nHeight=*/1)};
+    FlatFilePos pos2{blockman.WriteBlock(block2, /*nHeight=*/2)};
+    BOOST_CHECK_EQUAL(pos1.nPos, STORAGE_HEADER_BYTES);
+    BOOST_CHECK_EQUAL(pos2.nPos, TEST_BLOCK_SIZE + STORAGE_HEADER_BYTES * 2);
+    BOOST_CHECK_EQUAL(blockman.CalculateCurrentUsage(), (TEST_BLOCK_SIZE + STORAGE_HEADER_BYTES) * 2);
+
+    // Reads wait for queued writes to the same file
+    CBlock read_block;
+    {
+        ASSERT_DEBUG_LOG("Errors in block header");
+        BOOST_CHECK(!blockman.ReadBlock(read_block, pos2, {}));
+        BOOST_CHECK_EQUAL(read_block.nVersion, 2);
+    }
+    {
+        ASSERT_DEBUG_LOG("Errors in block header");
+        BOOST_CHECK(!blockman.ReadBlock(read_block, pos1, {}));
+        BOOST_CHECK_EQUAL(read_block.nVersion, 1);
+    }
+
+    // Writing the block index drains the queue
+    BOOST_CHECK(WITH_LOCK(::cs_main, return blockman.WriteBlockIndexDB()));
+    const auto stats{*blockman.GetWriteQueueStats()};
+    BOOST_CHECK_EQUAL(stats.queue_depth, 0U);
+    BOOST_CHECK_EQUAL(stats.bytes_pending, 0U);
+    BOOST_CHECK_EQUAL(stats.writes, 2U);
+    BOOST_CHECK_EQUAL(stats.bytes_written, (TEST_BLOCK_SIZE + STORAGE_HEADER_BYTES) * 2);
+    BOOST_CHECK_EQUAL(stats.failures, 0U);
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_block_index_dump, TestChain100Setup)
+{
+    std::vector<CBlockHeader> headers;
+    arith_uint256 tip_work;
+    {
+        LOCK(cs_main);
+        for (const CBlockIndex* index{m_node.chainman->ActiveTip()}; index; index = index->pprev) {
+            headers.push_back(index->GetBlockHeader());
+        }
+        tip_work = m_node.chainman->ActiveTip()->nChainWork;
+    }
+    std::reverse(headers.begin(), headers.end());
+
+    KernelNotifications notifications{Assert(m_node.shutdown_request), m_node.exit_status, *Assert(m_node.warnings)};
+    const fs::path dir{m_args.GetDataDirNet() / "dumptest"};
+    const node::BlockManager::Options blockman_opts{
+        .chainparams = Params(),
+        .persist_block_index = true,
+        .blocks_dir = m_args.GetBlocksDirPath(),
+        .notifications = notifications,
+        .block_tree_db_params = DBParams{
+            .path = dir / "index",
+            .cache_bytes = 0,
+        },
+    };
+    const auto load{[&](BlockManager& blockman) {
+        LOCK(cs_main);
+        BOOST_REQUIRE(blockman.LoadBlockIndexDB(std::nullopt));
+        BOOST_CHECK_EQUAL(blockman.m_block_index.size(), headers.size());
+        const CBlockIndex* tip{blockman.LookupBlockIndex(headers.back().GetHash())};
+        BOOST_REQUIRE(tip);
+        BOOST_CHECK(tip->nChainWork == tip_work);
+        BOOST_CHECK_EQUAL(tip->GetAncestor(0)->GetBlockHash(), headers.front().GetHash());
+    }};
+
+    {
+        BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+        LOCK(cs_main);
+        CBlockIndex* best_header{nullptr};
+        for (const auto& header : headers) blockman.AddToBlockIndex(header, best_header);
+        BOOST_CHECK(blockman.DumpBlockIndex());
+    }
+    BOOST_CHECK(fs::exists(dir / "blockindex.dat"));
+    {
+        // The dump is used while it matches the database...
+        BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+        ASSERT_DEBUG_LOG(strprintf("Loaded %u block index entries", headers.size()));
+        load(blockman);
+        // ...and invalidated by the next database write.
+        BOOST_CHECK(WITH_LOCK(cs_main, return blockman.WriteBlockIndexDB()));
+    }
+    {
+        BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+        ASSERT_DEBUG_LOG("Ignoring outdated block index dump");
+        load(blockman);
+        BOOST_CHECK(WITH_LOCK(cs_main, return blockman.DumpBlockIndex()));
+    }
+
+    // Corrupt one byte, which must make the dump unusable.
+    {
+        AutoFile file{fsbridge::fopen(dir / "blockindex.dat", "rb+")};
+        uint8_t byte;
+        file.seek(100, SEEK_SET);
+        file >> byte;
+        file.seek(100, SEEK_SET);
+        file << uint8_t(~byte);
+        BOOST_REQUIRE_EQUAL(file.fclose(), 0);
+    }
+    {
+        BlockManager blockman{*Assert(m_node.shutdown_signal), blockman_opts};
+        ASSERT_DEBUG_LOG("Checksum mismatch");
+        load(blockman);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(blockmanager_reorg_prefetch, TestChain100Setup)
+{
+    LOCK(cs_main);
+    BlockManager& blockman{m_node.chainman->m_blockman};
+    std::vector<const CBlockIndex*> path;
+    for (const CBlockIndex* index{m_node.chainman->ActiveTip()}; index->nHeight > 80; index = index->pprev) {
+        path.push_back(index);
+    }
+
+    ReorgPrefetcher prefetcher{blockman, path, /*num_threads=*/3};
+    // Only the next block of the path can be taken.
+    BOOST_CHECK(!prefetcher.Take(*path[1]));
+    for (const CBlockIndex* index : path) {
+        const auto entry{prefetcher.Take(*index)};
+        BOOST_REQUIRE(entry);
+        BOOST_CHECK_EQUAL(entry->block->GetHash(), index->GetBlockHash());
+        CBlockUndo undo;
+        BOOST_REQUIRE(blockman.ReadBlockUndo(undo, *index));
+        BOOST_CHECK_EQUAL(entry->undo.vtxundo.size(), undo.vtxundo.size());
+    }
+    BOOST_CHECK(!prefetcher.Take(*path.back()->pprev));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -114,4 +114,32 @@ BOOST_FIXTURE_TEST_CASE(coinstatsindex_unclean_shutdown, TestChain100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(coinstats_sharded, TestChain100Setup)
+{
+    Chainstate& chainstate = Assert(m_node.chainman)->ActiveChainstate();
+    WITH_LOCK(cs_main, chainstate.ForceFlushStateToDisk());
+    CCoinsViewDB& coins_db = WITH_LOCK(cs_main, return chainstate.CoinsDB());
+
+    // Computing the statistics in parallel must not change any of the results.
+    for (const auto hash_type : {kernel::CoinStatsHashType::HASH_SERIALIZED, kernel::CoinStatsHashType::MUHASH, kernel::CoinStatsHashType::NONE}) {
+        const auto expected{kernel::ComputeUTXOStats(hash_type, &coins_db, m_node.chainman->m_blockman)};
+        BOOST_REQUIRE(expected);
+        for (const int num_threads : {2, 3, 16}) {
+            const auto stats{kernel::ComputeUTXOStats(hash_type, &coins_db, m_node.chainman->m_blockman, {}, num_threads)};
+            BOOST_REQUIRE(stats);
+            BOOST_CHECK_EQUAL(stats->hashSerialized, expected->hashSerialized);
+            BOOST_CHECK_EQUAL(stats->coins_count, expected->coins_count);
+            BOOST_CHECK_EQUAL(stats->nTransactions, expected->nTransactions);
+            BOOST_CHECK_EQUAL(stats->nTransactionOutputs, expected->nTransactionOutputs);
+            BOOST_CHECK_EQUAL(stats->nBogoSize, expected->nBogoSize);
+            BOOST_CHECK(stats->total_amount == expected->total_amount);
+        }
+    }
+
+    // An interruption on the calling thread stops the workers.
+    struct Interrupted {
+    };
+    BOOST_CHECK_THROW(kernel::ComputeUTXOStats(kernel::CoinStatsHashType::HASH_SERIALIZED, &coins_db, m_node.chainman->m_blockman, [] { throw Interrupted{}; }, 4), Interrupted);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -12,6 +12,7 @@
 
 #include <deque>
 #include <mutex>
+#include <set>
 #include <shared_mutex>
 #include <thread>
 #include <vector>
@@ -49,6 +50,32 @@ BOOST_AUTO_TEST_CASE(test_cuckoocache_no_fakes)
     }
 };
 
+/* Test that for_each visits exactly the elements which are stored and not
+ * marked for erasure.
+ */
+BOOST_AUTO_TEST_CASE(test_cuckoocache_for_each)
+{
+    SeedRandomForTest(SeedRand::ZEROS);
+    CuckooCache::cache<uint256, SignatureCacheHasher> cc{};
+    cc.setup_bytes(1 << 20);
+    BOOST_CHECK_EQUAL(cc.capacity(), (1 << 20) / sizeof(uint256));
+
+    // Far below the capacity, so that no element is evicted.
+    std::set<uint256> kept;
+    for (int x = 0; x < 1000; ++x) {
+        const uint256 element{m_rng.rand256()};
+        cc.insert(element);
+        if (x % 4 == 0) {
+            BOOST_CHECK(cc.contains(element, /*erase=*/true));
+        } else {
+            kept.insert(element);
+        }
+    }
+    std::set<uint256> visited;
+    cc.for_each([&](const uint256& element) { BOOST_CHECK(visited.insert(element).second); });
+    BOOST_CHECK(visited == kept);
+};
+
 struct HitRateTest : BasicTestingSetup {
 /** This helper returns the hit rate when megabytes*load worth of entries are
  * inserted into a megabytes sized cache
@@ -2,14 +2,20 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <common/args.h>
 #include <dbwrapper.h>
+#include <node/database_args.h>
 #include <test/util/random.h>
 #include <test/util/setup_common.h>
 #include <uint256.h>
 #include <util/string.h>
 
+#include <algorithm>
+#include <chrono>
+#include <map>
 #include <memory>
 #include <ranges>
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 
@@ -422,5 +428,129 @@ BOOST_AUTO_TEST_CASE(unicodepath)
     BOOST_CHECK(fs::exists(lockPath));
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_multiread)
+{
+    for (const bool obfuscate : {false, true}) {
+        CDBWrapper dbw{{.path = m_args.GetDataDirBase() / "dbwrapper_multiread", .cache_bytes = 1_MiB, .memory_only = true, .obfuscate = obfuscate}};
+        // Clustered keys (several per prefix) and isolated ones.
+        std::map<std::pair<uint256, uint32_t>, uint256> entries;
+        CDBBatch batch{dbw};
+        for (int i = 0; i < 500; ++i) {
+            const uint256 prefix{m_rng.rand256()};
+            for (uint32_t n = 0; n < (i % 2 ? 1U : 5U); ++n) {
+                const auto [it, inserted] = entries.emplace(std::make_pair(prefix, n * 3), m_rng.rand256());
+                batch.Write(it->first, it->second);
+            }
+        }
+        dbw.WriteBatch(batch);
+        // A value that does not deserialize.
+        dbw.Write(std::make_pair(uint256::ONE, uint32_t{0}), uint8_t{1});
+
+        std::vector<std::pair<uint256, uint32_t>> keys;
+        for (const auto& [key, value] : entries) {
+            keys.push_back(key);
+            // Missing keys next to existing ones.
+            if (m_rng.randbool()) keys.emplace_back(key.first, key.second + 1);
+        }
+        keys.emplace_back(uint256::ONE, 0);
+        keys.emplace_back(m_rng.rand256(), 0);
+        keys.push_back(keys.front()); // duplicate
+        std::shuffle(keys.begin(), keys.end(), m_rng);
+
+        for (int threads : {1, 4}) {
+            const auto values{dbw.MultiRead<std::pair<uint256, uint32_t>, uint256>(keys, threads)};
+            BOOST_REQUIRE_EQUAL(values.size(), keys.size());
+            for (size_t i = 0; i < keys.size(); ++i) {
+                const auto it{entries.find(keys[i])};
+                if (it == entries.end()) {
+                    BOOST_CHECK(!values[i]);
+                } else {
+                    BOOST_REQUIRE(values[i]);
+                    BOOST_CHECK_EQUAL(*values[i], it->second);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_options_and_stats)
+{
+    constexpr size_t CACHE_SIZE{4_MiB};
+    DBOptions options;
+    options.bloom_bits = 0;
+    options.block_cache_percent = 20;
+    options.max_file_size = 4_MiB;
+    options.compact_after_bytes = 2_MiB;
+    CDBWrapper dbw{{.path = m_args.GetDataDirBase() / "dbstats", .cache_bytes = CACHE_SIZE, .memory_only = true, .options = options}};
+
+    DBStats stats{dbw.GetStats()};
+    BOOST_CHECK_EQUAL(stats.name, "dbstats");
+    BOOST_CHECK_EQUAL(stats.files_per_level.size(), 7U);
+    BOOST_CHECK_EQUAL(stats.block_cache_bytes, CACHE_SIZE / 100 * 20);
+    BOOST_CHECK_EQUAL(stats.write_buffer_bytes, (CACHE_SIZE - stats.block_cache_bytes) / 2);
+    BOOST_CHECK_EQUAL(stats.bloom_bits, 0);
+    BOOST_CHECK_EQUAL(stats.max_file_size, 4_MiB);
+    BOOST_CHECK(!stats.leveldb_stats.empty());
+
+    // Small batches do not count towards the compaction threshold.
+    for (uint32_t i{0}; i < 100; ++i) dbw.Write(i, m_rng.rand256());
+    stats = dbw.GetStats();
+    BOOST_CHECK_EQUAL(stats.batches_written, 100U);
+    BOOST_CHECK_EQUAL(stats.compactions_scheduled, 0U);
+
+    // Two large batches trigger one background compaction.
+    for (int batch_num{0}; batch_num < 2; ++batch_num) {
+        CDBBatch batch{dbw};
+        for (uint32_t i{0}; i < 40'000; ++i) batch.Write(std::make_pair(batch_num, i), m_rng.rand256());
+        BOOST_REQUIRE_GE(batch.ApproximateSize(), 1_MiB);
+        dbw.WriteBatch(batch);
+    }
+    stats = dbw.GetStats();
+    BOOST_CHECK_EQUAL(stats.batches_written, 102U);
+    BOOST_CHECK_EQUAL(stats.compactions_scheduled, 1U);
+    for (int i{0}; i < 1000 && dbw.GetStats().compactions_completed == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    stats = dbw.GetStats();
+    BOOST_CHECK_EQUAL(stats.compactions_completed, 1U);
+    BOOST_CHECK_EQUAL(stats.files_per_level.at(0), 0);
+    uint256 value;
+    BOOST_CHECK(dbw.Read(std::make_pair(1, uint32_t{39'999}), value));
+}
+
+BOOST_AUTO_TEST_CASE(database_args)
+{
+    ArgsManager args;
+    for (const char* name : {"-dbbloombits", "-dbblockcachepercent", "-dbmaxfilesize", "-dbcompactafter"}) {
+        args.AddArg(strprintf("%s=<n>", name), "", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    }
+    const auto parse{[&](std::vector<const char*> argv) {
+        argv.insert(argv.begin(), "ignored");
+        std::string error;
+        BOOST_REQUIRE(args.ParseParameters(argv.size(), argv.data(), error));
+    }};
+
+    parse({"-dbbloombits=12", "-dbbloombits=chainstate:16", "-dbmaxfilesize=indexes:8", "-dbcompactafter=64", "-dbcompactafter=blocks:0"});
+    DBOptions chainstate, blocks, indexes;
+    BOOST_CHECK(node::ReadDatabaseArgs(args, chainstate, node::DB_TYPE_CHAINSTATE));
+    BOOST_CHECK(node::ReadDatabaseArgs(args, blocks, node::DB_TYPE_BLOCKS));
+    BOOST_CHECK(node::ReadDatabaseArgs(args, indexes, node::DB_TYPE_INDEXES));
+    BOOST_CHECK_EQUAL(chainstate.bloom_bits, 16);
+    BOOST_CHECK_EQUAL(blocks.bloom_bits, 12);
+    BOOST_CHECK_EQUAL(indexes.bloom_bits, 12);
+    BOOST_CHECK_EQUAL(chainstate.max_file_size, DBWRAPPER_MAX_FILE_SIZE);
+    BOOST_CHECK_EQUAL(indexes.max_file_size, 8_MiB);
+    BOOST_CHECK_EQUAL(chainstate.compact_after_bytes, 64_MiB);
+    BOOST_CHECK_EQUAL(blocks.compact_after_bytes, 0U);
+    BOOST_CHECK_EQUAL(blocks.block_cache_percent, DEFAULT_DB_BLOCK_CACHE_PERCENT);
+
+    // Malformed values are reported whichever database they apply to.
+    for (const char* bad : {"-dbblockcachepercent=101", "-dbbloombits=wallet:10", "-dbmaxfilesize=blocks:1", "-dbbloombits=indexes:x"}) {
+        parse({bad});
+        DBOptions options;
+        BOOST_CHECK(!node::ReadDatabaseArgs(args, options, node::DB_TYPE_CHAINSTATE));
+    }
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -195,6 +195,18 @@ void TestCoinsView(FuzzedDataProvider& fuzzed_data_provider, CCoinsView& backend
         } else {
             assert(!exists_using_have_coin_in_backend);
         }
+        // Batched lookups return the same coins as single ones.
+        const std::vector<COutPoint> outpoints{random_out_point, COutPoint{random_out_point.hash, random_out_point.n + 1}, random_out_point};
+        const auto backend_coins{backend_coins_view.GetCoins(outpoints)};
+        const auto cache_coins{coins_view_cache.GetCoins(outpoints)};
+        assert(backend_coins.size() == outpoints.size() && cache_coins.size() == outpoints.size());
+        const auto same_coin{[](const std::optional<Coin>& a, const std::optional<Coin>& b) {
+            return a.has_value() == b.has_value() && (!a || *a == *b);
+        }};
+        for (size_t i = 0; i < outpoints.size(); ++i) {
+            assert(same_coin(backend_coins[i], backend_coins_view.GetCoin(outpoints[i])));
+            assert(same_coin(cache_coins[i], coins_view_cache.GetCoin(outpoints[i])));
+        }
     }
 
     {
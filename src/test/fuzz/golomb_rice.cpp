@@ -16,6 +16,8 @@
 #include <cassert>
 #include <cstdint>
 #include <iosfwd>
+#include <optional>
+#include <span>
 #include <unordered_set>
 #include <vector>
 
@@ -80,6 +82,34 @@ FUZZ_TARGET(golomb_rice)
 
     assert(encoded_deltas == decoded_deltas);
 
+    {
+        // The word-at-a-time coder is bit-identical to the bit stream one (which
+        // does not support P = 64).
+        const uint8_t p{fuzzed_data_provider.ConsumeIntegralInRange<uint8_t>(0, 63)};
+        const int value_bits{std::min(p + 8, 64)};
+        std::vector<uint64_t> values;
+        const int n = fuzzed_data_provider.ConsumeIntegralInRange<int>(0, 64);
+        for (int i = 0; i < n; ++i) {
+            const uint64_t value{fuzzed_data_provider.ConsumeIntegral<uint64_t>()};
+            values.push_back(value_bits == 64 ? value : value & ((uint64_t{1} << value_bits) - 1));
+        }
+        std::vector<uint8_t> bit_stream_data;
+        {
+            VectorWriter stream{bit_stream_data, 0};
+            BitStreamWriter bitwriter{stream};
+            for (uint64_t value : values) GolombRiceEncode(bitwriter, p, value);
+        }
+        std::vector<uint8_t> word_data;
+        {
+            GolombRiceWriter writer{word_data};
+            for (uint64_t value : values) writer.Encode(p, value);
+        }
+        assert(word_data == bit_stream_data);
+        GolombRiceReader reader{word_data};
+        for (uint64_t value : values) assert(reader.Decode(p) == value);
+        assert(reader.BytesConsumed() == word_data.size());
+    }
+
     {
         const std::vector<uint8_t> random_bytes = ConsumeRandomLengthByteVector(fuzzed_data_provider, 1024);
         SpanReader stream{random_bytes};
@@ -90,11 +120,20 @@ FUZZ_TARGET(golomb_rice)
             return;
         }
         BitStreamReader bitreader{stream};
+        GolombRiceReader reader{std::span{random_bytes}.last(stream.size())};
         for (uint32_t i = 0; i < std::min<uint32_t>(n, 1024); ++i) {
+            // Both decoders agree, including on where the data ends.
+            std::optional<uint64_t> bit_stream_value, word_value;
+            try {
+                bit_stream_value = GolombRiceDecode(bitreader, BASIC_FILTER_P);
+            } catch (const std::ios_base::failure&) {
+            }
             try {
-                (void)GolombRiceDecode(bitreader, BASIC_FILTER_P);
+                word_value = reader.Decode(BASIC_FILTER_P);
             } catch (const std::ios_base::failure&) {
             }
+            assert(bit_stream_value == word_value);
+            if (!word_value) break;
         }
     }
 }
@@ -127,6 +127,7 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "getchainstates",
     "getchaintxstats",
     "getconnectioncount",
+    "getdbstats",
     "getdeploymentinfo",
     "getdescriptoractivity",
     "getdescriptorinfo",
@@ -148,10 +149,14 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "getrawaddrman",
     "getrawmempool",
     "getrawtransaction",
+    "getrawtransactions",
+    "getscripthashhistory",
+    "getscripthashunspent",
     "getrpcinfo",
     "gettxout",
     "gettxoutsetinfo",
     "gettxspendingprevout",
+    "getvalidationcacheinfo",
     "help",
     "invalidateblock",
     "joinpsbts",
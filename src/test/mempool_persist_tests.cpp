@@ -0,0 +1,100 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <node/mempool_persist.h>
+#include <node/mempool_persist_args.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <txmempool.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using node::DumpMempool;
+using node::LoadMempool;
+
+BOOST_FIXTURE_TEST_SUITE(mempool_persist_tests, TestChain100Setup)
+
+BOOST_AUTO_TEST_CASE(mempool_persist_roundtrip)
+{
+    CTxMemPool& pool{*Assert(m_node.mempool)};
+    Chainstate& chainstate{m_node.chainman->ActiveChainstate()};
+    const fs::path path{node::MempoolPath(m_args)};
+    const CScript script{GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()))};
+
+    // Confirm a few outputs to build the mempool transactions on.
+    const CTransactionRef& coinbase{m_coinbase_txns[0]};
+    const auto [fanout, fanout_fee]{CreateValidTransaction({coinbase}, {COutPoint{coinbase->GetHash(), 0}}, /*input_height=*/1, {coinbaseKey},
+                                                           std::vector<CTxOut>(3, CTxOut{coinbase->vout[0].nValue / 4, script}), {}, {})};
+    CreateAndProcessBlock({fanout}, script);
+    const CTransactionRef fanout_tx{MakeTransactionRef(fanout)};
+    const int height{WITH_LOCK(::cs_main, return chainstate.m_chain.Height())};
+    auto spend = [&](const CTransactionRef& prev, uint32_t vout) {
+        return MakeTransactionRef(CreateValidMempoolTransaction(prev, vout, height, coinbaseKey, script, prev->vout[vout].nValue - 10'000));
+    };
+
+    // The oldest transaction expires by the time the mempool is loaded again.
+    const auto start{Now<NodeSeconds>()};
+    SetMockTime(start);
+    const CTransactionRef expiring{spend(fanout_tx, 0)};
+    const auto entry_time{start + pool.m_opts.expiry - 1h};
+    SetMockTime(entry_time);
+
+    // A chain of transactions, which can only be loaded if parents are written before their children.
+    std::vector<CTransactionRef> chain{spend(fanout_tx, 1)};
+    for (int i = 0; i < 4; ++i) chain.push_back(spend(chain.back(), 0));
+    const CTransactionRef prioritised{spend(fanout_tx, 2)};
+    pool.PrioritiseTransaction(prioritised->GetHash(), 5'000);
+    const Txid absent{Txid::FromUint256(m_rng.rand256())};
+    pool.PrioritiseTransaction(absent, 7'000);
+    BOOST_REQUIRE_EQUAL(pool.size(), chain.size() + 2);
+
+    BOOST_REQUIRE(DumpMempool(pool, path));
+
+    auto clear_mempool = [&] {
+        const auto deltas{pool.GetPrioritisedTransactions()};
+        LOCK(pool.cs);
+        for (const auto& tx : {expiring, chain.front(), prioritised}) {
+            if (pool.exists(tx->GetHash())) pool.removeRecursive(*tx, MemPoolRemovalReason::REPLACED);
+        }
+        for (const auto& delta : deltas) pool.ClearPrioritisation(delta.txid);
+        BOOST_REQUIRE_EQUAL(pool.size(), 0U);
+    };
+    clear_mempool();
+
+    SetMockTime(start + pool.m_opts.expiry + 1h);
+    BOOST_REQUIRE(LoadMempool(pool, path, chainstate, {}));
+    BOOST_CHECK_EQUAL(pool.size(), chain.size() + 1);
+    BOOST_CHECK(!pool.exists(expiring->GetHash()));
+    for (const auto& tx : chain) {
+        BOOST_CHECK(pool.exists(tx->GetHash()));
+        BOOST_CHECK(pool.info(tx->GetHash()).m_time == entry_time.time_since_epoch());
+    }
+    BOOST_CHECK_EQUAL(pool.info(prioritised->GetHash()).nFeeDelta, 5'000);
+    const auto deltas{pool.GetPrioritisedTransactions()};
+    BOOST_CHECK_EQUAL(deltas.size(), 2U);
+    for (const auto& delta : deltas) {
+        BOOST_CHECK_EQUAL(delta.in_mempool, delta.txid == prioritised->GetHash());
+        BOOST_CHECK_EQUAL(delta.delta, delta.in_mempool ? 5'000 : 7'000);
+    }
+
+    // An interrupt stops the load after the transaction being accepted, in the middle of a batch.
+    clear_mempool();
+    BOOST_REQUIRE(m_interrupt());
+    BOOST_CHECK(!LoadMempool(pool, path, chainstate, {}));
+    BOOST_CHECK_EQUAL(pool.size(), 1U);
+    BOOST_REQUIRE(m_interrupt.reset());
+    clear_mempool();
+
+    SetMockTime(0s);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
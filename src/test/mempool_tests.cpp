@@ -5,6 +5,7 @@
 #include <common/system.h>
 #include <policy/policy.h>
 #include <test/util/txmempool.h>
+#include <txgraph.h>
 #include <txmempool.h>
 #include <util/time.h>
 
@@ -537,23 +538,25 @@ BOOST_AUTO_TEST_CASE(MempoolSizeLimitTest)
     AddToMempool(pool, entry.Fee(110LL).FromTx(tx6));
     AddToMempool(pool, entry.Fee(900LL).FromTx(tx7));
 
-    // we only require this to remove, at max, 2 txn, because it's not clear what we're really optimizing for aside from that
+    // tx7 pays for both of its parents, so tx5, tx6 and tx7 form the worst chunk and are evicted together
     pool.TrimToSize(pool.DynamicMemoryUsage() - 1);
     BOOST_CHECK(pool.exists(tx4.GetHash()));
-    BOOST_CHECK(pool.exists(tx6.GetHash()));
+    BOOST_CHECK(!pool.exists(tx5.GetHash()));
+    BOOST_CHECK(!pool.exists(tx6.GetHash()));
     BOOST_CHECK(!pool.exists(tx7.GetHash()));
 
-    if (!pool.exists(tx5.GetHash()))
-        AddToMempool(pool, entry.Fee(100LL).FromTx(tx5));
+    AddToMempool(pool, entry.Fee(100LL).FromTx(tx5));
+    AddToMempool(pool, entry.Fee(110LL).FromTx(tx6));
     AddToMempool(pool, entry.Fee(900LL).FromTx(tx7));
 
-    pool.TrimToSize(pool.DynamicMemoryUsage() / 2); // should maximize mempool size by only removing 5/7
+    pool.TrimToSize(pool.DynamicMemoryUsage() / 2); // should maximize mempool size by only removing the 5/6/7 chunk
     BOOST_CHECK(pool.exists(tx4.GetHash()));
     BOOST_CHECK(!pool.exists(tx5.GetHash()));
-    BOOST_CHECK(pool.exists(tx6.GetHash()));
+    BOOST_CHECK(!pool.exists(tx6.GetHash()));
     BOOST_CHECK(!pool.exists(tx7.GetHash()));
 
     AddToMempool(pool, entry.Fee(100LL).FromTx(tx5));
+    AddToMempool(pool, entry.Fee(110LL).FromTx(tx6));
     AddToMempool(pool, entry.Fee(900LL).FromTx(tx7));
 
     std::vector<CTransactionRef> vtx;
@@ -804,4 +807,32 @@ BOOST_AUTO_TEST_CASE(MempoolAncestryTestsDiamond)
     BOOST_CHECK_EQUAL(descendants, 4ULL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolOversizedClusterTest)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    LOCK2(::cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    // A parent with one child more than the transaction graph can linearize in one cluster.
+    const CTransactionRef parent{make_tx(std::vector<CAmount>(MAX_CLUSTER_COUNT_LIMIT, 10 * COIN))};
+    AddToMempool(pool, entry.Fee(10000LL).FromTx(parent));
+    std::vector<CTransactionRef> children;
+    for (uint32_t i{0}; i < MAX_CLUSTER_COUNT_LIMIT; ++i) {
+        children.push_back(make_tx({9 * COIN}, {parent}, {i}));
+        AddToMempool(pool, entry.Fee(i == 0 ? 1 : 10000LL + i).FromTx(children.back()));
+    }
+    BOOST_CHECK_EQUAL(pool.size(), MAX_CLUSTER_COUNT_LIMIT + 1);
+    BOOST_CHECK(pool.m_txgraph->IsOversized());
+    BOOST_CHECK(!pool.GetBlockBuilder());
+
+    // Eviction falls back to the lowest descendant score, which is the child paying 1 sat.
+    pool.TrimToSize(pool.DynamicMemoryUsage() - 1);
+    BOOST_CHECK(!pool.exists(children[0]->GetHash()));
+    BOOST_CHECK_EQUAL(pool.size(), MAX_CLUSTER_COUNT_LIMIT);
+
+    // The remaining cluster fits the graph again.
+    BOOST_CHECK(!pool.m_txgraph->IsOversized());
+    BOOST_CHECK(pool.GetBlockBuilder());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
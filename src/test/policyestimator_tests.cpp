@@ -2,9 +2,11 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <kernel/mempool_entry.h>
 #include <policy/fees.h>
 #include <policy/fees_args.h>
 #include <policy/policy.h>
+#include <streams.h>
 #include <test/util/txmempool.h>
 #include <txmempool.h>
 #include <uint256.h>
@@ -15,6 +17,24 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <vector>
+
+class CBlockPolicyEstimatorTester
+{
+public:
+    static CFeeRate EstimateSmartFeeLocked(const CBlockPolicyEstimator& estimator, int conf_target, FeeCalculation* fee_calc, bool conservative)
+    {
+        LOCK(estimator.m_cs_fee_estimator);
+        return estimator.estimateSmartFeeLocked(conf_target, fee_calc, conservative);
+    }
+
+    static unsigned int MaxUsableEstimate(const CBlockPolicyEstimator& estimator)
+    {
+        LOCK(estimator.m_cs_fee_estimator);
+        return estimator.MaxUsableEstimate();
+    }
+};
+
 BOOST_FIXTURE_TEST_SUITE(policyestimator_tests, ChainTestingSetup)
 
 BOOST_AUTO_TEST_CASE(BlockPolicyEstimates)
@@ -262,4 +282,118 @@ BOOST_AUTO_TEST_CASE(BlockPolicyEstimates)
     }
 }
 
+BOOST_AUTO_TEST_CASE(SmartFeeSnapshot)
+{
+    CBlockPolicyEstimator feeEst{FeeestPath(*m_node.args), DEFAULT_ACCEPT_STALE_FEE_ESTIMATES};
+    TestMemPoolEntryHelper entry;
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vout.resize(1);
+    const std::vector<int> targets{1, 2, 3, 5, 6, 12, 24, 48, 100, 1008, 1009};
+
+    // Every answer served from the snapshot, whether computed by this query or
+    // an earlier one, must equal the answer computed under the lock.
+    auto check_snapshot = [&](const CBlockPolicyEstimator& estimator) {
+        for (const int target : targets) {
+            for (const bool conservative : {false, true}) {
+                FeeCalculation first_calc, cached_calc, locked_calc;
+                const CFeeRate first{estimator.estimateSmartFee(target, &first_calc, conservative)};
+                const CFeeRate cached{estimator.estimateSmartFee(target, &cached_calc, conservative)};
+                const CFeeRate locked{CBlockPolicyEstimatorTester::EstimateSmartFeeLocked(estimator, target, &locked_calc, conservative)};
+                for (const auto& [feerate, calc] : {std::pair{first, first_calc}, std::pair{cached, cached_calc}}) {
+                    BOOST_CHECK(feerate == locked);
+                    BOOST_CHECK(calc.reason == locked_calc.reason);
+                    BOOST_CHECK_EQUAL(calc.desiredTarget, locked_calc.desiredTarget);
+                    BOOST_CHECK_EQUAL(calc.returnedTarget, locked_calc.returnedTarget);
+                    BOOST_CHECK_EQUAL(calc.est.scale, locked_calc.est.scale);
+                    BOOST_CHECK_EQUAL(calc.est.pass.start, locked_calc.est.pass.start);
+                    BOOST_CHECK_EQUAL(calc.est.pass.end, locked_calc.est.pass.end);
+                }
+            }
+        }
+    };
+
+    // Without any blocks no target is usable.
+    check_snapshot(feeEst);
+    BOOST_CHECK_EQUAL(CBlockPolicyEstimatorTester::MaxUsableEstimate(feeEst), 0U);
+
+    // Track 4 transactions per feerate each block, where the higher feerates are
+    // confirmed in the next block more often.
+    std::vector<RemovedMempoolTransactionInfo> unconfirmed;
+    unsigned int height{0};
+    auto add_transactions = [&] {
+        for (int j = 0; j < 10; ++j) {
+            for (int k = 0; k < 4; ++k) {
+                tx.vin[0].prevout.n = 10000 * height + 100 * j + k;
+                const auto& info{unconfirmed.emplace_back(entry.Fee(2000 * (j + 1)).Height(height).FromTx(tx)).info};
+                feeEst.processTransaction(NewMempoolTransactionInfo{info.m_tx, info.m_fee, info.m_virtual_transaction_size, info.txHeight,
+                                                                    /*mempool_limit_bypassed=*/false,
+                                                                    /*submitted_in_package=*/false,
+                                                                    /*chainstate_is_current=*/true,
+                                                                    /*has_no_mempool_parents=*/true});
+            }
+        }
+    };
+    auto mine_block = [&] {
+        std::vector<RemovedMempoolTransactionInfo> confirmed, remaining;
+        for (const auto& removed : unconfirmed) {
+            (removed.info.m_fee >= 2000 * static_cast<CAmount>(10 - height % 10) ? confirmed : remaining).push_back(removed);
+        }
+        unconfirmed.swap(remaining);
+        feeEst.processBlock(confirmed, ++height);
+    };
+    while (height < 40) {
+        add_transactions();
+        mine_block();
+        check_snapshot(feeEst);
+    }
+
+    // Targets of 1 are raised to 2, and targets above the highest usable one
+    // are lowered to it, while the requested target is still reported.
+    const unsigned int max_usable{CBlockPolicyEstimatorTester::MaxUsableEstimate(feeEst)};
+    BOOST_REQUIRE_GT(max_usable, 2U);
+    BOOST_REQUIRE_LT(max_usable, 100U);
+    FeeCalculation calc;
+    feeEst.estimateSmartFee(1, &calc, /*conservative=*/false);
+    BOOST_CHECK_EQUAL(calc.desiredTarget, 1);
+    BOOST_CHECK_EQUAL(calc.returnedTarget, 2);
+    const CFeeRate highest{feeEst.estimateSmartFee(100, &calc, /*conservative=*/false)};
+    BOOST_CHECK_EQUAL(calc.desiredTarget, 100);
+    BOOST_CHECK_EQUAL(calc.returnedTarget, static_cast<int>(max_usable));
+    BOOST_CHECK(highest == feeEst.estimateSmartFee(max_usable, nullptr, /*conservative=*/false));
+    BOOST_CHECK(feeEst.estimateSmartFee(1009, &calc, /*conservative=*/false) == CFeeRate(0));
+    BOOST_CHECK_EQUAL(calc.desiredTarget, 1009);
+    BOOST_CHECK_EQUAL(calc.returnedTarget, 1009);
+
+    // Answers already given are frozen until the next block, even though the
+    // transactions arriving in between are tracked.
+    std::vector<CFeeRate> frozen;
+    for (const int target : targets) frozen.push_back(feeEst.estimateSmartFee(target, nullptr, /*conservative=*/false));
+    add_transactions();
+    for (size_t i = 0; i < targets.size(); ++i) {
+        BOOST_CHECK(feeEst.estimateSmartFee(targets[i], nullptr, /*conservative=*/false) == frozen[i]);
+    }
+    mine_block();
+    check_snapshot(feeEst);
+
+    // Reading estimates replaces the snapshot with one matching the read data.
+    const fs::path path{m_path_root / "fee_estimates_snapshot.dat"};
+    {
+        AutoFile file{fsbridge::fopen(path, "wb")};
+        BOOST_REQUIRE(feeEst.Write(file));
+        BOOST_REQUIRE_EQUAL(file.fclose(), 0);
+    }
+    CBlockPolicyEstimator readEst{FeeestPath(*m_node.args), DEFAULT_ACCEPT_STALE_FEE_ESTIMATES};
+    readEst.estimateSmartFee(2, nullptr, /*conservative=*/false);
+    {
+        AutoFile file{fsbridge::fopen(path, "rb")};
+        BOOST_REQUIRE(readEst.Read(file));
+    }
+    check_snapshot(readEst);
+
+    // Flushing the unconfirmed transactions refreshes the snapshot as well.
+    feeEst.FlushUnconfirmed();
+    check_snapshot(feeEst);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
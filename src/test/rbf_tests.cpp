@@ -627,6 +627,97 @@ BOOST_FIXTURE_TEST_CASE(calc_feerate_diagram_rbf, TestChain100Setup)
     }
 }
 
+/** The chunks CalculateChunksForRBF computes from ancestor/descendant state while some cluster is
+ *  too large for the transaction graph. Exact for a single replacement transaction without
+ *  in-mempool parents, in clusters of at most two transactions. */
+static std::pair<std::vector<FeeFrac>, std::vector<FeeFrac>> AncestorDescendantChunks(const CTxMemPool& pool, const CTxMemPool::setEntries& to_remove, const FeeFrac& replacement)
+    EXCLUSIVE_LOCKS_REQUIRED(pool.cs)
+{
+    std::vector<FeeFrac> old_chunks;
+    for (auto it : to_remove) {
+        // A parent is chunked together with its child.
+        if (it->GetCountWithDescendants() > 1) continue;
+        FeeFrac individual{it->GetModifiedFee(), it->GetTxSize()};
+        if (it->GetCountWithAncestors() > 1) {
+            FeeFrac package{it->GetModFeesWithAncestors(), static_cast<int32_t>(it->GetSizeWithAncestors())};
+            if (individual >> package) {
+                old_chunks.push_back(package);
+            } else {
+                old_chunks.push_back(package - individual);
+                old_chunks.push_back(individual);
+            }
+        } else {
+            old_chunks.push_back(individual);
+        }
+    }
+    std::sort(old_chunks.begin(), old_chunks.end(), std::greater());
+
+    std::vector<FeeFrac> new_chunks{replacement};
+    for (auto it : to_remove) {
+        // Parents of conflicts that are not replaced stay behind on their own.
+        for (const CTxMemPoolEntry& parent : it->GetMemPoolParentsConst()) {
+            if (!to_remove.contains(pool.mapTx.iterator_to(parent))) new_chunks.emplace_back(parent.GetModifiedFee(), parent.GetTxSize());
+        }
+    }
+    std::sort(new_chunks.begin(), new_chunks.end(), std::greater());
+    return {std::move(old_chunks), std::move(new_chunks)};
+}
+
+BOOST_AUTO_TEST_CASE(calc_feerate_diagram_matches_ancestor_chunks)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    TestMemPoolEntryHelper entry;
+    // Transactions not in the mempool, for the others to spend.
+    std::vector<CTransactionRef> funding;
+    for (int i = 0; i < 200; ++i) funding.push_back(make_tx(/*inputs=*/{}, /*output_values=*/{10 * COIN, 10 * COIN, i}));
+
+    for (int round = 0; round < 20; ++round) {
+        bilingual_str error;
+        CTxMemPool pool{MemPoolOptionsForTest(m_node), error};
+        BOOST_REQUIRE(error.empty());
+        LOCK2(::cs_main, pool.cs);
+
+        // Clusters of one or two transactions, of which a random part is replaced: a singleton,
+        // a parent with its child, or only the child.
+        CTxMemPool::setEntries to_remove;
+        for (int cluster = 0; cluster < 8; ++cluster) {
+            const auto parent{make_tx(/*inputs=*/{funding[round * 10 + cluster]}, /*output_values=*/{9 * COIN})};
+            AddToMempool(pool, entry.Fee(rng.randrange(100'000) + 1).FromTx(parent));
+            const auto parent_it{*pool.GetIter(parent->GetHash())};
+            std::optional<CTxMemPool::txiter> child_it;
+            if (rng.randbool()) {
+                const auto child{make_tx(/*inputs=*/{parent}, /*output_values=*/{8 * COIN})};
+                AddToMempool(pool, entry.Fee(rng.randrange(100'000) + 1).FromTx(child));
+                child_it = *pool.GetIter(child->GetHash());
+            }
+            switch (rng.randrange(3)) {
+            case 0: break;
+            case 1:
+                to_remove.insert(parent_it);
+                if (child_it) to_remove.insert(*child_it);
+                break;
+            case 2:
+                if (child_it) to_remove.insert(*child_it);
+                break;
+            }
+        }
+        if (to_remove.empty()) continue;
+
+        const auto replacement_tx{make_tx(/*inputs=*/{funding[round * 10 + 9]}, /*output_values=*/{5 * COIN})};
+        const CAmount replacement_fee{static_cast<CAmount>(rng.randrange(200'000))};
+        auto changeset{pool.GetChangeSet()};
+        for (auto it : to_remove) changeset->StageRemoval(it);
+        changeset->StageAddition(replacement_tx, replacement_fee, 0, 1, 0, false, 4, LockPoints());
+        const auto chunks{changeset->CalculateChunksForRBF()};
+        BOOST_REQUIRE(chunks.has_value());
+
+        const int32_t replacement_size{static_cast<int32_t>(entry.FromTx(replacement_tx).GetTxSize())};
+        const auto expected{AncestorDescendantChunks(pool, to_remove, {replacement_fee, replacement_size})};
+        BOOST_CHECK(chunks->first == expected.first);
+        BOOST_CHECK(chunks->second == expected.second);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(feerate_chunks_utilities)
 {
     // Sanity check the correctness of the feerate chunks comparison.
@@ -0,0 +1,96 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <consensus/validation.h>
+#include <index/scripthashindex.h>
+#include <interfaces/chain.h>
+#include <key.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(scripthashindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(scripthashindex_initial_sync, TestChain100Setup)
+{
+    ScriptHashIndex index(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(index.Init());
+
+    const CScript& coinbase_script{m_coinbase_txns[0]->vout[0].scriptPubKey};
+    const uint256 coinbase_hash{ComputeScriptHash(coinbase_script)};
+
+    // Nothing is found before the index is started.
+    BOOST_CHECK(index.FindHistory(coinbase_hash)->empty());
+
+    index.Sync();
+
+    // Every coinbase of the test chain pays to the same script.
+    auto history{index.FindHistory(coinbase_hash)};
+    BOOST_REQUIRE(history);
+    BOOST_REQUIRE_EQUAL(history->size(), m_coinbase_txns.size());
+    for (size_t i = 0; i < history->size(); ++i) {
+        const auto& entry{(*history)[i]};
+        BOOST_CHECK_EQUAL(entry.height, int(i + 1));
+        BOOST_CHECK_EQUAL(entry.tx_pos, 0U);
+        BOOST_CHECK(!entry.spending);
+        BOOST_CHECK(entry.txid == m_coinbase_txns[i]->GetHash());
+        BOOST_CHECK_EQUAL(entry.amount, m_coinbase_txns[i]->vout[0].nValue);
+    }
+    BOOST_CHECK_EQUAL(index.FindHistory(coinbase_hash, /*from_height=*/51)->size(), 50U);
+
+    // Spend the first coinbase to a new script.
+    CKey key{GenerateRandomKey()};
+    const CScript dest_script{GetScriptForDestination(PKHash(key.GetPubKey()))};
+    const uint256 dest_hash{ComputeScriptHash(dest_script)};
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 1, coinbaseKey, dest_script, 1 * COIN, /*submit=*/false)};
+    CreateAndProcessBlock({spend}, coinbase_script);
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+
+    history = index.FindHistory(coinbase_hash);
+    BOOST_REQUIRE(history);
+    BOOST_REQUIRE_EQUAL(history->size(), m_coinbase_txns.size() + 2);
+    const auto& spent_entry{(*history)[history->size() - 1]};
+    BOOST_CHECK(spent_entry.spending);
+    BOOST_CHECK_EQUAL(spent_entry.tx_pos, 1U);
+    BOOST_CHECK(spent_entry.txid == spend.GetHash());
+    BOOST_CHECK(spent_entry.outpoint == COutPoint(m_coinbase_txns[0]->GetHash(), 0));
+
+    auto unspent{index.FindUnspent(coinbase_hash)};
+    BOOST_REQUIRE(unspent);
+    BOOST_CHECK_EQUAL(unspent->size(), m_coinbase_txns.size());
+    BOOST_CHECK(unspent->front().txid == m_coinbase_txns[1]->GetHash());
+
+    auto dest_unspent{index.FindUnspent(dest_hash)};
+    BOOST_REQUIRE(dest_unspent);
+    BOOST_REQUIRE_EQUAL(dest_unspent->size(), 1U);
+    BOOST_CHECK(dest_unspent->front().outpoint == COutPoint(spend.GetHash(), 0));
+    BOOST_CHECK_EQUAL(dest_unspent->front().amount, 1 * COIN);
+
+    // Replace the block by one without the spend. The index rewinds the old
+    // block when the new one is connected, which removes its entries.
+    BlockValidationState state;
+    CBlockIndex* tip{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+    BOOST_CHECK(m_node.chainman->ActiveChainstate().InvalidateBlock(state, tip));
+    CreateAndProcessBlock({}, coinbase_script);
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+
+    BOOST_CHECK(index.FindHistory(dest_hash)->empty());
+    BOOST_CHECK_EQUAL(index.FindHistory(coinbase_hash)->size(), m_coinbase_txns.size() + 1);
+    BOOST_CHECK_EQUAL(index.FindUnspent(coinbase_hash)->size(), m_coinbase_txns.size() + 1);
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification. The BlockUntilSyncedToCurrentChain()
+    // calls above are sufficient to ensure this, but the
+    // SyncWithValidationInterfaceQueue() call below is also needed to ensure
+    // TSAN always sees the test thread waiting for the notification thread, and
+    // avoid potential false positive reports.
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
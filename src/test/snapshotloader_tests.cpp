@@ -0,0 +1,260 @@
+// Copyright (c) 2025-present The Bitquantum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <coins.h>
+#include <hash.h>
+#include <kernel/coinstats.h>
+#include <node/snapshotloader.h>
+#include <node/snapshotwriter.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <txdb.h>
+#include <util/fs.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using node::LoadSnapshotCoins;
+using node::SnapshotLoadOptions;
+
+namespace {
+
+using CoinList = std::vector<std::pair<COutPoint, Coin>>;
+
+struct SnapshotLoaderSetup : public BasicTestingSetup {
+    const fs::path m_path{m_path_root / "snapshot_coins.dat"};
+
+    //! Two coins for each of `num_txids` sorted txids, in snapshot order.
+    CoinList MakeCoins(size_t num_txids)
+    {
+        std::vector<Txid> txids;
+        for (size_t i = 0; i < num_txids; ++i) txids.push_back(Txid::FromUint256(m_rng.rand256()));
+        std::sort(txids.begin(), txids.end());
+
+        CoinList coins;
+        for (const Txid& txid : txids) {
+            for (uint32_t n : {0U, 3U}) {
+                CScript script;
+                if (m_rng.randbool()) {
+                    // Compressed as a special script.
+                    script << OP_DUP << OP_HASH160 << m_rng.randbytes(20) << OP_EQUALVERIFY << OP_CHECKSIG;
+                } else {
+                    script << OP_RETURN << m_rng.randbytes(m_rng.randrange(80));
+                }
+                coins.emplace_back(COutPoint{txid, n}, Coin{CTxOut{CAmount(m_rng.randrange(50 * COIN)), script}, int(m_rng.randrange(100)), m_rng.randbool()});
+            }
+        }
+        return coins;
+    }
+
+    //! Write the coins in the snapshot format, without metadata.
+    void WriteSnapshot(const CoinList& coins, bool trailing_byte = false)
+    {
+        AutoFile file{fsbridge::fopen(m_path, "wb")};
+        for (size_t i = 0; i < coins.size();) {
+            size_t end{i};
+            while (end < coins.size() && coins[end].first.hash == coins[i].first.hash) ++end;
+            file << coins[i].first.hash;
+            WriteCompactSize(file, end - i);
+            for (; i < end; ++i) {
+                WriteCompactSize(file, coins[i].first.n);
+                file << coins[i].second;
+            }
+        }
+        if (trailing_byte) file << uint8_t{0};
+        BOOST_REQUIRE_EQUAL(file.fclose(), 0);
+    }
+
+    util::Result<node::SnapshotLoadResult> Load(CCoinsViewDB& db, uint64_t coins_count, int num_threads = 4)
+    {
+        AutoFile file{fsbridge::fopen(m_path, "rb")};
+        SnapshotLoadOptions options;
+        options.base_height = 100;
+        options.coins_count = coins_count;
+        options.num_threads = num_threads;
+        return LoadSnapshotCoins(file, db, options);
+    }
+};
+
+uint256 HashCoins(const CoinList& coins)
+{
+    HashWriter hasher{};
+    for (const auto& [outpoint, coin] : coins) {
+        DataStream ss;
+        kernel::SerializeCoinForHash(ss, outpoint, coin);
+        hasher.write(ss);
+    }
+    return hasher.GetHash();
+}
+
+CCoinsViewDB MakeDB() { return CCoinsViewDB{{.path = "test", .cache_bytes = 1 << 23, .memory_only = true}, {}}; }
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(snapshotloader_tests, SnapshotLoaderSetup)
+
+BOOST_AUTO_TEST_CASE(load_ordered)
+{
+    // Several batches, so that they are decoded and written out of order.
+    CoinList coins{MakeCoins(node::SNAPSHOT_LOAD_BATCH_COINS + 1000)};
+    // An oversized script is loaded as a short unspendable one.
+    coins.back().second.out.scriptPubKey.resize(MAX_SCRIPT_SIZE + 1);
+    WriteSnapshot(coins);
+    coins.back().second.out.scriptPubKey = CScript() << OP_RETURN;
+
+    for (int threads : {1, 4}) {
+        CCoinsViewDB db{MakeDB()};
+        AutoFile file{fsbridge::fopen(m_path, "rb")};
+        SnapshotLoadOptions options;
+        options.base_height = 100;
+        options.coins_count = coins.size();
+        options.num_threads = threads;
+        uint64_t last_progress{0};
+        options.progress = [&](uint64_t loaded) {
+            BOOST_CHECK_GE(loaded, last_progress);
+            last_progress = loaded;
+        };
+        const auto result{LoadSnapshotCoins(file, db, options)};
+        BOOST_REQUIRE(result);
+        BOOST_CHECK_EQUAL(result->coins_loaded, coins.size());
+        BOOST_CHECK_EQUAL(last_progress, coins.size());
+        BOOST_REQUIRE(result->hash_serialized);
+        BOOST_CHECK_EQUAL(*result->hash_serialized, HashCoins(coins));
+        for (const auto& [outpoint, coin] : {coins.front(), coins[coins.size() / 2], coins.back()}) {
+            const auto db_coin{db.GetCoin(outpoint)};
+            BOOST_REQUIRE(db_coin);
+            BOOST_CHECK(db_coin->out == coin.out);
+            BOOST_CHECK_EQUAL(db_coin->nHeight, coin.nHeight);
+        }
+        // The best block is left to the caller.
+        BOOST_CHECK(db.GetBestBlock().IsNull());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(load_unordered)
+{
+    CoinList coins{MakeCoins(1000)};
+    std::swap(coins[0], coins[coins.size() - 1]);
+    WriteSnapshot(coins);
+
+    CCoinsViewDB db{MakeDB()};
+    const auto result{Load(db, coins.size())};
+    BOOST_REQUIRE(result);
+    // The content hash has to be computed from the database instead.
+    BOOST_CHECK(!result->hash_serialized);
+    for (const auto& [outpoint, coin] : coins) BOOST_CHECK(db.HaveCoin(outpoint));
+}
+
+BOOST_AUTO_TEST_CASE(load_errors)
+{
+    const CoinList coins{MakeCoins(node::SNAPSHOT_LOAD_BATCH_COINS)};
+
+    {
+        // A coin above the base height, in the second batch.
+        CoinList bad{coins};
+        bad[70000].second.nHeight = 101;
+        WriteSnapshot(bad);
+        CCoinsViewDB db{MakeDB()};
+        BOOST_CHECK_EQUAL(util::ErrorString(Load(db, coins.size())).original, "Bad snapshot data after deserializing 70000 coins");
+
+        // An earlier bad value takes precedence.
+        bad[20].second.out.nValue = MAX_MONEY + 1;
+        WriteSnapshot(bad);
+        CCoinsViewDB db2{MakeDB()};
+        BOOST_CHECK_EQUAL(util::ErrorString(Load(db2, coins.size())).original, "Bad snapshot data after deserializing 20 coins - bad tx out value");
+    }
+    {
+        // More coins announced than available.
+        WriteSnapshot(coins);
+        CCoinsViewDB db{MakeDB()};
+        BOOST_CHECK_EQUAL(util::ErrorString(Load(db, coins.size() + 1)).original,
+                          strprintf("Bad snapshot format or truncated snapshot after deserializing %d coins", coins.size()));
+
+        // Fewer coins announced than available.
+        CCoinsViewDB db2{MakeDB()};
+        BOOST_CHECK_EQUAL(util::ErrorString(Load(db2, 3)).original, "Mismatch in coins count in snapshot metadata and actual snapshot data");
+        CCoinsViewDB db3{MakeDB()};
+        BOOST_CHECK_EQUAL(util::ErrorString(Load(db3, 4)).original, "Bad snapshot - coins left over after deserializing 4 coins");
+    }
+    {
+        // A data error before the end of a truncated file is reported first.
+        CoinList bad{coins};
+        bad[10].second.nHeight = 101;
+        WriteSnapshot(bad);
+        CCoinsViewDB db{MakeDB()};
+        BOOST_CHECK_EQUAL(util::ErrorString(Load(db, coins.size() + 1)).original, "Bad snapshot data after deserializing 10 coins");
+    }
+    {
+        WriteSnapshot(coins, /*trailing_byte=*/true);
+        CCoinsViewDB db{MakeDB()};
+        BOOST_CHECK_EQUAL(util::ErrorString(Load(db, coins.size())).original,
+                          strprintf("Bad snapshot - coins left over after deserializing %d coins", coins.size()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(load_interrupted)
+{
+    const CoinList coins{MakeCoins(node::SNAPSHOT_LOAD_BATCH_COINS)};
+    WriteSnapshot(coins);
+
+    CCoinsViewDB db{MakeDB()};
+    AutoFile file{fsbridge::fopen(m_path, "rb")};
+    SnapshotLoadOptions options;
+    options.base_height = 100;
+    options.coins_count = coins.size();
+    options.num_threads = 2;
+    options.interrupted = [] { return true; };
+    BOOST_CHECK_EQUAL(util::ErrorString(LoadSnapshotCoins(file, db, options)).original, "Aborting after an interrupt was requested");
+}
+
+BOOST_AUTO_TEST_CASE(write_roundtrip)
+{
+    const CoinList coins{MakeCoins(20000)};
+    WriteSnapshot(coins);
+    const auto read_file{[&] {
+        AutoFile file{fsbridge::fopen(m_path, "rb")};
+        std::vector<std::byte> data(fs::file_size(m_path));
+        file.read(data);
+        return data;
+    }};
+    const std::vector<std::byte> expected{read_file()};
+
+    CCoinsViewDB db{MakeDB()};
+    db.WriteCoins(coins);
+
+    for (int threads : {1, 3, 16}) {
+        node::SnapshotCoinsWriter writer{db, threads};
+        AutoFile file{fsbridge::fopen(m_path, "wb")};
+        uint64_t last_coins{0};
+        const auto result{writer.Write(file, {}, [&](const node::SnapshotWriteResult& progress) {
+            BOOST_CHECK_GT(progress.coins_written, last_coins);
+            last_coins = progress.coins_written;
+        })};
+        BOOST_REQUIRE_EQUAL(file.fclose(), 0);
+        BOOST_CHECK_EQUAL(result.coins_written, coins.size());
+        BOOST_CHECK_EQUAL(result.bytes_written, expected.size());
+        BOOST_CHECK_EQUAL(result.hash_serialized, HashCoins(coins));
+        // Byte-identical to a sequential dump.
+        BOOST_CHECK(read_file() == expected);
+    }
+
+    // Later writes to the database are not seen by an existing writer.
+    node::SnapshotCoinsWriter writer{db, 4};
+    db.WriteCoins(MakeCoins(10));
+    AutoFile file{fsbridge::fopen(m_path, "wb")};
+    BOOST_CHECK_EQUAL(writer.Write(file).coins_written, coins.size());
+    BOOST_REQUIRE_EQUAL(file.fclose(), 0);
+
+    // An interruption stops the workers.
+    node::SnapshotCoinsWriter interrupted{db, 4};
+    AutoFile file2{fsbridge::fopen(m_path, "wb")};
+    BOOST_CHECK_THROW(interrupted.Write(file2, [] { throw std::runtime_error("interrupted"); }), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
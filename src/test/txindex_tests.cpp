@@ -4,13 +4,34 @@
 
 #include <addresstype.h>
 #include <chainparams.h>
+#include <index/disktxpos.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
+#include <node/blockstorage.h>
 #include <test/util/setup_common.h>
 #include <validation.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <vector>
+
+/** Gives the tests raw access to the database of a TxIndex. */
+class TxIndexTester
+{
+public:
+    /** Add a short key entry for txid pointing at pos, as if another transaction sharing its prefix was stored there. */
+    static bool WriteShortKey(TxIndex& index, const Txid& txid, const CDiskTxPos& pos)
+    {
+        std::array<unsigned char, 8> prefix;
+        std::memcpy(prefix.data(), txid.data(), prefix.size());
+        return index.GetDB().Write(std::make_pair(std::make_pair(uint8_t{'s'}, prefix), pos), uint8_t{0});
+    }
+};
+
 BOOST_AUTO_TEST_SUITE(txindex_tests)
 
 BOOST_FIXTURE_TEST_CASE(txindex_initial_sync, TestChain100Setup)
@@ -73,4 +94,132 @@ BOOST_FIXTURE_TEST_CASE(txindex_initial_sync, TestChain100Setup)
     txindex.Stop();
 }
 
+BOOST_FIXTURE_TEST_CASE(txindex_find_txs, TestChain100Setup)
+{
+    for (bool short_keys : {false, true}) {
+        TxIndex txindex(interfaces::MakeChain(m_node), 1 << 20, /*f_memory=*/true, /*f_wipe=*/false, short_keys);
+        BOOST_REQUIRE(txindex.Init());
+        txindex.Sync();
+
+        // The transactions of the active chain, read from the blocks themselves.
+        std::map<Txid, std::pair<uint256, CTransactionRef>> in_chain;
+        {
+            LOCK(::cs_main);
+            const CChain& active{m_node.chainman->ActiveChain()};
+            for (const CBlockIndex* block_index{active[1]}; block_index; block_index = active.Next(block_index)) {
+                CBlock block;
+                BOOST_REQUIRE(m_node.chainman->m_blockman.ReadBlock(block, *block_index));
+                for (const auto& tx : block.vtx) in_chain.try_emplace(tx->GetHash(), block_index->GetBlockHash(), tx);
+            }
+        }
+
+        // Unknown, duplicate and out of order hashes, from blocks in random order.
+        const Txid unknown{Txid::FromUint256(m_rng.rand256())};
+        std::vector<Txid> txids{unknown};
+        for (const auto& tx : m_coinbase_txns) txids.push_back(tx->GetHash());
+        std::shuffle(txids.begin(), txids.end(), m_rng);
+        txids.push_back(txids.front());
+        txids.push_back(Params().GenesisBlock().vtx[0]->GetHash());
+
+        const auto found{txindex.FindTxs(txids)};
+        BOOST_REQUIRE_EQUAL(found.size(), txids.size());
+        for (size_t i = 0; i < txids.size(); ++i) {
+            const auto expected{in_chain.find(txids[i])};
+            BOOST_REQUIRE_EQUAL(found[i].has_value(), expected != in_chain.end());
+            if (!found[i]) continue;
+            BOOST_CHECK_EQUAL(found[i]->first, expected->second.first);
+            BOOST_CHECK(*found[i]->second == *expected->second.second);
+        }
+        BOOST_CHECK_EQUAL(std::count_if(found.begin(), found.end(), [](const auto& entry) { return entry.has_value(); }), int(m_coinbase_txns.size()) + (txids.front() != unknown));
+        BOOST_CHECK(txindex.FindTxs({}).empty());
+
+        m_node.validation_signals->SyncWithValidationInterfaceQueue();
+        txindex.Stop();
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(txindex_short_key_collisions, TestChain100Setup)
+{
+    TxIndex txindex(interfaces::MakeChain(m_node), 1 << 20, /*f_memory=*/true, /*f_wipe=*/false, /*short_keys=*/true);
+    BOOST_REQUIRE(txindex.Init());
+    txindex.Sync();
+
+    // Each block of the test chain only holds its coinbase, which starts right after the transaction count.
+    auto coinbase_pos = [&](int height) {
+        return WITH_LOCK(::cs_main, return CDiskTxPos(m_node.chainman->ActiveChain()[height]->GetBlockPos(), GetSizeOfCompactSize(1)));
+    };
+    auto block_hash = [&](int height) {
+        return WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain()[height]->GetBlockHash());
+    };
+
+    // Make the coinbases at heights 5 and 20 share their key prefix with transactions stored
+    // before and after them in the block files.
+    const Txid& early{m_coinbase_txns[4]->GetHash()};
+    const Txid& late{m_coinbase_txns[19]->GetHash()};
+    BOOST_REQUIRE(TxIndexTester::WriteShortKey(txindex, early, coinbase_pos(2)));
+    BOOST_REQUIRE(TxIndexTester::WriteShortKey(txindex, late, coinbase_pos(50)));
+
+    // A hash that only shares the prefix of an indexed transaction is not found.
+    uint256 other{early.ToUint256()};
+    other.data()[other.size() - 1] ^= 1;
+
+    const std::vector<Txid> txids{early, late, Txid::FromUint256(other), m_coinbase_txns[1]->GetHash(), m_coinbase_txns[49]->GetHash()};
+    const auto found{txindex.FindTxs(txids)};
+    BOOST_REQUIRE_EQUAL(found.size(), txids.size());
+    BOOST_REQUIRE(found[0] && found[1] && !found[2] && found[3] && found[4]);
+    BOOST_CHECK_EQUAL(found[0]->first, block_hash(5));
+    BOOST_CHECK_EQUAL(found[0]->second->GetHash(), early);
+    BOOST_CHECK_EQUAL(found[1]->first, block_hash(20));
+    BOOST_CHECK_EQUAL(found[1]->second->GetHash(), late);
+    BOOST_CHECK_EQUAL(found[3]->first, block_hash(2));
+    BOOST_CHECK_EQUAL(found[4]->first, block_hash(50));
+
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    txindex.Stop();
+}
+
+BOOST_FIXTURE_TEST_CASE(txindex_reorg_prefers_active_chain, TestChain100Setup)
+{
+    for (bool short_keys : {false, true}) {
+        TxIndex txindex(interfaces::MakeChain(m_node), 1 << 20, /*f_memory=*/true, /*f_wipe=*/true, short_keys);
+        BOOST_REQUIRE(txindex.Init());
+        txindex.Sync();
+
+        // Mine the same spend in two competing blocks. With short keys the index keeps both
+        // locations, in file order.
+        const CScript dest_script{GetScriptForDestination(PKHash(GenerateRandomKey().GetPubKey()))};
+        const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[short_keys], 0, 1 + short_keys, coinbaseKey, dest_script, 1 * COIN, /*submit=*/false)};
+        const CBlock block_a{CreateAndProcessBlock({spend}, dest_script)};
+        BOOST_REQUIRE(txindex.BlockUntilSyncedToCurrentChain());
+
+        BlockValidationState state;
+        CBlockIndex* index_a{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, index_a));
+        const CBlock block_b{CreateAndProcessBlock({spend}, GetScriptForDestination(PKHash(coinbaseKey.GetPubKey())))};
+        BOOST_REQUIRE(block_a.GetHash() != block_b.GetHash());
+        BOOST_REQUIRE(txindex.BlockUntilSyncedToCurrentChain());
+
+        // The later block is active.
+        uint256 block_hash;
+        CTransactionRef tx;
+        BOOST_REQUIRE(txindex.FindTx(spend.GetHash(), block_hash, tx));
+        BOOST_CHECK_EQUAL(block_hash, block_b.GetHash());
+
+        // Switch back to the earlier block.
+        CBlockIndex* index_b{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+        WITH_LOCK(::cs_main, m_node.chainman->ActiveChainstate().ResetBlockFailureFlags(index_a));
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, index_b));
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().ActivateBestChain(state));
+        BOOST_REQUIRE_EQUAL(WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip()->GetBlockHash()), block_a.GetHash());
+        BOOST_REQUIRE(txindex.BlockUntilSyncedToCurrentChain());
+
+        BOOST_REQUIRE(txindex.FindTx(spend.GetHash(), block_hash, tx));
+        BOOST_CHECK_EQUAL(block_hash, block_a.GetHash());
+        BOOST_CHECK_EQUAL(tx->GetHash(), spend.GetHash());
+
+        m_node.validation_signals->SyncWithValidationInterfaceQueue();
+        txindex.Stop();
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
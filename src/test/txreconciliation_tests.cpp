@@ -4,10 +4,81 @@
 
 #include <node/txreconciliation.h>
 
+#include <random.h>
 #include <test/util/setup_common.h>
+#include <tinyformat.h>
 
 #include <boost/test/unit_test.hpp>
 
+#include <array>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace {
+
+//! Size of an inv entry (type and hash), the cost of announcing a transaction.
+constexpr size_t INV_ENTRY_SIZE{36};
+
+/** Register the peers with each other, the initiator having connected to the responder. */
+void RegisterPair(TxReconciliationTracker& initiator, NodeId initiator_id, TxReconciliationTracker& responder, NodeId responder_id)
+{
+    const uint64_t initiator_salt{initiator.PreRegisterPeer(responder_id)};
+    const uint64_t responder_salt{responder.PreRegisterPeer(initiator_id)};
+    BOOST_REQUIRE_EQUAL(initiator.RegisterPeer(responder_id, /*is_peer_inbound=*/false, TXRECONCILIATION_VERSION, responder_salt),
+                        ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE_EQUAL(responder.RegisterPeer(initiator_id, /*is_peer_inbound=*/true, TXRECONCILIATION_VERSION, initiator_salt),
+                        ReconciliationRegisterResult::SUCCESS);
+}
+
+struct RoundStats {
+    ReconciliationOutcome outcome;
+    bool extended{false};
+    //! Transactions announced by the initiator to the responder, and the other way round.
+    std::set<Wtxid> initiator_announced, responder_announced;
+    //! Bytes of all messages of the round, including the invs.
+    size_t bytes{0};
+};
+
+/** Exchange the messages of a full reconciliation round between two peers. */
+RoundStats RunRound(TxReconciliationTracker& initiator, NodeId initiator_id, TxReconciliationTracker& responder, NodeId responder_id)
+{
+    RoundStats stats;
+    const auto request{initiator.InitiateReconciliationRequest(responder_id)};
+    BOOST_REQUIRE(request);
+    stats.bytes += sizeof(request->set_size) + sizeof(request->q);
+
+    const auto sketch{responder.HandleReconciliationRequest(initiator_id, *request)};
+    BOOST_REQUIRE(sketch);
+    stats.bytes += sketch->size();
+    auto result{initiator.HandleSketch(responder_id, *sketch)};
+    BOOST_REQUIRE(result);
+    if (result->outcome == ReconciliationOutcome::EXTENSION_NEEDED) {
+        stats.extended = true;
+        const auto extension{responder.HandleExtensionRequest(initiator_id)};
+        BOOST_REQUIRE(extension);
+        BOOST_CHECK_EQUAL(extension->size(), sketch->size());
+        stats.bytes += extension->size();
+        // The extension arrives in a sketch message, like the initial sketch.
+        result = initiator.HandleSketch(responder_id, *extension);
+        BOOST_REQUIRE(result);
+        BOOST_REQUIRE(result->outcome != ReconciliationOutcome::EXTENSION_NEEDED);
+    }
+    stats.outcome = result->outcome;
+
+    const bool success{result->outcome == ReconciliationOutcome::SUCCESS};
+    stats.bytes += 1 + result->request.size() * sizeof(uint32_t);
+    const auto responder_announce{responder.HandleReconciliationDifference(initiator_id, success, result->request)};
+    BOOST_REQUIRE(responder_announce);
+
+    stats.initiator_announced.insert(result->announce.begin(), result->announce.end());
+    stats.responder_announced.insert(responder_announce->begin(), responder_announce->end());
+    stats.bytes += (result->announce.size() + responder_announce->size()) * INV_ENTRY_SIZE;
+    return stats;
+}
+
+} // namespace
+
 BOOST_FIXTURE_TEST_SUITE(txreconciliation_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(RegisterPeerTest)
@@ -81,4 +152,281 @@ BOOST_AUTO_TEST_CASE(IsPeerRegisteredTest)
     BOOST_CHECK(!tracker.IsPeerRegistered(peer_id0));
 }
 
+BOOST_AUTO_TEST_CASE(ReconciliationSetTest)
+{
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION), responder(TXRECONCILIATION_VERSION);
+    const Wtxid wtxid{Wtxid::FromUint256(m_rng.rand256())};
+
+    // Not registered.
+    BOOST_CHECK(!initiator.AddToSet(1, wtxid));
+    BOOST_CHECK(!initiator.ComputeShortID(1, wtxid));
+
+    RegisterPair(initiator, 0, responder, 1);
+    BOOST_CHECK(initiator.AddToSet(1, wtxid));
+    BOOST_CHECK(!initiator.AddToSet(1, wtxid));
+    BOOST_CHECK_EQUAL(initiator.GetSetSize(1), 1U);
+    BOOST_CHECK(initiator.TryRemovingFromSet(1, wtxid));
+    BOOST_CHECK(!initiator.TryRemovingFromSet(1, wtxid));
+    BOOST_CHECK_EQUAL(initiator.GetSetSize(1), 0U);
+
+    // Both sides compute the same short IDs from the combined salt.
+    const auto short_id{initiator.ComputeShortID(1, wtxid)};
+    BOOST_REQUIRE(short_id);
+    BOOST_CHECK(*short_id != 0);
+    BOOST_CHECK_EQUAL(*short_id, *responder.ComputeShortID(0, wtxid));
+
+    // The set is bounded.
+    for (size_t i{0}; i < MAX_RECONSET_SIZE; ++i) {
+        BOOST_CHECK(initiator.AddToSet(1, Wtxid::FromUint256(m_rng.rand256())));
+    }
+    BOOST_CHECK(!initiator.AddToSet(1, wtxid));
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationRoundTest)
+{
+    // Sets with a difference within the estimate are reconciled with a single sketch.
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION), responder(TXRECONCILIATION_VERSION);
+    RegisterPair(initiator, 0, responder, 1);
+
+    std::set<Wtxid> initiator_only, responder_only;
+    for (int i{0}; i < 100; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(m_rng.rand256())};
+        BOOST_CHECK(initiator.AddToSet(1, wtxid));
+        BOOST_CHECK(responder.AddToSet(0, wtxid));
+    }
+    for (int i{0}; i < 5; ++i) {
+        const Wtxid wtxid{*initiator_only.insert(Wtxid::FromUint256(m_rng.rand256())).first};
+        BOOST_CHECK(initiator.AddToSet(1, wtxid));
+    }
+    for (int i{0}; i < 7; ++i) {
+        const Wtxid wtxid{*responder_only.insert(Wtxid::FromUint256(m_rng.rand256())).first};
+        BOOST_CHECK(responder.AddToSet(0, wtxid));
+    }
+
+    const RoundStats stats{RunRound(initiator, 0, responder, 1)};
+    BOOST_CHECK(stats.outcome == ReconciliationOutcome::SUCCESS);
+    BOOST_CHECK(!stats.extended);
+    BOOST_CHECK(stats.initiator_announced == initiator_only);
+    BOOST_CHECK(stats.responder_announced == responder_only);
+    // Only the difference is announced, which is far cheaper than announcing the common transactions.
+    BOOST_CHECK_LT(stats.bytes, 100 * INV_ENTRY_SIZE);
+    BOOST_CHECK_EQUAL(initiator.GetSetSize(1), 0U);
+    BOOST_CHECK_EQUAL(responder.GetSetSize(0), 0U);
+
+    // The next round reconciles empty sets.
+    const RoundStats empty_stats{RunRound(initiator, 0, responder, 1)};
+    BOOST_CHECK(empty_stats.outcome == ReconciliationOutcome::SUCCESS);
+    BOOST_CHECK(empty_stats.initiator_announced.empty() && empty_stats.responder_announced.empty());
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationExtensionTest)
+{
+    // 40 common transactions and a difference of 24 exceed the initial capacity of
+    // 0.25 * 52 + 1 = 14 but not the extended one of 28.
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION), responder(TXRECONCILIATION_VERSION);
+    RegisterPair(initiator, 0, responder, 1);
+
+    std::set<Wtxid> initiator_only, responder_only;
+    for (int i{0}; i < 40; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(m_rng.rand256())};
+        initiator.AddToSet(1, wtxid);
+        responder.AddToSet(0, wtxid);
+    }
+    for (int i{0}; i < 12; ++i) {
+        initiator.AddToSet(1, *initiator_only.insert(Wtxid::FromUint256(m_rng.rand256())).first);
+        responder.AddToSet(0, *responder_only.insert(Wtxid::FromUint256(m_rng.rand256())).first);
+    }
+
+    const RoundStats stats{RunRound(initiator, 0, responder, 1)};
+    BOOST_CHECK(stats.outcome == ReconciliationOutcome::SUCCESS);
+    BOOST_CHECK(stats.extended);
+    BOOST_CHECK(stats.initiator_announced == initiator_only);
+    BOOST_CHECK(stats.responder_announced == responder_only);
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationFailureTest)
+{
+    // A difference of 60 exceeds even the extended capacity, so both sides fall back to
+    // announcing their whole sets.
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION), responder(TXRECONCILIATION_VERSION);
+    RegisterPair(initiator, 0, responder, 1);
+
+    std::set<Wtxid> initiator_set, responder_set;
+    for (int i{0}; i < 40; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(m_rng.rand256())};
+        initiator_set.insert(wtxid);
+        responder_set.insert(wtxid);
+    }
+    for (int i{0}; i < 30; ++i) {
+        initiator_set.insert(Wtxid::FromUint256(m_rng.rand256()));
+        responder_set.insert(Wtxid::FromUint256(m_rng.rand256()));
+    }
+    for (const Wtxid& wtxid : initiator_set) initiator.AddToSet(1, wtxid);
+    for (const Wtxid& wtxid : responder_set) responder.AddToSet(0, wtxid);
+
+    const RoundStats stats{RunRound(initiator, 0, responder, 1)};
+    BOOST_CHECK(stats.outcome == ReconciliationOutcome::FAILURE);
+    BOOST_CHECK(stats.extended);
+    BOOST_CHECK(stats.initiator_announced == initiator_set);
+    BOOST_CHECK(stats.responder_announced == responder_set);
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationProtocolViolationTest)
+{
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION), responder(TXRECONCILIATION_VERSION);
+    RegisterPair(initiator, 0, responder, 1);
+    const ReconciliationRequest request{.set_size = 0, .q = 0};
+
+    // Each side only plays its own role.
+    BOOST_CHECK(!responder.InitiateReconciliationRequest(0));
+    BOOST_CHECK(!initiator.HandleReconciliationRequest(1, request));
+    // Messages of a round that was not started.
+    BOOST_CHECK(!initiator.HandleSketch(1, std::vector<unsigned char>(4)));
+    BOOST_CHECK(!responder.HandleExtensionRequest(0));
+    BOOST_CHECK(!responder.HandleReconciliationDifference(0, true, {}));
+
+    BOOST_REQUIRE(initiator.InitiateReconciliationRequest(1));
+    // Only one round at a time.
+    BOOST_CHECK(!initiator.InitiateReconciliationRequest(1));
+    // Malformed sketches.
+    BOOST_CHECK(!initiator.HandleSketch(1, std::vector<unsigned char>(3)));
+    BOOST_CHECK(!initiator.HandleSketch(1, {}));
+    BOOST_CHECK(!initiator.HandleSketch(1, std::vector<unsigned char>((MAX_SKETCH_CAPACITY + 1) * 4)));
+    // No extension without a failed sketch.
+    BOOST_CHECK(!initiator.HandleSketchExtension(1, std::vector<unsigned char>(4)));
+
+    BOOST_REQUIRE(responder.HandleReconciliationRequest(0, request));
+    BOOST_CHECK(!responder.HandleReconciliationRequest(0, request));
+    // The extension is sent at most once.
+    BOOST_CHECK(responder.HandleExtensionRequest(0));
+    BOOST_CHECK(!responder.HandleExtensionRequest(0));
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationTimeoutTest)
+{
+    SetMockTime(Now<NodeSeconds>());
+    TxReconciliationTracker initiator(TXRECONCILIATION_VERSION), responder(TXRECONCILIATION_VERSION);
+    RegisterPair(initiator, 0, responder, 1);
+    const Wtxid frozen{Wtxid::FromUint256(m_rng.rand256())}, added{Wtxid::FromUint256(m_rng.rand256())};
+
+    // A responder falls back to flooding if the initiator does not start a round in time. An
+    // initiator is never timed out between rounds, as we start them.
+    BOOST_CHECK(responder.AddToSet(0, added));
+    BOOST_CHECK(initiator.AddToSet(1, frozen));
+    SetMockTime(Now<NodeSeconds>() + RECON_REQUEST_TIMEOUT - 1s);
+    BOOST_CHECK(!responder.ExpireReconciliation(0));
+    SetMockTime(Now<NodeSeconds>() + 1s);
+    const auto responder_announce{responder.ExpireReconciliation(0)};
+    BOOST_REQUIRE(responder_announce);
+    BOOST_CHECK(*responder_announce == std::vector<Wtxid>{added});
+    BOOST_CHECK(!responder.IsPeerRegistered(0));
+    BOOST_CHECK(!initiator.ExpireReconciliation(1));
+
+    // A round the responder does not complete in time is given up, along with the peer. Both
+    // the frozen set and the transactions added meanwhile are flooded.
+    BOOST_REQUIRE(initiator.InitiateReconciliationRequest(1));
+    BOOST_CHECK(initiator.AddToSet(1, added));
+    SetMockTime(Now<NodeSeconds>() + RECON_ROUND_TIMEOUT - 1s);
+    BOOST_CHECK(!initiator.ExpireReconciliation(1));
+    SetMockTime(Now<NodeSeconds>() + 1s);
+    const auto announce{initiator.ExpireReconciliation(1)};
+    BOOST_REQUIRE(announce);
+    BOOST_CHECK(std::set<Wtxid>(announce->begin(), announce->end()) == (std::set<Wtxid>{frozen, added}));
+    BOOST_CHECK(!initiator.IsPeerRegistered(1));
+    BOOST_CHECK(!initiator.ExpireReconciliation(1));
+
+    SetMockTime(0s);
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationFanoutTest)
+{
+    // We initiate reconciliations with the outbound peers 1 to 4 and respond to the inbound peer 5.
+    TxReconciliationTracker tracker(TXRECONCILIATION_VERSION);
+    for (NodeId id{1}; id <= 5; ++id) {
+        tracker.PreRegisterPeer(id);
+        BOOST_REQUIRE_EQUAL(tracker.RegisterPeer(id, /*is_peer_inbound=*/id == 5, TXRECONCILIATION_VERSION, m_rng.rand64()),
+                            ReconciliationRegisterResult::SUCCESS);
+    }
+
+    for (int i{0}; i < 100; ++i) {
+        const Wtxid wtxid{Wtxid::FromUint256(m_rng.rand256())};
+        size_t destinations{0};
+        for (NodeId id{1}; id <= 4; ++id) {
+            if (tracker.ShouldFanoutTo(id, wtxid, /*outbound_flooding_peers=*/0)) ++destinations;
+            // Outbound peers we do not reconcile with already get it flooded.
+            BOOST_CHECK(!tracker.ShouldFanoutTo(id, wtxid, /*outbound_flooding_peers=*/OUTBOUND_FANOUT_DESTINATIONS));
+        }
+        BOOST_CHECK_EQUAL(destinations, OUTBOUND_FANOUT_DESTINATIONS);
+        BOOST_CHECK(!tracker.ShouldFanoutTo(5, wtxid, 0));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationNetworkTest)
+{
+    // Simulate a fully connected network of nodes relaying transactions only through
+    // reconciliation: every node originates transactions, and every pair reconciles once per
+    // tick. All transactions must reach all nodes, for less bandwidth than flooding.
+    static constexpr NodeId NUM_NODES{4};
+    static constexpr int TXS_PER_TICK{10};
+    static constexpr int TICKS{10};
+
+    struct Node {
+        TxReconciliationTracker tracker{TXRECONCILIATION_VERSION};
+        std::set<Wtxid> known;
+    };
+    std::array<Node, NUM_NODES> nodes;
+    // Lower-numbered nodes connect to higher-numbered ones, so they initiate.
+    for (NodeId i{0}; i < NUM_NODES; ++i) {
+        for (NodeId j{i + 1}; j < NUM_NODES; ++j) RegisterPair(nodes[i].tracker, i, nodes[j].tracker, j);
+    }
+
+    const auto learn{[&](NodeId n, const Wtxid& wtxid, std::optional<NodeId> from) {
+        Node& node{nodes[n]};
+        if (!node.known.insert(wtxid).second) {
+            // The peer knows the transaction, so it does not have to be reconciled with it.
+            if (from) node.tracker.TryRemovingFromSet(*from, wtxid);
+            return;
+        }
+        for (NodeId peer{0}; peer < NUM_NODES; ++peer) {
+            if (peer != n && peer != from) BOOST_CHECK(node.tracker.AddToSet(peer, wtxid));
+        }
+    }};
+    const auto sets_empty{[&] {
+        for (NodeId i{0}; i < NUM_NODES; ++i) {
+            for (NodeId j{0}; j < NUM_NODES; ++j) {
+                if (i != j && nodes[i].tracker.GetSetSize(j) > 0) return false;
+            }
+        }
+        return true;
+    }};
+
+    size_t bytes{0}, num_txs{0}, rounds{0}, failures{0};
+    for (int tick{0}; tick < TICKS || !sets_empty(); ++tick) {
+        BOOST_REQUIRE(tick < 2 * TICKS);
+        if (tick < TICKS) {
+            for (NodeId n{0}; n < NUM_NODES; ++n) {
+                for (int k{0}; k < TXS_PER_TICK; ++k) learn(n, Wtxid::FromUint256(m_rng.rand256()), std::nullopt);
+            }
+            num_txs += NUM_NODES * TXS_PER_TICK;
+        }
+        for (NodeId i{0}; i < NUM_NODES; ++i) {
+            for (NodeId j{i + 1}; j < NUM_NODES; ++j) {
+                const RoundStats stats{RunRound(nodes[i].tracker, i, nodes[j].tracker, j)};
+                for (const Wtxid& wtxid : stats.initiator_announced) learn(j, wtxid, i);
+                for (const Wtxid& wtxid : stats.responder_announced) learn(i, wtxid, j);
+                bytes += stats.bytes;
+                ++rounds;
+                if (stats.outcome == ReconciliationOutcome::FAILURE) ++failures;
+            }
+        }
+    }
+
+    for (const Node& node : nodes) BOOST_CHECK_EQUAL(node.known.size(), num_txs);
+    // Flooding announces each transaction on every link except the one it arrived on.
+    const size_t flooding_bytes{num_txs * (NUM_NODES - 1) * (NUM_NODES - 1) * INV_ENTRY_SIZE};
+    BOOST_TEST_MESSAGE(strprintf("%u rounds (%u failed), %.1f bytes per transaction (flooding: %u)",
+                                 rounds, failures, double(bytes) / num_txs, flooding_bytes / num_txs));
+    BOOST_CHECK_LT(bytes, flooding_bytes);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
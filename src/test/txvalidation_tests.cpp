@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <consensus/validation.h>
+#include <key.h>
 #include <key_io.h>
 #include <policy/packages.h>
 #include <policy/policy.h>
@@ -10,6 +11,7 @@
 #include <policy/truc_policy.h>
 #include <primitives/transaction.h>
 #include <random.h>
+#include <script/interpreter.h>
 #include <script/script.h>
 #include <test/util/setup_common.h>
 #include <test/util/txmempool.h>
@@ -570,4 +572,77 @@ BOOST_FIXTURE_TEST_CASE(version3_tests, RegTestingSetup)
     // equivalent to the tx with multiple generations of ancestors.
 }
 
+/**
+ * Check that a package whose script checks run on the mempool script check
+ * threads reports the same failing transaction and state as the serial path.
+ */
+BOOST_FIXTURE_TEST_CASE(package_parallel_script_checks, TestingSetup)
+{
+    constexpr size_t NUM_TXS{3};
+    constexpr size_t NUM_INPUTS_PER_TX{4};
+    const CKey key{GenerateRandomKey()};
+    const CScript spk{GetScriptForDestination(PKHash(key.GetPubKey()))};
+    const std::vector<COutPoint> outpoints{random_outpoints(NUM_TXS * NUM_INPUTS_PER_TX)};
+
+    Package package;
+    for (size_t i{0}; i < NUM_TXS; ++i) {
+        CMutableTransaction mtx;
+        for (size_t n{0}; n < NUM_INPUTS_PER_TX; ++n) mtx.vin.emplace_back(outpoints[i * NUM_INPUTS_PER_TX + n]);
+        mtx.vout.emplace_back(NUM_INPUTS_PER_TX * COIN - 10000, spk);
+        for (size_t n{0}; n < NUM_INPUTS_PER_TX; ++n) {
+            std::vector<unsigned char> sig;
+            BOOST_REQUIRE(key.Sign(SignatureHash(spk, mtx, n, SIGHASH_ALL, COIN, SigVersion::BASE), sig));
+            sig.push_back(SIGHASH_ALL);
+            mtx.vin[n].scriptSig = CScript() << sig << ToByteVector(key.GetPubKey());
+        }
+        // Give the third input of the second transaction the signature of its second input.
+        if (i == 1) mtx.vin[2].scriptSig = mtx.vin[1].scriptSig;
+        package.push_back(MakeTransactionRef(mtx));
+    }
+    const Wtxid bad_wtxid{package[1]->GetWitnessHash()};
+
+    const auto add_coins{[&] {
+        LOCK(cs_main);
+        CCoinsViewCache& coins{m_node.chainman->ActiveChainstate().CoinsTip()};
+        for (const COutPoint& outpoint : outpoints) {
+            coins.AddCoin(outpoint, Coin{CTxOut{COIN, spk}, /*nHeightIn=*/0, /*fCoinBaseIn=*/false}, /*possible_overwrite=*/false);
+        }
+    }};
+    const auto test_accept{[&] {
+        LOCK(cs_main);
+        return ProcessNewPackage(m_node.chainman->ActiveChainstate(), *m_node.mempool, package, /*test_accept=*/true, /*client_maxfeerate=*/{});
+    }};
+
+    add_coins();
+    BOOST_REQUIRE(m_node.chainman->GetMempoolCheckQueue().HasThreads());
+    const auto parallel_result{test_accept()};
+
+    // Restart with -par=1, which leaves no script check threads.
+    m_args.ForceSetArg("-par", "1");
+    m_node.chainman.reset();
+    m_make_chainman();
+    LoadVerifyActivateChainstate();
+    add_coins();
+    BOOST_REQUIRE(!m_node.chainman->GetMempoolCheckQueue().HasThreads());
+    const auto serial_result{test_accept()};
+
+    BOOST_CHECK(serial_result.m_state.GetResult() == PackageValidationResult::PCKG_TX);
+    BOOST_CHECK(parallel_result.m_state.GetResult() == serial_result.m_state.GetResult());
+    BOOST_CHECK_EQUAL(parallel_result.m_state.ToString(), serial_result.m_state.ToString());
+    BOOST_CHECK_EQUAL(parallel_result.m_tx_results.size(), serial_result.m_tx_results.size());
+    for (const auto& [wtxid, serial_tx_result] : serial_result.m_tx_results) {
+        const auto it{parallel_result.m_tx_results.find(wtxid)};
+        BOOST_REQUIRE(it != parallel_result.m_tx_results.end());
+        BOOST_CHECK(it->second.m_result_type == serial_tx_result.m_result_type);
+        BOOST_CHECK(it->second.m_state.GetResult() == serial_tx_result.m_state.GetResult());
+        BOOST_CHECK_EQUAL(it->second.m_state.ToString(), serial_tx_result.m_state.ToString());
+    }
+
+    const auto& bad_result{serial_result.m_tx_results.at(bad_wtxid)};
+    BOOST_CHECK(bad_result.m_result_type == MempoolAcceptResult::ResultType::INVALID);
+    BOOST_CHECK(bad_result.m_state.GetResult() == TxValidationResult::TX_NOT_STANDARD);
+    BOOST_CHECK_EQUAL(bad_result.m_state.GetRejectReason(), "mempool-script-verify-flag-failed (Signature must be zero for failed CHECK(MULTI)SIG operation)");
+    BOOST_CHECK_EQUAL(serial_result.m_tx_results.count(package[2]->GetWitnessHash()), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
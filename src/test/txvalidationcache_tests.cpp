@@ -142,7 +142,10 @@ static void ValidateCheckInputsForAllFlags(const CTransaction &tx, uint32_t fail
             // WITNESS requires P2SH
             test_flags |= SCRIPT_VERIFY_P2SH;
         }
+        const ValidationCacheStats lookups_before{validation_cache.m_lookups};
         bool ret = CheckInputScripts(tx, state, &active_coins_tip, test_flags, true, add_to_cache, txdata, validation_cache, nullptr);
+        const ValidationCacheStats lookups{validation_cache.m_lookups - lookups_before};
+        BOOST_CHECK_EQUAL(lookups.script_execution_hits + lookups.script_execution_misses, 1U);
         // CheckInputScripts should succeed iff test_flags doesn't intersect with
         // failing_flags
         bool expected_return_value = !(test_flags & failing_flags);
@@ -160,6 +163,22 @@ static void ValidateCheckInputsForAllFlags(const CTransaction &tx, uint32_t fail
             std::vector<CScriptCheck> scriptchecks;
             BOOST_CHECK(CheckInputScripts(tx, state, &active_coins_tip, test_flags, true, add_to_cache, txdata, validation_cache, &scriptchecks));
             BOOST_CHECK_EQUAL(scriptchecks.size(), tx.vin.size());
+
+            // Queued checks count their signature lookups where the caller
+            // asks them to, and not in the validation cache.
+            const ValidationCacheStats queued_before{validation_cache.m_lookups};
+            std::vector<SignatureCacheLookups> signature_lookups(scriptchecks.size());
+            uint64_t num_signature_lookups{0};
+            for (size_t i{0}; i < scriptchecks.size(); ++i) {
+                scriptchecks[i].CountSignatureLookups(&signature_lookups[i]);
+                scriptchecks[i]();
+                num_signature_lookups += signature_lookups[i].hits + signature_lookups[i].misses;
+            }
+            BOOST_CHECK_EQUAL(validation_cache.m_lookups.signature_hits, queued_before.signature_hits);
+            BOOST_CHECK_EQUAL(validation_cache.m_lookups.signature_misses, queued_before.signature_misses);
+            validation_cache.AddSignatureLookups(signature_lookups);
+            const ValidationCacheStats queued{validation_cache.m_lookups - queued_before};
+            BOOST_CHECK_EQUAL(queued.signature_hits + queued.signature_misses, num_signature_lookups);
         }
     }
 }
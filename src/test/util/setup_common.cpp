@@ -267,8 +267,8 @@ ChainTestingSetup::ChainTestingSetup(const ChainType chainType, TestOpts opts)
             .check_block_index = 1,
             .notifications = *m_node.notifications,
             .signals = m_node.validation_signals.get(),
-            // Use no worker threads while fuzzing to avoid non-determinism
-            .worker_threads_num = EnableFuzzDeterminism() ? 0 : 2,
+            // Use no worker threads while fuzzing to avoid non-determinism, else -par (3) minus the calling thread
+            .worker_threads_num = EnableFuzzDeterminism() ? 0 : int(m_args.GetIntArg("-par", 3)) - 1,
         };
         if (opts.min_validation_cache) {
             chainman_opts.script_execution_cache_bytes = 0;
@@ -71,6 +71,14 @@ std::optional<Coin> CCoinsViewDB::GetCoin(const COutPoint& outpoint) const
     return std::nullopt;
 }
 
+std::vector<std::optional<Coin>> CCoinsViewDB::GetCoins(std::span<const COutPoint> outpoints) const
+{
+    std::vector<CoinEntry> keys;
+    keys.reserve(outpoints.size());
+    for (const COutPoint& outpoint : outpoints) keys.emplace_back(&outpoint);
+    return m_db->MultiRead<CoinEntry, Coin>(keys, m_options.read_threads);
+}
+
 bool CCoinsViewDB::HaveCoin(const COutPoint &outpoint) const {
     return m_db->Exists(CoinEntry(&outpoint));
 }
@@ -154,6 +162,19 @@ bool CCoinsViewDB::BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &hashB
     return ret;
 }
 
+void CCoinsViewDB::WriteCoins(std::span<const std::pair<COutPoint, Coin>> coins)
+{
+    CDBBatch batch(*m_db);
+    for (const auto& [outpoint, coin] : coins) {
+        batch.Write(CoinEntry(&outpoint), coin);
+        if (batch.ApproximateSize() > m_options.batch_write_bytes) {
+            m_db->WriteBatch(batch);
+            batch.Clear();
+        }
+    }
+    m_db->WriteBatch(batch);
+}
+
 size_t CCoinsViewDB::EstimateSize() const
 {
     return m_db->EstimateSize(DB_COIN, uint8_t(DB_COIN + 1));
@@ -183,13 +204,19 @@ private:
 };
 
 std::unique_ptr<CCoinsViewCursor> CCoinsViewDB::Cursor() const
+{
+    return CursorFrom(Txid{});
+}
+
+std::unique_ptr<CCoinsViewCursor> CCoinsViewDB::CursorFrom(const Txid& start) const
 {
     auto i = std::make_unique<CCoinsViewDBCursor>(
         const_cast<CDBWrapper&>(*m_db).NewIterator(), GetBestBlock());
     /* It seems that there are no "const iterators" for LevelDB.  Since we
        only need read operations on it, use a const-cast to get around
        that restriction.  */
-    i->pcursor->Seek(DB_COIN);
+    const COutPoint start_key{start, 0};
+    i->pcursor->Seek(CoinEntry(&start_key));
     // Cache key of first record
     if (i->pcursor->Valid()) {
         CoinEntry entry(&i->keyTmp.second);
@@ -16,6 +16,8 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
+#include <utility>
 #include <vector>
 
 class COutPoint;
@@ -23,6 +25,8 @@ class uint256;
 
 //! -dbbatchsize default (bytes)
 static const int64_t nDefaultDbBatchSize = 16 << 20;
+//! -dbreadthreads default
+static const int DEFAULT_DB_READ_THREADS = 4;
 
 //! User-controlled performance and debug options.
 struct CoinsViewOptions {
@@ -31,6 +35,8 @@ struct CoinsViewOptions {
     //! If non-zero, randomly exit when the database is flushed with (1/ratio)
     //! probability.
     int simulate_crash_ratio = 0;
+    //! Number of threads a GetCoins() call may use to look up coins.
+    int read_threads = DEFAULT_DB_READ_THREADS;
 };
 
 /** CCoinsView backed by the coin database (chainstate/) */
@@ -44,11 +50,18 @@ public:
     explicit CCoinsViewDB(DBParams db_params, CoinsViewOptions options);
 
     std::optional<Coin> GetCoin(const COutPoint& outpoint) const override;
+    std::vector<std::optional<Coin>> GetCoins(std::span<const COutPoint> outpoints) const override;
     bool HaveCoin(const COutPoint &outpoint) const override;
     uint256 GetBestBlock() const override;
     std::vector<uint256> GetHeadBlocks() const override;
     bool BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &hashBlock) override;
     std::unique_ptr<CCoinsViewCursor> Cursor() const override;
+    std::unique_ptr<CCoinsViewCursor> CursorFrom(const Txid& start) const override;
+
+    //! Write coins straight to the database, bypassing any cache, in batches of
+    //! at most batch_write_bytes. Used to bulk load a UTXO snapshot: the best
+    //! block is not updated and may be called from several threads at once.
+    void WriteCoins(std::span<const std::pair<COutPoint, Coin>> coins);
 
     //! Whether an unsupported database format is used.
     bool NeedsUpgrade();
@@ -59,6 +72,9 @@ public:
 
     //! @returns filesystem path to on-disk storage or std::nullopt if in memory.
     std::optional<fs::path> StoragePath() { return m_db->StoragePath(); }
+
+    //! LevelDB statistics, counted since the database was (re)opened by ResizeCache.
+    DBStats GetDBStats() const EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return m_db->GetStats(); }
 };
 
 #endif // BITQUANTUM_TXDB_H
@@ -16,6 +16,7 @@
 #include <policy/settings.h>
 #include <random.h>
 #include <tinyformat.h>
+#include <txgraph.h>
 #include <util/check.h>
 #include <util/feefrac.h>
 #include <util/moneystr.h>
@@ -28,6 +29,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <numeric>
 #include <optional>
 #include <ranges>
@@ -37,6 +39,9 @@
 TRACEPOINT_SEMAPHORE(mempool, added);
 TRACEPOINT_SEMAPHORE(mempool, removed);
 
+//! Number of linearization improvement steps after which a cluster's linearization is good enough.
+static constexpr uint64_t ACCEPTABLE_ITERS{1'700};
+
 bool TestLockPointValidity(CChain& active_chain, const LockPoints& lp)
 {
     AssertLockHeld(cs_main);
@@ -145,6 +150,7 @@ void CTxMemPool::UpdateTransactionsFromBlock(const std::vector<Txid>& vHashesToU
                 if (!visited(childIter) && !setAlreadyIncluded.count(childHash)) {
                     UpdateChild(it, childIter, true);
                     UpdateParent(childIter, it, true);
+                    m_txgraph->AddDependency(/*parent=*/*it, /*child=*/*childIter);
                 }
             }
         } // release epoch guard for UpdateForDescendants
@@ -414,6 +420,10 @@ static CTxMemPool::Options&& Flatten(CTxMemPool::Options&& opts, bilingual_str&
 CTxMemPool::CTxMemPool(Options opts, bilingual_str& error)
     : m_opts{Flatten(std::move(opts), error)}
 {
+    // Clusters are not limited by policy. Those beyond what the graph can
+    // linearize leave it oversized, and the graph-based code falls back to
+    // the ancestor/descendant state while that is the case.
+    m_txgraph = MakeTxGraph(MAX_CLUSTER_COUNT_LIMIT, std::numeric_limits<int32_t>::max(), ACCEPTABLE_ITERS);
 }
 
 bool CTxMemPool::isSpent(const COutPoint& outpoint) const
@@ -435,6 +445,8 @@ void CTxMemPool::AddTransactionsUpdated(unsigned int n)
 void CTxMemPool::Apply(ChangeSet* changeset)
 {
     AssertLockHeld(cs);
+    // The staged graph already reflects all removals and additions.
+    if (m_txgraph->HaveStaging()) m_txgraph->CommitStaging();
     RemoveStaged(changeset->m_to_remove, false, MemPoolRemovalReason::REPLACED);
 
     for (size_t i=0; i<changeset->m_entry_vec.size(); ++i) {
@@ -593,6 +605,13 @@ void CTxMemPool::CalculateDescendants(txiter entryit, setEntries& setDescendants
     }
 }
 
+std::unique_ptr<TxGraph::BlockBuilder> CTxMemPool::GetBlockBuilder() const
+{
+    AssertLockHeld(cs);
+    if (m_txgraph->IsOversized(/*main_only=*/true)) return nullptr;
+    return m_txgraph->GetBlockBuilder();
+}
+
 void CTxMemPool::removeRecursive(const CTransaction &origTx, MemPoolRemovalReason reason)
 {
     // Remove transaction from memory pool
@@ -706,6 +725,11 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
 
     CCoinsViewCache mempoolDuplicate(const_cast<CCoinsViewCache*>(&active_coins_tip));
 
+    assert(!m_txgraph->HaveStaging());
+    assert(m_txgraph->GetTransactionCount() == mapTx.size());
+    m_txgraph->SanityCheck();
+    const bool graph_oversized{m_txgraph->IsOversized()};
+
     for (const auto& it : GetSortedDepthAndScore()) {
         checkTotal += it->GetTxSize();
         check_total_fee += it->GetFee();
@@ -753,6 +777,10 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
         assert(it->GetSizeWithAncestors() == nSizeCheck);
         assert(it->GetSigOpCostWithAncestors() == nSigOpCheck);
         assert(it->GetModFeesWithAncestors() == nFeesCheck);
+        // The transaction graph agrees on the fee, size and ancestors.
+        assert(m_txgraph->Exists(*it));
+        assert(m_txgraph->GetIndividualFeerate(*it) == FeeFrac(it->GetModifiedFee(), it->GetTxSize()));
+        if (!graph_oversized) assert(m_txgraph->GetAncestors(*it).size() == nCountCheck);
         // Sanity check: we are walking in ascending ancestor count order.
         assert(prev_ancestor_count <= it->GetCountWithAncestors());
         prev_ancestor_count = it->GetCountWithAncestors();
@@ -894,6 +922,7 @@ void CTxMemPool::PrioritiseTransaction(const Txid& hash, const CAmount& nFeeDelt
         txiter it = mapTx.find(hash);
         if (it != mapTx.end()) {
             mapTx.modify(it, [&nFeeDelta](CTxMemPoolEntry& e) { e.UpdateModifiedFee(nFeeDelta); });
+            m_txgraph->SetTransactionFee(*it, it->GetModifiedFee());
             // Now update all ancestors' modified fees with descendants
             auto ancestors{AssumeCalculateMemPoolAncestors(__func__, *it, Limits::NoLimits(), /*fSearchForParents=*/false)};
             for (txiter ancestorIt : ancestors) {
@@ -1029,6 +1058,26 @@ std::optional<Coin> CCoinsViewMemPool::GetCoin(const COutPoint& outpoint) const
     return base->GetCoin(outpoint);
 }
 
+std::vector<std::optional<Coin>> CCoinsViewMemPool::GetCoins(std::span<const COutPoint> outpoints) const
+{
+    std::vector<std::optional<Coin>> coins(outpoints.size());
+    std::vector<COutPoint> base_outpoints;
+    std::vector<size_t> base_indexes;
+    for (size_t i = 0; i < outpoints.size(); ++i) {
+        if (m_temp_added.contains(outpoints[i]) || mempool.exists(outpoints[i].hash)) {
+            coins[i] = GetCoin(outpoints[i]);
+        } else {
+            base_outpoints.push_back(outpoints[i]);
+            base_indexes.push_back(i);
+        }
+    }
+    if (!base_outpoints.empty()) {
+        auto base_coins{base->GetCoins(base_outpoints)};
+        for (size_t i = 0; i < base_indexes.size(); ++i) coins[base_indexes[i]] = std::move(base_coins[i]);
+    }
+    return coins;
+}
+
 void CCoinsViewMemPool::PackageAddTransaction(const CTransactionRef& tx)
 {
     for (unsigned int n = 0; n < tx->vout.size(); ++n) {
@@ -1069,15 +1118,10 @@ int CTxMemPool::Expire(std::chrono::seconds time)
 {
     AssertLockHeld(cs);
     Assume(!m_have_changeset);
-    indexed_transaction_set::index<entry_time>::type::iterator it = mapTx.get<entry_time>().begin();
-    setEntries toremove;
-    while (it != mapTx.get<entry_time>().end() && it->GetTime() < time) {
-        toremove.insert(mapTx.project<0>(it));
-        it++;
-    }
     setEntries stage;
-    for (txiter removeit : toremove) {
-        CalculateDescendants(removeit, stage);
+    // Entries already staged as descendants of an earlier one are not walked again.
+    for (auto it{mapTx.get<entry_time>().begin()}; it != mapTx.get<entry_time>().end() && it->GetTime() < time; ++it) {
+        CalculateDescendants(mapTx.project<0>(it), stage);
     }
     RemoveStaged(stage, false, MemPoolRemovalReason::EXPIRY);
     return stage.size();
@@ -1144,31 +1188,46 @@ void CTxMemPool::TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpends
     unsigned nTxnRemoved = 0;
     CFeeRate maxFeeRateRemoved(0);
     while (!mapTx.empty() && DynamicMemoryUsage() > sizelimit) {
-        indexed_transaction_set::index<descendant_score>::type::iterator it = mapTx.get<descendant_score>().begin();
+        setEntries stage;
+        CFeeRate removed;
+        if (!m_txgraph->IsOversized()) {
+            // Evict the last chunk of the mempool's linearization, which is the
+            // last chunk of its cluster, so it includes all its descendants.
+            // The chunk index of the graph is kept up to date on every addition
+            // and removal, so no descendants have to be walked here.
+            const auto [worst_chunk, chunk_feerate] = m_txgraph->GetWorstMainChunk();
+            removed = CFeeRate(chunk_feerate.fee, chunk_feerate.size);
+            for (const TxGraph::Ref* ref : worst_chunk) {
+                stage.insert(mapTx.iterator_to(static_cast<const CTxMemPoolEntry&>(*ref)));
+            }
+        } else {
+            // Some cluster is too large to be linearized, so evict the
+            // transaction with the lowest descendant score and its descendants.
+            indexed_transaction_set::index<descendant_score>::type::iterator it = mapTx.get<descendant_score>().begin();
+            removed = CFeeRate(it->GetModFeesWithDescendants(), it->GetSizeWithDescendants());
+            CalculateDescendants(mapTx.project<0>(it), stage);
+        }
 
         // We set the new mempool min fee to the feerate of the removed set, plus the
         // "minimum reasonable fee rate" (ie some value under which we consider txn
         // to have 0 fee). This way, we don't allow txn to enter mempool with feerate
         // equal to txn which were removed with no block in between.
-        CFeeRate removed(it->GetModFeesWithDescendants(), it->GetSizeWithDescendants());
         removed += m_opts.incremental_relay_feerate;
         trackPackageRemoved(removed);
         maxFeeRateRemoved = std::max(maxFeeRateRemoved, removed);
 
-        setEntries stage;
-        CalculateDescendants(mapTx.project<0>(it), stage);
         nTxnRemoved += stage.size();
 
-        std::vector<CTransaction> txn;
+        std::vector<CTransactionRef> txn;
         if (pvNoSpendsRemaining) {
             txn.reserve(stage.size());
             for (txiter iter : stage)
-                txn.push_back(iter->GetTx());
+                txn.push_back(iter->GetSharedTx());
         }
         RemoveStaged(stage, false, MemPoolRemovalReason::SIZELIMIT);
         if (pvNoSpendsRemaining) {
-            for (const CTransaction& tx : txn) {
-                for (const CTxIn& txin : tx.vin) {
+            for (const CTransactionRef& tx : txn) {
+                for (const CTxIn& txin : tx->vin) {
                     if (exists(txin.prevout.hash)) continue;
                     pvNoSpendsRemaining->push_back(txin.prevout);
                 }
@@ -1297,52 +1356,43 @@ std::optional<std::string> CTxMemPool::CheckConflictTopology(const setEntries& d
 util::Result<std::pair<std::vector<FeeFrac>, std::vector<FeeFrac>>> CTxMemPool::ChangeSet::CalculateChunksForRBF()
 {
     LOCK(m_pool->cs);
-    FeeFrac replacement_feerate{0, 0};
-    for (auto it : m_entry_vec) {
-        replacement_feerate += {it->GetModifiedFee(), it->GetTxSize()};
-    }
 
     auto err_string{m_pool->CheckConflictTopology(m_to_remove)};
     if (err_string.has_value()) {
-        // Unsupported topology for calculating a feerate diagram
+        // Unsupported topology for a package replacement
         return util::Error{Untranslated(err_string.value())};
     }
 
-    // new diagram will have chunks that consist of each ancestor of
-    // direct_conflicts that is at its own fee/size, along with the replacement
-    // tx/package at its own fee/size
+    if (!m_pool->m_txgraph->HaveStaging()) return std::make_pair(std::vector<FeeFrac>{}, std::vector<FeeFrac>{});
+    if (!m_pool->m_txgraph->IsOversized(/*main_only=*/true) && !m_pool->m_txgraph->IsOversized()) {
+        // The old diagram consists of the chunks of all clusters affected by the
+        // staged changes, and the new one of the chunks the same transactions
+        // (minus the removals, plus the additions) are linearized into.
+        return m_pool->m_txgraph->GetMainStagingDiagrams();
+    }
 
-    // old diagram will consist of the ancestors and descendants of each element of
-    // all_conflicts.  every such transaction will either be at its own feerate (followed
-    // by any descendant at its own feerate), or as a single chunk at the descendant's
-    // ancestor feerate.
+    // Some cluster is too large to be linearized. The conflicts form clusters
+    // of at most two transactions, so build the diagrams from their ancestor
+    // and descendant state instead.
+    FeeFrac replacement_feerate{0, 0};
+    for (auto it : m_entry_vec) {
+        replacement_feerate += {it->GetModifiedFee(), it->GetTxSize()};
+    }
 
+    // OLD: every conflict is either at its own feerate (followed by any
+    // descendant at its own feerate), or chunked with its descendant at the
+    // descendant's ancestor feerate.
     std::vector<FeeFrac> old_chunks;
-    // Step 1: build the old diagram.
-
-    // The above clusters are all trivially linearized;
-    // they have a strict topology of 1 or two connected transactions.
-
-    // OLD: Compute existing chunks from all affected clusters
     for (auto txiter : m_to_remove) {
-        // Does this transaction have descendants?
-        if (txiter->GetCountWithDescendants() > 1) {
-            // Consider this tx when we consider the descendant.
-            continue;
-        }
-        // Does this transaction have ancestors?
+        // Consider a transaction with descendants when we consider the descendant.
+        if (txiter->GetCountWithDescendants() > 1) continue;
         FeeFrac individual{txiter->GetModifiedFee(), txiter->GetTxSize()};
         if (txiter->GetCountWithAncestors() > 1) {
-            // We'll add chunks for either the ancestor by itself and this tx
-            // by itself, or for a combined package.
             FeeFrac package{txiter->GetModFeesWithAncestors(), static_cast<int32_t>(txiter->GetSizeWithAncestors())};
             if (individual >> package) {
-                // The individual feerate is higher than the package, and
-                // therefore higher than the parent's fee. Chunk these
-                // together.
+                // The child pays for its parent, so they form one chunk.
                 old_chunks.emplace_back(package);
             } else {
-                // Add two points, one for the parent and one for this child.
                 old_chunks.emplace_back(package - individual);
                 old_chunks.emplace_back(individual);
             }
@@ -1350,37 +1400,20 @@ util::Result<std::pair<std::vector<FeeFrac>, std::vector<FeeFrac>>> CTxMemPool::
             old_chunks.emplace_back(individual);
         }
     }
-
-    // No topology restrictions post-chunking; sort
     std::sort(old_chunks.begin(), old_chunks.end(), std::greater());
 
+    // NEW: the parents of conflicts that are not conflicted themselves, at
+    // their own feerate, plus the replacement as a single chunk.
     std::vector<FeeFrac> new_chunks;
-
-    /* Step 2: build the NEW diagram
-     * CON = Conflicts of proposed chunk
-     * CNK = Proposed chunk
-     * NEW = OLD - CON + CNK: New diagram includes all chunks in OLD, minus
-     * the conflicts, plus the proposed chunk
-     */
-
-    // OLD - CON: Add any parents of direct conflicts that are not conflicted themselves
     for (auto direct_conflict : m_to_remove) {
-        // If a direct conflict has an ancestor that is not in all_conflicts,
-        // it can be affected by the replacement of the child.
         if (direct_conflict->GetMemPoolParentsConst().size() > 0) {
-            // Grab the parent.
             const CTxMemPoolEntry& parent = direct_conflict->GetMemPoolParentsConst().begin()->get();
             if (!m_to_remove.contains(m_pool->mapTx.iterator_to(parent))) {
-                // This transaction would be left over, so add to the NEW
-                // diagram.
                 new_chunks.emplace_back(parent.GetModifiedFee(), parent.GetTxSize());
             }
         }
     }
-    // + CNK: Add the proposed chunk itself
     new_chunks.emplace_back(replacement_feerate);
-
-    // No topology restrictions post-chunking; sort
     std::sort(new_chunks.begin(), new_chunks.end(), std::greater());
     return std::make_pair(old_chunks, new_chunks);
 }
@@ -1394,10 +1427,33 @@ CTxMemPool::ChangeSet::TxHandle CTxMemPool::ChangeSet::StageAddition(const CTran
     m_pool->ApplyDelta(tx->GetHash(), delta);
     if (delta) m_to_add.modify(newit, [&delta](CTxMemPoolEntry& e) { e.UpdateModifiedFee(delta); });
 
+    // Add the transaction to the staged graph (with its virtual size as the
+    // size), depending on its in-mempool and previously staged parents.
+    TxGraph& graph{*m_pool->m_txgraph};
+    if (!graph.HaveStaging()) graph.StartStaging();
+    m_to_add.modify(newit, [&](CTxMemPoolEntry& e) {
+        static_cast<TxGraph::Ref&>(e) = graph.AddTransaction(FeePerWeight(e.GetModifiedFee(), e.GetTxSize()));
+    });
+    for (const CTxIn& txin : tx->vin) {
+        if (auto parent{m_pool->GetIter(txin.prevout.hash)}) {
+            graph.AddDependency(/*parent=*/**parent, /*child=*/*newit);
+        } else if (auto staged_parent{m_to_add.find(txin.prevout.hash)}; staged_parent != m_to_add.end()) {
+            graph.AddDependency(/*parent=*/*staged_parent, /*child=*/*newit);
+        }
+    }
+
     m_entry_vec.push_back(newit);
     return newit;
 }
 
+void CTxMemPool::ChangeSet::StageRemoval(CTxMemPool::txiter it)
+{
+    LOCK(m_pool->cs);
+    if (!m_pool->m_txgraph->HaveStaging()) m_pool->m_txgraph->StartStaging();
+    m_pool->m_txgraph->RemoveTransaction(*it);
+    m_to_remove.insert(it);
+}
+
 void CTxMemPool::ChangeSet::Apply()
 {
     LOCK(m_pool->cs);
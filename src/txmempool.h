@@ -19,6 +19,7 @@
 #include <primitives/transaction.h>
 #include <primitives/transaction_identifier.h>
 #include <sync.h>
+#include <txgraph.h>
 #include <util/epochguard.h>
 #include <util/feefrac.h>
 #include <util/hasher.h>
@@ -34,6 +35,7 @@
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
 #include <string>
@@ -365,6 +367,17 @@ public:
      * the mempool is consistent with the new chain tip and fully populated.
      */
     mutable RecursiveMutex cs;
+    /**
+     * Fees, sizes and dependencies of all transactions in mapTx, whose entries
+     * are the graph's TxGraph::Refs. The graph groups them into clusters and
+     * keeps a linearization of each, which replacement checks, eviction and
+     * block building are based on. Clusters are not limited by policy; while
+     * one is too large for the graph to linearize, these fall back to the
+     * ancestor/descendant state in mapTx. A ChangeSet stages its additions
+     * and removals in the graph's staging level. Declared before mapTx, so
+     * that it outlives the entries.
+     */
+    std::unique_ptr<TxGraph> m_txgraph GUARDED_BY(cs);
     indexed_transaction_set mapTx GUARDED_BY(cs);
 
     using txiter = indexed_transaction_set::nth_index<0>::type::const_iterator;
@@ -570,6 +583,12 @@ public:
      *  already in it.  */
     void CalculateDescendants(txiter it, setEntries& setDescendants) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    /** Get a builder drawing the chunks of the mempool's cluster linearizations in
+     *  order of decreasing feerate, for block building. Returns nullptr if some
+     *  cluster is too large for the transaction graph to linearize. The mempool must
+     *  not be modified while the builder exists. */
+    std::unique_ptr<TxGraph::BlockBuilder> GetBlockBuilder() const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     /** The minimum fee to get into the mempool, which may itself not be enough
      *  for larger-sized transactions.
      *  The m_incremental_relay_feerate policy variable is used to bound the time it
@@ -581,6 +600,12 @@ public:
     }
 
     /** Remove transactions from the mempool until its dynamic size is <= sizelimit.
+      *  Each step evicts the lowest feerate chunk. The transaction graph keeps
+      *  chunks indexed, so finding it is logarithmic in the size of the
+      *  mempool. Removing it still updates the ancestors of the removed
+      *  transactions, and the graph may have to linearize clusters first.
+      *  While some cluster is too large for the graph, each step evicts the
+      *  lowest descendant score package instead.
       *  pvNoSpendsRemaining, if set, will be populated with the list of outpoints
       *  which are not in mempool which no longer have any spends in this mempool.
       */
@@ -811,12 +836,18 @@ public:
      *
      * Only one changeset may exist at a time. While a changeset is
      * outstanding, no removals or additions may be made directly to the
-     * mempool.
+     * mempool. The changes are mirrored in the staging level of the
+     * mempool's transaction graph, which is committed by Apply() and
+     * discarded when the changeset is destroyed without being applied.
      */
     class ChangeSet {
     public:
         explicit ChangeSet(CTxMemPool* pool) : m_pool(pool) {}
-        ~ChangeSet() EXCLUSIVE_LOCKS_REQUIRED(m_pool->cs) { m_pool->m_have_changeset = false; }
+        ~ChangeSet() EXCLUSIVE_LOCKS_REQUIRED(m_pool->cs)
+        {
+            if (m_pool->m_txgraph->HaveStaging()) m_pool->m_txgraph->AbortStaging();
+            m_pool->m_have_changeset = false;
+        }
 
         ChangeSet(const ChangeSet&) = delete;
         ChangeSet& operator=(const ChangeSet&) = delete;
@@ -824,7 +855,7 @@ public:
         using TxHandle = CTxMemPool::txiter;
 
         TxHandle StageAddition(const CTransactionRef& tx, const CAmount fee, int64_t time, unsigned int entry_height, uint64_t entry_sequence, bool spends_coinbase, int64_t sigops_cost, LockPoints lp);
-        void StageRemoval(CTxMemPool::txiter it) { m_to_remove.insert(it); }
+        void StageRemoval(CTxMemPool::txiter it);
 
         const CTxMemPool::setEntries& GetRemovals() const { return m_to_remove; }
 
@@ -936,6 +967,9 @@ public:
     /** GetCoin, returning whether it exists and is not spent. Also updates m_non_base_coins if the
      * coin is not fetched from base. */
     std::optional<Coin> GetCoin(const COutPoint& outpoint) const override;
+    /** Like GetCoin for each outpoint, but the outpoints not created by the mempool or the package
+     * are fetched from base with a single GetCoins call. */
+    std::vector<std::optional<Coin>> GetCoins(std::span<const COutPoint> outpoints) const override;
     /** Add the coins created by this transaction. These coins are only temporarily stored in
      * m_temp_added and cannot be flushed to the back end. Only used for package validation. */
     void PackageAddTransaction(const CTransactionRef& tx);
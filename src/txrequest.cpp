@@ -15,7 +15,6 @@
 #include <boost/multi_index/sequenced_index.hpp>
 #include <boost/multi_index/tag.hpp>
 #include <boost/multi_index_container.hpp>
-#include <boost/tuple/tuple.hpp>
 
 #include <chrono>
 #include <unordered_map>
@@ -57,6 +56,9 @@ enum class State : uint8_t {
 //! Type alias for sequence numbers.
 using SequenceNumber = uint64_t;
 
+//! Type alias for priorities.
+using Priority = uint64_t;
+
 /** An announcement. This is the data we track for each txid or wtxid that is announced to us by each peer. */
 struct Announcement {
     /** Txid or wtxid that was announced. */
@@ -65,6 +67,9 @@ struct Announcement {
     std::chrono::microseconds m_time;
     /** What peer the request was from. */
     const NodeId m_peer;
+    /** The priority of this announcement among the ones for the same txhash (see PriorityComputer). Computed once,
+     *  as the ByTxHash index compares it for every CANDIDATE_READY announcement it passes. */
+    const Priority m_priority;
     /** What sequence number this announcement has. */
     const SequenceNumber m_sequence : 59;
     /** Whether the request is preferred. */
@@ -94,13 +99,11 @@ struct Announcement {
 
     /** Construct a new announcement from scratch, initially in CANDIDATE_DELAYED state. */
     Announcement(const GenTxid& gtxid, NodeId peer, bool preferred, std::chrono::microseconds reqtime,
-                 SequenceNumber sequence)
-        : m_gtxid(gtxid), m_time(reqtime), m_peer(peer), m_sequence(sequence), m_preferred(preferred) {}
+                 SequenceNumber sequence, Priority priority)
+        : m_gtxid(gtxid), m_time(reqtime), m_peer(peer), m_priority(priority), m_sequence(sequence),
+          m_preferred(preferred) {}
 };
 
-//! Type alias for priorities.
-using Priority = uint64_t;
-
 /** A functor with embedded salt that computes priority of an announcement.
  *
  * Higher priorities are selected first.
@@ -117,11 +120,6 @@ public:
         uint64_t low_bits = CSipHasher(m_k0, m_k1).Write(txhash).Write(peer).Finalize() >> 1;
         return low_bits | uint64_t{preferred} << 63;
     }
-
-    Priority operator()(const Announcement& ann) const
-    {
-        return operator()(ann.m_gtxid.ToUint256(), ann.m_peer, ann.m_preferred);
-    }
 };
 
 // Definitions for the 3 indexes used in the main data structure.
@@ -160,14 +158,12 @@ struct ByPeerViewExtractor
 //   deleted.
 struct ByTxHash {};
 using ByTxHashView = std::tuple<const uint256&, State, Priority>;
-class ByTxHashViewExtractor {
-    const PriorityComputer& m_computer;
-public:
-    explicit ByTxHashViewExtractor(const PriorityComputer& computer) : m_computer(computer) {}
+struct ByTxHashViewExtractor
+{
     using result_type = ByTxHashView;
     result_type operator()(const Announcement& ann) const
     {
-        const Priority prio = (ann.GetState() == State::CANDIDATE_READY) ? m_computer(ann) : 0;
+        const Priority prio = (ann.GetState() == State::CANDIDATE_READY) ? ann.m_priority : 0;
         return ByTxHashView{ann.m_gtxid.ToUint256(), ann.GetState(), prio};
     }
 };
@@ -277,6 +273,9 @@ std::map<uint256, TxHashInfo> ComputeTxHashInfo(const Index& index, const Priori
     std::map<uint256, TxHashInfo> ret;
     for (const Announcement& ann : index) {
         TxHashInfo& info = ret[ann.m_gtxid.ToUint256()];
+        // The cached priority must match the one computed from scratch.
+        const Priority priority{computer(ann.m_gtxid.ToUint256(), ann.m_peer, ann.m_preferred)};
+        assert(ann.m_priority == priority);
         // Classify how many announcements of each state we have for this txhash.
         info.m_candidate_delayed += (ann.GetState() == State::CANDIDATE_DELAYED);
         info.m_candidate_ready += (ann.GetState() == State::CANDIDATE_READY);
@@ -284,10 +283,10 @@ std::map<uint256, TxHashInfo> ComputeTxHashInfo(const Index& index, const Priori
         info.m_requested += (ann.GetState() == State::REQUESTED);
         // And track the priority of the best CANDIDATE_READY/CANDIDATE_BEST announcements.
         if (ann.GetState() == State::CANDIDATE_BEST) {
-            info.m_priority_candidate_best = computer(ann);
+            info.m_priority_candidate_best = priority;
         }
         if (ann.GetState() == State::CANDIDATE_READY) {
-            info.m_priority_best_candidate_ready = std::max(info.m_priority_best_candidate_ready, computer(ann));
+            info.m_priority_best_candidate_ready = std::max(info.m_priority_best_candidate_ready, priority);
         }
         // Also keep track of which peers this txhash has an announcement for (so we can detect duplicates).
         info.m_peers.push_back(ann.m_peer);
@@ -406,8 +405,8 @@ private:
             // already.
             Modify<ByTxHash>(it, [](Announcement& ann){ ann.SetState(State::CANDIDATE_BEST); });
         } else if (it_next->GetState() == State::CANDIDATE_BEST) {
-            Priority priority_old = m_computer(*it_next);
-            Priority priority_new = m_computer(*it);
+            Priority priority_old = it_next->m_priority;
+            Priority priority_new = it->m_priority;
             if (priority_new > priority_old) {
                 // There is a CANDIDATE_BEST announcement already, but this one is better.
                 Modify<ByTxHash>(it_next, [](Announcement& ann){ ann.SetState(State::CANDIDATE_READY); });
@@ -514,15 +513,9 @@ private:
 
 public:
     explicit Impl(bool deterministic) :
-        m_computer(deterministic),
-        // Explicitly initialize m_index as we need to pass a reference to m_computer to ByTxHashViewExtractor.
-        m_index(boost::make_tuple(
-            boost::make_tuple(ByPeerViewExtractor(), std::less<ByPeerView>()),
-            boost::make_tuple(ByTxHashViewExtractor(m_computer), std::less<ByTxHashView>()),
-            boost::make_tuple(ByTimeViewExtractor(), std::less<ByTimeView>())
-        )) {}
-
-    // Disable copying and assigning (a default copy won't work due the stateful ByTxHashViewExtractor).
+        m_computer(deterministic) {}
+
+    // Disable copying and assigning.
     Impl(const Impl&) = delete;
     Impl& operator=(const Impl&) = delete;
 
@@ -585,7 +578,8 @@ public:
         // Try creating the announcement with CANDIDATE_DELAYED state (which will fail due to the uniqueness
         // of the ByPeer index if a non-CANDIDATE_BEST announcement already exists with the same txhash and peer).
         // Bail out in that case.
-        auto ret = m_index.get<ByPeer>().emplace(gtxid, peer, preferred, reqtime, m_current_sequence);
+        auto ret = m_index.get<ByPeer>().emplace(gtxid, peer, preferred, reqtime, m_current_sequence,
+                                                 m_computer(gtxid.ToUint256(), peer, preferred));
         if (!ret.second) return;
 
         // Update accounting metadata.
@@ -5,11 +5,17 @@
 #ifndef BITQUANTUM_UTIL_GOLOMBRICE_H
 #define BITQUANTUM_UTIL_GOLOMBRICE_H
 
+#include <crypto/common.h>
 #include <util/fastrange.h>
 
 #include <streams.h>
 
+#include <bit>
 #include <cstdint>
+#include <ios>
+#include <span>
+#include <stdexcept>
+#include <vector>
 
 template <typename OStream>
 void GolombRiceEncode(BitStreamWriter<OStream>& bitwriter, uint8_t P, uint64_t x)
@@ -42,4 +48,160 @@ uint64_t GolombRiceDecode(BitStreamReader<IStream>& bitreader, uint8_t P)
     return (q << P) + r;
 }
 
+/**
+ * Golomb-Rice encoder appending to a byte vector. Produces the same output as
+ * GolombRiceEncode() on a BitStreamWriter, but collects the bits in a 64-bit
+ * word and writes them 8 bytes at a time.
+ */
+class GolombRiceWriter
+{
+private:
+    std::vector<unsigned char>& m_out;
+    /// Pending bits, aligned to the most significant bit.
+    uint64_t m_buffer{0};
+    /// Number of pending bits in m_buffer.
+    int m_bits{0};
+
+    /** Write the nbits (1 to 64) least significant bits of value, which must
+     * have no bits set above them. */
+    void WriteBits(uint64_t value, int nbits)
+    {
+        const int free{64 - m_bits};
+        if (nbits < free) {
+            m_buffer |= value << (free - nbits);
+            m_bits += nbits;
+            return;
+        }
+        m_buffer |= value >> (nbits - free);
+        const size_t size{m_out.size()};
+        m_out.resize(size + 8);
+        WriteBE64(m_out.data() + size, m_buffer);
+        m_bits = nbits - free;
+        m_buffer = m_bits > 0 ? value << (64 - m_bits) : 0;
+    }
+
+public:
+    explicit GolombRiceWriter(std::vector<unsigned char>& out) : m_out(out) {}
+
+    ~GolombRiceWriter()
+    {
+        Flush();
+    }
+
+    void Encode(uint8_t P, uint64_t x)
+    {
+        if (P > 64) throw std::out_of_range("nbits must be between 0 and 64");
+        const uint64_t remainder{P == 64 ? x : x & ((uint64_t{1} << P) - 1)};
+        uint64_t q = P == 64 ? 0 : x >> P;
+        if (q + 1 + P <= 64) {
+            // The common case: the quotient in unary, its terminating 0 and
+            // the remainder fit in a single write.
+            const uint64_t unary{q == 0 ? 0 : ((uint64_t{1} << q) - 1) << (P + 1)};
+            WriteBits(unary | remainder, q + 1 + P);
+            return;
+        }
+        while (q > 0) {
+            const int nbits = q <= 64 ? static_cast<int>(q) : 64;
+            WriteBits(~uint64_t{0} >> (64 - nbits), nbits);
+            q -= nbits;
+        }
+        WriteBits(0, 1);
+        if (P > 0) WriteBits(remainder, P);
+    }
+
+    /** Write out the pending bits, padding with 0's to the next byte boundary. */
+    void Flush()
+    {
+        for (; m_bits > 0; m_bits -= 8) {
+            m_out.push_back(static_cast<unsigned char>(m_buffer >> 56));
+            m_buffer <<= 8;
+        }
+        m_bits = 0;
+        m_buffer = 0;
+    }
+};
+
+/**
+ * Golomb-Rice decoder reading from a byte span. Decodes the same values as
+ * GolombRiceDecode() on a BitStreamReader, but refills a 64-bit buffer a word
+ * at a time and reads unary quotients with a leading-ones count.
+ */
+class GolombRiceReader
+{
+private:
+    std::span<const unsigned char> m_data;
+    /// Position of the next byte to load into m_buffer.
+    size_t m_pos{0};
+    /// Loaded bits, aligned to the most significant bit. The bits below the
+    /// first m_bits are either zero or equal to the data that follows.
+    uint64_t m_buffer{0};
+    /// Number of loaded and not yet consumed bits in m_buffer.
+    int m_bits{0};
+
+    /** Load whole bytes until more than 56 bits are available or the data ends. */
+    void Refill()
+    {
+        if (m_pos + 8 <= m_data.size()) {
+            m_buffer |= ReadBE64(m_data.data() + m_pos) >> m_bits;
+            const int bytes{(64 - m_bits) >> 3};
+            m_pos += bytes;
+            m_bits += bytes * 8;
+            return;
+        }
+        while (m_bits <= 56 && m_pos < m_data.size()) {
+            m_buffer |= uint64_t{m_data[m_pos++]} << (56 - m_bits);
+            m_bits += 8;
+        }
+    }
+
+    void Consume(int nbits)
+    {
+        m_buffer = nbits < 64 ? m_buffer << nbits : 0;
+        m_bits -= nbits;
+    }
+
+    /** Read nbits (0 to 64) bits. */
+    uint64_t ReadBits(int nbits)
+    {
+        if (nbits > 56) {
+            const uint64_t high{ReadBits(nbits - 32)};
+            return (high << 32) | ReadBits(32);
+        }
+        if (m_bits < nbits) {
+            Refill();
+            if (m_bits < nbits) throw std::ios_base::failure("GolombRiceReader: end of data");
+        }
+        if (nbits == 0) return 0;
+        const uint64_t value{m_buffer >> (64 - nbits)};
+        Consume(nbits);
+        return value;
+    }
+
+public:
+    explicit GolombRiceReader(std::span<const unsigned char> data) : m_data(data) {}
+
+    uint64_t Decode(uint8_t P)
+    {
+        if (P > 64) throw std::out_of_range("nbits must be between 0 and 64");
+        uint64_t q = 0;
+        while (true) {
+            if (m_bits == 0) {
+                Refill();
+                if (m_bits == 0) throw std::ios_base::failure("GolombRiceReader: end of data");
+            }
+            const int ones{std::min(std::countl_one(m_buffer), m_bits)};
+            q += ones;
+            if (ones < m_bits) {
+                Consume(ones + 1);
+                break;
+            }
+            Consume(ones);
+        }
+        return (q << P) + ReadBits(P);
+    }
+
+    /** Number of bytes of the data read so far, including a partially read last byte. */
+    size_t BytesConsumed() const { return (m_pos * 8 - m_bits + 7) / 8; }
+};
+
 #endif // BITQUANTUM_UTIL_GOLOMBRICE_H
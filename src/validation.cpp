@@ -31,6 +31,8 @@
 #include <logging.h>
 #include <logging/timer.h>
 #include <node/blockstorage.h>
+#include <node/reorgprefetch.h>
+#include <node/snapshotloader.h>
 #include <node/utxo_snapshot.h>
 #include <policy/ephemeral_policy.h>
 #include <policy/policy.h>
@@ -112,8 +114,11 @@ const std::vector<std::string> CHECKLEVEL_DOC {
  *  noticeably interfere with the pruning mechanism.
  * */
 static constexpr int PRUNE_LOCK_BUFFER{10};
+/** Minimum number of inputs for the policy script checks of mempool acceptance to use the mempool script check threads */
+static constexpr size_t MIN_PARALLEL_POLICY_SCRIPT_CHECK_INPUTS{8};
 
 TRACEPOINT_SEMAPHORE(validation, block_connected);
+TRACEPOINT_SEMAPHORE(validation, block_cache_stats);
 TRACEPOINT_SEMAPHORE(utxocache, flush);
 TRACEPOINT_SEMAPHORE(mempool, replaced);
 TRACEPOINT_SEMAPHORE(mempool, rejected);
@@ -683,6 +688,15 @@ private:
     // only invoke this on transactions that have otherwise passed policy checks.
     bool PolicyScriptChecks(const ATMPArgs& args, Workspace& ws) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
 
+    // Run PolicyScriptChecks() on several transactions. If they have enough inputs,
+    // all inputs are first checked at once on the mempool script check threads,
+    // which are shared only with LoadMempool().
+    // The transactions are then only checked one by one if that fails, to find the
+    // failing transaction and fill in its state. Returns the workspace of the first
+    // failing transaction, or nullptr. cs_main and m_pool.cs stay held while the
+    // threads run, so only the inputs of one transaction or package are batched.
+    Workspace* ParallelPolicyScriptChecks(const ATMPArgs& args, std::span<Workspace> workspaces) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
+
     // Re-run the script checks, using consensus flags, and try to cache the
     // result in the scriptcache. This should be done after
     // PolicyScriptChecks(). This requires that all inputs either be in our
@@ -849,15 +863,21 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     m_view.SetBackend(m_viewmempool);
 
     const CCoinsViewCache& coins_cache = m_active_chainstate.CoinsTip();
-    // do all inputs exist?
+    std::vector<COutPoint> prevouts;
+    prevouts.reserve(tx.vin.size());
     for (const CTxIn& txin : tx.vin) {
         if (!coins_cache.HaveCoinInCache(txin.prevout)) {
             coins_to_uncache.push_back(txin.prevout);
         }
+        prevouts.push_back(txin.prevout);
+    }
+    // Fetch all inputs with one batched lookup. Note: this call may add them
+    // to the coins cache (coins_cache.cacheCoins). They should be removed
+    // later (via coins_to_uncache) if this tx turns out to be invalid.
+    m_view.PrefetchCoins(prevouts);
 
-        // Note: this call may add txin.prevout to the coins cache
-        // (coins_cache.cacheCoins) by way of FetchCoin(). It should be removed
-        // later (via coins_to_uncache) if this tx turns out to be invalid.
+    // do all inputs exist?
+    for (const CTxIn& txin : tx.vin) {
         if (!m_view.HaveCoin(txin.prevout)) {
             // Are inputs missing because we already have the tx?
             for (size_t out = 0; out < tx.vout.size(); out++) {
@@ -1265,6 +1285,42 @@ bool MemPoolAccept::PolicyScriptChecks(const ATMPArgs& args, Workspace& ws)
     return true;
 }
 
+MemPoolAccept::Workspace* MemPoolAccept::ParallelPolicyScriptChecks(const ATMPArgs& args, std::span<Workspace> workspaces)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(m_pool.cs);
+
+    auto& queue{m_active_chainstate.m_chainman.GetMempoolCheckQueue()};
+    size_t num_inputs{0};
+    for (const Workspace& ws : workspaces) num_inputs += ws.m_ptx->vin.size();
+    if (queue.HasThreads() && num_inputs >= MIN_PARALLEL_POLICY_SCRIPT_CHECK_INPUTS) {
+        // One signature cache lookup counter per check, outliving control.
+        std::vector<SignatureCacheLookups> signature_lookups(num_inputs);
+        size_t num_queued_checks{0};
+        CCheckQueueControl<CScriptCheck> control{queue};
+        bool all_queued{true};
+        for (Workspace& ws : workspaces) {
+            std::vector<CScriptCheck> checks;
+            TxValidationState state;
+            if (!CheckInputScripts(*ws.m_ptx, state, m_view, STANDARD_SCRIPT_VERIFY_FLAGS, /*cacheSigStore=*/true, /*cacheFullScriptStore=*/false,
+                                   ws.m_precomputed_txdata, GetValidationCache(), &checks)) {
+                all_queued = false;
+                break;
+            }
+            for (CScriptCheck& check : checks) check.CountSignatureLookups(&signature_lookups[num_queued_checks++]);
+            control.Add(std::move(checks));
+        }
+        const bool all_passed{!control.Complete().has_value()};
+        GetValidationCache().AddSignatureLookups(std::span{signature_lookups}.first(num_queued_checks));
+        if (all_passed && all_queued) return nullptr;
+    }
+
+    for (Workspace& ws : workspaces) {
+        if (!PolicyScriptChecks(args, ws)) return &ws;
+    }
+    return nullptr;
+}
+
 bool MemPoolAccept::ConsensusScriptChecks(const ATMPArgs& args, Workspace& ws)
 {
     AssertLockHeld(cs_main);
@@ -1466,7 +1522,7 @@ MempoolAcceptResult MemPoolAccept::AcceptSingleTransaction(const CTransactionRef
 
     // Perform the inexpensive checks first and avoid hashing and signature verification unless
     // those checks pass, to mitigate CPU exhaustion denial-of-service attacks.
-    if (!PolicyScriptChecks(args, ws)) return MempoolAcceptResult::Failure(ws.m_state);
+    if (ParallelPolicyScriptChecks(args, {&ws, 1})) return MempoolAcceptResult::Failure(ws.m_state);
 
     if (!ConsensusScriptChecks(args, ws)) return MempoolAcceptResult::Failure(ws.m_state);
 
@@ -1616,10 +1672,11 @@ PackageMempoolAcceptResult MemPoolAccept::AcceptMultipleTransactions(const std::
         }
     }
 
+    for (Workspace& ws : workspaces) ws.m_package_feerate = package_feerate;
+    Workspace* const failed_ws{ParallelPolicyScriptChecks(args, workspaces)};
     for (Workspace& ws : workspaces) {
-        ws.m_package_feerate = package_feerate;
-        if (!PolicyScriptChecks(args, ws)) {
-            // Exit early to avoid doing pointless work. Update the failed tx result; the rest are unfinished.
+        if (&ws == failed_ws) {
+            // Update the failed tx result; the rest are unfinished.
             package_state.Invalid(PackageValidationResult::PCKG_TX, "transaction failed");
             results.emplace(ws.m_ptx->GetWitnessHash(), MempoolAcceptResult::Failure(ws.m_state));
             return PackageMempoolAcceptResult(package_state, std::move(results));
@@ -2096,7 +2153,7 @@ std::optional<std::pair<ScriptError, std::string>> CScriptCheck::operator()() {
     const CScript &scriptSig = ptxTo->vin[nIn].scriptSig;
     const CScriptWitness *witness = &ptxTo->vin[nIn].scriptWitness;
     ScriptError error{SCRIPT_ERR_UNKNOWN_ERROR};
-    if (VerifyScript(scriptSig, m_tx_out.scriptPubKey, witness, nFlags, CachingTransactionSignatureChecker(ptxTo, nIn, m_tx_out.nValue, cacheStore, *m_signature_cache, *txdata), &error)) {
+    if (VerifyScript(scriptSig, m_tx_out.scriptPubKey, witness, nFlags, CachingTransactionSignatureChecker(ptxTo, nIn, m_tx_out.nValue, cacheStore, *m_signature_cache, *txdata, m_signature_lookups), &error)) {
         return std::nullopt;
     } else {
         auto debug_str = strprintf("input %i of %s (wtxid %s), spending %s:%i", nIn, ptxTo->GetHash().ToString(), ptxTo->GetWitnessHash().ToString(), ptxTo->vin[nIn].prevout.hash.ToString(), ptxTo->vin[nIn].prevout.n);
@@ -2104,22 +2161,69 @@ std::optional<std::pair<ScriptError, std::string>> CScriptCheck::operator()() {
     }
 }
 
+ValidationCacheStats& ValidationCacheStats::operator+=(const ValidationCacheStats& other)
+{
+    script_execution_hits += other.script_execution_hits;
+    script_execution_misses += other.script_execution_misses;
+    signature_hits += other.signature_hits;
+    signature_misses += other.signature_misses;
+    return *this;
+}
+
+ValidationCacheStats ValidationCacheStats::operator-(const ValidationCacheStats& other) const
+{
+    return {
+        .script_execution_hits = script_execution_hits - other.script_execution_hits,
+        .script_execution_misses = script_execution_misses - other.script_execution_misses,
+        .signature_hits = signature_hits - other.signature_hits,
+        .signature_misses = signature_misses - other.signature_misses,
+    };
+}
+
 ValidationCache::ValidationCache(const size_t script_execution_cache_bytes, const size_t signature_cache_bytes)
     : m_signature_cache{signature_cache_bytes}
 {
     // Setup the salted hasher
-    uint256 nonce = GetRandHash();
-    // We want the nonce to be 64 bytes long to force the hasher to process
-    // this chunk, which makes later hash computations more efficient. We
-    // just write our 32-byte entropy twice to fill the 64 bytes.
-    m_script_execution_cache_hasher.Write(nonce.begin(), 32);
-    m_script_execution_cache_hasher.Write(nonce.begin(), 32);
+    SetScriptExecutionCacheSalt(GetRandHash());
 
     const auto [num_elems, approx_size_bytes] = m_script_execution_cache.setup_bytes(script_execution_cache_bytes);
     LogInfo("Using %zu MiB out of %zu MiB requested for script execution cache, able to store %zu elements",
               approx_size_bytes >> 20, script_execution_cache_bytes >> 20, num_elems);
 }
 
+void ValidationCache::SetScriptExecutionCacheSalt(const uint256& salt)
+{
+    m_script_execution_cache_salt = salt;
+    // We want the nonce to be 64 bytes long to force the hasher to process
+    // this chunk, which makes later hash computations more efficient. We
+    // just write our 32-byte entropy twice to fill the 64 bytes.
+    m_script_execution_cache_hasher.Reset();
+    m_script_execution_cache_hasher.Write(salt.begin(), 32);
+    m_script_execution_cache_hasher.Write(salt.begin(), 32);
+}
+
+void ValidationCache::AddSignatureLookups(std::span<const SignatureCacheLookups> lookups)
+{
+    AssertLockHeld(::cs_main);
+    for (const SignatureCacheLookups& check_lookups : lookups) {
+        m_lookups.signature_hits += check_lookups.hits;
+        m_lookups.signature_misses += check_lookups.misses;
+    }
+}
+
+void ValidationCache::RecordBlockStats(int height, const ValidationCacheStats& stats, bool initial_block_download)
+{
+    AssertLockHeld(::cs_main);
+    m_last_block_stats = stats;
+    m_last_block_height = height;
+    // Blocks downloaded during initial block download were never in our
+    // mempool, so they would only dilute the hit rates.
+    if (!initial_block_download) {
+        m_synced_blocks_stats += stats;
+        ++m_synced_blocks;
+    }
+}
+
 /**
  * Check whether all of this transaction's input scripts succeed.
  *
@@ -2161,8 +2265,10 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
     hasher.Write(UCharCast(tx.GetWitnessHash().begin()), 32).Write((unsigned char*)&flags, sizeof(flags)).Finalize(hashCacheEntry.begin());
     AssertLockHeld(cs_main); //TODO: Remove this requirement by making CuckooCache not require external locks
     if (validation_cache.m_script_execution_cache.contains(hashCacheEntry, !cacheFullScriptStore)) {
+        ++validation_cache.m_lookups.script_execution_hits;
         return true;
     }
+    ++validation_cache.m_lookups.script_execution_misses;
 
     if (!txdata.m_spent_outputs_ready) {
         std::vector<CTxOut> spent_outputs;
@@ -2178,6 +2284,9 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
     }
     assert(txdata.m_spent_outputs.size() == tx.vin.size());
 
+    // Checks run here count their signature lookups together, those pushed
+    // onto pvChecks are counted by the caller.
+    SignatureCacheLookups signature_lookups;
     for (unsigned int i = 0; i < tx.vin.size(); i++) {
 
         // We very carefully only pass in things to CScriptCheck which
@@ -2190,7 +2299,11 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
         CScriptCheck check(txdata.m_spent_outputs[i], tx, validation_cache.m_signature_cache, i, flags, cacheSigStore, &txdata);
         if (pvChecks) {
             pvChecks->emplace_back(std::move(check));
-        } else if (auto result = check(); result.has_value()) {
+            continue;
+        }
+        check.CountSignatureLookups(&signature_lookups);
+        if (auto result = check(); result.has_value()) {
+            validation_cache.AddSignatureLookups({&signature_lookups, 1});
             // Tx failures never trigger disconnections/bans.
             // This is so that network splits aren't triggered
             // either due to non-consensus relay policies (such as
@@ -2205,6 +2318,8 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
         }
     }
 
+    validation_cache.AddSignatureLookups({&signature_lookups, 1});
+
     if (cacheFullScriptStore && !pvChecks) {
         // We executed all of the provided scripts, and were told to
         // cache the result. Do so now.
@@ -2256,17 +2371,19 @@ int ApplyTxInUndo(Coin&& undo, CCoinsViewCache& view, const COutPoint& out)
 }
 
 /** Undo the effects of this block (with given index) on the UTXO set represented by coins.
+ *  If prefetched_undo is not nullptr, it is used (and consumed) instead of reading the undo data from disk.
  *  When FAILED is returned, view is left in an indeterminate state. */
-DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view)
+DisconnectResult Chainstate::DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view, CBlockUndo* prefetched_undo)
 {
     AssertLockHeld(::cs_main);
     bool fClean = true;
 
-    CBlockUndo blockUndo;
-    if (!m_blockman.ReadBlockUndo(blockUndo, *pindex)) {
+    CBlockUndo read_undo;
+    if (!prefetched_undo && !m_blockman.ReadBlockUndo(read_undo, *pindex)) {
         LogError("DisconnectBlock(): failure reading undo data\n");
         return DISCONNECT_FAILED;
     }
+    CBlockUndo& blockUndo{prefetched_undo ? *prefetched_undo : read_undo};
 
     if (blockUndo.vtxundo.size() + 1 != block.vtx.size()) {
         LogError("DisconnectBlock(): block and undo data inconsistent\n");
@@ -2383,6 +2500,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     assert(*pindex->phashBlock == block_hash);
 
     const auto time_start{SteadyClock::now()};
+    const ValidationCacheStats cache_stats_start{m_chainman.m_validation_cache.m_lookups};
     const CChainParams& params{m_chainman.GetParams()};
 
     // Check it again in case a previous version let a bad block in
@@ -2574,12 +2692,38 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     // until after `control` has run the script checks (potentially
     // in multiple threads). Preallocate the vector size so a new allocation
     // doesn't invalidate pointers into the vector, and keep txsdata in scope
-    // for as long as `control`.
+    // for as long as `control`. The same holds for the signature cache
+    // lookup counters, one per queued check so that no two threads share one.
+    std::vector<SignatureCacheLookups> signature_lookups;
     std::optional<CCheckQueueControl<CScriptCheck>> control;
-    if (auto& queue = m_chainman.GetCheckQueue(); queue.HasThreads() && fScriptChecks) control.emplace(queue);
+    if (auto& queue = m_chainman.GetCheckQueue(); queue.HasThreads() && fScriptChecks) {
+        size_t num_inputs{0};
+        for (const auto& tx : block.vtx | std::views::drop(1)) num_inputs += tx->vin.size();
+        signature_lookups.resize(num_inputs);
+        control.emplace(queue);
+    }
+    size_t num_queued_checks{0};
 
     std::vector<PrecomputedTransactionData> txsdata(block.vtx.size());
 
+    {
+        // Fetch the coins spent by the block that are not in the cache with
+        // one batched lookup, instead of one database read per input as the
+        // loop below reaches them. Outputs created in the block itself are
+        // not in the view yet and are skipped.
+        std::vector<Txid> block_txids;
+        block_txids.reserve(block.vtx.size());
+        for (const auto& tx : block.vtx) block_txids.push_back(tx->GetHash());
+        std::sort(block_txids.begin(), block_txids.end());
+        std::vector<COutPoint> prevouts;
+        for (const auto& tx : block.vtx | std::views::drop(1)) {
+            for (const CTxIn& txin : tx->vin) {
+                if (!std::binary_search(block_txids.begin(), block_txids.end(), txin.prevout.hash)) prevouts.push_back(txin.prevout);
+            }
+        }
+        view.PrefetchCoins(prevouts);
+    }
+
     std::vector<int> prevheights;
     CAmount nFees = 0;
     int nInputs = 0;
@@ -2645,6 +2789,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
             if (control) {
                 std::vector<CScriptCheck> vChecks;
                 tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache, &vChecks);
+                for (CScriptCheck& check : vChecks) check.CountSignatureLookups(&signature_lookups[num_queued_checks++]);
                 if (tx_ok) control->Add(std::move(vChecks));
             } else {
                 tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache);
@@ -2678,6 +2823,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     }
     if (control) {
         auto parallel_result = control->Complete();
+        m_chainman.m_validation_cache.AddSignatureLookups(std::span{signature_lookups}.first(num_queued_checks));
         if (parallel_result.has_value() && state.IsValid()) {
             state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, strprintf("block-script-verify-flag-failed (%s)", ScriptErrorString(parallel_result->first)), parallel_result->second);
         }
@@ -2733,6 +2879,19 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
         Ticks<std::chrono::nanoseconds>(time_5 - time_start)
     );
 
+    // Lookups are only added under cs_main, so all lookups since the start of
+    // this function were made for this block.
+    const ValidationCacheStats cache_stats{m_chainman.m_validation_cache.m_lookups - cache_stats_start};
+    m_chainman.m_validation_cache.RecordBlockStats(pindex->nHeight, cache_stats, m_chainman.IsInitialBlockDownload());
+    TRACEPOINT(validation, block_cache_stats,
+        block_hash.data(),
+        pindex->nHeight,
+        cache_stats.script_execution_hits,
+        cache_stats.script_execution_misses,
+        cache_stats.signature_hits,
+        cache_stats.signature_misses
+    );
+
     return true;
 }
 
@@ -2862,9 +3021,16 @@ bool Chainstate::FlushStateToDisk(
             }
             // Finally remove any pruned files
             if (fFlushForPrune) {
-                LOG_TIME_MILLIS_WITH_CATEGORY("unlink pruned files", BCLog::BENCH);
+                if (nManualPruneHeight > 0) {
+                    LOG_TIME_MILLIS_WITH_CATEGORY("unlink pruned files", BCLog::BENCH);
 
-                m_blockman.UnlinkPrunedFiles(setFilesToPrune);
+                    // Callers of pruneblockchain expect the files to be gone on return.
+                    m_blockman.UnlinkPrunedFiles(setFilesToPrune);
+                } else {
+                    // The block index no longer references these files, so
+                    // they can be deleted without holding up validation.
+                    m_blockman.ScheduleUnlinkPrunedFiles(setFilesToPrune);
+                }
             }
 
             if (!CoinsTip().GetBestBlock().IsNull()) {
@@ -2996,8 +3162,11 @@ void Chainstate::UpdateTip(const CBlockIndex* pindexNew)
   * If disconnectpool is nullptr, then no disconnected transactions are added to
   * disconnectpool (note that the caller is responsible for mempool consistency
   * in any case).
+  *
+  * If prefetcher is not nullptr and covers the current tip, the block and its
+  * undo data are taken from it instead of being read from disk here.
   */
-bool Chainstate::DisconnectTip(BlockValidationState& state, DisconnectedBlockTransactions* disconnectpool)
+bool Chainstate::DisconnectTip(BlockValidationState& state, DisconnectedBlockTransactions* disconnectpool, node::ReorgPrefetcher* prefetcher)
 {
     AssertLockHeld(cs_main);
     if (m_mempool) AssertLockHeld(m_mempool->cs);
@@ -3005,10 +3174,12 @@ bool Chainstate::DisconnectTip(BlockValidationState& state, DisconnectedBlockTra
     CBlockIndex *pindexDelete = m_chain.Tip();
     assert(pindexDelete);
     assert(pindexDelete->pprev);
-    // Read block from disk.
-    std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+    std::optional<node::ReorgPrefetcher::Entry> prefetched;
+    if (prefetcher) prefetched = prefetcher->Take(*pindexDelete);
+    // Read block from disk, unless it has been prefetched.
+    std::shared_ptr<CBlock> pblock = prefetched ? prefetched->block : std::make_shared<CBlock>();
     CBlock& block = *pblock;
-    if (!m_blockman.ReadBlock(block, *pindexDelete)) {
+    if (!prefetched && !m_blockman.ReadBlock(block, *pindexDelete)) {
         LogError("DisconnectTip(): Failed to read block\n");
         return false;
     }
@@ -3017,7 +3188,7 @@ bool Chainstate::DisconnectTip(BlockValidationState& state, DisconnectedBlockTra
     {
         CCoinsViewCache view(&CoinsTip());
         assert(view.GetBestBlock() == pindexDelete->GetBlockHash());
-        if (DisconnectBlock(block, pindexDelete, view) != DISCONNECT_OK) {
+        if (DisconnectBlock(block, pindexDelete, view, prefetched ? &prefetched->undo : nullptr) != DISCONNECT_OK) {
             LogError("DisconnectTip(): DisconnectBlock %s failed\n", pindexDelete->GetBlockHash().ToString());
             return false;
         }
@@ -3300,8 +3471,17 @@ bool Chainstate::ActivateBestChainStep(BlockValidationState& state, CBlockIndex*
     // Disconnect active blocks which are no longer in the best chain.
     bool fBlocksDisconnected = false;
     DisconnectedBlockTransactions disconnectpool{MAX_DISCONNECTED_TX_POOL_BYTES};
+    // The whole disconnect path is known up front, so read it ahead in parallel.
+    std::optional<node::ReorgPrefetcher> prefetcher;
+    if (m_chain.Tip() && m_chain.Tip()->pprev && m_chain.Tip()->pprev != pindexFork) {
+        std::vector<const CBlockIndex*> path;
+        for (const CBlockIndex* walk{m_chain.Tip()}; walk && walk != pindexFork; walk = walk->pprev) {
+            path.push_back(walk);
+        }
+        prefetcher.emplace(m_blockman, path);
+    }
     while (m_chain.Tip() && m_chain.Tip() != pindexFork) {
-        if (!DisconnectTip(state, &disconnectpool)) {
+        if (!DisconnectTip(state, &disconnectpool, prefetcher ? &*prefetcher : nullptr)) {
             // This is likely a fatal error, but keep the mempool consistent,
             // just in case. Only remove from the mempool in this case.
             MaybeUpdateMempoolForReorg(disconnectpool, false);
@@ -3314,6 +3494,7 @@ bool Chainstate::ActivateBestChainStep(BlockValidationState& state, CBlockIndex*
         }
         fBlocksDisconnected = true;
     }
+    prefetcher.reset();
 
     // Build list of new blocks to connect (in descending height order).
     std::vector<CBlockIndex*> vpindexToConnect;
@@ -3655,6 +3836,20 @@ bool Chainstate::InvalidateBlock(BlockValidationState& state, CBlockIndex* pinde
         }
     }
 
+    // The chain cannot change underneath us while m_chainstate_mutex is held,
+    // so the blocks from the tip down to pindex can be read ahead.
+    std::optional<node::ReorgPrefetcher> prefetcher;
+    {
+        LOCK(cs_main);
+        if (m_chain.Contains(pindex) && m_chain.Tip() != pindex) {
+            std::vector<const CBlockIndex*> path;
+            for (const CBlockIndex* walk{m_chain.Tip()}; walk != pindex->pprev; walk = walk->pprev) {
+                path.push_back(walk);
+            }
+            prefetcher.emplace(m_blockman, path);
+        }
+    }
+
     // Disconnect (descendants of) pindex, and mark them invalid.
     while (true) {
         if (m_chainman.m_interrupt) break;
@@ -3673,7 +3868,7 @@ bool Chainstate::InvalidateBlock(BlockValidationState& state, CBlockIndex* pinde
         // ActivateBestChain considers blocks already in m_chain
         // unconditionally valid already, so force disconnect away from it.
         DisconnectedBlockTransactions disconnectpool{MAX_DISCONNECTED_TX_POOL_BYTES};
-        bool ret = DisconnectTip(state, &disconnectpool);
+        bool ret = DisconnectTip(state, &disconnectpool, prefetcher ? &*prefetcher : nullptr);
         // DisconnectTip will add transactions to disconnectpool.
         // Adjust the mempool to be consistent with the new tip, adding
         // transactions back to the mempool if disconnecting was successful,
@@ -5823,12 +6018,10 @@ util::Result<CBlockIndex*> ChainstateManager::ActivateSnapshot(
     return snapshot_start_block;
 }
 
-static void FlushSnapshotToDisk(CCoinsViewCache& coins_cache, bool snapshot_loaded)
+static void FlushSnapshotToDisk(CCoinsViewCache& coins_cache)
 {
     LOG_TIME_MILLIS_WITH_CATEGORY_MSG_ONCE(
-        strprintf("%s (%.2f MB)",
-                  snapshot_loaded ? "saving snapshot chainstate" : "flushing coins cache",
-                  coins_cache.DynamicMemoryUsage() / (1000 * 1000)),
+        strprintf("saving snapshot chainstate (%.2f MB)", coins_cache.DynamicMemoryUsage() / (1000 * 1000)),
         BCLog::LogFlags::ALL);
 
     coins_cache.Flush();
@@ -5885,120 +6078,76 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
     }
 
     const uint64_t coins_count = metadata.m_coins_count;
-    uint64_t coins_left = metadata.m_coins_count;
-
-    LogInfo("[snapshot] loading %d coins from snapshot %s", coins_left, base_blockhash.ToString());
-    int64_t coins_processed{0};
 
-    while (coins_left > 0) {
-        try {
-            Txid txid;
-            coins_file >> txid;
-            size_t coins_per_txid{0};
-            coins_per_txid = ReadCompactSize(coins_file);
-
-            if (coins_per_txid > coins_left) {
-                return util::Error{Untranslated("Mismatch in coins count in snapshot metadata and actual snapshot data")};
-            }
-
-            for (size_t i = 0; i < coins_per_txid; i++) {
-                COutPoint outpoint;
-                Coin coin;
-                outpoint.n = static_cast<uint32_t>(ReadCompactSize(coins_file));
-                outpoint.hash = txid;
-                coins_file >> coin;
-                if (coin.nHeight > base_height ||
-                    outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
-                ) {
-                    return util::Error{Untranslated(strprintf("Bad snapshot data after deserializing %d coins",
-                              coins_count - coins_left))};
-                }
-                if (!MoneyRange(coin.out.nValue)) {
-                    return util::Error{Untranslated(strprintf("Bad snapshot data after deserializing %d coins - bad tx out value",
-                              coins_count - coins_left))};
-                }
-                coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint), std::move(coin));
+    LogInfo("[snapshot] loading %d coins from snapshot %s", coins_count, base_blockhash.ToString());
 
-                --coins_left;
-                ++coins_processed;
-
-                if (coins_processed % 1000000 == 0) {
-                    LogInfo("[snapshot] %d coins loaded (%.2f%%, %.2f MB)",
-                        coins_processed,
-                        static_cast<float>(coins_processed) * 100 / static_cast<float>(coins_count),
-                        coins_cache.DynamicMemoryUsage() / (1000 * 1000));
-                }
-
-                // Batch write and flush (if we need to) every so often.
-                //
-                // If our average Coin size is roughly 41 bytes, checking every 120,000 coins
-                // means <5MB of memory imprecision.
-                if (coins_processed % 120000 == 0) {
-                    if (m_interrupt) {
-                        return util::Error{Untranslated("Aborting after an interrupt was requested")};
-                    }
-
-                    const auto snapshot_cache_state = WITH_LOCK(::cs_main,
-                        return snapshot_chainstate.GetCoinsCacheSizeState());
+    // As below, okay to immediately release cs_main here since no other context knows
+    // about the snapshot_chainstate.
+    CCoinsViewDB* snapshot_coinsdb = WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB());
 
-                    if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
-                        // This is a hack - we don't know what the actual best block is, but that
-                        // doesn't matter for the purposes of flushing the cache here. We'll set this
-                        // to its correct value (`base_blockhash`) below after the coins are loaded.
-                        coins_cache.SetBestBlock(GetRandHash());
+    // The coins are written straight to the (empty) coins database by the
+    // loader threads, the coins cache is bypassed.
+    node::SnapshotLoadOptions load_options;
+    load_options.base_height = base_height;
+    load_options.coins_count = coins_count;
+    load_options.num_threads = m_options.worker_threads_num + 1;
+    load_options.interrupted = [&interrupt = m_interrupt] { return bool{interrupt}; };
+    uint64_t last_logged{0};
+    int last_percent{-1};
+    load_options.progress = [&](uint64_t coins_loaded) {
+        m_snapshot_load_coins = coins_loaded;
+        const int percent{coins_count ? static_cast<int>(coins_loaded * 100 / coins_count) : 100};
+        if (percent != last_percent) {
+            GetNotifications().progress(_("Loading UTXO snapshot…"), percent, false);
+            last_percent = percent;
+        }
+        if (coins_loaded / 1000000 > last_logged / 1000000) {
+            LogInfo("[snapshot] %d coins loaded (%.2f%%)",
+                coins_loaded,
+                static_cast<float>(coins_loaded) * 100 / static_cast<float>(coins_count));
+        }
+        last_logged = coins_loaded;
+    };
 
-                        // No need to acquire cs_main since this chainstate isn't being used yet.
-                        FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/false);
-                    }
-                }
-            }
-        } catch (const std::ios_base::failure&) {
-            return util::Error{Untranslated(strprintf("Bad snapshot format or truncated snapshot after deserializing %d coins",
-                      coins_processed))};
-        }
+    m_snapshot_load_coins = 0;
+    m_snapshot_load_total = coins_count;
+    const auto load_result{node::LoadSnapshotCoins(coins_file, *snapshot_coinsdb, load_options)};
+    m_snapshot_load_total = 0;
+    GetNotifications().progress(bilingual_str{}, 100, false);
+    if (!load_result) {
+        return util::Error{util::ErrorString(load_result)};
     }
 
-    // Important that we set this. This and the coins_cache accesses above are
+    // Important that we set this. This and the coins database writes above are
     // sort of a layer violation, but either we reach into the innards of
-    // CCoinsViewCache here or we have to invert some of the Chainstate to
-    // embed them in a snapshot-activation-specific CCoinsViewCache bulk load
-    // method.
+    // CCoinsViewDB here or we have to invert some of the Chainstate to
+    // embed them in a snapshot-activation-specific bulk load method.
     coins_cache.SetBestBlock(base_blockhash);
 
-    bool out_of_coins{false};
-    try {
-        std::byte left_over_byte;
-        coins_file >> left_over_byte;
-    } catch (const std::ios_base::failure&) {
-        // We expect an exception since we should be out of coins.
-        out_of_coins = true;
-    }
-    if (!out_of_coins) {
-        return util::Error{Untranslated(strprintf("Bad snapshot - coins left over after deserializing %d coins",
-            coins_count))};
-    }
-
-    LogInfo("[snapshot] loaded %d (%.2f MB) coins from snapshot %s",
+    LogInfo("[snapshot] loaded %d coins from snapshot %s",
         coins_count,
-        coins_cache.DynamicMemoryUsage() / (1000 * 1000),
         base_blockhash.ToString());
 
     // No need to acquire cs_main since this chainstate isn't being used yet.
-    FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/true);
+    FlushSnapshotToDisk(coins_cache);
 
     assert(coins_cache.GetBestBlock() == base_blockhash);
 
-    // As above, okay to immediately release cs_main here since no other context knows
-    // about the snapshot_chainstate.
-    CCoinsViewDB* snapshot_coinsdb = WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB());
-
     std::optional<CCoinsStats> maybe_stats;
 
-    try {
-        maybe_stats = ComputeUTXOStats(
-            CoinStatsHashType::HASH_SERIALIZED, snapshot_coinsdb, m_blockman, [&interrupt = m_interrupt] { SnapshotUTXOHashBreakpoint(interrupt); });
-    } catch (StopHashingException const&) {
-        return util::Error{Untranslated("Aborting after an interrupt was requested")};
+    if (load_result->hash_serialized) {
+        // The coins were hashed in database order while they were loaded.
+        maybe_stats.emplace(base_height, base_blockhash);
+        maybe_stats->hashSerialized = *load_result->hash_serialized;
+    } else {
+        LogInfo("[snapshot] coins are not in database order, hashing the loaded chainstate");
+        try {
+            maybe_stats = ComputeUTXOStats(
+                CoinStatsHashType::HASH_SERIALIZED, snapshot_coinsdb, m_blockman, [&interrupt = m_interrupt] { SnapshotUTXOHashBreakpoint(interrupt); },
+                std::clamp(m_options.worker_threads_num + 1, 1, kernel::MAX_UTXO_HASH_THREADS));
+        } catch (StopHashingException const&) {
+            return util::Error{Untranslated("Aborting after an interrupt was requested")};
+        }
     }
     if (!maybe_stats.has_value()) {
         return util::Error{Untranslated("Failed to generate coins stats")};
@@ -6156,7 +6305,8 @@ SnapshotCompletionResult ChainstateManager::MaybeCompleteSnapshotValidation()
             CoinStatsHashType::HASH_SERIALIZED,
             &ibd_coins_db,
             m_blockman,
-            [&interrupt = m_interrupt] { SnapshotUTXOHashBreakpoint(interrupt); });
+            [&interrupt = m_interrupt] { SnapshotUTXOHashBreakpoint(interrupt); },
+            std::clamp(m_options.worker_threads_num + 1, 1, kernel::MAX_UTXO_HASH_THREADS));
     } catch (StopHashingException const&) {
         return SnapshotCompletionResult::STATS_FAILED;
     }
@@ -6266,6 +6416,8 @@ static ChainstateManager::Options&& Flatten(ChainstateManager::Options&& opts)
 
 ChainstateManager::ChainstateManager(const util::SignalInterrupt& interrupt, Options options, node::BlockManager::Options blockman_options)
     : m_script_check_queue{/*batch_size=*/128, std::clamp(options.worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS)},
+      m_mempool_script_check_queue{/*batch_size=*/128, std::clamp(options.worker_threads_num, 0, MAX_SCRIPTCHECK_THREADS),
+                                   /*thread_name=*/"mempoolch", /*purpose=*/"Mempool script verification"},
       m_interrupt{interrupt},
       m_options{Flatten(std::move(options))},
       m_blockman{interrupt, std::move(blockman_options)},
@@ -49,6 +49,7 @@
 #include <utility>
 #include <vector>
 
+class CBlockUndo;
 class Chainstate;
 class CTxMemPool;
 class ChainstateManager;
@@ -58,6 +59,7 @@ struct PrecomputedTransactionData;
 struct LockPoints;
 struct AssumeutxoData;
 namespace node {
+class ReorgPrefetcher;
 class SnapshotMetadata;
 } // namespace node
 namespace Consensus {
@@ -340,6 +342,7 @@ private:
     bool cacheStore;
     PrecomputedTransactionData *txdata;
     SignatureCache* m_signature_cache;
+    SignatureCacheLookups* m_signature_lookups{nullptr};
 
 public:
     CScriptCheck(const CTxOut& outIn, const CTransaction& txToIn, SignatureCache& signature_cache, unsigned int nInIn, unsigned int nFlagsIn, bool cacheIn, PrecomputedTransactionData* txdataIn) :
@@ -350,6 +353,13 @@ public:
     CScriptCheck(CScriptCheck&&) = default;
     CScriptCheck& operator=(CScriptCheck&&) = default;
 
+    /**
+     * Count the signature cache lookups of this check in lookups, which must
+     * outlive the check. Checks which may run on different threads must not
+     * share one.
+     */
+    void CountSignatureLookups(SignatureCacheLookups* lookups) { m_signature_lookups = lookups; }
+
     std::optional<std::pair<ScriptError, std::string>> operator()();
 };
 
@@ -358,6 +368,17 @@ static_assert(std::is_nothrow_move_assignable_v<CScriptCheck>);
 static_assert(std::is_nothrow_move_constructible_v<CScriptCheck>);
 static_assert(std::is_nothrow_destructible_v<CScriptCheck>);
 
+/** Lookups in the script execution cache and the signature cache which hit or missed. */
+struct ValidationCacheStats {
+    uint64_t script_execution_hits{0};
+    uint64_t script_execution_misses{0};
+    uint64_t signature_hits{0};
+    uint64_t signature_misses{0};
+
+    ValidationCacheStats& operator+=(const ValidationCacheStats& other);
+    ValidationCacheStats operator-(const ValidationCacheStats& other) const;
+};
+
 /**
  * Convenience class for initializing and passing the script execution cache
  * and signature cache.
@@ -367,11 +388,27 @@ class ValidationCache
 private:
     //! Pre-initialized hasher to avoid having to recreate it for every hash calculation.
     CSHA256 m_script_execution_cache_hasher;
+    //! The salt the hasher was initialized with, needed to persist the cache entries.
+    uint256 m_script_execution_cache_salt;
 
 public:
     CuckooCache::cache<uint256, SignatureCacheHasher> m_script_execution_cache;
     SignatureCache m_signature_cache;
 
+    /**
+     * Lookups in both caches since startup. Script checks run on the check
+     * queue count their signature lookups separately, which the caller adds
+     * once they are complete.
+     */
+    ValidationCacheStats m_lookups GUARDED_BY(::cs_main);
+
+    //! Cache lookups while connecting the most recent block, and its height (-1 if none).
+    ValidationCacheStats m_last_block_stats GUARDED_BY(::cs_main);
+    int m_last_block_height GUARDED_BY(::cs_main){-1};
+    //! Cache lookups summed over the blocks connected after initial block download.
+    ValidationCacheStats m_synced_blocks_stats GUARDED_BY(::cs_main);
+    uint64_t m_synced_blocks GUARDED_BY(::cs_main){0};
+
     ValidationCache(size_t script_execution_cache_bytes, size_t signature_cache_bytes);
 
     ValidationCache(const ValidationCache&) = delete;
@@ -379,6 +416,21 @@ public:
 
     //! Return a copy of the pre-initialized hasher.
     CSHA256 ScriptExecutionCacheHasher() const { return m_script_execution_cache_hasher; }
+
+    const uint256& ScriptExecutionCacheSalt() const { return m_script_execution_cache_salt; }
+
+    /**
+     * Salt the script execution cache entries with the given value, e.g. the
+     * one persisted along with the entries. Entries stored with the previous
+     * salt are no longer found.
+     */
+    void SetScriptExecutionCacheSalt(const uint256& salt);
+
+    //! Add the signature lookups counted by script checks run on the check queue.
+    void AddSignatureLookups(std::span<const SignatureCacheLookups> lookups) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+
+    //! Record the lookups made while connecting a block.
+    void RecordBlockStats(int height, const ValidationCacheStats& stats, bool initial_block_download) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 };
 
 /** Functions for validating blocks and updating the block tree */
@@ -732,13 +784,13 @@ public:
         LOCKS_EXCLUDED(::cs_main);
 
     // Block (dis)connection on a given view:
-    DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view)
+    DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view, CBlockUndo* prefetched_undo = nullptr)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
     bool ConnectBlock(const CBlock& block, BlockValidationState& state, CBlockIndex* pindex,
                       CCoinsViewCache& view, bool fJustCheck = false) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     // Apply the effects of a block disconnection on the UTXO set.
-    bool DisconnectTip(BlockValidationState& state, DisconnectedBlockTransactions* disconnectpool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs);
+    bool DisconnectTip(BlockValidationState& state, DisconnectedBlockTransactions* disconnectpool, node::ReorgPrefetcher* prefetcher = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs);
 
     // Manual block validity manipulation:
     /** Mark a block as precious and reorganize.
@@ -979,6 +1031,10 @@ private:
     //! A queue for script verifications that have to be performed by worker threads.
     CCheckQueue<CScriptCheck> m_script_check_queue;
 
+    //! A separate queue for the script verifications of mempool acceptance and
+    //! mempool loading, so that these never wait for, or hold up, ConnectBlock().
+    CCheckQueue<CScriptCheck> m_mempool_script_check_queue;
+
     //! Timers and counters used for benchmarking validation in both background
     //! and active chainstates.
     SteadyClock::duration GUARDED_BY(::cs_main) time_check{};
@@ -1047,6 +1103,10 @@ public:
      */
     mutable std::atomic<bool> m_cached_finished_ibd{false};
 
+    //! Coins written and announced by the snapshot being loaded, see GetSnapshotLoadProgress().
+    std::atomic<uint64_t> m_snapshot_load_coins{0};
+    std::atomic<uint64_t> m_snapshot_load_total{0};
+
     /**
      * Every received block is assigned a unique and increasing identifier, so we
      * know which one to give priority in case of a fork.
@@ -1106,6 +1166,21 @@ public:
     [[nodiscard]] util::Result<CBlockIndex*> ActivateSnapshot(
         AutoFile& coins_file, const node::SnapshotMetadata& metadata, bool in_memory);
 
+    struct SnapshotLoadProgress {
+        uint64_t coins_loaded;
+        uint64_t coins_total;
+    };
+
+    //! Progress of the coins being loaded by ActivateSnapshot(), if a snapshot
+    //! is being loaded. Does not require cs_main, which is not held while the
+    //! coins are loaded.
+    std::optional<SnapshotLoadProgress> GetSnapshotLoadProgress() const
+    {
+        const uint64_t total{m_snapshot_load_total};
+        if (total == 0) return std::nullopt;
+        return SnapshotLoadProgress{m_snapshot_load_coins, total};
+    }
+
     //! Once the background validation chainstate has reached the height which
     //! is the base of the UTXO snapshot in use, compare its coins to ensure
     //! they match those expected by the snapshot.
@@ -1336,6 +1411,7 @@ public:
     void RecalculateBestHeader() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
     CCheckQueue<CScriptCheck>& GetCheckQueue() { return m_script_check_queue; }
+    CCheckQueue<CScriptCheck>& GetMempoolCheckQueue() { return m_mempool_script_check_queue; }
 
     ~ChainstateManager();
 };
@@ -74,7 +74,9 @@
 #include <algorithm>
 #include <cassert>
 #include <condition_variable>
+#include <deque>
 #include <exception>
+#include <limits>
 #include <optional>
 #include <stdexcept>
 #include <thread>
@@ -331,13 +333,30 @@ public:
             if (current_range_end > last_range_end) {
                 AddScriptPubKeys(desc_spkm, last_range_end);
                 m_last_range_ends.at(desc_spkm->GetID()) = current_range_end;
+                // results matched against the old filter set are stale
+                m_pending_matches.clear();
             }
         }
     }
 
-    std::optional<bool> MatchesBlock(const uint256& block_hash) const
+    /**
+     * Return whether the block matches the filter set. The filters of the
+     * next max_blocks blocks are matched in one go, in parallel, and the
+     * results are kept for the following calls.
+     */
+    std::optional<bool> MatchesBlock(const uint256& block_hash, int max_blocks)
     {
-        return m_wallet.chain().blockFilterMatchesAny(BlockFilterType::BASIC, block_hash, m_filter_set);
+        if (m_pending_matches.empty() || m_pending_matches.front().first != block_hash) {
+            auto matches{m_wallet.chain().blockFiltersMatchAny(BlockFilterType::BASIC, block_hash, std::min(max_blocks, FILTER_MATCH_BATCH_SIZE), m_filter_set)};
+            m_pending_matches.assign(matches.begin(), matches.end());
+            if (m_pending_matches.empty() || m_pending_matches.front().first != block_hash) {
+                m_pending_matches.clear();
+                return m_wallet.chain().blockFilterMatchesAny(BlockFilterType::BASIC, block_hash, m_filter_set);
+            }
+        }
+        const std::optional<bool> matches{m_pending_matches.front().second};
+        m_pending_matches.pop_front();
+        return matches;
     }
 
 private:
@@ -350,6 +369,10 @@ private:
       */
     std::map<uint256, int32_t> m_last_range_ends;
     GCSFilter::ElementSet m_filter_set;
+    /** Number of blocks whose filters are matched at once. */
+    static constexpr int FILTER_MATCH_BATCH_SIZE{1000};
+    /** Hashes and match results of the next blocks to scan. */
+    std::deque<std::pair<uint256, std::optional<bool>>> m_pending_matches;
 
     void AddScriptPubKeys(const DescriptorScriptPubKeyMan* desc_spkm, int32_t last_range_end = 0)
     {
@@ -1849,7 +1872,8 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
         bool fetch_block{true};
         if (fast_rescan_filter) {
             fast_rescan_filter->UpdateIfNeeded();
-            auto matches_block{fast_rescan_filter->MatchesBlock(block_hash)};
+            const int max_blocks{max_height ? std::max(*max_height - block_height + 1, 1) : std::numeric_limits<int>::max()};
+            auto matches_block{fast_rescan_filter->MatchesBlock(block_hash, max_blocks)};
             if (matches_block.has_value()) {
                 if (*matches_block) {
                     LogDebug(BCLog::SCAN, "Fast rescan: inspect block %d [%s] (filter matched)\n", block_height, block_hash.ToString());
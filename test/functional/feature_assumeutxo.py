@@ -22,9 +22,12 @@ from test_framework.compressor import (
 )
 from test_framework.messages import (
     CBlockHeader,
+    CInv,
     from_hex,
     MAGIC_BYTES,
     MAX_MONEY,
+    MSG_BLOCK,
+    msg_getdata,
     msg_headers,
     ser_varint,
     tx_from_hex,
@@ -323,6 +326,16 @@ class AssumeutxoTest(BitquantumTestFramework):
         # Load snapshot
         snapshot_node.loadtxoutset(snapshot['path'])
 
+        # Blocks below the snapshot base have not been downloaded yet, which is not the same as pruned
+        requests_before = snapshot_node.getnetworkinfo()['blockrequests']
+        block_request_conn = snapshot_node.add_p2p_connection(P2PInterface())
+        block_request_conn.send_and_ping(msg_getdata([CInv(MSG_BLOCK, int(snapshot_node.getblockhash(SNAPSHOT_BASE_HEIGHT - 1), 16))]))
+        requests = snapshot_node.getnetworkinfo()['blockrequests']
+        assert_equal(requests['missing'], requests_before['missing'] + 1)
+        assert_equal(requests['pruned'], requests_before['pruned'])
+        assert_equal(requests['served'], requests_before['served'])
+        snapshot_node.disconnect_p2ps()
+
         # Connect nodes and verify the ibd_node can sync-up the headers-chain from the snapshot_node
         self.connect_nodes(ibd_node.index, snapshot_node.index)
         snapshot_block_hash = snapshot['base_hash']
@@ -15,6 +15,12 @@ from test_framework.blocktools import (
     create_block,
     create_coinbase,
 )
+from test_framework.messages import (
+    CInv,
+    MSG_BLOCK,
+    msg_getdata,
+)
+from test_framework.p2p import P2PInterface
 from test_framework.script import (
     CScript,
     OP_NOP,
@@ -483,6 +489,9 @@ class PruneTest(BitquantumTestFramework):
         self.log.info("Test pruneheight reflects the presence of block and undo data")
         self.test_pruneheight_undo_presence()
 
+        self.log.info("Test requests for pruned blocks are counted")
+        self.test_pruned_block_requests()
+
         self.log.info("Done")
 
     def test_scanblocks_pruned(self):
@@ -509,5 +518,21 @@ class PruneTest(BitquantumTestFramework):
         new_pruneheight = node.getblockchaininfo()["pruneheight"]
         assert_equal(pruneheight, new_pruneheight)
 
+    def test_pruned_block_requests(self):
+        # Peers without noban permission are disconnected before reaching the pruned data check
+        self.restart_node(5, extra_args=self.extra_args[5] + ["-whitelist=noban@127.0.0.1"])
+        node = self.nodes[5]
+        pruned_hash = node.getblockhash(1)
+        assert_raises_rpc_error(-1, "Block not available (pruned data)", node.getblock, pruned_hash)
+
+        requests_before = node.getnetworkinfo()['blockrequests']
+        peer = node.add_p2p_connection(P2PInterface())
+        peer.send_and_ping(msg_getdata([CInv(MSG_BLOCK, int(pruned_hash, 16))]))
+        requests = node.getnetworkinfo()['blockrequests']
+        assert_equal(requests['pruned'], requests_before['pruned'] + 1)
+        assert_equal(requests['missing'], requests_before['missing'])
+        assert_equal(requests['served'], requests_before['served'])
+        node.disconnect_p2ps()
+
 if __name__ == '__main__':
     PruneTest(__file__).main()
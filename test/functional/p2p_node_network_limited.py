@@ -7,7 +7,8 @@
 Tests that a node configured with -prune=550 signals NODE_NETWORK_LIMITED correctly
 and that it responds to getdata requests for blocks correctly:
     - send a block within 288 + 2 of the tip
-    - disconnect peers who request blocks older than that."""
+    - disconnect peers who request blocks older than that.
+It also checks that these requests are counted in getnetworkinfo's blockrequests."""
 from test_framework.messages import (
     CInv,
     MSG_BLOCK,
@@ -132,6 +133,8 @@ class NodeNetworkLimitedTest(BitquantumTestFramework):
         self.connect_nodes(0, 1)
         blocks = self.generate(self.nodes[1], 292, sync_fun=lambda: self.sync_blocks([self.nodes[0], self.nodes[1]]))
 
+        requests_before = self.nodes[0].getnetworkinfo()['blockrequests']
+
         self.log.info("Make sure we can max retrieve block at tip-288.")
         node.send_getdata_for_block(blocks[1])  # last block in valid range
         node.wait_for_block(int(blocks[1], 16), timeout=3)
@@ -141,6 +144,17 @@ class NodeNetworkLimitedTest(BitquantumTestFramework):
         node.wait_for_disconnect(timeout=5)
         self.nodes[0].disconnect_p2ps()
 
+        self.log.info("Check that both requests were counted, in the buckets of their depth.")
+        requests = self.nodes[0].getnetworkinfo()['blockrequests']
+        assert_equal(requests['served'], requests_before['served'] + 1)
+        assert_equal(requests['limited'], requests_before['limited'] + 1)
+        assert_equal(requests['pruned'], requests_before['pruned'])
+        assert_equal(requests['missing'], requests_before['missing'])
+        assert_equal([bucket.get('max_depth') for bucket in requests['depth_histogram']], [288, 1008, 4032, 52560, None])
+        # tip-288 falls into the first bucket, which is inclusive, tip-289 into the second one.
+        assert_equal(requests['depth_histogram'][0]['count'], requests_before['depth_histogram'][0]['count'] + 1)
+        assert_equal(requests['depth_histogram'][1]['count'], requests_before['depth_histogram'][1]['count'] + 1)
+
         # connect unsynced node 2 with pruned NODE_NETWORK_LIMITED peer
         # because node 2 is in IBD and node 0 is a NODE_NETWORK_LIMITED peer, sync must not be possible
         self.connect_nodes(0, 2)
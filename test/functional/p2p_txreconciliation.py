@@ -0,0 +1,349 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025-present The Bitquantum Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test transaction reconciliation rounds (BIP 330).
+
+Transactions for peers we reconcile with are added to their reconciliation
+sets instead of being announced, and only announced once a reconciliation
+round (reqrecon, sketch, reqsktchext, reconcildiff) finds the peer is missing
+them. The node initiates rounds with its outbound peers and responds to its
+inbound peers. Each transaction is still flooded to one outbound peer, and the
+node falls back to flooding to peers which do not take part in rounds.
+"""
+
+import random
+import time
+
+from test_framework.crypto.siphash import siphash256
+from test_framework.key import TaggedHash
+from test_framework.messages import (
+    CInv,
+    MSG_WTX,
+    msg_inv,
+    msg_reconcildiff,
+    msg_reqrecon,
+    msg_reqsktchext,
+    msg_sendtxrcncl,
+    msg_sketch,
+    msg_tx,
+)
+from test_framework.p2p import (
+    P2PInterface,
+    P2PTxInvStore,
+    p2p_lock,
+)
+from test_framework.test_framework import BitquantumTestFramework
+from test_framework.util import assert_equal
+from test_framework.wallet import MiniWallet
+
+# Reconciliation requests are sent every 8 seconds, trickled announcements every few seconds.
+MOCKTIME_STEP = 60
+RECON_ROUND_TIMEOUT = 30
+RECON_REQUEST_TIMEOUT = 120
+# Modulus of the field minisketch uses for 32-bit short IDs: x^32 + x^7 + x^3 + x^2 + 1.
+GF32_MODULUS = (1 << 32) | 0x8d
+
+
+def gf32_mul(a, b):
+    """Multiply two elements of GF(2^32)."""
+    r = 0
+    while b:
+        if b & 1:
+            r ^= a
+        b >>= 1
+        a <<= 1
+        if a >> 32:
+            a ^= GF32_MODULUS
+    return r
+
+
+def gf32_pow(a, n):
+    r = 1
+    while n:
+        if n & 1:
+            r = gf32_mul(r, a)
+        a = gf32_mul(a, a)
+        n >>= 1
+    return r
+
+
+def sketch_syndromes(elements, capacity):
+    """The odd syndromes (power sums) of a set of short IDs, which make up its sketch."""
+    syndromes = [0] * capacity
+    for element in elements:
+        square = gf32_mul(element, element)
+        power = element
+        for i in range(capacity):
+            syndromes[i] ^= power
+            power = gf32_mul(power, square)
+    return syndromes
+
+
+def serialize_sketch(syndromes):
+    return b"".join(s.to_bytes(4, "little") for s in syndromes)
+
+
+class ReconciliationPeer(P2PInterface):
+    """A peer offering to reconcile transactions during the version handshake."""
+    def __init__(self):
+        super().__init__(wtxidrelay=True)
+        self.salt = random.getrandbits(64)
+        self.k0 = self.k1 = None
+
+    def send_version(self):
+        if self.on_connection_send_msg:
+            super().send_version()
+            # Offer reconciliation right after the version, before the verack.
+            sendtxrcncl = msg_sendtxrcncl()
+            sendtxrcncl.version = 1
+            sendtxrcncl.salt = self.salt
+            self.send_without_ping(sendtxrcncl)
+
+    def on_sendtxrcncl(self, message):
+        salt = TaggedHash("Tx Relay Salting", min(self.salt, message.salt).to_bytes(8, "little") + max(self.salt, message.salt).to_bytes(8, "little"))
+        self.k0 = int.from_bytes(salt[:8], "little")
+        self.k1 = int.from_bytes(salt[8:16], "little")
+
+    def short_id(self, wtxid):
+        return 1 + siphash256(self.k0, self.k1, int(wtxid, 16)) % 0xffffffff
+
+    def pop_message(self, msgtype, *, timeout=60):
+        self.wait_until(lambda: msgtype in self.last_message, timeout=timeout)
+        with p2p_lock:
+            return self.last_message.pop(msgtype)
+
+    def wtx_invs(self):
+        with p2p_lock:
+            message = self.last_message.pop("inv", None)
+        return [] if message is None else [inv.hash for inv in message.inv if inv.type == MSG_WTX]
+
+
+class TxReconciliationTest(BitquantumTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.extra_args = [["-txreconciliation"]]
+
+    def bump_mocktime(self):
+        self.mocktime += MOCKTIME_STEP
+        self.nodes[0].setmocktime(self.mocktime)
+
+    def add_outbound_peer(self):
+        peer = self.nodes[0].add_outbound_p2p_connection(ReconciliationPeer(), p2p_idx=self.next_p2p_idx, connection_type="outbound-full-relay")
+        self.next_p2p_idx += 1
+        peer.wait_until(lambda: peer.k0 is not None)
+        return peer
+
+    def add_outbound_flooding_peer(self):
+        """An outbound peer we do not reconcile with, so that transactions are not also flooded to the reconciling ones."""
+        peer = self.nodes[0].add_outbound_p2p_connection(P2PTxInvStore(), p2p_idx=self.next_p2p_idx, connection_type="outbound-full-relay")
+        self.next_p2p_idx += 1
+        return peer
+
+    def add_inbound_peer(self):
+        peer = self.nodes[0].add_p2p_connection(ReconciliationPeer())
+        peer.wait_until(lambda: peer.k0 is not None)
+        return peer
+
+    def test_initiator_announces(self):
+        self.log.info("Test that transactions are reconciled with outbound peers rather than announced")
+        node = self.nodes[0]
+        flooding_peer = self.add_outbound_flooding_peer()
+        peer = self.add_outbound_peer()
+
+        tx = self.wallet.send_self_transfer(from_node=node)
+        self.bump_mocktime()
+        request = peer.pop_message("reqrecon")
+        assert_equal(request.set_size, 1)
+        assert_equal(peer.wtx_invs(), [])
+        # Peers we do not reconcile with still get the transaction announced.
+        flooding_peer.wait_until(lambda: flooding_peer.tx_invs_received[int(tx["wtxid"], 16)] == 1)
+
+        # An empty sketch leaves the transaction as the difference, which the peer is missing.
+        peer.send_without_ping(msg_sketch(serialize_sketch(sketch_syndromes([], 1))))
+        diff = peer.pop_message("reconcildiff")
+        assert diff.success
+        assert_equal(diff.ask_shortids, [])
+        peer.wait_until(lambda: "inv" in peer.last_message)
+        assert_equal(peer.wtx_invs(), [int(tx["wtxid"], 16)])
+        peer.wait_until(lambda: "tx" in peer.last_message and peer.last_message["tx"].tx.wtxid_hex == tx["wtxid"])
+        node.disconnect_p2ps()
+
+    def test_initiator_requests(self):
+        self.log.info("Test that transactions the outbound peer has are requested")
+        node = self.nodes[0]
+        self.add_outbound_flooding_peer()
+        peer = self.add_outbound_peer()
+        tx = self.wallet.create_self_transfer()
+        self.bump_mocktime()
+        assert_equal(peer.pop_message("reqrecon").set_size, 0)
+
+        short_id = peer.short_id(tx["wtxid"])
+        peer.send_without_ping(msg_sketch(serialize_sketch(sketch_syndromes([short_id], 1))))
+        diff = peer.pop_message("reconcildiff")
+        assert diff.success
+        assert_equal(diff.ask_shortids, [short_id])
+
+        # The peer announces the requested transaction, which the node then fetches.
+        peer.send_without_ping(msg_inv([CInv(t=MSG_WTX, h=int(tx["wtxid"], 16))]))
+        peer.wait_for_getdata([int(tx["wtxid"], 16)])
+        peer.send_and_ping(msg_tx(tx["tx"]))
+        assert tx["txid"] in node.getrawmempool()
+        node.disconnect_p2ps()
+
+    def test_initiator_extension(self):
+        self.log.info("Test that the outbound peer is asked to extend a sketch that could not be decoded")
+        node = self.nodes[0]
+        self.add_outbound_flooding_peer()
+        peer = self.add_outbound_peer()
+        tx = self.wallet.send_self_transfer(from_node=node)
+        self.bump_mocktime()
+        assert_equal(peer.pop_message("reqrecon").set_size, 1)
+
+        # Relative to the node's set, the peer's set is missing nothing and has three
+        # elements that add up to zero. The first syndrome of the difference is zero
+        # while the second is not, so it can only be decoded once the sketch is extended.
+        x = random.randrange(1, 2**31)
+        difference = [x, x << 1, x ^ (x << 1)]
+        peer_syndromes = sketch_syndromes([peer.short_id(tx["wtxid"])] + difference, 4)
+        peer.send_without_ping(msg_sketch(serialize_sketch(peer_syndromes[:2])))
+        peer.pop_message("reqsktchext")
+        peer.send_without_ping(msg_sketch(serialize_sketch(peer_syndromes[2:])))
+        diff = peer.pop_message("reconcildiff")
+        assert diff.success
+        assert_equal(sorted(diff.ask_shortids), sorted(difference))
+        peer.sync_with_ping()
+        assert_equal(peer.wtx_invs(), [])
+        node.disconnect_p2ps()
+
+    def test_initiator_failure(self):
+        self.log.info("Test that the whole set is announced when the extended sketch cannot be decoded either")
+        node = self.nodes[0]
+        self.add_outbound_flooding_peer()
+        peer = self.add_outbound_peer()
+        tx = self.wallet.send_self_transfer(from_node=node)
+        self.bump_mocktime()
+        assert_equal(peer.pop_message("reqrecon").set_size, 1)
+
+        # A difference whose syndromes are (0, c, 0, 0) has the locator polynomial
+        # 1 + c*x^3, which has no roots when c is not a cube.
+        c = 2
+        while gf32_pow(c, (2**32 - 1) // 3) == 1:
+            c += 1
+        peer_syndromes = sketch_syndromes([peer.short_id(tx["wtxid"])], 4)
+        peer_syndromes[1] ^= c
+        peer.send_without_ping(msg_sketch(serialize_sketch(peer_syndromes[:2])))
+        peer.pop_message("reqsktchext")
+        peer.send_without_ping(msg_sketch(serialize_sketch(peer_syndromes[2:])))
+        diff = peer.pop_message("reconcildiff")
+        assert not diff.success
+        assert_equal(diff.ask_shortids, [])
+        peer.wait_until(lambda: "inv" in peer.last_message)
+        assert_equal(peer.wtx_invs(), [int(tx["wtxid"], 16)])
+        node.disconnect_p2ps()
+
+    def test_responder(self):
+        self.log.info("Test that the node sends sketches to inbound peers and announces what they ask for")
+        node = self.nodes[0]
+        peer = self.add_inbound_peer()
+        for success in [True, False]:
+            tx = self.wallet.send_self_transfer(from_node=node)
+            self.bump_mocktime()
+            peer.sync_with_ping()
+            assert_equal(peer.wtx_invs(), [])
+
+            # The sketch capacity is the difference of the set sizes, plus one.
+            short_id = peer.short_id(tx["wtxid"])
+            syndromes = sketch_syndromes([short_id], 4)
+            peer.send_without_ping(msg_reqrecon(set_size=0, q=0))
+            assert_equal(peer.pop_message("sketch").skdata, serialize_sketch(syndromes[:2]))
+            peer.send_without_ping(msg_reqsktchext())
+            assert_equal(peer.pop_message("sketch").skdata, serialize_sketch(syndromes[2:]))
+
+            # On success only the requested transactions are announced, on failure the whole set.
+            peer.send_without_ping(msg_reconcildiff(success=success, ask_shortids=[short_id] if success else []))
+            peer.wait_until(lambda: "inv" in peer.last_message)
+            assert_equal(peer.wtx_invs(), [int(tx["wtxid"], 16)])
+        node.disconnect_p2ps()
+
+    def test_fanout(self):
+        self.log.info("Test that transactions are flooded to an outbound peer we reconcile with if no other outbound peer gets them")
+        node = self.nodes[0]
+        peer = self.add_outbound_peer()
+        tx = self.wallet.send_self_transfer(from_node=node)
+        self.bump_mocktime()
+        peer.wait_until(lambda: "inv" in peer.last_message)
+        assert_equal(peer.wtx_invs(), [int(tx["wtxid"], 16)])
+        assert_equal(peer.pop_message("reqrecon").set_size, 0)
+        node.disconnect_p2ps()
+
+    def test_handshake_only(self):
+        self.log.info("Test that transactions are flooded to an outbound peer which does not answer reconciliation requests")
+        node = self.nodes[0]
+        self.add_outbound_flooding_peer()
+        peer = self.add_outbound_peer()
+        tx = self.wallet.send_self_transfer(from_node=node)
+        self.bump_mocktime()
+        assert_equal(peer.pop_message("reqrecon").set_size, 1)
+        assert_equal(peer.wtx_invs(), [])
+
+        # Once the round times out, the frozen set is announced and later transactions are flooded.
+        assert MOCKTIME_STEP >= RECON_ROUND_TIMEOUT
+        with node.assert_debug_log(["txreconciliation with peer=", "timed out, flooding transactions to it instead"]):
+            self.bump_mocktime()
+            peer.wait_until(lambda: "inv" in peer.last_message)
+        assert_equal(peer.wtx_invs(), [int(tx["wtxid"], 16)])
+        tx = self.wallet.send_self_transfer(from_node=node)
+        self.bump_mocktime()
+        peer.wait_until(lambda: "inv" in peer.last_message)
+        assert_equal(peer.wtx_invs(), [int(tx["wtxid"], 16)])
+        node.disconnect_p2ps()
+
+        self.log.info("Test that transactions are flooded to an inbound peer which does not request reconciliations")
+        peer = self.add_inbound_peer()
+        tx = self.wallet.send_self_transfer(from_node=node)
+        self.bump_mocktime()
+        peer.sync_with_ping()
+        assert_equal(peer.wtx_invs(), [])
+        self.mocktime += RECON_REQUEST_TIMEOUT
+        node.setmocktime(self.mocktime)
+        peer.wait_until(lambda: "inv" in peer.last_message)
+        assert_equal(peer.wtx_invs(), [int(tx["wtxid"], 16)])
+        node.disconnect_p2ps()
+
+    def test_protocol_violations(self):
+        self.log.info("Test that unexpected reconciliation messages are ignored or lead to a disconnect")
+        node = self.nodes[0]
+        peer = node.add_p2p_connection(P2PInterface())
+        with node.assert_debug_log(["reqrecon from peer=", "ignored, as we do not reconcile transactions with it"]):
+            peer.send_and_ping(msg_reqrecon())
+
+        peer = self.add_inbound_peer()
+        with node.assert_debug_log(["txreconciliation protocol violation (unexpected sketch)"]):
+            peer.send_without_ping(msg_sketch(serialize_sketch([0])))
+            peer.wait_for_disconnect()
+
+        peer = self.add_inbound_peer()
+        with node.assert_debug_log(["txreconciliation protocol violation (unexpected reconcildiff)"]):
+            peer.send_without_ping(msg_reconcildiff(success=True))
+            peer.wait_for_disconnect()
+        node.disconnect_p2ps()
+
+    def run_test(self):
+        self.wallet = MiniWallet(self.nodes[0])
+        self.mocktime = int(time.time())
+        self.nodes[0].setmocktime(self.mocktime)
+        self.next_p2p_idx = 0
+
+        self.test_initiator_announces()
+        self.test_initiator_requests()
+        self.test_initiator_extension()
+        self.test_initiator_failure()
+        self.test_responder()
+        self.test_fanout()
+        self.test_handshake_only()
+        self.test_protocol_violations()
+
+
+if __name__ == '__main__':
+    TxReconciliationTest(__file__).main()
@@ -59,6 +59,8 @@ class DumptxoutsetTest(BitquantumTestFramework):
         assert_equal(
             out['txoutset_hash'], 'd4453995f4f20db7bb3a604afd10d7128e8ee11159cde56d5b2fd7f55be7c74c')
         assert_equal(out['nchaintx'], 101)
+        assert_equal(out['bytes_written'], expected_path.stat().st_size)
+        assert out['bytes_per_second'] >= 0
 
         # Specifying a path to an existing or invalid file will fail.
         assert_raises_rpc_error(
@@ -12,6 +12,7 @@ from test_framework.util import (
     assert_greater_than,
     assert_greater_than_or_equal,
 )
+from test_framework.wallet import MiniWallet
 
 from test_framework.authproxy import JSONRPCException
 
@@ -99,6 +100,62 @@ class RpcMiscTest(BitquantumTestFramework):
         # Specifying an unknown index name returns an empty result
         assert_equal(node.getindexinfo("foo"), {})
 
+        self.log.info("test getdbstats")
+        self.restart_node(0, ["-txindex", "-dbbloombits=chainstate:16", "-dbblockcachepercent=indexes:25"])
+        stats = node.getdbstats()
+        assert_equal(sorted(stats), ["blocks", "chainstate", "txindex"])
+        assert_equal(stats["chainstate"]["bloom_bits"], 16)
+        assert_equal(stats["blocks"]["bloom_bits"], 10)
+        assert_equal(len(stats["chainstate"]["files_per_level"]), 7)
+        assert_equal(stats["chainstate"]["background_compactions"]["scheduled"], 0)
+        # The default block cache is twice the size of a write buffer, with
+        # 25% of the cache it is smaller.
+        assert_greater_than(stats["chainstate"]["block_cache_bytes"], stats["chainstate"]["write_buffer_bytes"])
+        assert_greater_than(stats["txindex"]["write_buffer_bytes"], stats["txindex"]["block_cache_bytes"])
+
+        self.log.info("test invalid database options")
+        self.stop_node(0)
+        node.assert_start_raises_init_error(["-dbbloombits=wallet:10"], "Error: Unknown database type in -dbbloombits=wallet:10, must be one of chainstate, blocks or indexes")
+        self.start_node(0)
+
+        self.log.info("test getvalidationcacheinfo")
+        wallet = MiniWallet(node)
+        info = node.getvalidationcacheinfo()
+        assert_greater_than(info["script_execution_cache"]["capacity"], 0)
+        assert_greater_than(info["signature_cache"]["capacity"], 0)
+        wallet.send_self_transfer(from_node=node)
+        self.generate(node, 1)
+        info = node.getvalidationcacheinfo()
+        assert_equal(info["last_block"]["height"], node.getblockcount())
+        # The scripts of the transaction were checked when it entered the mempool.
+        assert_equal(info["last_block"]["script_execution"], {"hits": 1, "misses": 0, "hit_rate": 1})
+        # Too few blocks to recommend anything else than the default size.
+        assert_equal(info["recommended_maxsigcachesize"], 32)
+
+        self.log.info("test -persistscriptcache")
+        self.restart_node(0, ["-persistscriptcache", "-persistmempool=0"])
+        tx = wallet.create_self_transfer()
+        node.sendrawtransaction(tx["hex"])
+        self.stop_node(0)
+        assert (node.chain_path / "scriptcache.dat").exists()
+        with node.assert_debug_log(["Loaded 1 script execution cache entries from file"]):
+            self.start_node(0, ["-persistscriptcache", "-persistmempool=0"])
+        assert_equal(node.getrawmempool(), [])
+        # With the persisted salt, the entry is found again.
+        hits = node.getvalidationcacheinfo()["lookups"]["script_execution"]["hits"]
+        node.sendrawtransaction(tx["hex"])
+        assert_equal(node.getvalidationcacheinfo()["lookups"]["script_execution"]["hits"], hits + 1)
+
+        self.log.info("test that a script execution cache written by a different build is discarded")
+        self.stop_node(0)
+        # The file starts with its 8-byte format version and the length of the build string.
+        path = node.chain_path / "scriptcache.dat"
+        data = bytearray(path.read_bytes())
+        data[9] ^= 1
+        path.write_bytes(data)
+        with node.assert_debug_log(["Discarding script execution cache file written by a different build"]):
+            self.start_node(0, ["-persistscriptcache", "-persistmempool=0"])
+
 
 if __name__ == '__main__':
     RpcMiscTest(__file__).main()
@@ -85,6 +85,7 @@ class RawTransactionsTest(BitquantumTestFramework):
         self.wallet = MiniWallet(self.nodes[0])
 
         self.getrawtransaction_tests()
+        self.getrawtransactions_tests()
         self.createrawtransaction_tests()
         self.sendrawtransaction_tests()
         self.sendrawtransaction_testmempoolaccept_tests()
@@ -178,6 +179,31 @@ class RawTransactionsTest(BitquantumTestFramework):
         block = self.nodes[0].getblock(self.nodes[0].getblockhash(0))
         assert_raises_rpc_error(-5, "The genesis block coinbase is not considered an ordinary transaction", self.nodes[0].getrawtransaction, block['merkleroot'])
 
+    def getrawtransactions_tests(self):
+        self.log.info("Test getrawtransactions")
+        mined = [self.wallet.send_self_transfer(from_node=self.nodes[0]) for _ in range(3)]
+        block_hash = self.generate(self.nodes[0], 1)[0]
+        in_mempool = self.wallet.send_self_transfer(from_node=self.nodes[0])
+        unknown = "00" * 32
+        genesis_coinbase = self.nodes[0].getblock(self.nodes[0].getblockhash(0))['merkleroot']
+        txids = [mined[1]['txid'], in_mempool['txid'], unknown, mined[0]['txid'], genesis_coinbase, mined[1]['txid'], mined[2]['txid']]
+
+        sync_txindex(self, self.nodes[0])
+        result = self.nodes[0].getrawtransactions(txids)
+        assert_equal(result, [mined[1]['hex'], in_mempool['hex'], None, mined[0]['hex'], None, mined[1]['hex'], mined[2]['hex']])
+        verbose = self.nodes[0].getrawtransactions(txids, True)
+        assert_equal([entry and entry['hex'] for entry in verbose], result)
+        assert_equal(verbose[0]['blockhash'], block_hash)
+        assert_equal(verbose[0]['confirmations'], 1)
+        assert 'blockhash' not in verbose[1]
+        assert_equal(self.nodes[0].getrawtransactions([]), [])
+
+        # Without -txindex only mempool transactions are found.
+        self.sync_mempools([self.nodes[0], self.nodes[2]])
+        assert_equal(self.nodes[2].getrawtransactions(txids[:3]), [None, in_mempool['hex'], None])
+        assert_raises_rpc_error(-8, "txids[1] must be of length 64", self.nodes[2].getrawtransactions, [unknown, "abcd"])
+        self.generate(self.nodes[0], 1)
+
     def getrawtransaction_verbosity_tests(self):
         tx = self.wallet.send_self_transfer(from_node=self.nodes[1])['txid']
         [block1] = self.generate(self.nodes[1], 1)